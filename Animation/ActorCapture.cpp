@@ -0,0 +1,131 @@
+#include "ActorCapture.h"
+#include "Animation.h"
+#include "Recording.h"
+
+#include <sstream>
+
+
+ActorCapture::ActorSource::ActorSource( const SkeletonSource& source, size_t firstActor )
+	: source(source)
+	, firstActor(firstActor)
+	, bound(false)
+	, trackingID(0)
+	, tracked(false)
+{}
+
+const SkeletonData *ActorCapture::ActorSource::getTrackedSkeletonData() const
+{
+	if (!bound) return nullptr;
+
+	const size_t numActors = source.getNumActors();
+	for (size_t actor = firstActor; actor < numActors; ++actor) {
+		const SkeletonData *skeletonData = source.getActorSkeletonData(actor);
+		if (nullptr != skeletonData && skeletonData->trackingID == trackingID) {
+			return skeletonData;
+		}
+	}
+	return nullptr;
+}
+
+
+ActorCapture::ActorCapture( const SkeletonSource& source, size_t maxActors, float reserveSeconds, bool skipPrimary/*=false*/ )
+	: source(source)
+	, firstActor(skipPrimary ? 1 : 0)
+	, reserveSeconds(reserveSeconds)
+	, capturing(false)
+	, sources()
+	, recordings()
+{
+	sources.reserve(maxActors);
+	recordings.reserve(maxActors);
+	for (size_t slot = 0; slot < maxActors; ++slot) {
+		sources.push_back(std::unique_ptr<ActorSource>(new ActorSource(source, firstActor)));
+		recordings.push_back(createRecording(slot));
+	}
+}
+
+ActorCapture::~ActorCapture()
+{}
+
+std::unique_ptr<Recording> ActorCapture::createRecording( size_t slot ) const
+{
+	std::ostringstream name;
+	name << "actor slot " << slot;
+	std::unique_ptr<Recording> recording(new Recording(name.str(), *sources[slot]));
+	recording->reserve(reserveSeconds);
+	return recording;
+}
+
+void ActorCapture::update( float delta )
+{
+	for (auto& slot : sources) {
+		slot->tracked = false;
+	}
+
+	// Actors already in a slot stay there, new ones take the first free slot, if there is one
+	const size_t numActors = source.getNumActors();
+	for (size_t actor = firstActor; actor < numActors; ++actor) {
+		const SkeletonData *skeletonData = source.getActorSkeletonData(actor);
+		if (nullptr == skeletonData) continue;
+
+		ActorSource *free = nullptr;
+		ActorSource *found = nullptr;
+		for (auto& slot : sources) {
+			if (slot->bound && slot->trackingID == skeletonData->trackingID) { found = slot.get(); break; }
+			if (!slot->bound && nullptr == free) free = slot.get();
+		}
+		if (nullptr == found && nullptr != free) {
+			found = free;
+			found->bound = true;
+			found->trackingID = skeletonData->trackingID;
+		}
+		if (nullptr != found) found->tracked = true;
+	}
+
+	// Outside a take a slot is freed as soon as its actor is lost, during one it waits for the actor
+	if (!capturing) {
+		for (auto& slot : sources) {
+			if (!slot->tracked) slot->bound = false;
+		}
+		return;
+	}
+
+	// Slots whose actor hasn't turned up yet keep time with the rest, so every take shares one timeline
+	for (auto& recording : recordings) {
+		recording->update(delta);
+	}
+}
+
+void ActorCapture::start()
+{
+	for (size_t slot = 0; slot < sources.size(); ++slot) {
+		if (!sources[slot]->tracked) sources[slot]->bound = false;
+		recordings[slot]->clearRecording();
+		recordings[slot]->startRecording();
+	}
+	capturing = true;
+}
+
+void ActorCapture::stop()
+{
+	for (auto& recording : recordings) {
+		recording->stopRecording();
+	}
+	capturing = false;
+}
+
+std::unique_ptr<Recording> ActorCapture::release( size_t slot )
+{
+	std::unique_ptr<Recording> take(createRecording(slot));
+	take.swap(recordings[slot]);
+	return take;
+}
+
+size_t ActorCapture::getMemoryUsage() const
+{
+	size_t bytes = 0;
+	for (auto& recording : recordings) {
+		bytes += recording->getAnimation()->getMemoryUsage();
+	}
+	return bytes;
+}
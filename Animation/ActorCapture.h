@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Kinect/SkeletonSource.h"
+
+#include <memory>
+#include <vector>
+
+class Recording;
+
+
+// Simultaneous capture of every actor a source tracks, each into a Recording of its own
+// Slots, their recordings and keyframe storage for reserveSeconds of capture are all made
+// up front. An actor keeps its slot for as long as its tracking ID is tracked, while capturing
+// for the whole take, so actors coming and going never allocate and a frame only allocates
+// once a take outgrows what was reserved
+class ActorCapture
+{
+public:
+	// maxActors slots, with skipPrimary actor 0 of source is left to a recording of its own
+	ActorCapture(const SkeletonSource& source, size_t maxActors, float reserveSeconds, bool skipPrimary = false);
+	~ActorCapture();
+
+	// Give newly tracked actors free slots, then add a frame to every slot's take while capturing
+	void update(float delta);
+	// Start new takes for the actors tracked now and any that turn up before stop()
+	void start();
+	// Every slot keeps its take until the next start()
+	void stop();
+
+	// Hand over the take of slot once stopped, a new recording takes its place
+	std::unique_ptr<Recording> release(size_t slot);
+
+	bool isCapturing() const;
+	size_t getNumSlots() const;
+	// Whether slot follows an actor, and its tracking ID if so
+	bool isBound(size_t slot) const;
+	unsigned int getTrackingID(size_t slot) const;
+	const Recording& getRecording(size_t slot) const;
+	size_t getMemoryUsage() const;
+
+private:
+	ActorCapture(const ActorCapture&);
+	ActorCapture& operator=(const ActorCapture&);
+
+	// One actor of the capture's source, found by tracking ID, what a slot's recording captures
+	class ActorSource : public SkeletonSource
+	{
+	public:
+		ActorSource(const SkeletonSource& source, size_t firstActor);
+
+		const SkeletonData *getTrackedSkeletonData() const;
+
+		const SkeletonSource& source;
+		const size_t firstActor;
+		bool bound;
+		unsigned int trackingID;
+		bool tracked; // seen in the latest update
+	};
+
+	std::unique_ptr<Recording> createRecording(size_t slot) const;
+
+	const SkeletonSource& source;
+	const size_t firstActor;
+	const float reserveSeconds;
+	bool capturing;
+
+	// Recordings keep a reference to their slot's source, so neither moves once made
+	std::vector< std::unique_ptr<ActorSource> > sources;
+	std::vector< std::unique_ptr<Recording> > recordings;
+
+};
+
+inline bool ActorCapture::isCapturing() const { return capturing; }
+inline size_t ActorCapture::getNumSlots() const { return sources.size(); }
+inline bool ActorCapture::isBound(size_t slot) const { return sources[slot]->bound; }
+inline unsigned int ActorCapture::getTrackingID(size_t slot) const { return sources[slot]->trackingID; }
+inline const Recording& ActorCapture::getRecording(size_t slot) const { return *recordings[slot]; }
@@ -3,19 +3,21 @@
 #include "TransformKeyFrame.h"
 
 #include "Skeleton.h"
+#include "Util/ThreadPool.h"
 
 #include <algorithm>
-
-bool hasBoneTrack( const Animation& animation, unsigned short boneId )
-{
-	return animation.getBoneTracks().find(boneId) != end(animation.getBoneTracks());
-}
+#include <cassert>
 
 Animation::Animation( unsigned short id, const std::string& name )
 	: mId(id)
 	, mName(name)
 	, mInterpMethod(KFInterp_Linear)
-{}
+	, mNumKeyFrames(0)
+	, mMemoryUsage(0)
+	, mLength(0)
+{
+	std::fill(mBoneTracks, mBoneTracks + EBoneID::COUNT, nullptr);
+}
 
 Animation::~Animation()
 {
@@ -27,15 +29,27 @@ void Animation::apply( Skeleton* skel, float time, float weight/*=1.f*/, float s
 	assert(nullptr != skel);
 
 	// apply bone tracks
-	std::for_each(begin(boneMask), end(boneMask), [&](const EBoneID& boneID) {
-		const BoneAnimationTrack& bt = *mBoneTracks.at(boneID);
-		bt.apply(skel, time, weight, scale);
+	boneMask.forEach([&](EBoneID boneID) {
+		const BoneAnimationTrack* bt = mBoneTracks[boneID];
+		if( bt != nullptr )
+			bt->apply(skel, time, weight, scale);
 	});
 }
 
+bool Animation::sample( unsigned short boneId, float time, TransformKeyFrame* kf ) const
+{
+	const BoneAnimationTrack* bt = getBoneTrack(boneId);
+	if( bt == nullptr || bt->getNumKeyFrames() == 0 )
+		return false;
+
+	bt->getInterpolatedKeyFrame(time, kf);
+	return true;
+}
+
 void Animation::getPositions( unsigned short boneId, std::vector<glm::vec3>& positions, float lastTime/*=-1.f*/ ) const
 {
-	const auto& track = mBoneTracks.at(boneId);
+	const BoneAnimationTrack* track = getBoneTrack(boneId);
+	assert(nullptr != track);
 	positions.clear();
 	positions.resize(track->getNumKeyFrames());
 
@@ -49,34 +63,51 @@ void Animation::getPositions( unsigned short boneId, std::vector<glm::vec3>& pos
 
 BoneAnimationTrack* Animation::createBoneTrack( unsigned short boneId )
 {
+	assert(boneId < EBoneID::COUNT);
+	if( mBoneTracks[boneId] != nullptr )
+		return mBoneTracks[boneId];
+
 	BoneAnimationTrack* bat = new BoneAnimationTrack(boneId, this);
-	mBoneTracks.insert(std::make_pair(bat->getBoneId(), bat));
+	mBoneTracks[boneId] = bat;
 	return bat;
 }
 
 void Animation::deleteBoneTrack( unsigned short boneId )
 {
-	BoneTrackIterator bti = mBoneTracks.find(boneId);
-	if( bti != end(mBoneTracks)  )
+	BoneAnimationTrack* bat = getBoneTrack(boneId);
+	if( bat != nullptr )
 	{
-		delete bti->second;
-		mBoneTracks.erase(bti);
+		// Remove the track before deleting it, its keyframe deletion updates the running totals
+		mBoneTracks[boneId] = nullptr;
+		delete bat;
 	}
 }
 
 void Animation::deleteAllBoneTrack()
 {
-	for(BoneTrackIterator bti = begin(mBoneTracks); bti != end(mBoneTracks); ++bti)
+	for(unsigned short boneId = 0; boneId < EBoneID::COUNT; ++boneId)
 	{
-		delete bti->second;
+		deleteBoneTrack(boneId);
 	}
-
-	mBoneTracks.clear();
 }
 
-BoneAnimationTrack* Animation::getBoneTrack(unsigned short boneId) const
+size_t Animation::reduceKeyFrames( const KeyFrameTolerance& tolerance, unsigned int numThreads/*=0*/ )
 {
-	return (hasBoneTrack(*this, boneId) ? mBoneTracks.at(boneId) : nullptr);
+	// Search each bone's track independently, the tracks are only changed back on this thread
+	std::vector< std::vector<bool> > keep(EBoneID::COUNT);
+	parallelFor(numThreads, EBoneID::COUNT, [&](size_t boneID) {
+		const BoneAnimationTrack* bt = mBoneTracks[boneID];
+		if( bt != nullptr )
+			bt->findRedundantKeyFrames(tolerance, keep[boneID]);
+	});
+
+	const size_t numKeyFrames = mNumKeyFrames;
+	for(unsigned short boneId = 0; boneId < EBoneID::COUNT; ++boneId)
+	{
+		if( mBoneTracks[boneId] != nullptr )
+			mBoneTracks[boneId]->deleteKeyFrames(keep[boneId]);
+	}
+	return numKeyFrames - mNumKeyFrames;
 }
 
 void Animation::setKFInterpMethod(KFInterpMethod interpMethod)
@@ -84,40 +115,40 @@ void Animation::setKFInterpMethod(KFInterpMethod interpMethod)
 	mInterpMethod = interpMethod;
 	if( mInterpMethod == KFInterp_Spline )
 	{
-		for(BoneTrackIterator bti = begin(mBoneTracks); bti != end(mBoneTracks); ++bti)
+		for(unsigned short boneId = 0; boneId < EBoneID::COUNT; ++boneId)
 		{
-			BoneAnimationTrack& bt = *bti->second;
-			bt._buildInterpSplines();
+			if( mBoneTracks[boneId] != nullptr )
+				mBoneTracks[boneId]->_buildInterpSplines();
 		}
 	}
 
 }
 
-float Animation::getLength() const
+void Animation::_keyFrameCreated( float time )
 {
-	float cur_length = 0, length = 0;
-
-	for(BoneTrackConstIterator bti = begin(mBoneTracks); bti != end(mBoneTracks); ++bti)
-	{
-		const BoneAnimationTrack& bt = *bti->second;
-		if( (cur_length = bt.getLength() ) > length )
-			length = cur_length;
-	}
+	++mNumKeyFrames;
+	if( time > mLength )
+		mLength = time;
+}
 
-	return length;
+void Animation::_memoryUsageChanged( size_t previousBytes, size_t bytes )
+{
+	assert( previousBytes <= mMemoryUsage );
+	mMemoryUsage = mMemoryUsage - previousBytes + bytes;
 }
 
-size_t Animation::_calcMemoryUsage() const
+void Animation::_keyFramesDeleted( size_t count )
 {
-	size_t mem_usage = 0;
+	assert( count <= mNumKeyFrames );
+	mNumKeyFrames -= count;
 
-	// Compute memory usage from animation tracks
-	for( BoneTrackConstIterator bti = begin(mBoneTracks); bti != end(mBoneTracks); ++bti)
+	// Deleted keyframes may have been the last ones, so find the new length
+	float cur_length = 0;
+	mLength = 0;
+	for(unsigned short boneId = 0; boneId < EBoneID::COUNT; ++boneId)
 	{
-		const BoneAnimationTrack& boneTrack = *bti->second;
-		mem_usage += boneTrack.getNumKeyFrames()
-		          * (sizeof(float) + 2 * sizeof(glm::vec3) + sizeof(glm::quat));
+		const BoneAnimationTrack* bt = mBoneTracks[boneId];
+		if( bt != nullptr && (cur_length = bt->getLength()) > mLength )
+			mLength = cur_length;
 	}
-
-	return mem_usage;
 }
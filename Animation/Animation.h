@@ -1,16 +1,16 @@
 #pragma once
 
 #include "AnimationTypes.h"
+#include "PoseSampler.h"
 
 #include <glm/glm.hpp>
 
 #include <string>
 #include <vector>
-#include <map>
-#include <set>
 
 class BoneAnimationTrack;
-enum EBoneID;
+class Skeleton;
+struct KeyFrameTolerance;
 
 enum KFInterpMethod
 {
@@ -18,12 +18,7 @@ enum KFInterpMethod
 	KFInterp_Spline
 };
 
-typedef std::map<unsigned short, BoneAnimationTrack*> BoneTracks; 
-typedef BoneTracks::iterator                          BoneTrackIterator;
-typedef BoneTracks::const_iterator                    BoneTrackConstIterator;
-
-
-class Animation
+class Animation : public PoseSampler
 {
 	friend class Skeleton;
 
@@ -32,35 +27,57 @@ public:
 	~Animation();
 
 	void apply(Skeleton* skel, float time, float weight=1.f, float scale=1.f, const BoneMask& boneMask=default_bone_mask) const;
+	bool sample(unsigned short boneId, float time, TransformKeyFrame* kf) const;
 	void getPositions(unsigned short boneId, std::vector<glm::vec3>& positions, float lastTime=-1.f) const;
 
 	void deleteAllBoneTrack();
 	void deleteBoneTrack(unsigned short boneId);
 	BoneAnimationTrack* createBoneTrack(unsigned short boneId);
 
+	// Delete keyframes that linear interpolation of the remaining ones reproduces within tolerance,
+	// bones are searched in parallel, numThreads of 0 uses one thread per hardware thread
+	// Returns the number of keyframes deleted
+	size_t reduceKeyFrames(const KeyFrameTolerance& tolerance, unsigned int numThreads = 0);
+
 	float getLength() const;
+	size_t getNumKeyFrames() const;
+	size_t getMemoryUsage() const;
 	unsigned short getId() const;
 	const std::string& getName() const;
-	const BoneTracks& getBoneTracks() const;
 	KFInterpMethod getKFInterpMethod() const;
+	// nullptr if there is no track for boneId
 	BoneAnimationTrack* getBoneTrack(unsigned short boneId) const;
 
+	void setName(const std::string& name);
 	void setKFInterpMethod(KFInterpMethod interpMethod);
 
-	size_t _calcMemoryUsage() const;
 	void _clone(Animation* clonePtr) const;
 
+	// Running keyframe and memory totals, kept up to date by the owned bone tracks
+	void _keyFrameCreated(float time);
+	void _keyFramesDeleted(size_t count);
+	void _memoryUsageChanged(size_t previousBytes, size_t bytes);
+
 private:
 	unsigned short mId;
 	std::string mName;
 
-	BoneTracks mBoneTracks;
+	// Indexed by bone id, nullptr where the bone has no track
+	BoneAnimationTrack* mBoneTracks[EBoneID::COUNT];
 	KFInterpMethod mInterpMethod;
 
+	size_t mNumKeyFrames;
+	size_t mMemoryUsage;
+	float mLength;
+
 };
 
 
+inline float Animation::getLength() const { return mLength; }
+inline size_t Animation::getNumKeyFrames() const { return mNumKeyFrames; }
+inline size_t Animation::getMemoryUsage() const { return mMemoryUsage; }
 inline unsigned short Animation::getId() const { return mId; }
 inline const std::string& Animation::getName() const { return mName; }
 inline KFInterpMethod Animation::getKFInterpMethod() const { return mInterpMethod; }
-inline const BoneTracks& Animation::getBoneTracks() const { return mBoneTracks; }
+inline BoneAnimationTrack* Animation::getBoneTrack(unsigned short boneId) const { return (boneId < EBoneID::COUNT) ? mBoneTracks[boneId] : nullptr; }
+inline void Animation::setName(const std::string& name) { mName = name; }
@@ -28,18 +28,35 @@ SOFTWARE.
 
 
 AnimationTrack::AnimationTrack( Animation* anim )
-	: mKeyFrames()
-	, mAnim(anim)
+	: mAnim(anim)
+	, mKeyFrames()
+	, mGeneration(0)
+	, mMemoryUsage(0)
 {}
 
 AnimationTrack::~AnimationTrack()
 {
 	deleteAllKeyFrames();
+
+	// Whatever the subclass still held is gone with it
+	if( mAnim != nullptr ) mAnim->_memoryUsageChanged(mMemoryUsage, 0);
 }
 
 KeyFrame* AnimationTrack::createKeyFrame( float time )
 {
 	KeyFrame* kf = nullptr;
+	++mGeneration;
+
+	// Fast path for appending past the end, the common case when recording or blending
+	if( mKeyFrames.empty() || mKeyFrames.back()->getTime() + 0.00001f <= time )
+	{
+		kf = _createKeyFrame(time);
+		kf->_setIndex( mKeyFrames.size() );
+		mKeyFrames.push_back(kf);
+		if( mAnim != nullptr ) mAnim->_keyFrameCreated(time);
+		_updateMemoryUsage();
+		return kf;
+	}
 
 	for( KeyFrameIterator kfi = begin(mKeyFrames); kfi != end(mKeyFrames); ++kfi )
 	{
@@ -53,6 +70,7 @@ KeyFrame* AnimationTrack::createKeyFrame( float time )
 		{
 			kf = _createKeyFrame(time);
 			mKeyFrames.insert( kfi, kf );
+			if( mAnim != nullptr ) mAnim->_keyFrameCreated(time);
 			break;
 		}
 	}
@@ -61,9 +79,11 @@ KeyFrame* AnimationTrack::createKeyFrame( float time )
 	{
 		kf = _createKeyFrame(time);
 		mKeyFrames.push_back(kf);
+		if( mAnim != nullptr ) mAnim->_keyFrameCreated(time);
 	}
 
 	_updateKeyFrameIndices();
+	_updateMemoryUsage();
 
 	return kf;
 }
@@ -72,18 +92,47 @@ void AnimationTrack::deleteKeyFrame( unsigned int index )
 {
 	assert( index < getNumKeyFrames() );
 
-	delete mKeyFrames[index];
+	_destroyKeyFrame( mKeyFrames[index] );
 	mKeyFrames.erase( mKeyFrames.begin() + index );
+	++mGeneration;
+
+	_updateKeyFrameIndices();
+
+	if( mAnim != nullptr ) mAnim->_keyFramesDeleted(1);
+}
+
+void AnimationTrack::deleteKeyFrames( const std::vector<bool>& keep )
+{
+	assert( keep.size() == getNumKeyFrames() );
+
+	size_t kept = 0;
+	for( size_t kfi = 0; kfi < mKeyFrames.size(); ++kfi )
+	{
+		if( keep[kfi] )
+			mKeyFrames[kept++] = mKeyFrames[kfi];
+		else
+			_destroyKeyFrame( mKeyFrames[kfi] );
+	}
+
+	const size_t count = mKeyFrames.size() - kept;
+	mKeyFrames.resize(kept);
+	++mGeneration;
 
 	_updateKeyFrameIndices();
+
+	if( mAnim != nullptr && count > 0 ) mAnim->_keyFramesDeleted(count);
 }
 
 void AnimationTrack::deleteAllKeyFrames()
 {
-	for( unsigned int kfi = 0; kfi < mKeyFrames.size(); ++kfi )
-		delete mKeyFrames[kfi];
+	_destroyAllKeyFrames();
 
+	const size_t count = mKeyFrames.size();
 	mKeyFrames.clear();
+	++mGeneration;
+
+	if( mAnim != nullptr && count > 0 ) mAnim->_keyFramesDeleted(count);
+	_updateMemoryUsage();
 }
 
 KeyFrame* AnimationTrack::getKeyFrame( unsigned int index ) const
@@ -98,6 +147,11 @@ unsigned int AnimationTrack::getNumKeyFrames() const
 	return mKeyFrames.size();
 }
 
+std::size_t AnimationTrack::getMemoryUsage() const
+{
+	return mKeyFrames.capacity() * sizeof(KeyFrame*);
+}
+
 AnimationTrack::KeyFrameIterator AnimationTrack::getKeyFrameIterator()
 {
 	return begin(mKeyFrames); //KeyFrameIterator( mKeyFrames );
@@ -145,6 +199,28 @@ float AnimationTrack::getLength() const
 	return mKeyFrames[ getNumKeyFrames() - 1 ]->getTime();
 }
 
+void AnimationTrack::_updateMemoryUsage()
+{
+	// Only changes when the pointer array or the key-frame storage grows or is released
+	const std::size_t bytes = getMemoryUsage();
+	if( bytes == mMemoryUsage )
+		return;
+
+	if( mAnim != nullptr ) mAnim->_memoryUsageChanged(mMemoryUsage, bytes);
+	mMemoryUsage = bytes;
+}
+
+void AnimationTrack::_destroyKeyFrame( KeyFrame* kf )
+{
+	delete kf;
+}
+
+void AnimationTrack::_destroyAllKeyFrames()
+{
+	for( unsigned int kfi = 0; kfi < mKeyFrames.size(); ++kfi )
+		delete mKeyFrames[kfi];
+}
+
 void AnimationTrack::_updateKeyFrameIndices()
 {
 	for( unsigned int kfi = 0; kfi < mKeyFrames.size(); ++kfi )
@@ -22,6 +22,7 @@ SOFTWARE.
 #pragma once
 
 #include <vector>
+#include <cstddef>
 
 class KeyFrame;
 class Animation;
@@ -72,6 +73,13 @@ public:
 	*/
 	virtual void deleteKeyFrame( unsigned int index );
 
+	/**
+	* Deletes every key-frame not flagged to be kept.
+	*
+	* @param keep One flag per key-frame, false where the key-frame should be deleted.
+	*/
+	virtual void deleteKeyFrames( const std::vector<bool>& keep );
+
 	/**
 	* Deletes all key-frames.
 	*/
@@ -92,6 +100,21 @@ public:
 	*/
 	virtual unsigned int getNumKeyFrames() const;
 
+	/**
+	* Gets the memory held for key-frames, in bytes.
+	*
+	* The base class only counts the key-frame pointers,
+	* subclasses add the storage of the key-frames themselves.
+	*/
+	virtual std::size_t getMemoryUsage() const;
+
+	/**
+	* Gets the key-frame generation, which changes whenever
+	* key-frames are created or deleted, so data derived from the
+	* key-frames can tell when it is stale even if their number is the same.
+	*/
+	std::size_t getGeneration() const;
+
 	/**
 	* Gets an iterator over the vector of key-frames.
 	*/
@@ -145,14 +168,20 @@ public:
 protected:
 
 	virtual KeyFrame* _createKeyFrame( float time ) = 0; ///< Actual key-frame creation, implemented in concrete AnimationTrack subclasses.
+	virtual void _destroyKeyFrame( KeyFrame* kf ); ///< Frees a key-frame made by _createKeyFrame.
+	virtual void _destroyAllKeyFrames(); ///< Frees every key-frame, mKeyFrames is cleared by the caller.
 	virtual void _updateKeyFrameIndices();
+	void _updateMemoryUsage(); ///< Reports a change of getMemoryUsage() to the owning animation.
 
 	Animation* mAnim;
 
 	std::vector<KeyFrame*> mKeyFrames;
+	std::size_t mGeneration; ///< Bumped by every key-frame creation and deletion.
+	std::size_t mMemoryUsage; ///< Last memory usage reported to the owning animation.
 
 };
 
 
 inline Animation* AnimationTrack::getAnimation() const { return mAnim; }
 inline const std::vector<KeyFrame*>& AnimationTrack::getKeyFrames() const { return mKeyFrames; }
+inline std::size_t AnimationTrack::getGeneration() const { return mGeneration; }
@@ -1,20 +1,51 @@
 #include "AnimationTypes.h"
 
 
-const BoneMask empty_bone_mask = BoneMask();
+const BoneMask empty_bone_mask   = BoneMask(BONE_MASK_NONE);
+const BoneMask default_bone_mask = BoneMask(BONE_MASK_ALL);
+const BoneMask seated_bone_mask  = BoneMask(BONE_MASK_SEATED);
 
-const BoneMask default_bone_mask = ([]() -> BoneMask {
-	BoneMask mask;
-	for (int id = 0; id < EBoneID::COUNT; ++id) {
-		mask.insert((EBoneID) id);
+
+BoneMask::BoneMask(unsigned int bits, float weight)
+	: mask(bits & BONE_MASK_ALL)
+{
+	for (int id = 0; id < COUNT; ++id) {
+		boneWeights[id] = contains((EBoneID) id) ? weight : 0.f;
+	}
+}
+
+void BoneMask::insert(EBoneID boneID, float weight)
+{
+	mask |= (1u << boneID);
+	boneWeights[boneID] = weight;
+}
+
+void BoneMask::erase(EBoneID boneID)
+{
+	mask &= ~(1u << boneID);
+	boneWeights[boneID] = 0.f;
+}
+
+void BoneMask::clear()
+{
+	mask = BONE_MASK_NONE;
+	for (int id = 0; id < COUNT; ++id) {
+		boneWeights[id] = 0.f;
 	}
-	return mask;
-} ());
+}
+
+unsigned int BoneMask::size() const
+{
+	unsigned int count = 0;
+	forEach([&](EBoneID) { ++count; });
+	return count;
+}
 
-const BoneMask seated_bone_mask = ([]() -> BoneMask {
-	BoneMask mask;
-	for (int id = SHOULDER_CENTER; id <= HAND_RIGHT; ++id) {
-		mask.insert((EBoneID) id);
+bool BoneMask::operator==(const BoneMask& other) const
+{
+	if (mask != other.mask) return false;
+	for (int id = 0; id < COUNT; ++id) {
+		if (boneWeights[id] != other.boneWeights[id]) return false;
 	}
-	return mask;
-} ());
+	return true;
+}
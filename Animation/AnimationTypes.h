@@ -1,7 +1,10 @@
 #pragma once
 
 #include <map>
-#include <set>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 
 enum ELayerMappingMode
@@ -40,7 +43,72 @@ enum EBoneID
 
 typedef std::map<EBoneID, EBoneID> BoneJointPairs;
 
-typedef std::set<EBoneID> BoneMask;
+// Preset bone masks as plain bits (bit n is EBoneID n), usable in constant expressions
+enum EBoneMaskBits
+{
+	BONE_MASK_NONE   = 0,
+	BONE_MASK_ALL    = (1 << COUNT) - 1,
+	BONE_MASK_SEATED = ((1 << (HAND_RIGHT + 1)) - 1) & ~((1 << SHOULDER_CENTER) - 1)
+};
+
+// Index of the lowest set bit in a non-zero value
+inline unsigned int lowestSetBit(unsigned int bits)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, bits);
+	return index;
+#else
+	return __builtin_ctz(bits);
+#endif
+}
+
+
+// Set of bones stored as a 32-bit mask, with a weight per bone for soft masks
+// Weights of bones not in the mask are always 0 so they can be used without testing membership
+class BoneMask
+{
+public:
+	explicit BoneMask(unsigned int bits = BONE_MASK_NONE, float weight = 1.f);
+
+	void insert(EBoneID boneID, float weight = 1.f);
+	void erase(EBoneID boneID);
+	void clear();
+
+	bool contains(EBoneID boneID) const;
+	bool empty() const;
+	unsigned int size() const;
+	unsigned int bits() const;
+
+	float weight(EBoneID boneID) const;
+	const float *weights() const;
+
+	// Call func(EBoneID) for each bone in the mask, in bone id order
+	template<class Func> void forEach(Func func) const;
+
+	bool operator==(const BoneMask& other) const;
+	bool operator!=(const BoneMask& other) const;
+
+private:
+	unsigned int mask;
+	float boneWeights[COUNT];
+
+};
+
+inline bool BoneMask::contains(EBoneID boneID) const { return 0 != (mask & (1u << boneID)); }
+inline bool BoneMask::empty() const { return 0 == mask; }
+inline unsigned int BoneMask::bits() const { return mask; }
+inline float BoneMask::weight(EBoneID boneID) const { return boneWeights[boneID]; }
+inline const float *BoneMask::weights() const { return boneWeights; }
+inline bool BoneMask::operator!=(const BoneMask& other) const { return !(*this == other); }
+
+template<class Func>
+inline void BoneMask::forEach(Func func) const
+{
+	for (unsigned int remaining = mask; 0 != remaining; remaining &= remaining - 1) {
+		func(static_cast<EBoneID>(lowestSetBit(remaining)));
+	}
+}
 
 extern const BoneMask empty_bone_mask;
 extern const BoneMask default_bone_mask;
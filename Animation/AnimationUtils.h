@@ -1,8 +1,50 @@
 #pragma once
 
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
 class Animation;
+class Skeleton;
+
+
+// Poses skeleton with animation at time then draws it from the skeleton's world transforms
+// Only touches skeleton, so different animations and skeletons can be posed concurrently,
+// calibrate the skeleton first to draw with its rest bone lengths
+void renderAnimation(const Animation& animation, Skeleton& skeleton, const float time = 0.f);
+
+// Draws an already posed skeleton, e.g. one evaluated by a PoseEvaluator, moved by offset
+void renderPose(const Skeleton& skeleton, const glm::vec3& offset = glm::vec3());
 
 
-void exportAnimationAsBVH(const Animation *animation);
+// Rotation angle between two unit quaternions, accurate for small angles unlike acos of the dot product
+inline float angleBetween(const glm::quat& a, glm::quat b)
+{
+	if (glm::dot(a, b) < 0.f) b = -b;
+	const float dw = a.w - b.w, dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+	const float chord = std::sqrt(dw * dw + dx * dx + dy * dy + dz * dz);
+	return 4.f * std::asin(std::min(1.f, 0.5f * chord));
+}
 
-void renderAnimation(const Animation& animation, const float time = 0.f);
+// Normalized lerp between quaternion arrays along the shortest arc, out may alias a
+inline void nlerp(const float *aw, const float *ax, const float *ay, const float *az
+                , const float *bw, const float *bx, const float *by, const float *bz
+                , float weight, size_t count
+                , float *ow, float *ox, float *oy, float *oz)
+{
+	const float inv = 1.f - weight;
+	for (size_t i = 0; i < count; ++i) {
+		const float dot = aw[i] * bw[i] + ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+		const float w = (dot < 0.f) ? -weight : weight;
+		const float qw = inv * aw[i] + w * bw[i];
+		const float qx = inv * ax[i] + w * bx[i];
+		const float qy = inv * ay[i] + w * by[i];
+		const float qz = inv * az[i] + w * bz[i];
+		const float len = std::sqrt(qw * qw + qx * qx + qy * qy + qz * qz);
+		const float s = (len > 0.f) ? 1.f / len : 0.f;
+		ow[i] = qw * s; ox[i] = qx * s; oy[i] = qy * s; oz[i] = qz * s;
+	}
+}
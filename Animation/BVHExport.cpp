@@ -0,0 +1,332 @@
+#include "BVHExport.h"
+
+#include "Animation.h"
+#include "TransformKeyFrame.h"
+#include "BoneAnimationTrack.h"
+#include "Skeleton.h"
+#include "Util/zhGlm.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+using namespace std;
+
+
+void exportHeirarchyAsBVH(const Animation *animation, ostream& fout, zh::EulerRotOrder eulerOrder);
+void exportMotionAsBVH(const Animation *animation, ostream& fout, zh::EulerRotOrder eulerOrder);
+
+std::string eulerOrderFileString(zh::EulerRotOrder eulerOrder)
+{
+	switch (eulerOrder)
+	{
+		case zh::EulerRotOrder::EulerRotOrder_XYZ: return "xyz";
+		case zh::EulerRotOrder::EulerRotOrder_XZY: return "xzy";
+		case zh::EulerRotOrder::EulerRotOrder_YXZ: return "yxz";
+		case zh::EulerRotOrder::EulerRotOrder_YZX: return "yzx";
+		case zh::EulerRotOrder::EulerRotOrder_ZXY: return "zxy";
+		case zh::EulerRotOrder::EulerRotOrder_ZYX: return "zyx";
+		default: return "xyz";
+	}
+}
+
+std::string eulerOrderBVHString(zh::EulerRotOrder eulerOrder)
+{
+	switch (eulerOrder)
+	{
+		case zh::EulerRotOrder::EulerRotOrder_XYZ: return "Xrotation Yrotation Zrotation";
+		case zh::EulerRotOrder::EulerRotOrder_XZY: return "Xrotation Zrotation Yrotation";
+		case zh::EulerRotOrder::EulerRotOrder_YXZ: return "Yrotation Xrotation Zrotation";
+		case zh::EulerRotOrder::EulerRotOrder_YZX: return "Yrotation Zrotation Xrotation";
+		case zh::EulerRotOrder::EulerRotOrder_ZXY: return "Zrotation Xrotation Yrotation";
+		case zh::EulerRotOrder::EulerRotOrder_ZYX: return "Zrotation Yrotation Xrotation";
+		default: return "Xrotation Yrotation Zrotation";
+	}
+}
+
+void outputAngles(ostream& fout, const glm::vec3& angles, zh::EulerRotOrder eulerOrder)
+{
+	switch (eulerOrder)
+	{
+		case zh::EulerRotOrder::EulerRotOrder_XYZ:
+			fout << glm::degrees(angles.x) << " " << glm::degrees(angles.y) << " " << glm::degrees(angles.z) << " ";
+			break;
+		case zh::EulerRotOrder::EulerRotOrder_XZY:
+			fout << glm::degrees(angles.x) << " " << glm::degrees(angles.z) << " " << glm::degrees(angles.y) << " ";
+			break;
+		case zh::EulerRotOrder::EulerRotOrder_YXZ:
+			fout << glm::degrees(angles.y) << " " << glm::degrees(angles.x) << " " << glm::degrees(angles.z) << " ";
+			break;
+		case zh::EulerRotOrder::EulerRotOrder_YZX:
+			fout << glm::degrees(angles.y) << " " << glm::degrees(angles.z) << " " << glm::degrees(angles.x) << " ";
+			break;
+		case zh::EulerRotOrder::EulerRotOrder_ZXY:
+			fout << glm::degrees(angles.z) << " " << glm::degrees(angles.x) << " " << glm::degrees(angles.y) << " ";
+			break;
+		case zh::EulerRotOrder::EulerRotOrder_ZYX:
+			fout << glm::degrees(angles.z) << " " << glm::degrees(angles.y) << " " << glm::degrees(angles.x) << " ";
+			break;
+	}
+}
+
+void exportAnimationAsBVH(const Animation& animation, ostream& fout, zh::EulerRotOrder eulerOrder)
+{
+	exportHeirarchyAsBVH(&animation, fout, eulerOrder);
+	exportMotionAsBVH(&animation, fout, eulerOrder);
+}
+
+void exportAnimationAsBVH_WithOrdering(const Animation& animation, zh::EulerRotOrder eulerOrder)
+{
+	const string filename = animation.getName() + "_" + eulerOrderFileString(eulerOrder) + ".bvh";
+	ofstream fout(filename);
+	if (!fout.is_open()) {
+		cout << "Unable to open file '" << filename << "' for writing.\n";
+		return;
+	}
+
+	exportAnimationAsBVH(animation, fout, eulerOrder);
+
+	fout.close();
+}
+
+void exportAnimationAsBVH(const Animation *animation)
+{
+	if (nullptr == animation) return;
+
+	exportAnimationAsBVH_WithOrdering(*animation, zh::EulerRotOrder::EulerRotOrder_XYZ);
+	// Uncomment for debugging purposes...
+	//exportAnimationAsBVH_WithOrdering(*animation, zh::EulerRotOrder::EulerRotOrder_XZY);
+	//exportAnimationAsBVH_WithOrdering(*animation, zh::EulerRotOrder::EulerRotOrder_YXZ);
+	//exportAnimationAsBVH_WithOrdering(*animation, zh::EulerRotOrder::EulerRotOrder_YZX);
+	//exportAnimationAsBVH_WithOrdering(*animation, zh::EulerRotOrder::EulerRotOrder_ZXY);
+	//exportAnimationAsBVH_WithOrdering(*animation, zh::EulerRotOrder::EulerRotOrder_ZYX);
+}
+
+
+void exportHeirarchyAsBVH(const Animation *animation, ostream& fout, zh::EulerRotOrder eulerOrder)
+{
+	const string translationOrder("Xposition Yposition Zposition");
+	const string rotationOrder = eulerOrderBVHString(eulerOrder);
+	const float scale = 100.f;
+
+	const auto& rootTrack = animation->getBoneTrack(HIP_CENTER);
+	const auto& rootKeyFrame = static_cast<TransformKeyFrame*>(rootTrack->getKeyFrame(0));
+
+	// Joint positions of the first pose relative to the root, read from the skeleton's world transforms
+	Skeleton skeleton;
+	animation->apply(&skeleton, rootKeyFrame->getTime());
+	const glm::vec3 rootPosition(skeleton.getWorldPosition(HIP_CENTER));
+
+	vector<glm::vec3> offsets;
+	for (unsigned short i = 0; i < EBoneID::COUNT; ++i) {
+		const glm::vec3 position(skeleton.getWorldPosition(i));
+		offsets.push_back(scale * (position - rootPosition));
+	}
+
+	// -------------------------------------------------------------------------
+	// ROOT
+	// -------------------------------------------------------------------------
+	fout << "HIERARCHY" << endl;
+	fout << "ROOT Hip" << endl;
+	fout << "{" << endl;
+	fout << "\tOFFSET 0.0 0.0 0.0" << endl;
+	fout << "\tCHANNELS 6 " << translationOrder << " " << rotationOrder << endl;
+
+	// -------------------------------------------------------------------------
+	// Spine
+	fout << "\tJOINT Spine" << endl;
+	fout << "\t{" << endl;
+	fout << "\t\tOFFSET " << offsets[1].x - offsets[0].x << " " << offsets[1].y - offsets[0].y << " " << offsets[1].z - offsets[0].z << endl;
+	fout << "\t\tCHANNELS 3 " << rotationOrder << endl;
+
+	// -------------------------------------------------------------------------
+	// Shoulder Center
+	fout << "\t\tJOINT ShoulderCenter" << endl;
+	fout << "\t\t{" << endl;
+	fout << "\t\t\tOFFSET " << offsets[2].x - offsets[1].x << " " << offsets[2].y - offsets[1].y << " " << offsets[2].z - offsets[1].z << endl;
+	fout << "\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Head
+	fout << "\t\t\tJOINT Head" << endl;
+	fout << "\t\t\t{" << endl;
+	fout << "\t\t\t\tOFFSET " << offsets[3].x - offsets[2].x << " " << offsets[3].y - offsets[2].y << " " << offsets[3].z - offsets[2].z << endl;
+	fout << "\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// End Site
+	fout << "\t\t\t\tEnd Site" << endl;
+	fout << "\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\tOFFSET 0.0 0.0 0.0" << endl;
+	fout << "\t\t\t\t}" << endl;
+	fout << "\t\t\t}" << endl;
+
+	// -------------------------------------------------------------------------
+	// Shoulder Left
+	fout << "\t\t\tJOINT ShoulderLeft" << endl;
+	fout << "\t\t\t{" << endl;
+	fout << "\t\t\t\tOFFSET " << offsets[4].x - offsets[2].x << " " << offsets[4].y - offsets[2].y << " " << offsets[4].z - offsets[2].z << endl;
+	fout << "\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Elbow Left
+	fout << "\t\t\t\tJOINT ElbowLeft" << endl;
+	fout << "\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\tOFFSET " << offsets[5].x - offsets[4].x << " " << offsets[5].y - offsets[4].y << " " << offsets[5].z - offsets[4].z << endl;
+	fout << "\t\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Wrist Left
+	fout << "\t\t\t\t\tJOINT WristLeft" << endl;
+	fout << "\t\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\t\tOFFSET " << offsets[6].x - offsets[5].x << " " << offsets[6].y - offsets[5].y << " " << offsets[6].z - offsets[5].z << endl;
+	fout << "\t\t\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Hand Left
+	fout << "\t\t\t\t\t\tJOINT HandLeft" << endl;
+	fout << "\t\t\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\t\t\tOFFSET " << offsets[7].x - offsets[6].x << " " << offsets[7].y - offsets[6].y << " " << offsets[7].z - offsets[6].z << endl;
+	fout << "\t\t\t\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// End Site
+	fout << "\t\t\t\t\t\t\tEnd Site" << endl;
+	fout << "\t\t\t\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\t\t\t\tOFFSET 0.0 0.0 0.0" << endl;
+	fout << "\t\t\t\t\t\t\t}" << endl;
+	fout << "\t\t\t\t\t\t}" << endl;
+	fout << "\t\t\t\t\t}" << endl;
+	fout << "\t\t\t\t}" << endl;
+	fout << "\t\t\t}" << endl;
+
+	// -------------------------------------------------------------------------
+	// Shoulder Right
+	fout << "\t\t\tJOINT ShoulderRight" << endl;
+	fout << "\t\t\t{" << endl;
+	fout << "\t\t\t\tOFFSET " << offsets[8].x - offsets[2].x << " " << offsets[8].y - offsets[2].y << " " << offsets[8].z - offsets[2].z << endl;
+	fout << "\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Elbow Right
+	fout << "\t\t\t\tJOINT ElbowRight" << endl;
+	fout << "\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\tOFFSET " << offsets[9].x - offsets[8].x << " " << offsets[9].y - offsets[8].y << " " << offsets[9].z - offsets[8].z << endl;
+	fout << "\t\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Wrist Right
+	fout << "\t\t\t\t\tJOINT WristRight" << endl;
+	fout << "\t\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\t\tOFFSET " << offsets[10].x - offsets[9].x << " " << offsets[10].y - offsets[9].y << " " << offsets[10].z - offsets[9].z << endl;
+	fout << "\t\t\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Hand Right
+	fout << "\t\t\t\t\t\tJOINT HandRight" << endl;
+	fout << "\t\t\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\t\t\tOFFSET " << offsets[11].x - offsets[10].x << " " << offsets[11].y - offsets[10].y << " " << offsets[11].z - offsets[10].z << endl;
+	fout << "\t\t\t\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// End Site
+	fout << "\t\t\t\t\t\t\tEnd Site" << endl;
+	fout << "\t\t\t\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\t\t\t\tOFFSET 0.0 0.0 0.0" << endl;
+	fout << "\t\t\t\t\t\t\t}" << endl;
+	fout << "\t\t\t\t\t\t}" << endl;
+	fout << "\t\t\t\t\t}" << endl;
+	fout << "\t\t\t\t}" << endl;
+	fout << "\t\t\t}" << endl;
+
+	fout << "\t\t}" << endl;
+
+	fout << "\t}" << endl;
+
+	// -------------------------------------------------------------------------
+	// Hip Left
+	fout << "\tJOINT HipLeft" << endl;
+	fout << "\t{" << endl;
+	fout << "\t\tOFFSET " << offsets[12].x - offsets[0].x << " " << offsets[12].y - offsets[0].y << " " << offsets[12].z - offsets[0].z << endl;
+	fout << "\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Knee Left
+	fout << "\t\tJOINT KneeLeft" << endl;
+	fout << "\t\t{" << endl;
+	fout << "\t\t\tOFFSET " << offsets[13].x - offsets[12].x << " " << offsets[13].y - offsets[12].y << " " << offsets[13].z - offsets[12].z << endl;
+	fout << "\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Ankle Left
+	fout << "\t\t\tJOINT AnkleLeft" << endl;
+	fout << "\t\t\t{" << endl;
+	fout << "\t\t\t\tOFFSET " << offsets[14].x - offsets[13].x << " " << offsets[14].y - offsets[13].y << " " << offsets[14].z - offsets[13].z << endl;
+	fout << "\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Foot Left
+	fout << "\t\t\t\tJOINT FootLeft" << endl;
+	fout << "\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\tOFFSET " << offsets[15].x - offsets[14].x << " " << offsets[15].y - offsets[14].y << " " << offsets[15].z - offsets[14].z << endl;
+	fout << "\t\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// End Site
+	fout << "\t\t\t\t\tEnd Site" << endl;
+	fout << "\t\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\t\tOFFSET 0.0 0.0 0.0" << endl;
+	fout << "\t\t\t\t\t}" << endl;
+	fout << "\t\t\t\t}" << endl;
+	fout << "\t\t\t}" << endl;
+	fout << "\t\t}" << endl;
+	fout << "\t}" << endl;
+
+	// -------------------------------------------------------------------------
+	// Hip Right
+	fout << "\tJOINT HipRight" << endl;
+	fout << "\t{" << endl;
+	fout << "\t\tOFFSET " << offsets[16].x - offsets[0].x << " " << offsets[16].y - offsets[0].y << " " << offsets[16].z - offsets[0].z << endl;
+	fout << "\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Knee Right
+	fout << "\t\tJOINT KneeRight" << endl;
+	fout << "\t\t{" << endl;
+	fout << "\t\t\tOFFSET " << offsets[17].x - offsets[16].x << " " << offsets[17].y - offsets[16].y << " " << offsets[17].z - offsets[16].z << endl;
+	fout << "\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Ankle Right
+	fout << "\t\t\tJOINT AnkleRight" << endl;
+	fout << "\t\t\t{" << endl;
+	fout << "\t\t\t\tOFFSET " << offsets[18].x - offsets[17].x << " " << offsets[18].y - offsets[17].y << " " << offsets[18].z - offsets[17].z << endl;
+	fout << "\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// Foot Right
+	fout << "\t\t\t\tJOINT FootRight" << endl;
+	fout << "\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\tOFFSET " << offsets[19].x - offsets[18].x << " " << offsets[19].y - offsets[18].y << " " << offsets[19].z - offsets[18].z << endl;
+	fout << "\t\t\t\t\tCHANNELS 3 " << rotationOrder << endl;
+	// End Site
+	fout << "\t\t\t\t\tEnd Site" << endl;
+	fout << "\t\t\t\t\t{" << endl;
+	fout << "\t\t\t\t\t\tOFFSET 0.0 0.0 0.0" << endl;
+	fout << "\t\t\t\t\t}" << endl;
+	fout << "\t\t\t\t}" << endl;
+	fout << "\t\t\t}" << endl;
+	fout << "\t\t}" << endl;
+	fout << "\t}" << endl;
+
+	fout << "}" << endl;
+}
+
+void outputRotationAngles(int boneId, float time, const Animation *animation, ostream& fout, zh::EulerRotOrder eulerOrder)
+{
+	const auto& track = animation->getBoneTrack(boneId);
+	TransformKeyFrame keyFrame(time, 0);
+	track->getInterpolatedKeyFrame(time, &keyFrame);
+
+	glm::vec3 angles;
+	zh::getEuler(keyFrame.getRotation(), angles.x, angles.y, angles.z, eulerOrder);
+
+	outputAngles(fout, angles, eulerOrder);
+}
+
+void exportMotionAsBVH(const Animation *animation, ostream& fout, zh::EulerRotOrder eulerOrder)
+{
+	const float translation_scale = 100.f;
+	const float frame_time = 1.f / 30.f;
+	const auto& rootTrack = animation->getBoneTrack(HIP_CENTER);
+
+	// Tracks may have been reduced to different keyframes, so every frame is sampled at a fixed rate
+	const float start = rootTrack->getKeyFrame(0)->getTime();
+	const int numFrames = static_cast<int>((animation->getLength() - start) / frame_time + 0.001f) + 1;
+
+	fout << "\nMOTION" << endl;
+	fout << "Frames: " << numFrames << endl;
+	fout << "Frame Time: " << "0.0333333" << endl;
+
+	TransformKeyFrame rootKeyFrame(0.f, 0);
+	for (int i = 0; i < numFrames; ++i) {
+		const float time = start + i * frame_time;
+		rootTrack->getInterpolatedKeyFrame(time, &rootKeyFrame);
+		const glm::vec3 pos = rootKeyFrame.getTranslation() * translation_scale;
+
+		fout << pos.x << " " << pos.y << " " << pos.z << " ";
+		for (int boneId = 0; boneId < EBoneID::COUNT; ++boneId) {
+			outputRotationAngles(boneId, time, animation, fout, eulerOrder);
+		}
+		fout << endl;
+	}
+}
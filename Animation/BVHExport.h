@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Util/zhMatrix4.h"
+
+#include <ostream>
+
+class Animation;
+
+
+void exportAnimationAsBVH(const Animation *animation);
+void exportAnimationAsBVH(const Animation& animation, std::ostream& out, zh::EulerRotOrder eulerOrder=zh::EulerRotOrder_XYZ);
@@ -0,0 +1,411 @@
+#include "BlendEngine.h"
+#include "Animation.h"
+#include "AnimationUtils.h"
+#include "BoneAnimationTrack.h"
+#include "Skeleton.h"
+#include "TimeWarp.h"
+#include "TransformKeyFrame.h"
+#include "Util/ThreadPool.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Samples of one bone over a run of frames, one array per component
+	// Only translations and local rotations are sampled and mapped, absolute
+	// rotations are filled in afterwards from the world rotations of the posed skeleton
+	struct BoneSamples
+	{
+		std::vector<float> tx, ty, tz;
+		std::vector<float> rw, rx, ry, rz;
+		std::vector<float> aw, ax, ay, az;
+
+		void resize(size_t count)
+		{
+			tx.resize(count); ty.resize(count); tz.resize(count);
+			rw.resize(count); rx.resize(count); ry.resize(count); rz.resize(count);
+			aw.resize(count); ax.resize(count); ay.resize(count); az.resize(count);
+		}
+
+		void set(size_t i, const glm::vec3& t, const glm::quat& r)
+		{
+			tx[i] = t.x; ty[i] = t.y; tz[i] = t.z;
+			rw[i] = r.w; rx[i] = r.x; ry[i] = r.y; rz[i] = r.z;
+		}
+
+		glm::quat rotation(size_t i) const { return glm::quat(rw[i], rx[i], ry[i], rz[i]); }
+
+		void setAbsRotation(size_t i, const glm::quat& a)
+		{
+			aw[i] = a.w; ax[i] = a.x; ay[i] = a.y; az[i] = a.z;
+		}
+	};
+
+	bool keyFrameTimeLess(float time, const KeyFrame *keyFrame) { return time < keyFrame->getTime(); }
+
+	// Sample times start + i * delta
+	struct UniformTimes
+	{
+		float start, delta;
+
+		UniformTimes(float start, float delta) : start(start), delta(delta) {}
+		float operator()(size_t i) const { return start + i * delta; }
+	};
+
+	// Layer times played at base times start + i * delta
+	struct WarpedTimes
+	{
+		const TimeWarp& warp;
+		float start, delta;
+
+		WarpedTimes(const TimeWarp& warp, float start, float delta) : warp(warp), start(start), delta(delta) {}
+		float operator()(size_t i) const { return warp.map(start + i * delta); }
+	};
+
+	// Sample track at times(i) for i in [0, count), times must not decrease, walking the keyframes once
+	template<class Times>
+	void sampleTrackAt(const BoneAnimationTrack& track, const Times& times, size_t count, BoneSamples& samples)
+	{
+		samples.resize(count);
+
+		const std::vector<KeyFrame*>& keyFrames = track.getKeyFrames();
+		if (keyFrames.empty()) {
+			for (size_t i = 0; i < count; ++i) {
+				samples.set(i, glm::vec3(), glm::quat());
+			}
+			return;
+		}
+
+		// Splines need the track's own sampler
+		if (track.getAnimation()->getKFInterpMethod() != KFInterp_Linear) {
+			TransformKeyFrame keyFrame(0.f, 0);
+			for (size_t i = 0; i < count; ++i) {
+				track.getInterpolatedKeyFrame(times(i), &keyFrame);
+				samples.set(i, keyFrame.getTranslation(), keyFrame.getRotation());
+			}
+			return;
+		}
+
+		// Index of the last keyframe at or before the first sample time
+		const size_t last = keyFrames.size() - 1;
+		size_t k = std::upper_bound(begin(keyFrames), end(keyFrames), times(0), keyFrameTimeLess) - begin(keyFrames);
+		k = (k > 0) ? k - 1 : 0;
+
+		for (size_t i = 0; i < count; ++i) {
+			const float time = times(i);
+			while (k < last && keyFrames[k + 1]->getTime() <= time) ++k;
+
+			const TransformKeyFrame *kf1 = static_cast<const TransformKeyFrame*>(keyFrames[k]);
+			if (k == last || time <= kf1->getTime()) {
+				samples.set(i, kf1->getTranslation(), kf1->getRotation());
+				continue;
+			}
+
+			const TransformKeyFrame *kf2 = static_cast<const TransformKeyFrame*>(keyFrames[k + 1]);
+			const float t = (time - kf1->getTime()) / (kf2->getTime() - kf1->getTime());
+			samples.set(i
+				, kf1->getTranslation() + (kf2->getTranslation() - kf1->getTranslation()) * t
+				, glm::slerp(kf1->getRotation(), kf2->getRotation(), t));
+		}
+	}
+
+	void sampleTrack(const BoneAnimationTrack& track, float start, float delta, size_t count, BoneSamples& samples)
+	{
+		sampleTrackAt(track, UniformTimes(start, delta), count, samples);
+	}
+
+	void lerp(const float *a, const float *b, float weight, size_t count, float *out)
+	{
+		for (size_t i = 0; i < count; ++i) {
+			out[i] = a[i] + (b[i] - a[i]) * weight;
+		}
+	}
+
+	// Per-frame offset of the base root from the layer root, Ry(t) - Rx(t)
+	struct RootOffsets
+	{
+		std::vector<float> x, y, z;
+	};
+
+	// quaternion arrays * constant quaternion, in place
+	void mulQuat(float *qw, float *qx, float *qy, float *qz, const glm::quat& b, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i) {
+			const float w = qw[i], x = qx[i], y = qy[i], z = qz[i];
+			qw[i] = w * b.w - x * b.x - y * b.y - z * b.z;
+			qx[i] = w * b.x + x * b.w + y * b.z - z * b.y;
+			qy[i] = w * b.y + y * b.w + z * b.x - x * b.z;
+			qz[i] = w * b.z + z * b.w + x * b.y - y * b.x;
+		}
+	}
+
+	void fillQuat(float *qw, float *qx, float *qy, float *qz, const glm::quat& q, size_t count)
+	{
+		std::fill(qw, qw + count, q.w);
+		std::fill(qx, qx + count, q.x);
+		std::fill(qy, qy + count, q.y);
+		std::fill(qz, qz + count, q.z);
+	}
+
+	// Map layer samples onto the base in place, see BlendEngine for the mappings
+	// layerPrev is the layer bone position one frame before the first sample
+	void mapLayer( ELayerMappingMode mappingMode
+	             , int boneID
+	             , const BoneSamples& base
+	             , BoneSamples& layer
+	             , const RootOffsets& roots
+	             , const LayerReference& reference
+	             , const glm::vec3& layerPrev
+	             , size_t count )
+	{
+		switch (mappingMode)
+		{
+			case MAP_DIRECT: break;
+
+			case MAP_ABSOLUTE:
+			case MAP_TRAJECTORY_RELATIVE:
+			{
+				const glm::vec3& offset = reference.positionOffset[boneID];
+				for (size_t i = 0; i < count; ++i) {
+					layer.tx[i] += roots.x[i] + offset.x;
+					layer.ty[i] += roots.y[i] + offset.y;
+					layer.tz[i] += roots.z[i] + offset.z;
+				}
+				if (mappingMode == MAP_ABSOLUTE) {
+					mulQuat(&layer.rw[0], &layer.rx[0], &layer.ry[0], &layer.rz[0], reference.rotationOffset[boneID], count);
+				} else {
+					fillQuat(&layer.rw[0], &layer.rx[0], &layer.ry[0], &layer.rz[0], reference.baseRotation[boneID], count);
+				}
+			}
+			break;
+
+			case MAP_ADDITIVE:
+			{
+				// Backwards so each frame still sees the previous unmapped layer position
+				for (size_t i = count - 1; i > 0; --i) {
+					layer.tx[i] = base.tx[i] + (layer.tx[i] - layer.tx[i - 1]);
+					layer.ty[i] = base.ty[i] + (layer.ty[i] - layer.ty[i - 1]);
+					layer.tz[i] = base.tz[i] + (layer.tz[i] - layer.tz[i - 1]);
+				}
+				layer.tx[0] = base.tx[0] + (layer.tx[0] - layerPrev.x);
+				layer.ty[0] = base.ty[0] + (layer.ty[0] - layerPrev.y);
+				layer.tz[0] = base.tz[0] + (layer.tz[0] - layerPrev.z);
+
+				std::copy(begin(base.rw), begin(base.rw) + count, begin(layer.rw));
+				std::copy(begin(base.rx), begin(base.rx) + count, begin(layer.rx));
+				std::copy(begin(base.ry), begin(base.ry) + count, begin(layer.ry));
+				std::copy(begin(base.rz), begin(base.rz) + count, begin(layer.rz));
+			}
+			break;
+		}
+	}
+
+	// Blend mapped layer samples into base in place, base holds the result
+	void blendSamples(BoneSamples& base, const BoneSamples& layer, float weight, size_t count)
+	{
+		if (weight <= 0.f || count == 0) return;
+
+		lerp(&base.tx[0], &layer.tx[0], weight, count, &base.tx[0]);
+		lerp(&base.ty[0], &layer.ty[0], weight, count, &base.ty[0]);
+		lerp(&base.tz[0], &layer.tz[0], weight, count, &base.tz[0]);
+		nlerp(&base.rw[0], &base.rx[0], &base.ry[0], &base.rz[0]
+		    , &layer.rw[0], &layer.rx[0], &layer.ry[0], &layer.rz[0]
+		    , weight, count
+		    , &base.rw[0], &base.rx[0], &base.ry[0], &base.rz[0]);
+	}
+
+	// Fill in the absolute rotations of frames [first, last) from the world rotations of
+	// skeleton posed with the local rotations in samples, bones without samples keep the identity
+	void computeAbsRotations(std::vector<BoneSamples>& samples, size_t first, size_t last, Skeleton& skeleton)
+	{
+		for (size_t i = first; i < last; ++i) {
+			for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+				if (samples[boneID].tx.empty()) continue;
+				skeleton.getBone(boneID)->rotation = samples[boneID].rotation(i);
+			}
+			for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+				if (samples[boneID].tx.empty()) continue;
+				samples[boneID].setAbsRotation(i, skeleton.getWorldRotation(boneID));
+			}
+		}
+	}
+
+	// Root offsets for count frames from start, only needed by the relative mappings
+	// The layer is sampled at the warped times when timeWarp isn't null
+	void sampleRootOffsets(const Animation& base, const Animation& layer, float start, float delta, size_t count, RootOffsets& roots, const TimeWarp *timeWarp = nullptr)
+	{
+		roots.x.assign(count, 0.f);
+		roots.y.assign(count, 0.f);
+		roots.z.assign(count, 0.f);
+
+		const BoneAnimationTrack *baseRoot  = base.getBoneTrack(HIP_CENTER);
+		const BoneAnimationTrack *layerRoot = layer.getBoneTrack(HIP_CENTER);
+		if (nullptr == baseRoot || nullptr == layerRoot) return;
+
+		BoneSamples baseSamples, layerSamples;
+		sampleTrack(*baseRoot,  start, delta, count, baseSamples);
+		if (nullptr != timeWarp) sampleTrackAt(*layerRoot, WarpedTimes(*timeWarp, start, delta), count, layerSamples);
+		else                     sampleTrack(*layerRoot, start, delta, count, layerSamples);
+		for (size_t i = 0; i < count; ++i) {
+			roots.x[i] = baseSamples.tx[i] - layerSamples.tx[i];
+			roots.y[i] = baseSamples.ty[i] - layerSamples.ty[i];
+			roots.z[i] = baseSamples.tz[i] - layerSamples.tz[i];
+		}
+	}
+
+	// Append samples to track as keyframes at start + i * delta
+	void writeTrack(BoneAnimationTrack& track, float start, float delta, size_t count, const BoneSamples& samples)
+	{
+		for (size_t i = 0; i < count; ++i) {
+			TransformKeyFrame *keyFrame = static_cast<TransformKeyFrame*>(track.createKeyFrame(start + i * delta));
+			if (nullptr == keyFrame) continue;
+
+			keyFrame->setTranslation(glm::vec3(samples.tx[i], samples.ty[i], samples.tz[i]));
+			keyFrame->setRotation(glm::quat(samples.rw[i], samples.rx[i], samples.ry[i], samples.rz[i]));
+			keyFrame->setAbsRotation(glm::quat(samples.aw[i], samples.ax[i], samples.ay[i], samples.az[i]));
+			keyFrame->setScale(glm::vec3(1)); // scale is ignored
+		}
+	}
+}
+
+
+LayerReference makeLayerReference(const Animation& base, const Animation& layer)
+{
+	// Time 0 poses of both animations, offsets are taken between their world transforms
+	Skeleton baseSkeleton, layerSkeleton;
+	base.apply(&baseSkeleton, 0.f);
+	layer.apply(&layerSkeleton, 0.f);
+	const Skeleton& basePose  = baseSkeleton;
+	const Skeleton& layerPose = layerSkeleton;
+
+	LayerReference reference;
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const glm::quat& baseRotation  = basePose.getBone(boneID)->rotation;
+		const glm::quat& layerRotation = layerPose.getBone(boneID)->rotation;
+
+		reference.positionOffset[boneID] = basePose.getWorldPosition(boneID) - layerPose.getWorldPosition(boneID);
+		reference.rotationOffset[boneID] = glm::inverse(layerRotation) * baseRotation;
+		reference.baseRotation[boneID]   = baseRotation;
+	}
+
+	return reference;
+}
+
+
+BlendEngine::BlendEngine( unsigned int numThreads )
+	: numThreads(numThreads)
+	, reference()
+	, referenceValid(false)
+{
+	if (0 == this->numThreads) {
+		this->numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+}
+
+void BlendEngine::blend( const Animation& base
+                       , const Animation& layer
+                       , const BoneMask& boneMask
+                       , ELayerMappingMode mappingMode
+                       , Animation& blend
+                       , float frameDelta
+                       , const TimeWarp *timeWarp ) const
+{
+	// A time warp covers the whole base, mapping it onto the whole layer
+	const bool warped = (nullptr != timeWarp && !timeWarp->empty());
+	const float length = warped ? base.getLength() : std::min(base.getLength(), layer.getLength());
+	const size_t numFrames = (frameDelta > 0.f) ? static_cast<size_t>(length / frameDelta + 0.001f) + 1 : 1;
+
+	// Shared by every bone, computed once up front
+	const LayerReference takeReference = makeLayerReference(base, layer);
+	RootOffsets roots;
+	sampleRootOffsets(base, layer, 0.f, frameDelta, numFrames, roots, warped ? timeWarp : nullptr);
+
+	// Sample, map and blend each bone independently, results are written back on this thread
+	std::vector<BoneSamples> results(EBoneID::COUNT);
+	parallelFor(numThreads, EBoneID::COUNT, [&](size_t boneID) {
+		const BoneAnimationTrack *baseTrack  = base.getBoneTrack(boneID);
+		const BoneAnimationTrack *layerTrack = layer.getBoneTrack(boneID);
+		if (nullptr == baseTrack || nullptr == layerTrack) return;
+
+		BoneSamples& samples = results[boneID];
+		sampleTrack(*baseTrack, 0.f, frameDelta, numFrames, samples);
+		const float weight = boneMask.weight((EBoneID) boneID);
+		if (weight > 0.f) {
+			BoneSamples layerSamples;
+			if (warped) sampleTrackAt(*layerTrack, WarpedTimes(*timeWarp, 0.f, frameDelta), numFrames, layerSamples);
+			else        sampleTrack(*layerTrack, 0.f, frameDelta, numFrames, layerSamples);
+			const glm::vec3 layerPrev(layerSamples.tx[0], layerSamples.ty[0], layerSamples.tz[0]);
+			mapLayer(mappingMode, boneID, samples, layerSamples, roots, takeReference, layerPrev, numFrames);
+			blendSamples(samples, layerSamples, std::min(weight, 1.f), numFrames);
+		}
+	});
+
+	Skeleton skeleton;
+	computeAbsRotations(results, 0, numFrames, skeleton);
+
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		BoneAnimationTrack *blendTrack = blend.getBoneTrack(boneID);
+		if (nullptr == blendTrack || results[boneID].tx.empty()) continue;
+
+		blendTrack->deleteAllKeyFrames();
+		writeTrack(*blendTrack, 0.f, frameDelta, numFrames, results[boneID]);
+	}
+}
+
+void BlendEngine::blendFrame( float time
+                            , float frameDelta
+                            , const Animation& base
+                            , const Animation& layer
+                            , const BoneMask& boneMask
+                            , ELayerMappingMode mappingMode
+                            , Animation& blend )
+{
+	// The first frame of a session fixes the reference poses,
+	// before this frame is written in case base and blend are the same animation
+	if (!referenceValid) {
+		reference = makeLayerReference(base, layer);
+		referenceValid = true;
+	}
+
+	RootOffsets roots;
+	sampleRootOffsets(base, layer, time, 0.f, 1, roots);
+
+	std::vector<BoneSamples> results(EBoneID::COUNT);
+	BoneSamples layerSamples, prevSamples;
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const BoneAnimationTrack *baseTrack  = base.getBoneTrack(boneID);
+		const BoneAnimationTrack *layerTrack = layer.getBoneTrack(boneID);
+		if (nullptr == baseTrack || nullptr == layerTrack || nullptr == blend.getBoneTrack(boneID)) continue;
+
+		BoneSamples& samples = results[boneID];
+		sampleTrack(*baseTrack, time, 0.f, 1, samples);
+		const float weight = boneMask.weight((EBoneID) boneID);
+		if (weight > 0.f) {
+			sampleTrack(*layerTrack, time, 0.f, 1, layerSamples);
+
+			glm::vec3 layerPrev(layerSamples.tx[0], layerSamples.ty[0], layerSamples.tz[0]);
+			if (mappingMode == MAP_ADDITIVE) {
+				sampleTrack(*layerTrack, std::max(time - frameDelta, 0.f), 0.f, 1, prevSamples);
+				layerPrev = glm::vec3(prevSamples.tx[0], prevSamples.ty[0], prevSamples.tz[0]);
+			}
+
+			mapLayer(mappingMode, boneID, samples, layerSamples, roots, reference, layerPrev, 1);
+			blendSamples(samples, layerSamples, std::min(weight, 1.f), 1);
+		}
+	}
+
+	// Absolute rotations need the local rotations of every ancestor, so bones are only written once all are mapped
+	Skeleton skeleton;
+	computeAbsRotations(results, 0, 1, skeleton);
+
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		if (results[boneID].tx.empty()) continue;
+		writeTrack(*blend.getBoneTrack(boneID), time, 0.f, 1, results[boneID]);
+	}
+}
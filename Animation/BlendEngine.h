@@ -0,0 +1,83 @@
+#pragma once
+
+#include "AnimationTypes.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+class Animation;
+class TimeWarp;
+
+
+// Relationship between the first (time 0) poses of a base and a layer,
+// these don't change once a layer starts so they are computed once per layering session
+// Both poses are applied to skeletons and read back from their world transforms
+struct LayerReference
+{
+	glm::vec3 positionOffset[EBoneID::COUNT]; // base(0) - layer(0) world joint positions
+	glm::quat rotationOffset[EBoneID::COUNT]; // inverse(layer(0)) * base(0) bone rotations
+	glm::quat baseRotation[EBoneID::COUNT];   // base(0) bone rotations
+};
+
+LayerReference makeLayerReference(const Animation& base, const Animation& layer);
+
+
+// Blends a layer animation over a base animation
+// Poses are resampled into flat per-component arrays, the layer is mapped onto the base
+// with the selected ELayerMappingMode then blended a whole run of frames at a time,
+// with bones spread over worker threads
+//
+// Bone mask weights select how much of the mapped layer replaces each base bone,
+// 0 keeps the base bone, 1 takes the mapped layer bone
+//
+// Mappings, with Y the base, X the layer and R the root (hip center) position:
+//   MAP_DIRECT              Y'(t) = X(t)
+//   MAP_ABSOLUTE            Y'(t) = Y(0) + (X(t) - X(0)) + (Ry(t) - Rx(t)),  Yr'(t) = Xr(t) inv(Xr(0)) Yr(0)
+//   MAP_ADDITIVE            Y'(t) = Y(t) + (X(t) - X(t - dt)),              Yr'(t) = Yr(t)
+//   MAP_TRAJECTORY_RELATIVE Y'(t) = Y(0) + (X(t) - X(0)) + (Ry(t) - Rx(t)),  Yr'(t) = Yr(0)
+//
+// Mappings and blending act on joint positions and bone rotations, the absolute rotations
+// of the result are the world rotations of a skeleton posed with the blended bone rotations
+class BlendEngine
+{
+public:
+	// numThreads of 0 uses one thread per hardware thread
+	explicit BlendEngine(unsigned int numThreads = 0);
+
+	// Replace the keyframes of blend with base and layer blended over their shared timeline,
+	// sampled every frameDelta seconds
+	// With a time warp the blend covers the whole base and the layer is played at timeWarp->map(t)
+	void blend( const Animation& base
+	          , const Animation& layer
+	          , const BoneMask& boneMask
+	          , ELayerMappingMode mappingMode
+	          , Animation& blend
+	          , float frameDelta = 1 / 60.f
+	          , const TimeWarp *timeWarp = nullptr ) const;
+
+	// Start a new live layering session, the reference poses are
+	// cached by the first blendFrame() call after this
+	void beginLayer();
+
+	// Add a single blended keyframe at time to blend, used while layering live
+	// frameDelta is the time between layer frames, used by MAP_ADDITIVE
+	void blendFrame( float time
+	               , float frameDelta
+	               , const Animation& base
+	               , const Animation& layer
+	               , const BoneMask& boneMask
+	               , ELayerMappingMode mappingMode
+	               , Animation& blend );
+
+	unsigned int getNumThreads() const;
+
+private:
+	unsigned int numThreads;
+
+	LayerReference reference;
+	bool referenceValid;
+
+};
+
+inline void BlendEngine::beginLayer() { referenceValid = false; }
+inline unsigned int BlendEngine::getNumThreads() const { return numThreads; }
@@ -22,22 +22,74 @@ SOFTWARE.
 #include "BoneAnimationTrack.h"
 #include "TransformKeyFrame.h"
 #include "Animation.h"
-#include "Skeleton.h"
 #include "AnimationUtils.h"
-#include "Util/zhQuat.h"
-#include "Util/zhVector3.h"
+#include "Skeleton.h"
 #include "Util/zhMathMacros.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <new>
+#include <utility>
+
+
+namespace
+{
+	// Largest error, relative to tolerance, of interpolating between first and last
+	// for any key-frame in between, and the key-frame it occurs at
+	std::pair<float, size_t> segmentError( const std::vector<KeyFrame*>& keyFrames, size_t first, size_t last, const KeyFrameTolerance& tolerance )
+	{
+		const TransformKeyFrame *kf1 = static_cast<const TransformKeyFrame*>( keyFrames[first] );
+		const TransformKeyFrame *kf2 = static_cast<const TransformKeyFrame*>( keyFrames[last] );
+		const float span = kf2->getTime() - kf1->getTime();
+
+		std::pair<float, size_t> worst(0.f, first);
+		for( size_t kfi = first + 1; kfi < last; ++kfi )
+		{
+			const TransformKeyFrame *kf = static_cast<const TransformKeyFrame*>( keyFrames[kfi] );
+			const float t = ( span > 0.f ) ? ( kf->getTime() - kf1->getTime() ) / span : 0.f;
+
+			const float translation = glm::length( kf1->getTranslation() + ( kf2->getTranslation() - kf1->getTranslation() ) * t - kf->getTranslation() );
+			const float scale = glm::length( kf1->getScale() + ( kf2->getScale() - kf1->getScale() ) * t - kf->getScale() );
+			const float rotation = angleBetween( glm::slerp(kf1->getRotation(), kf2->getRotation(), t), kf->getRotation() );
+			const float absRotation = angleBetween( glm::slerp(kf1->getAbsRotation(), kf2->getAbsRotation(), t), kf->getAbsRotation() );
+
+			const float error = std::max( std::max(translation, scale) / tolerance.translation
+			                            , std::max(rotation, absRotation) / tolerance.rotation );
+			if( error > worst.first )
+				worst = std::make_pair(error, kfi);
+		}
+		return worst;
+	}
+}
 
 
 BoneAnimationTrack::BoneAnimationTrack( unsigned short boneId, Animation* anim )
 	: AnimationTrack(anim)
 	, mBoneId(boneId)
+	, mKeyFramePool(sizeof(TransformKeyFrame))
+	, mSplineGeneration(0)
 {}
 
 BoneAnimationTrack::~BoneAnimationTrack()
-{}
+{
+	// Free the key-frames here, the base class destructor can no longer reach the pool
+	deleteAllKeyFrames();
+}
+
+size_t BoneAnimationTrack::getMemoryUsage() const
+{
+	return mKeyFramePool.getMemoryUsage() + mKeyFrames.capacity() * sizeof(KeyFrame*);
+}
+
+void BoneAnimationTrack::reserveKeyFrames( size_t count )
+{
+	if( !mKeyFrames.empty() ) return;
+
+	mKeyFrames.reserve(count);
+	mKeyFramePool.reserve(count);
+	_updateMemoryUsage();
+}
 
 
 void BoneAnimationTrack::getInterpolatedKeyFrame( float time, KeyFrame* kf ) const
@@ -91,19 +143,18 @@ void BoneAnimationTrack::getInterpolatedKeyFrame( float time, KeyFrame* kf ) con
 		else // if( mAnim->getKFInterpolationMethod() == KFInterp_Spline )
 		{
 			// TODO : spline interpolation is broken
-			if( mTransSpline.getNumControlPoints() <= 0 )
+			if( mSplineGeneration.load(std::memory_order_acquire) != mGeneration )
+			{
 				// interpolation splines not built yet, build them now
-				_buildInterpSplines();
-
-			zh::Vector3 tr( mTransSpline.getPoint( tkf1->getIndex(), t) );
-			zh::Quat r( mRotSpline.getPoint( tkf1->getIndex(), t) );
-			zh::Quat a( mAbsRotSpline.getPoint( tkf1->getIndex(), t) );
-			zh::Vector3 s( mScalSpline.getPoint( tkf1->getIndex(), t) );
+				std::lock_guard<std::mutex> lock(mSplineMutex);
+				if( mSplineGeneration.load(std::memory_order_relaxed) != mGeneration )
+					_buildInterpSplines();
+			}
 
-			tkf->setTranslation( glm::vec3(tr.x, tr.y, tr.z) );//mTransSpline.getPoint( tkf1->getIndex(), t ) );
-			tkf->setRotation( glm::quat(r.w, r.x, r.y, r.z) );//mRotSpline.getPoint( tkf1->getIndex(), t ) );
-			tkf->setAbsRotation( glm::quat(a.w, a.x, a.y, a.z) );
-			tkf->setScale( glm::vec3(s.x, s.y, s.z) );//mScalSpline.getPoint( tkf1->getIndex(), t ) );
+			tkf->setTranslation( mTransSpline.getPoint( tkf1->getIndex(), t ) );
+			tkf->setRotation( mRotSpline.getPoint( tkf1->getIndex(), t ) );
+			tkf->setAbsRotation( mAbsRotSpline.getPoint( tkf1->getIndex(), t ) );
+			tkf->setScale( mScalSpline.getPoint( tkf1->getIndex(), t ) );
 		}
 	}
 }
@@ -120,35 +171,97 @@ void BoneAnimationTrack::apply( Skeleton* skel, float time, float weight, float
 
 	bone->translation = glm::vec3( tkf.getTranslation() * weight * scale );
 	bone->rotation = glm::slerp( glm::quat(), tkf.getRotation(), weight );
-	bone->scale = ( glm::vec3(1) + ( glm::vec3(1) - tkf.getScale() ) * weight * scale );
+	bone->scale = ( glm::vec3(1) + ( tkf.getScale() - glm::vec3(1) ) * weight * scale );
+}
+
+size_t BoneAnimationTrack::findRedundantKeyFrames( const KeyFrameTolerance& tolerance, std::vector<bool>& keep ) const
+{
+	assert( tolerance.translation > 0.f && tolerance.rotation > 0.f );
+
+	const size_t count = mKeyFrames.size();
+	keep.assign( count, false );
+	if( count <= 2 )
+	{
+		keep.assign( count, true );
+		return 0;
+	}
+
+	// Keep the ends, then split each segment at its worst key-frame until every one is within tolerance
+	keep.front() = keep.back() = true;
+	size_t kept = 2;
+
+	std::vector< std::pair<size_t, size_t> > segments;
+	segments.push_back( std::make_pair(size_t(0), count - 1) );
+	while( !segments.empty() )
+	{
+		const std::pair<size_t, size_t> segment = segments.back();
+		segments.pop_back();
+		if( segment.second - segment.first < 2 )
+			continue;
+
+		const std::pair<float, size_t> worst = segmentError( mKeyFrames, segment.first, segment.second, tolerance );
+		if( worst.first <= 1.f )
+			continue;
+
+		keep[worst.second] = true;
+		++kept;
+		segments.push_back( std::make_pair(segment.first, worst.second) );
+		segments.push_back( std::make_pair(worst.second, segment.second) );
+	}
+
+	return count - kept;
+}
+
+size_t BoneAnimationTrack::reduceKeyFrames( const KeyFrameTolerance& tolerance )
+{
+	std::vector<bool> keep;
+	const size_t redundant = findRedundantKeyFrames( tolerance, keep );
+	if( redundant > 0 )
+		deleteKeyFrames( keep );
+
+	return redundant;
 }
 
 KeyFrame* BoneAnimationTrack::_createKeyFrame( float time )
 {
-	return new TransformKeyFrame( time, 0 );
+	return new( mKeyFramePool.allocate() ) TransformKeyFrame( time, 0 );
+}
+
+void BoneAnimationTrack::_destroyKeyFrame( KeyFrame* kf )
+{
+	static_cast<TransformKeyFrame*>(kf)->~TransformKeyFrame();
+	mKeyFramePool.deallocate(kf);
+}
+
+void BoneAnimationTrack::_destroyAllKeyFrames()
+{
+	// TransformKeyFrame owns nothing, so the whole pool is dropped without running destructors
+	mKeyFramePool.clear();
 }
 
 void BoneAnimationTrack::_buildInterpSplines() const
 {
 	TransformKeyFrame* tkf;
 
+	mTransSpline.clearControlPoints();
+	mRotSpline.clearControlPoints();
+	mAbsRotSpline.clearControlPoints();
+	mScalSpline.clearControlPoints();
+
 	for( unsigned int kfi = 0; kfi < mKeyFrames.size(); ++kfi )
 	{
 		tkf = static_cast<TransformKeyFrame*>( mKeyFrames[kfi] );
 
-		glm::vec3 t(tkf->getTranslation());
-		glm::quat r(tkf->getRotation());
-		glm::quat a(tkf->getAbsRotation());
-		glm::vec3 s(tkf->getScale());
-
-		mTransSpline.addControlPoint( zh::Vector3(t.x, t.y, t.z) );//tkf->getTranslation() );
-		mRotSpline.addControlPoint( zh::Quat(r.w, r.x, r.y, r.z) );//tkf->getRotation() );
-		mAbsRotSpline.addControlPoint( zh::Quat(a.w, a.x, a.y, a.z) );//tkf->getAbsRotation() );
-		mScalSpline.addControlPoint( zh::Vector3(s.x, s.y, s.z) );//tkf->getScale() );
+		mTransSpline.addControlPoint( tkf->getTranslation() );
+		mRotSpline.addControlPoint( tkf->getRotation() );
+		mAbsRotSpline.addControlPoint( tkf->getAbsRotation() );
+		mScalSpline.addControlPoint( tkf->getScale() );
 	}
 
 	mTransSpline.calcTangents();
 	mRotSpline.calcTangents();
 	mAbsRotSpline.calcTangents();
 	mScalSpline.calcTangents();
+
+	mSplineGeneration.store(mGeneration, std::memory_order_release);
 }
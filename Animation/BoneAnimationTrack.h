@@ -22,17 +22,35 @@ SOFTWARE.
 #pragma once
 
 #include "AnimationTrack.h"
-#include "Util/zhCatmullRomSpline.h"
-#include "Util/zhQuat.h"
-#include "Util/zhVector3.h"
+#include "KeyFramePool.h"
+#include "Util/zhGlm.h"
 #include "Skeleton.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 class Animation;
 
 
+/**
+* @brief Largest errors allowed when removing key-frames from a track.
+*/
+struct KeyFrameTolerance
+{
+	float translation; ///< Translation and scale error, in the track's units (meters for Kinect takes).
+	float rotation;    ///< Rotation error in radians, for both the hierarchical and absolute rotations.
+
+	KeyFrameTolerance( float translation = 0.001f, float rotation = glm::radians(0.5f) )
+		: translation(translation)
+		, rotation(rotation)
+	{}
+};
+
+
 /**
 * @brief Class representing a bone animation track.
 */
@@ -59,6 +77,21 @@ public:
 	*/
 	unsigned short getBoneId() const;
 
+	/**
+	* Gets the memory held for key-frames, in bytes,
+	* including pool room not handed out yet.
+	*/
+	size_t getMemoryUsage() const;
+
+	/**
+	* Allocates room for the specified number of key-frames up front,
+	* kept when the key-frames are deleted, so captures that fit never allocate.
+	*
+	* @param count Number of key-frames.
+	* @remark Only has effect while the track has no key-frames.
+	*/
+	void reserveKeyFrames( size_t count );
+
 	/**
 	* Gets the key-frame interpolated from the neighboring key-frames
 	* at the specified time.
@@ -80,26 +113,57 @@ public:
 	*/
 	 void apply( Skeleton* skel, float time, float weight = 1.f, float scale = 1.f ) const;
 
+	 /**
+	 * Finds the key-frames needed for linear interpolation of the track
+	 * to stay within tolerance of every current key-frame,
+	 * using Ramer-Douglas-Peucker on all channels at once.
+	 *
+	 * @param tolerance Largest allowed errors, must be greater than zero.
+	 * @param keep Set to one flag per key-frame, true where the key-frame is needed.
+	 * @return Number of key-frames that are not needed.
+	 */
+	 size_t findRedundantKeyFrames( const KeyFrameTolerance& tolerance, std::vector<bool>& keep ) const;
+
+	 /**
+	 * Deletes the key-frames found by findRedundantKeyFrames().
+	 *
+	 * @param tolerance Largest allowed errors, must be greater than zero.
+	 * @return Number of key-frames deleted.
+	 */
+	 size_t reduceKeyFrames( const KeyFrameTolerance& tolerance );
+
 	 /**
 	 * Builds the splines used for key-frame interpolation.
 	 *
 	 * @remark This function is called automatically by Animation.
 	 * Do not call it manually without a good reason.
+	 * Rebuilds from scratch, so not while other threads sample the track.
 	 */
 	 void _buildInterpSplines() const;
 
 protected:
 
 	KeyFrame* _createKeyFrame( float time );
+	void _destroyKeyFrame( KeyFrame* kf );
+	void _destroyAllKeyFrames();
 
 private:
 
 	unsigned short mBoneId;
 
-	mutable zh::CatmullRomSpline<zh::Vector3> mTransSpline;//glm::vec3> mTransSpline;
-	mutable zh::CatmullRomSpline<zh::Quat> mRotSpline;//glm::quat> mRotSpline;
-	mutable zh::CatmullRomSpline<zh::Quat> mAbsRotSpline;//glm::quat> mAbsRotSpline;
-	mutable zh::CatmullRomSpline<zh::Vector3> mScalSpline;//glm::vec3> mScalSpline;
+	// Storage of this track's key-frames, see KeyFramePool
+	KeyFramePool mKeyFramePool;
+
+	mutable zh::CatmullRomSpline<glm::vec3> mTransSpline;
+	mutable zh::CatmullRomSpline<glm::quat> mRotSpline;
+	mutable zh::CatmullRomSpline<glm::quat> mAbsRotSpline;
+	mutable zh::CatmullRomSpline<glm::vec3> mScalSpline;
+
+	// Splines are rebuilt on first use after keyframes are added or removed,
+	// possibly from several sampling threads at once, and remember the
+	// key-frame generation they were built from
+	mutable std::mutex mSplineMutex;
+	mutable std::atomic<size_t> mSplineGeneration;
 
 };
 
@@ -0,0 +1,281 @@
+#include "CompressedAnimation.h"
+#include "Animation.h"
+#include "AnimationUtils.h"
+#include "BoneAnimationTrack.h"
+#include "TransformKeyFrame.h"
+#include "Skeleton.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const size_t values_per_key = 9;
+
+	// Smallest three components lie within +/- 1/sqrt(2), stored in 15 bits each
+	const float quat_range = 0.70710678f;
+	const float quat_steps = 32767.f;
+
+	inline float quatComponent(const glm::quat& q, int i)
+	{
+		switch (i) {
+			case 0:  return q.x;
+			case 1:  return q.y;
+			case 2:  return q.z;
+			default: return q.w;
+		}
+	}
+
+	// Top bits of the first two values hold which component was dropped
+	void packQuat(glm::quat q, unsigned short *packed)
+	{
+		q = glm::normalize(q);
+
+		int largest = 0;
+		for (int i = 1; i < 4; ++i) {
+			if (std::fabs(quatComponent(q, i)) > std::fabs(quatComponent(q, largest))) largest = i;
+		}
+		// q and -q are the same rotation, keep the dropped component positive
+		const float sign = (quatComponent(q, largest) < 0.f) ? -1.f : 1.f;
+
+		for (int i = 0, j = 0; i < 4; ++i) {
+			if (i == largest) continue;
+			const float c = glm::clamp(sign * quatComponent(q, i), -quat_range, quat_range);
+			packed[j++] = static_cast<unsigned short>((c + quat_range) / (2.f * quat_range) * quat_steps + 0.5f);
+		}
+		packed[0] |= static_cast<unsigned short>((largest & 1) << 15);
+		packed[1] |= static_cast<unsigned short>((largest & 2) << 14);
+	}
+
+	glm::quat unpackQuat(const unsigned short *packed)
+	{
+		const int largest = ((packed[0] >> 15) & 1) | ((packed[1] >> 14) & 2);
+
+		float c[4];
+		float sum = 0.f;
+		for (int i = 0, j = 0; i < 4; ++i) {
+			if (i == largest) continue;
+			c[i] = (packed[j++] & 0x7FFF) * (2.f * quat_range / quat_steps) - quat_range;
+			sum += c[i] * c[i];
+		}
+		c[largest] = std::sqrt(std::max(0.f, 1.f - sum));
+
+		return glm::quat(c[3], c[0], c[1], c[2]);
+	}
+
+	void packTranslation(const glm::vec3& t, const glm::vec3& min, const glm::vec3& step, unsigned short *packed)
+	{
+		for (int i = 0; i < 3; ++i) {
+			const float q = (step[i] > 0.f) ? (t[i] - min[i]) / step[i] : 0.f;
+			packed[i] = static_cast<unsigned short>(glm::clamp(q + 0.5f, 0.f, 65535.f));
+		}
+	}
+
+	glm::vec3 unpackTranslation(const unsigned short *packed, const glm::vec3& min, const glm::vec3& step)
+	{
+		return glm::vec3(min.x + packed[0] * step.x, min.y + packed[1] * step.y, min.z + packed[2] * step.z);
+	}
+}
+
+
+CompressedAnimation::CompressedAnimation()
+	: numKeyFrames(0)
+	, length(0.f)
+{
+	clear();
+}
+
+void CompressedAnimation::clear()
+{
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		tracks[boneID] = Track();
+		tracks[boneID].scale = glm::vec3(1);
+	}
+	numKeyFrames = 0;
+	length = 0.f;
+}
+
+void CompressedAnimation::compress(const Animation& animation)
+{
+	clear();
+
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const BoneAnimationTrack *boneTrack = animation.getBoneTrack(boneID);
+		if (nullptr == boneTrack || 0 == boneTrack->getNumKeyFrames()) continue;
+
+		const std::vector<KeyFrame*>& keyFrames = boneTrack->getKeyFrames();
+		const size_t count = keyFrames.size();
+		Track& track = tracks[boneID];
+
+		// Translations are quantized over the track's bounds
+		glm::vec3 min(static_cast<const TransformKeyFrame*>(keyFrames[0])->getTranslation()), max(min);
+		for (const auto& keyFrame : keyFrames) {
+			const glm::vec3& t = static_cast<const TransformKeyFrame*>(keyFrame)->getTranslation();
+			min = glm::min(min, t);
+			max = glm::max(max, t);
+		}
+		track.translationMin  = min;
+		track.translationStep = (max - min) / 65535.f;
+
+		track.times.resize(count);
+		track.values.resize(values_per_key * count);
+		for (size_t i = 0; i < count; ++i) {
+			const TransformKeyFrame *keyFrame = static_cast<const TransformKeyFrame*>(keyFrames[i]);
+			unsigned short *packed = &track.values[values_per_key * i];
+			track.times[i] = keyFrame->getTime();
+			packTranslation(keyFrame->getTranslation(), min, track.translationStep, packed);
+			packQuat(keyFrame->getRotation(), packed + 3);
+			packQuat(keyFrame->getAbsRotation(), packed + 6);
+		}
+
+		// Scale, dropped to one value unless it actually changes
+		track.scale = static_cast<const TransformKeyFrame*>(keyFrames[0])->getScale();
+		const bool constantScale = std::all_of(keyFrames.begin(), keyFrames.end(), [&](const KeyFrame *keyFrame) {
+			return glm::length(static_cast<const TransformKeyFrame*>(keyFrame)->getScale() - track.scale) <= 1e-6f;
+		});
+		if (!constantScale) {
+			track.scales.resize(count);
+			for (size_t i = 0; i < count; ++i) {
+				track.scales[i] = static_cast<const TransformKeyFrame*>(keyFrames[i])->getScale();
+			}
+		}
+
+		numKeyFrames += count;
+		length = std::max(length, track.times.back());
+	}
+}
+
+void CompressedAnimation::decompress(Animation& animation) const
+{
+	glm::vec3 translation, scale;
+	glm::quat rotation, absRotation;
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const Track& track = tracks[boneID];
+		BoneAnimationTrack *boneTrack = track.times.empty() ? animation.getBoneTrack(boneID) : animation.createBoneTrack(boneID);
+		if (nullptr == boneTrack) continue;
+
+		boneTrack->deleteAllKeyFrames();
+		if (track.times.empty()) continue;
+
+		boneTrack->reserveKeyFrames(track.times.size());
+		for (size_t key = 0; key < track.times.size(); ++key) {
+			decodeKey(track, key, translation, rotation, absRotation, scale);
+
+			TransformKeyFrame *keyFrame = static_cast<TransformKeyFrame*>(boneTrack->createKeyFrame(track.times[key]));
+			keyFrame->setTranslation(translation);
+			keyFrame->setRotation(rotation);
+			keyFrame->setAbsRotation(absRotation);
+			keyFrame->setScale(scale);
+		}
+	}
+}
+
+void CompressedAnimation::decodeKey( const Track& track
+                                   , size_t key
+                                   , glm::vec3& translation
+                                   , glm::quat& rotation
+                                   , glm::quat& absRotation
+                                   , glm::vec3& scale ) const
+{
+	const unsigned short *packed = &track.values[values_per_key * key];
+	translation = unpackTranslation(packed, track.translationMin, track.translationStep);
+	rotation    = unpackQuat(packed + 3);
+	absRotation = unpackQuat(packed + 6);
+	scale       = track.scales.empty() ? track.scale : track.scales[key];
+}
+
+void CompressedAnimation::sampleTrack( const Track& track
+                                     , float time
+                                     , glm::vec3& translation
+                                     , glm::quat& rotation
+                                     , glm::quat& absRotation
+                                     , glm::vec3& scale ) const
+{
+	// Keys either side of time, clamped to the first and last
+	const auto next = std::upper_bound(track.times.begin(), track.times.end(), time);
+	if (next == track.times.begin() || next == track.times.end()) {
+		decodeKey(track, (next == track.times.begin()) ? 0 : track.times.size() - 1, translation, rotation, absRotation, scale);
+		return;
+	}
+
+	const size_t key = static_cast<size_t>(next - track.times.begin()) - 1;
+	const float t = (time - track.times[key]) / (track.times[key + 1] - track.times[key]);
+
+	glm::vec3 nextTranslation, nextScale;
+	glm::quat nextRotation, nextAbsRotation;
+	decodeKey(track, key, translation, rotation, absRotation, scale);
+	decodeKey(track, key + 1, nextTranslation, nextRotation, nextAbsRotation, nextScale);
+
+	translation += (nextTranslation - translation) * t;
+	rotation     = glm::slerp(rotation, nextRotation, t);
+	absRotation  = glm::slerp(absRotation, nextAbsRotation, t);
+	scale       += (nextScale - scale) * t;
+}
+
+bool CompressedAnimation::sample(unsigned short boneId, float time, TransformKeyFrame* kf) const
+{
+	if (boneId >= EBoneID::COUNT || tracks[boneId].times.empty()) return false;
+
+	glm::vec3 translation, scale;
+	glm::quat rotation, absRotation;
+	sampleTrack(tracks[boneId], time, translation, rotation, absRotation, scale);
+
+	kf->setTranslation(translation);
+	kf->setRotation(rotation);
+	kf->setAbsRotation(absRotation);
+	kf->setScale(scale);
+	return true;
+}
+
+void CompressedAnimation::apply(Skeleton* skel, float time, float weight/*=1.f*/, float scale/*=1.f*/, const BoneMask& boneMask/*=default_bone_mask*/) const
+{
+	glm::vec3 translation, boneScale;
+	glm::quat rotation, absRotation;
+	boneMask.forEach([&](EBoneID boneID) {
+		const Track& track = tracks[boneID];
+		Bone* bone = skel->getBone(boneID);
+		if (track.times.empty() || nullptr == bone) return;
+
+		// Same weighting as BoneAnimationTrack::apply
+		sampleTrack(track, time, translation, rotation, absRotation, boneScale);
+		bone->translation = translation * weight * scale;
+		bone->rotation    = glm::slerp(glm::quat(), rotation, weight);
+		bone->scale       = glm::vec3(1) + (boneScale - glm::vec3(1)) * weight * scale;
+	});
+}
+
+size_t CompressedAnimation::getMemoryUsage() const
+{
+	size_t bytes = sizeof(*this);
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const Track& track = tracks[boneID];
+		bytes += track.times.capacity() * sizeof(float)
+		       + track.values.capacity() * sizeof(unsigned short)
+		       + track.scales.capacity() * sizeof(glm::vec3);
+	}
+	return bytes;
+}
+
+
+CompressionError measureCompressionError(const Animation& original, const CompressedAnimation& compressed)
+{
+	CompressionError error;
+	error.maxAngularError     = 0.f;
+	error.maxTranslationError = 0.f;
+
+	TransformKeyFrame sampled(0.f, 0);
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const BoneAnimationTrack *track = original.getBoneTrack(boneID);
+		if (nullptr == track) continue;
+
+		for (const auto& keyFrame : track->getKeyFrames()) {
+			const TransformKeyFrame *expected = static_cast<const TransformKeyFrame*>(keyFrame);
+			if (!compressed.sample(static_cast<unsigned short>(boneID), expected->getTime(), &sampled)) continue;
+
+			error.maxTranslationError = std::max(error.maxTranslationError, glm::length(sampled.getTranslation() - expected->getTranslation()));
+			error.maxAngularError     = std::max(error.maxAngularError, angleBetween(sampled.getRotation(), glm::normalize(expected->getRotation())));
+			error.maxAngularError     = std::max(error.maxAngularError, angleBetween(sampled.getAbsRotation(), glm::normalize(expected->getAbsRotation())));
+		}
+	}
+	return error;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "PoseSampler.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+
+class Animation;
+
+
+// Largest differences between a compressed take and the keyframes it was made from
+struct CompressionError
+{
+	float maxAngularError;     // radians, over both rotation channels
+	float maxTranslationError;
+};
+
+
+// Read only, compact copy of a finished take, keyframe for keyframe
+//
+// Each bone track keeps the times of its keyframes and nine 16 bit values per keyframe:
+//   translation   16 bits per component over the track's bounding box
+//   rotations     smallest three quaternion components, 15 bits each, for both rotations
+//   scale         a single value when constant, which it is for captured takes
+// Keyframes aren't dropped here, finished takes are reduced by Animation::reduceKeyFrames first
+// Sampling interpolates as Animation does with KFInterp_Linear
+class CompressedAnimation : public PoseSampler
+{
+public:
+	CompressedAnimation();
+
+	// Replace the contents with a compressed copy of animation
+	void compress(const Animation& animation);
+	// Replace the keyframes of animation with the decoded ones, existing tracks of bones without keyframes are emptied
+	void decompress(Animation& animation) const;
+	void clear();
+
+	void apply(Skeleton* skel, float time, float weight=1.f, float scale=1.f, const BoneMask& boneMask=default_bone_mask) const;
+	bool sample(unsigned short boneId, float time, TransformKeyFrame* kf) const;
+	float getLength() const;
+
+	bool empty() const;
+	size_t getNumKeyFrames() const;
+	size_t getMemoryUsage() const;
+
+private:
+	struct Track
+	{
+		std::vector<float> times;
+		std::vector<unsigned short> values; // 9 per keyframe: translation, rotation, absolute rotation
+		glm::vec3 translationMin;
+		glm::vec3 translationStep;
+		glm::vec3 scale;                    // used when scales is empty
+		std::vector<glm::vec3> scales;      // one per keyframe unless constant
+	};
+
+	void decodeKey(const Track& track, size_t key, glm::vec3& translation, glm::quat& rotation, glm::quat& absRotation, glm::vec3& scale) const;
+	void sampleTrack(const Track& track, float time, glm::vec3& translation, glm::quat& rotation, glm::quat& absRotation, glm::vec3& scale) const;
+
+	Track tracks[EBoneID::COUNT];
+	size_t numKeyFrames;
+	float length;
+
+};
+
+inline float CompressedAnimation::getLength() const { return length; }
+inline bool CompressedAnimation::empty() const { return 0 == numKeyFrames; }
+inline size_t CompressedAnimation::getNumKeyFrames() const { return numKeyFrames; }
+
+
+// Compare compressed against original at each of the original's keyframes
+CompressionError measureCompressionError(const Animation& original, const CompressedAnimation& compressed);
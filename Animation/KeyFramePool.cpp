@@ -0,0 +1,89 @@
+#include "KeyFramePool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace
+{
+	// Keyframes hold floats and a vtable pointer
+	const size_t element_alignment = 8;
+
+	const size_t first_chunk_elements = 64;
+	const size_t max_chunk_elements   = 4096;
+}
+
+
+KeyFramePool::KeyFramePool( size_t elementSize )
+	: elementSize((std::max(elementSize, sizeof(FreeElement)) + element_alignment - 1) & ~(element_alignment - 1))
+	, chunks()
+	, chunkSizes()
+	, used(0)
+	, capacity(0)
+	, freeList(nullptr)
+{}
+
+KeyFramePool::~KeyFramePool()
+{
+	for (auto chunk : chunks) {
+		::operator delete(chunk);
+	}
+}
+
+void *KeyFramePool::allocate()
+{
+	if (nullptr != freeList) {
+		FreeElement *element = freeList;
+		freeList = element->next;
+		return element;
+	}
+
+	if (chunks.empty() || used == chunkSizes.back()) {
+		const size_t count = chunks.empty() ? first_chunk_elements : std::min(2 * chunkSizes.back(), max_chunk_elements);
+		chunks.push_back(static_cast<char*>(::operator new(count * elementSize)));
+		chunkSizes.push_back(count);
+		capacity += count;
+		used = 0;
+	}
+
+	return chunks.back() + elementSize * used++;
+}
+
+void KeyFramePool::deallocate( void *element )
+{
+	assert(nullptr != element);
+
+	FreeElement *freed = static_cast<FreeElement*>(element);
+	freed->next = freeList;
+	freeList = freed;
+}
+
+void KeyFramePool::clear()
+{
+	freeList = nullptr;
+	used = 0;
+	if (chunks.empty()) return;
+
+	for (size_t i = 1; i < chunks.size(); ++i) {
+		::operator delete(chunks[i]);
+	}
+	chunks.resize(1);
+	chunkSizes.resize(1);
+	capacity = chunkSizes[0];
+}
+
+void KeyFramePool::reserve( size_t count )
+{
+	// Elements may live in any chunk but an unused first one
+	if (used > 0 || chunks.size() > 1 || nullptr != freeList) return;
+	if (!chunks.empty() && chunkSizes[0] >= count) return;
+
+	if (!chunks.empty()) {
+		::operator delete(chunks[0]);
+		chunks.clear();
+		chunkSizes.clear();
+	}
+	chunks.push_back(static_cast<char*>(::operator new(count * elementSize)));
+	chunkSizes.push_back(count);
+	capacity = count;
+}
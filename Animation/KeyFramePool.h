@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+
+// Slab allocator for the keyframes of one animation track
+// Keyframes are carved out of chunks that double in size as the track grows, so a
+// track's keyframes sit together in memory and a long take costs a few dozen heap
+// allocations rather than one per keyframe
+// Freed keyframes are reused before the chunks grow, clear() drops every keyframe at once
+class KeyFramePool
+{
+public:
+	explicit KeyFramePool(size_t elementSize);
+	~KeyFramePool();
+
+	// Uninitialized storage for one element, construct it with placement new
+	void *allocate();
+	// Return storage of an element that has already been destroyed
+	void deallocate(void *element);
+
+	// Forget every element without running destructors, only the first chunk is kept for reuse
+	void clear();
+	// Make the first chunk hold at least count elements, so that many are allocated without the heap
+	// and stay allocated through clear(), does nothing once elements have been handed out
+	void reserve(size_t count);
+
+	size_t getNumChunks() const;
+	size_t getMemoryUsage() const;
+
+private:
+	KeyFramePool(const KeyFramePool&);
+	KeyFramePool& operator=(const KeyFramePool&);
+
+	struct FreeElement
+	{
+		FreeElement *next;
+	};
+
+	size_t elementSize;
+
+	std::vector<char*> chunks;
+	std::vector<size_t> chunkSizes; // elements in each chunk
+	size_t used;                    // elements handed out from the last chunk
+	size_t capacity;                // elements in all chunks
+	FreeElement *freeList;
+
+};
+
+inline size_t KeyFramePool::getNumChunks() const { return chunks.size(); }
+inline size_t KeyFramePool::getMemoryUsage() const { return capacity * elementSize; }
@@ -0,0 +1,379 @@
+#include "MotionIndex.h"
+#include "PoseSampler.h"
+#include "Util/ThreadPool.h"
+#include "Util/zhPrereq.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+	const size_t projected_dims = 8;             // principal components each frame is projected on
+	const size_t list_frames = 1024;             // frames per list on average
+	const size_t train_frames_per_list = 64;     // frames k-means is trained on, per list
+	const unsigned int kmeans_iterations = 8;
+	const size_t pca_samples = 65536;            // most frames the components are computed from
+	const size_t assign_block_frames = 4096;     // frames per list assignment job
+	const int jacobi_sweeps = 32;
+	const float default_velocity_weight = 0.1f;
+
+	PoseFeatureExtractor defaultExtractor()
+	{
+		PoseFeatureExtractor extractor;
+		extractor.addBone(HEAD);
+		extractor.addBone(HAND_LEFT);
+		extractor.addBone(HAND_RIGHT);
+		extractor.addBone(FOOT_LEFT);
+		extractor.addBone(FOOT_RIGHT);
+		extractor.setVelocityWeight(default_velocity_weight);
+		return extractor;
+	}
+
+	// Eigenvectors of the symmetric n x n matrix a by cyclic Jacobi rotations, as the columns of v,
+	// a is left diagonal with the eigenvalues
+	void jacobiEigen(std::vector<double>& a, size_t n, std::vector<double>& v)
+	{
+		v.assign(n * n, 0.0);
+		for (size_t i = 0; i < n; ++i) {
+			v[i * n + i] = 1.0;
+		}
+
+		for (int sweep = 0; sweep < jacobi_sweeps; ++sweep) {
+			double diagonal = 0.0, offDiagonal = 0.0;
+			for (size_t p = 0; p < n; ++p) {
+				diagonal += a[p * n + p] * a[p * n + p];
+				for (size_t q = p + 1; q < n; ++q) {
+					offDiagonal += a[p * n + q] * a[p * n + q];
+				}
+			}
+			if (offDiagonal <= 1e-24 * diagonal) break;
+
+			for (size_t p = 0; p < n; ++p) {
+				for (size_t q = p + 1; q < n; ++q) {
+					const double apq = a[p * n + q];
+					if (apq == 0.0) continue;
+
+					// Rotation zeroing a[p][q], applied as a = J'aJ and v = vJ
+					const double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+					const double t = ((theta < 0.0) ? -1.0 : 1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+					const double c = 1.0 / std::sqrt(t * t + 1.0);
+					const double s = t * c;
+					for (size_t k = 0; k < n; ++k) {
+						const double akp = a[k * n + p], akq = a[k * n + q];
+						a[k * n + p] = c * akp - s * akq;
+						a[k * n + q] = s * akp + c * akq;
+					}
+					for (size_t k = 0; k < n; ++k) {
+						const double apk = a[p * n + k], aqk = a[q * n + k];
+						a[p * n + k] = c * apk - s * aqk;
+						a[q * n + k] = s * apk + c * aqk;
+					}
+					for (size_t k = 0; k < n; ++k) {
+						const double vkp = v[k * n + p], vkq = v[k * n + q];
+						v[k * n + p] = c * vkp - s * vkq;
+						v[k * n + q] = s * vkp + c * vkq;
+					}
+				}
+			}
+		}
+	}
+
+	// Squared distance and list order position of a candidate, the k best are kept in a max heap
+	typedef std::pair<float, unsigned int> Candidate;
+
+	// Distance from the query's projection to a list's center, and the list
+	typedef std::pair<float, unsigned int> ListDistance;
+}
+
+
+MotionIndex::MotionIndex()
+	: extractor(defaultExtractor())
+	, frameDelta(1.f / zhAnimation_SampleRate)
+	, stride(extractor.getStride())
+	, projectedStride(std::min(stride, projected_dims))
+{}
+
+MotionIndex::MotionIndex( const PoseFeatureExtractor& extractor, float frameDelta )
+	: extractor(extractor)
+	, frameDelta(frameDelta)
+	, stride(extractor.getStride())
+	, projectedStride(std::min(stride, projected_dims))
+{}
+
+void MotionIndex::clear()
+{
+	takes.clear();
+	mean.clear();
+	components.clear();
+	centers.clear();
+	lists.clear();
+	frames.clear();
+	features.clear();
+	projections.clear();
+}
+
+void MotionIndex::build( const std::vector<const PoseSampler*>& samplers, unsigned int numThreads )
+{
+	clear();
+	if (frameDelta <= 0.f || stride == 0) return;
+
+	// Features of every take, one after another
+	std::vector<float> takeFeatures;
+	PoseFeatures poses;
+	for (size_t take = 0; take < samplers.size(); ++take) {
+		const PoseSampler *sampler = samplers[take];
+		if (nullptr == sampler || sampler->getLength() <= 0.f) continue;
+
+		const size_t numFrames = static_cast<size_t>(sampler->getLength() / frameDelta) + 1;
+		extractor.extract(*sampler, frameDelta, numFrames, numThreads, poses);
+
+		const unsigned int takeIndex = static_cast<unsigned int>(takes.size());
+		takes.push_back(sampler);
+		takeFeatures.insert(takeFeatures.end(), poses.values.begin(), poses.values.end());
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			const Frame entry = { takeIndex, static_cast<unsigned int>(frame) };
+			frames.push_back(entry);
+		}
+	}
+	if (frames.empty()) return;
+
+	computeComponents(takeFeatures);
+
+	std::vector<float> projected(frames.size() * projectedStride);
+	const size_t numBlocks = (frames.size() + assign_block_frames - 1) / assign_block_frames;
+	parallelFor(numThreads, numBlocks, [&](size_t block) {
+		const size_t last = std::min(frames.size(), (block + 1) * assign_block_frames);
+		for (size_t frame = block * assign_block_frames; frame < last; ++frame) {
+			project(&takeFeatures[frame * stride], &projected[frame * projectedStride]);
+		}
+	});
+
+	computeLists(projected, numThreads);
+
+	// Each frame's list, counted then laid out list after list so a list is read in one sweep
+	std::vector<unsigned int> assignment(frames.size());
+	parallelFor(numThreads, numBlocks, [&](size_t block) {
+		const size_t last = std::min(frames.size(), (block + 1) * assign_block_frames);
+		for (size_t frame = block * assign_block_frames; frame < last; ++frame) {
+			assignment[frame] = nearestList(&projected[frame * projectedStride]);
+		}
+	});
+
+	std::vector<unsigned int> next(lists.size() + 1, 0);
+	for (auto list : assignment) {
+		++next[list + 1];
+	}
+	for (size_t list = 0; list < lists.size(); ++list) {
+		next[list + 1] += next[list];
+		lists[list].first  = next[list];
+		lists[list].last   = next[list + 1];
+		lists[list].radius = 0.f;
+	}
+
+	std::vector<Frame> sortedFrames(frames.size());
+	features.resize(takeFeatures.size());
+	projections.resize(projected.size());
+	for (size_t frame = 0; frame < frames.size(); ++frame) {
+		const unsigned int list = assignment[frame];
+		const unsigned int i = next[list]++;
+		sortedFrames[i] = frames[frame];
+		std::copy(takeFeatures.begin() + frame * stride, takeFeatures.begin() + (frame + 1) * stride, features.begin() + i * stride);
+		std::copy(projected.begin() + frame * projectedStride, projected.begin() + (frame + 1) * projectedStride, projections.begin() + i * projectedStride);
+
+		const float distance = std::sqrt(squaredDistance(&projections[i * projectedStride], &centers[list * projectedStride], projectedStride));
+		lists[list].radius = std::max(lists[list].radius, distance);
+	}
+	frames.swap(sortedFrames);
+}
+
+void MotionIndex::computeComponents( const std::vector<float>& values )
+{
+	// Mean and covariance over frames spread evenly through the takes
+	const size_t numFrames = values.size() / stride;
+	const size_t step = std::max<size_t>(1, numFrames / pca_samples);
+	std::vector<double> sum(stride, 0.0), covariance(stride * stride, 0.0);
+	size_t samples = 0;
+	for (size_t frame = 0; frame < numFrames; frame += step, ++samples) {
+		const float *row = &values[frame * stride];
+		for (size_t i = 0; i < stride; ++i) {
+			sum[i] += row[i];
+			for (size_t j = i; j < stride; ++j) {
+				covariance[i * stride + j] += static_cast<double>(row[i]) * row[j];
+			}
+		}
+	}
+
+	mean.resize(stride);
+	for (size_t i = 0; i < stride; ++i) {
+		mean[i] = static_cast<float>(sum[i] / samples);
+	}
+	for (size_t i = 0; i < stride; ++i) {
+		for (size_t j = i; j < stride; ++j) {
+			const double c = covariance[i * stride + j] / samples - (sum[i] / samples) * (sum[j] / samples);
+			covariance[i * stride + j] = covariance[j * stride + i] = c;
+		}
+	}
+
+	// Leading components first, they are orthonormal so projected distances never exceed full ones
+	std::vector<double> vectors;
+	jacobiEigen(covariance, stride, vectors);
+	std::vector<size_t> order(stride);
+	for (size_t i = 0; i < stride; ++i) {
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return covariance[a * stride + a] > covariance[b * stride + b];
+	});
+
+	components.resize(projectedStride * stride);
+	for (size_t component = 0; component < projectedStride; ++component) {
+		for (size_t d = 0; d < stride; ++d) {
+			components[component * stride + d] = static_cast<float>(vectors[d * stride + order[component]]);
+		}
+	}
+}
+
+void MotionIndex::project( const float *feature, float *projection ) const
+{
+	for (size_t component = 0; component < projectedStride; ++component) {
+		const float *axis = &components[component * stride];
+		float value = 0.f;
+		for (size_t d = 0; d < stride; ++d) {
+			value += (feature[d] - mean[d]) * axis[d];
+		}
+		projection[component] = value;
+	}
+}
+
+unsigned int MotionIndex::nearestList( const float *projection ) const
+{
+	unsigned int nearest = 0;
+	float nearestDistance = squaredDistance(&centers[0], projection, projectedStride);
+	for (unsigned int list = 1; list < lists.size(); ++list) {
+		const float distance = squaredDistance(&centers[list * projectedStride], projection, projectedStride);
+		if (distance < nearestDistance) {
+			nearestDistance = distance;
+			nearest = list;
+		}
+	}
+	return nearest;
+}
+
+void MotionIndex::computeLists( const std::vector<float>& projected, unsigned int numThreads )
+{
+	// Centers start at frames spread evenly through the takes, then k-means runs over a sample of them
+	const size_t numFrames = projected.size() / projectedStride;
+	const size_t numLists = std::max<size_t>(1, numFrames / list_frames);
+	const size_t numSamples = std::min(numFrames, numLists * train_frames_per_list);
+
+	std::vector<float> samples(numSamples * projectedStride);
+	for (size_t sample = 0; sample < numSamples; ++sample) {
+		const size_t frame = sample * numFrames / numSamples;
+		std::copy(projected.begin() + frame * projectedStride, projected.begin() + (frame + 1) * projectedStride, samples.begin() + sample * projectedStride);
+	}
+
+	const List empty = { 0, 0, 0.f };
+	lists.assign(numLists, empty);
+	centers.resize(numLists * projectedStride);
+	for (size_t list = 0; list < numLists; ++list) {
+		const size_t sample = list * numSamples / numLists;
+		std::copy(samples.begin() + sample * projectedStride, samples.begin() + (sample + 1) * projectedStride, centers.begin() + list * projectedStride);
+	}
+
+	std::vector<unsigned int> assignment(numSamples);
+	std::vector<double> sums(numLists * projectedStride);
+	std::vector<size_t> counts(numLists);
+	const size_t numBlocks = (numSamples + assign_block_frames - 1) / assign_block_frames;
+	for (unsigned int iteration = 0; iteration < kmeans_iterations; ++iteration) {
+		parallelFor(numThreads, numBlocks, [&](size_t block) {
+			const size_t last = std::min(numSamples, (block + 1) * assign_block_frames);
+			for (size_t sample = block * assign_block_frames; sample < last; ++sample) {
+				assignment[sample] = nearestList(&samples[sample * projectedStride]);
+			}
+		});
+
+		// Lists left without samples keep their center
+		std::fill(sums.begin(), sums.end(), 0.0);
+		std::fill(counts.begin(), counts.end(), 0);
+		for (size_t sample = 0; sample < numSamples; ++sample) {
+			const unsigned int list = assignment[sample];
+			++counts[list];
+			for (size_t k = 0; k < projectedStride; ++k) {
+				sums[list * projectedStride + k] += samples[sample * projectedStride + k];
+			}
+		}
+		for (size_t list = 0; list < numLists; ++list) {
+			if (counts[list] == 0) continue;
+			for (size_t k = 0; k < projectedStride; ++k) {
+				centers[list * projectedStride + k] = static_cast<float>(sums[list * projectedStride + k] / counts[list]);
+			}
+		}
+	}
+}
+
+void MotionIndex::search( const float *feature, size_t k, std::vector<MotionMatch>& matches, size_t maxLists ) const
+{
+	matches.clear();
+	if (lists.empty() || k == 0) return;
+
+	std::vector<float> projection(projectedStride);
+	project(feature, &projection[0]);
+
+	// Lists nearest first by their centers
+	std::vector<ListDistance> order(lists.size());
+	for (unsigned int list = 0; list < lists.size(); ++list) {
+		order[list] = ListDistance(std::sqrt(squaredDistance(&centers[list * projectedStride], &projection[0], projectedStride)), list);
+	}
+	if (maxLists > 0 && maxLists < order.size()) {
+		std::partial_sort(order.begin(), order.begin() + maxLists, order.end());
+		order.resize(maxLists);
+	} else {
+		std::sort(order.begin(), order.end());
+	}
+
+	std::vector<Candidate> best;
+	best.reserve(k + 1);
+	for (auto& entry : order) {
+		// No projection in a list is nearer than its center less its radius
+		const List& list = lists[entry.second];
+		const float bound = entry.first - list.radius;
+		if (best.size() == k && bound > 0.f && bound * bound >= best.front().first) continue;
+
+		for (unsigned int i = list.first; i < list.last; ++i) {
+			if (best.size() == k && squaredDistance(&projections[i * projectedStride], &projection[0], projectedStride) >= best.front().first) continue;
+
+			const float distance = squaredDistance(&features[i * stride], feature, stride);
+			if (best.size() < k) {
+				best.push_back(Candidate(distance, i));
+				std::push_heap(best.begin(), best.end());
+			} else if (distance < best.front().first) {
+				std::pop_heap(best.begin(), best.end());
+				best.back() = Candidate(distance, i);
+				std::push_heap(best.begin(), best.end());
+			}
+		}
+	}
+
+	std::sort_heap(best.begin(), best.end());
+	for (auto& candidate : best) {
+		const Frame& frame = frames[candidate.second];
+		matches.push_back(MotionMatch(takes[frame.take], frame.frame * frameDelta, std::sqrt(candidate.first)));
+	}
+}
+
+void MotionIndex::search( const PoseSampler& take, float time, size_t k, std::vector<MotionMatch>& matches, size_t maxLists ) const
+{
+	std::vector<float> feature(stride);
+	extractor.extract(take, time, frameDelta, &feature[0]);
+	search(&feature[0], k, matches, maxLists);
+}
+
+size_t MotionIndex::getMemoryUsage() const
+{
+	return takes.capacity() * sizeof(const PoseSampler*)
+	     + (mean.capacity() + components.capacity() + centers.capacity()) * sizeof(float)
+	     + lists.capacity() * sizeof(List)
+	     + frames.capacity() * sizeof(Frame)
+	     + (features.capacity() + projections.capacity()) * sizeof(float);
+}
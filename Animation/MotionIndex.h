@@ -0,0 +1,99 @@
+#pragma once
+
+#include "PoseFeatures.h"
+
+#include <vector>
+
+class PoseSampler;
+
+
+// One frame found by a motion search
+struct MotionMatch
+{
+	const PoseSampler *take;
+	float time;
+	float distance; // between pose features
+
+	MotionMatch(const PoseSampler *take, float time, float distance)
+		: take(take)
+		, time(time)
+		, distance(distance)
+	{}
+};
+
+
+// Nearest neighbour search over every frame of a set of takes
+//
+// Frames are described by a PoseFeatureExtractor, by default the head, hands and feet
+// relative to the hip center plus their velocities. Each frame is also projected on the
+// features' leading principal components, and k-means over the projections groups the
+// frames into lists whose features are kept side by side. A search scans the lists in
+// order of their centers' distance from the query, skipping lists and frames whose projected
+// distance, which never exceeds the full one, can't beat the k nearest so far, and ranks the
+// rest on their full features. An exact search scans every list, a bounded one only the
+// maxLists nearest, which bounds its time however many hours are indexed
+class MotionIndex
+{
+public:
+	// Indexes the default features sampled at zhAnimation_SampleRate
+	MotionIndex();
+	MotionIndex(const PoseFeatureExtractor& extractor, float frameDelta);
+
+	// Replace the index with every frame of takes, which must outlive it and not change while indexed,
+	// takes without length are left out, numThreads of 0 uses one thread per hardware thread
+	void build(const std::vector<const PoseSampler*>& takes, unsigned int numThreads = 0);
+	void clear();
+
+	// Replace matches with the k frames nearest to feature, closest first,
+	// feature holds getExtractor().getStride() floats, maxLists of 0 searches exactly
+	void search(const float *feature, size_t k, std::vector<MotionMatch>& matches, size_t maxLists = 0) const;
+	// Same for the pose of take at time, take needn't be indexed
+	void search(const PoseSampler& take, float time, size_t k, std::vector<MotionMatch>& matches, size_t maxLists = 0) const;
+
+	const PoseFeatureExtractor& getExtractor() const;
+	float getFrameDelta() const;
+	size_t getNumTakes() const;
+	size_t getNumFrames() const;
+	size_t getNumLists() const;
+	size_t getMemoryUsage() const;
+
+private:
+	// Frames [first, last) and the furthest any of their projections is from the list's center
+	struct List
+	{
+		unsigned int first, last;
+		float radius;
+	};
+
+	struct Frame
+	{
+		unsigned int take;
+		unsigned int frame;
+	};
+
+	void computeComponents(const std::vector<float>& values);
+	void project(const float *feature, float *projection) const;
+	unsigned int nearestList(const float *projection) const;
+	void computeLists(const std::vector<float>& projected, unsigned int numThreads);
+
+	PoseFeatureExtractor extractor;
+	float frameDelta;
+	size_t stride;
+	size_t projectedStride; // principal components kept, a multiple of 4
+
+	std::vector<const PoseSampler*> takes;
+	std::vector<float> mean;        // stride floats
+	std::vector<float> components;  // projectedStride rows of stride floats
+	std::vector<float> centers;     // projectedStride floats per list
+	std::vector<List> lists;
+	std::vector<Frame> frames;      // in list order
+	std::vector<float> features;    // stride floats per frame, in list order
+	std::vector<float> projections; // projectedStride floats per frame, in list order
+
+};
+
+inline const PoseFeatureExtractor& MotionIndex::getExtractor() const { return extractor; }
+inline float MotionIndex::getFrameDelta() const { return frameDelta; }
+inline size_t MotionIndex::getNumTakes() const { return takes.size(); }
+inline size_t MotionIndex::getNumFrames() const { return frames.size(); }
+inline size_t MotionIndex::getNumLists() const { return lists.size(); }
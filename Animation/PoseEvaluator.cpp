@@ -0,0 +1,17 @@
+#include "PoseEvaluator.h"
+#include "PoseSampler.h"
+#include "Skeleton.h"
+
+
+PoseEvaluator::PoseEvaluator(unsigned int numThreads)
+	: pool(numThreads)
+{}
+
+void PoseEvaluator::evaluate(const std::vector<PoseJob>& jobs)
+{
+	pool.parallelFor(jobs.size(), [&](size_t i) {
+		const PoseJob& job = jobs[i];
+		job.take->apply(job.skeleton, job.time);
+		job.skeleton->updateWorldTransforms();
+	});
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Util/ThreadPool.h"
+
+#include <vector>
+
+class PoseSampler;
+class Skeleton;
+
+
+// One pose to evaluate, take sampled at time and written into skeleton
+struct PoseJob
+{
+	const PoseSampler *take;
+	Skeleton *skeleton;
+	float time;
+
+	PoseJob(const PoseSampler *take, Skeleton *skeleton, float time)
+		: take(take)
+		, skeleton(skeleton)
+		, time(time)
+	{}
+};
+
+
+// Poses many skeletons at once, one job per skeleton spread over a thread pool
+// Each job must have its own skeleton, skeletons come back with their world transforms
+// already up to date so the renderer only reads them
+class PoseEvaluator
+{
+public:
+	// numThreads of 0 uses one thread per hardware thread
+	explicit PoseEvaluator(unsigned int numThreads = 0);
+
+	void evaluate(const std::vector<PoseJob>& jobs);
+
+	unsigned int getNumThreads() const;
+
+private:
+	ThreadPool pool;
+
+};
+
+inline unsigned int PoseEvaluator::getNumThreads() const { return pool.getNumThreads(); }
@@ -0,0 +1,102 @@
+#include "PoseFeatures.h"
+#include "PoseSampler.h"
+#include "TransformKeyFrame.h"
+#include "Util/ThreadPool.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const size_t block_frames = 256; // frames per extraction job
+}
+
+
+PoseFeatureExtractor::PoseFeatureExtractor()
+	: bones()
+	, scales()
+	, velocityWeight(0.f)
+{}
+
+void PoseFeatureExtractor::addBone( EBoneID boneID, float weight )
+{
+	if (weight <= 0.f) return;
+	bones.push_back(static_cast<unsigned short>(boneID));
+	scales.push_back(std::sqrt(weight));
+}
+
+void PoseFeatureExtractor::setVelocityWeight( float weight )
+{
+	velocityWeight = std::max(0.f, weight);
+}
+
+void PoseFeatureExtractor::samplePositions( const PoseSampler& take, float time, float *positions ) const
+{
+	TransformKeyFrame keyFrame(0.f, 0);
+
+	glm::vec3 root;
+	if (take.sample(HIP_CENTER, time, &keyFrame)) {
+		root = keyFrame.getTranslation();
+	}
+
+	for (size_t b = 0; b < bones.size(); ++b) {
+		glm::vec3 position;
+		if (take.sample(bones[b], time, &keyFrame)) {
+			position = (keyFrame.getTranslation() - root) * scales[b];
+		}
+		positions[b * 3 + 0] = position.x;
+		positions[b * 3 + 1] = position.y;
+		positions[b * 3 + 2] = position.z;
+	}
+}
+
+void PoseFeatureExtractor::extract( const PoseSampler& take, float time, float frameDelta, float *row ) const
+{
+	const size_t numValues = bones.size() * 3;
+	std::fill(row, row + getStride(), 0.f);
+	samplePositions(take, time, row);
+	if (velocityWeight <= 0.f || frameDelta <= 0.f) return;
+
+	// Backwards difference as extract() over a whole take does, forwards at its first frame
+	std::vector<float> other(numValues);
+	const bool first = (time < frameDelta);
+	samplePositions(take, first ? time + frameDelta : time - frameDelta, &other[0]);
+
+	const float scale = velocityWeight / frameDelta;
+	for (size_t k = 0; k < numValues; ++k) {
+		row[numValues + k] = (first ? other[k] - row[k] : row[k] - other[k]) * scale;
+	}
+}
+
+void PoseFeatureExtractor::extract( const PoseSampler& take, float frameDelta, size_t numFrames, unsigned int numThreads, PoseFeatures& features ) const
+{
+	features.numFrames  = numFrames;
+	features.stride     = getStride();
+	features.frameDelta = frameDelta;
+	features.values.assign(numFrames * features.stride, 0.f);
+
+	const size_t numValues = bones.size() * 3;
+	const size_t stride = features.stride;
+	const size_t numBlocks = (numFrames + block_frames - 1) / block_frames;
+
+	parallelFor(numThreads, numBlocks, [&](size_t block) {
+		const size_t last = std::min(numFrames, (block + 1) * block_frames);
+		for (size_t frame = block * block_frames; frame < last; ++frame) {
+			samplePositions(take, frame * frameDelta, &features.values[frame * stride]);
+		}
+	});
+	if (velocityWeight <= 0.f || frameDelta <= 0.f || numFrames < 2) return;
+
+	// Velocities from the positions of neighbouring rows
+	const float scale = velocityWeight / frameDelta;
+	for (size_t frame = 1; frame < numFrames; ++frame) {
+		const float *prev = &features.values[(frame - 1) * stride];
+		float *row = &features.values[frame * stride];
+		for (size_t k = 0; k < numValues; ++k) {
+			row[numValues + k] = (row[k] - prev[k]) * scale;
+		}
+	}
+	std::copy(features.values.begin() + stride + numValues, features.values.begin() + stride + 2 * numValues, features.values.begin() + numValues);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "AnimationTypes.h"
+
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define POSE_FEATURES_SSE 1
+#endif
+
+class PoseSampler;
+
+
+// Pose descriptors of a take sampled every frameDelta seconds, one row of stride floats per frame
+struct PoseFeatures
+{
+	size_t numFrames;
+	size_t stride;  // multiple of 4, the padding is 0
+	float frameDelta;
+	std::vector<float> values;
+
+	PoseFeatures() : numFrames(0), stride(0), frameDelta(0.f), values() {}
+
+	const float *row(size_t frame) const { return &values[frame * stride]; }
+};
+
+
+// Describes a pose by the positions of a set of bones relative to the hip center,
+// so where the actor stands doesn't matter, optionally followed by their velocities
+// Each bone's values are scaled by the square root of its weight so squared distances
+// between rows are weighted sums over the bones
+class PoseFeatureExtractor
+{
+public:
+	// No bones and no velocities
+	PoseFeatureExtractor();
+
+	void addBone(EBoneID boneID, float weight = 1.f);
+	// Seconds of velocity counted the same as a unit of position, 0 leaves velocities out
+	void setVelocityWeight(float weight);
+
+	// Feature of take at time, velocities are differences over frameDelta, row holds getStride() floats
+	void extract(const PoseSampler& take, float time, float frameDelta, float *row) const;
+	// Features of the first numFrames frames of take, frameDelta apart, spread over numThreads threads
+	void extract(const PoseSampler& take, float frameDelta, size_t numFrames, unsigned int numThreads, PoseFeatures& features) const;
+
+	size_t getNumBones() const;
+	size_t getStride() const;
+
+private:
+	// Scaled positions of every bone at time, relative to the hip center
+	void samplePositions(const PoseSampler& take, float time, float *positions) const;
+
+	std::vector<unsigned short> bones;
+	std::vector<float> scales;
+	float velocityWeight;
+
+};
+
+inline size_t PoseFeatureExtractor::getNumBones() const { return bones.size(); }
+inline size_t PoseFeatureExtractor::getStride() const { return ((velocityWeight > 0.f ? 6 : 3) * bones.size() + 3) & ~size_t(3); }
+
+
+// Squared distance between two feature rows of stride floats, stride is a multiple of 4
+inline float squaredDistance(const float *a, const float *b, size_t stride)
+{
+#if defined(POSE_FEATURES_SSE)
+	__m128 sum = _mm_setzero_ps();
+	for (size_t k = 0; k < stride; k += 4) {
+		const __m128 d = _mm_sub_ps(_mm_loadu_ps(a + k), _mm_loadu_ps(b + k));
+		sum = _mm_add_ps(sum, _mm_mul_ps(d, d));
+	}
+	float lanes[4];
+	_mm_storeu_ps(lanes, sum);
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+	float s0 = 0.f, s1 = 0.f, s2 = 0.f, s3 = 0.f;
+	for (size_t k = 0; k < stride; k += 4) {
+		const float d0 = a[k + 0] - b[k + 0];
+		const float d1 = a[k + 1] - b[k + 1];
+		const float d2 = a[k + 2] - b[k + 2];
+		const float d3 = a[k + 3] - b[k + 3];
+		s0 += d0 * d0; s1 += d1 * d1; s2 += d2 * d2; s3 += d3 * d3;
+	}
+	return (s0 + s1) + (s2 + s3);
+#endif
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "AnimationTypes.h"
+
+class Skeleton;
+class TransformKeyFrame;
+
+
+// Anything a take can be played back from, its keyframes in an Animation
+// or the packed copy of a finished take in a CompressedAnimation
+class PoseSampler
+{
+public:
+	virtual ~PoseSampler() {}
+
+	// Pose the bones of skel in boneMask at time, weight and scale as BoneAnimationTrack::apply
+	virtual void apply(Skeleton* skel, float time, float weight=1.f, float scale=1.f, const BoneMask& boneMask=default_bone_mask) const = 0;
+	// Transform of one bone at time, false leaving kf as it is when the bone has no keyframes
+	virtual bool sample(unsigned short boneId, float time, TransformKeyFrame* kf) const = 0;
+
+	virtual float getLength() const = 0;
+
+};
@@ -1,27 +1,37 @@
 #include "Recording.h"
+#include "BlendEngine.h"
 #include "Skeleton.h"
 #include "Animation.h"
 #include "AnimationTypes.h"
+#include "CompressedAnimation.h"
 #include "TransformKeyFrame.h"
 #include "BoneAnimationTrack.h"
-#include "Kinect/KinectDevice.h"
-#include "Core/Messages/Messages.h"
+#include "RollingCapture.h"
+#include "Kinect/SkeletonSource.h"
+
+#include <algorithm>
 
 
 unsigned int Recording::nextAnimationID = 0;
 
 
-Recording::Recording( const std::string& name, const KinectDevice& kinect )
-	: animation(new Animation(nextAnimationID++, name))
-	, kinect(kinect)
-	, looping(true)
+Recording::Recording( const std::string& name, const SkeletonSource& source )
+	: source(source)
+	, animation(new Animation(nextAnimationID++, name))
+	, packed()
+	, skeleton(new Skeleton())
 	, bonepaths(false)
+	, looping(true)
 	, playback(false)
 	, playbackTime(0)
 	, playbackDelta(1 / 60.f)
 	, recording(false)
 	, recordingTime(0)
 	, recordingDelta(1 / 60.f)
+	, reducedKeyFrames(0)
+	, captureFrames(0)
+	, captureElapsed(0)
+	, captureRate(0)
 {
 	for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
 		animation->createBoneTrack(boneID);
@@ -40,14 +50,14 @@ void Recording::update( float delta )
 void Recording::apply( Skeleton *skeleton, float time, const BoneMask& boneMask/*=default_bone_mask*/ )
 {
 	if (getAnimationLength() > 0.f) {
-		animation->apply(skeleton, time, 1.f, 1.f, boneMask);
+		getPoses().apply(skeleton, time, 1.f, 1.f, boneMask);
 	}
 }
 
 void Recording::apply( Skeleton *skeleton, const BoneMask& boneMask/*=default_bone_mask*/ )
 {
 	if (getAnimationLength() > 0.f) {
-		animation->apply(skeleton, playbackTime, 1.f, 1.f, boneMask);
+		getPoses().apply(skeleton, playbackTime, 1.f, 1.f, boneMask);
 	}
 }
 
@@ -55,12 +65,13 @@ size_t Recording::saveKeyFrame(float now)
 {
 	if (nullptr == animation) return 0;
 
-	// Get the Kinect skeleton data if there is any
-	const auto& skeletonFrame    = kinect.getSkeletonFrame();
-	const auto *skeletonData     = kinect.getFirstTrackedSkeletonData(skeletonFrame);
-	const auto *boneOrientations = kinect.getOrientations();
+	// Get the tracked skeleton data if there is any
+	const SkeletonData *skeletonData = source.getTrackedSkeletonData();
 	if (nullptr == skeletonData) return 0;
 
+	// Capturing more onto a packed take carries on from its keyframes
+	unpack();
+
 	// Update all bone tracks with a new keyframe
 	BoneAnimationTrack *track   = nullptr;
 	TransformKeyFrame *keyFrame = nullptr;
@@ -72,12 +83,9 @@ size_t Recording::saveKeyFrame(float now)
 		keyFrame = static_cast<TransformKeyFrame*>(track->createKeyFrame(now));
 		if (nullptr == keyFrame) continue;
 
-		const Vector4& p = skeletonData->SkeletonPositions[boneID];
-		const Vector4& q = boneOrientations[boneID].hierarchicalRotation.rotationQuaternion;
-		const Vector4& a = boneOrientations[boneID].absoluteRotation.rotationQuaternion;
-		keyFrame->setTranslation(glm::vec3(p.x, p.y, p.z));
-		keyFrame->setRotation(glm::normalize(glm::quat(q.w, q.x, q.y, q.z)));
-		keyFrame->setAbsRotation(glm::normalize(glm::quat(a.w, a.x, a.y, a.z)));
+		keyFrame->setTranslation(skeletonData->positions[boneID]);
+		keyFrame->setRotation(skeletonData->hierarchicalRotations[boneID]);
+		keyFrame->setAbsRotation(skeletonData->absoluteRotations[boneID]);
 		keyFrame->setScale(glm::vec3(1));
 
 		numKeyFrames += track->getNumKeyFrames();
@@ -87,39 +95,25 @@ size_t Recording::saveKeyFrame(float now)
 }
 
 void Recording::saveBlendFrame( float time
+                              , BlendEngine& engine
                               , const Recording& base
                               , const Recording& layer
                               , const BoneMask& boneMask/*=default_bone_mask */
-                              , const ELayerMappingMode& mappingMode/*=ELayerMappingMode::MAP_ADDITIVE*/ )
+                              , const ELayerMappingMode& mappingMode/*=ELayerMappingMode::MAP_DIRECT*/ )
 {
-	const Animation *baseAnim  = base.getAnimation();
-	const Animation *layerAnim = layer.getAnimation();
-
-	BoneAnimationTrack *baseTrack  = nullptr;
-	BoneAnimationTrack *layerTrack = nullptr;
-	BoneAnimationTrack *blendTrack = nullptr;
+	unpack();
+	engine.blendFrame(time, recordingDelta, *base.getAnimation(), *layer.getAnimation(), boneMask, mappingMode, *animation);
+}
 
-	for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
-		// Get this bone's animation track for the base, layer, and blend (i.e. this) animations
-		baseTrack  = baseAnim->getBoneTrack(boneID);
-		layerTrack = layerAnim->getBoneTrack(boneID);
-		blendTrack = animation->getBoneTrack(boneID);
-		if (nullptr == baseTrack || nullptr == layerTrack || nullptr == blendTrack) continue;
-
-		// Create a new keyframe in this blended recording
-		TransformKeyFrame *blendTKF = static_cast<TransformKeyFrame*>(blendTrack->createKeyFrame(time));
-		if (nullptr == blendTKF) continue;
-
-		// If this boneID is not in boneMask, save the base keyframe for this bone
-		if (end(boneMask) == boneMask.find((EBoneID) boneID)) {
-			baseTrack->getInterpolatedKeyFrame(time, blendTKF);
-			continue;
-		}
-		// else this boneID is in boneMask, so save a blended keyframe
-		layerTrack->getInterpolatedKeyFrame(time, blendTKF);
-		blendTKF->setRotation(glm::normalize(blendTKF->getRotation()));
-		blendTKF->setScale(glm::vec3(1)); // scale is ignored
-	}
+void Recording::blend( const BlendEngine& engine
+                     , const Recording& base
+                     , const Recording& layer
+                     , const BoneMask& boneMask/*=default_bone_mask */
+                     , const ELayerMappingMode& mappingMode/*=ELayerMappingMode::MAP_DIRECT*/
+                     , const TimeWarp *timeWarp/*=nullptr*/ )
+{
+	unpack();
+	engine.blend(*base.getAnimation(), *layer.getAnimation(), boneMask, mappingMode, *animation, recordingDelta, timeWarp);
 }
 
 void Recording::updateRecording( float delta )
@@ -128,11 +122,17 @@ void Recording::updateRecording( float delta )
 
 	// Update animation timer for this new keyframe
 	recordingTime += recordingDelta;
-	saveKeyFrame(recordingTime);
+	if (saveKeyFrame(recordingTime) > 0) {
+		++captureFrames;
+	}
 
-	// Update gui label text
-	msg::gDispatcher.dispatchMessage(msg::SetRecordingLabelMessage(
-		"Mem usage: " + std::to_string(animation->_calcMemoryUsage()) + " bytes\n" ));
+	// Measure capture rate once per second of real time
+	captureElapsed += delta;
+	if (captureElapsed >= 1.f) {
+		captureRate    = captureFrames / captureElapsed;
+		captureFrames  = 0;
+		captureElapsed = 0.f;
+	}
 }
 
 void Recording::updatePlayback( float delta )
@@ -141,7 +141,7 @@ void Recording::updatePlayback( float delta )
 
 	playbackTime += playbackDelta;
 
-	const float len = animation->getLength();
+	const float len = getAnimationLength();
 	if (playbackTime > len) {
 		if (looping) playbackTime = 0.f;
 		else         playbackTime = len;
@@ -150,26 +150,120 @@ void Recording::updatePlayback( float delta )
 
 void Recording::clearRecording()
 {
-	animation->deleteAllBoneTrack();
+	packed.reset();
 
+	// Tracks are kept, so their keyframe pools are reused by the next take
 	for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
-		animation->createBoneTrack(boneID);
+		animation->createBoneTrack(boneID)->deleteAllKeyFrames();
 	}
+	skeleton->clearCalibration();
 
 	playback  = false;
 	recording = false;
 
 	playbackTime  = 0.f;
 	recordingTime = 0.f;
+
+	reducedKeyFrames = 0;
+
+	captureFrames  = 0;
+	captureElapsed = 0.f;
+	captureRate    = 0.f;
+}
+
+void Recording::reserve( float seconds )
+{
+	unpack();
+
+	const size_t numKeyFrames = static_cast<size_t>(std::max(0.f, seconds) / recordingDelta) + 1;
+	for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		animation->createBoneTrack(boneID)->reserveKeyFrames(numKeyFrames);
+	}
+}
+
+size_t Recording::keep( const RollingCapture& capture, float seconds )
+{
+	clearRecording();
+
+	// Recording more carries on from the end of the kept frames
+	const size_t numFrames = capture.snapshot(seconds, *animation);
+	recordingTime = animation->getLength();
+	return numFrames;
+}
+
+size_t Recording::reduceKeyFrames( const KeyFrameTolerance& tolerance )
+{
+	unpack();
+
+	const size_t removed = animation->reduceKeyFrames(tolerance);
+	reducedKeyFrames += removed;
+	return removed;
+}
+
+bool Recording::calibrate( float time/*=0.f*/ )
+{
+	return skeleton->calibrate(getPoses(), time);
+}
+
+void Recording::calibrate( const Recording& other )
+{
+	skeleton->calibrate(other.getSkeleton());
+}
+
+bool Recording::pack()
+{
+	if (recording || (nullptr == packed && 0 == animation->getNumKeyFrames())) return false;
+
+	if (nullptr == packed) {
+		packed.reset(new CompressedAnimation());
+		packed->compress(*animation);
+	} else if (0 == animation->getNumKeyFrames()) {
+		return true; // nothing decoded to free
+	}
+
+	// Tracks are kept, they are empty and hold no keyframe memory
+	for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		animation->deleteBoneTrack(boneID);
+		animation->createBoneTrack(boneID);
+	}
+	return true;
+}
+
+void Recording::unpack()
+{
+	if (nullptr == packed) return;
+
+	getAnimation();
+	packed.reset();
+}
+
+void Recording::setName( const std::string& name )
+{
+	animation->setName(name);
+}
+
+const Animation *Recording::getAnimation() const
+{
+	// The keyframes are the same take as the packed copy, only decoded
+	if (nullptr != packed && 0 == animation->getNumKeyFrames()) {
+		packed->decompress(*animation);
+	}
+	return animation.get();
+}
+
+const PoseSampler& Recording::getPoses() const
+{
+	if (nullptr != packed) return *packed;
+	else                   return *animation;
 }
 
 void Recording::setPlaybackTime( float t )
 {
-	playbackTime = glm::clamp<float>(t, 0.f, animation->getLength());
+	playbackTime = glm::clamp<float>(t, 0.f, getAnimationLength());
 }
 
 void Recording::playbackNextFrame() {
-	const float length = animation->getLength();
+	const float length = getAnimationLength();
 	playbackTime += playbackDelta;
 	if (playbackTime > length) {
 		playbackTime = length;
@@ -184,124 +278,18 @@ void Recording::playbackPreviousFrame() {
 }
 
 float Recording::getAnimationLength() const {
+	if (nullptr != packed)    return packed->getLength();
 	if (nullptr != animation) return animation->getLength();
 	else                      return 0.f;
 }
 
-
-/*------------------------------------------------------------------------------
-void Recording::saveBlendFrame( float time
-                              , const Recording& base
-                              , const Recording& layer
-                              , const BoneMask& boneMask//=default_bone_mask 
-                              , const ELayerMappingMode& mappingMode//=ELayerMappingMode::MAP_DIRECT )
-{
-	const Animation *baseAnim  = base.getAnimation();
-	const Animation *layerAnim = layer.getAnimation();
-
-	BoneAnimationTrack *baseTrack  = nullptr;
-	BoneAnimationTrack *layerTrack = nullptr;
-	BoneAnimationTrack *blendTrack = nullptr;
-
-	TransformKeyFrame baseKeyFrame(0.f, 0);
-	TransformKeyFrame layerKeyFrame1(0.f, 0);
-	TransformKeyFrame layerKeyFrame2(0.f, 0);
-
-	// Get position of root bone for base and layer in order to calculate offset of masked bones
-	TransformKeyFrame baseRootKeyFrame(0.f, 0);
-	TransformKeyFrame layerRootKeyFrame(0.f, 0);
-	baseAnim ->getBoneTrack(HIP_CENTER)->getInterpolatedKeyFrame(time, &baseRootKeyFrame);
-	layerAnim->getBoneTrack(HIP_CENTER)->getInterpolatedKeyFrame(time, &layerRootKeyFrame);
-	const glm::vec3 baseRootPos  = baseRootKeyFrame.getTranslation();
-	const glm::vec3 layerRootPos = layerRootKeyFrame.getTranslation();
-
-	for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
-		// Get this bone's animation track for the base, layer, and blend (i.e. this) animations
-		baseTrack  = baseAnim->getBoneTrack(boneID);
-		layerTrack = layerAnim->getBoneTrack(boneID);
-		blendTrack = animation->getBoneTrack(boneID);
-		if (nullptr == baseTrack || nullptr == layerTrack || nullptr == blendTrack) continue;
-
-		// Create a new keyframe in this blended recording
-		TransformKeyFrame *blendTKF = static_cast<TransformKeyFrame*>(blendTrack->createKeyFrame(time));
-		if (nullptr == blendTKF) continue;
-		blendTKF->setScale(glm::vec3(1)); // scale is ignored
-
-		// If this boneID is not in boneMask, save the base keyframe for this bone
-		if (end(boneMask) == boneMask.find((EBoneID) boneID)) {
-			baseTrack->getInterpolatedKeyFrame(time, blendTKF);
-			continue;
-		}
-		//NOTE : Alternative mappings don't work correctly at this time, 
-		//       Need to calculate world transforms, extract positions, 
-		//	   and use those for position transformations
-		// Else this boneID is in boneMask, save a blended keyframe using the current mapping mode...
-		switch (mappingMode)
-		{
-			case MAP_DIRECT:
-			{
-				layerTrack->getInterpolatedKeyFrame(time, blendTKF);
-				blendTKF->setRotation(glm::normalize(blendTKF->getRotation()));
-			}
-			break;
-
-			case MAP_ABSOLUTE:
-			{
-				baseTrack->getInterpolatedKeyFrame(0.f, &baseKeyFrame);
-				layerTrack->getInterpolatedKeyFrame(time, &layerKeyFrame1);
-				layerTrack->getInterpolatedKeyFrame(0.f, &layerKeyFrame2);
-
-				const glm::vec3 boneOffsetPos = layerKeyFrame1.getTranslation() - layerRootPos;
-
-				const glm::vec3 y0(baseKeyFrame.getTranslation());
-				const glm::vec3 xt(baseRootPos + boneOffsetPos);
-				const glm::vec3 x0(layerKeyFrame2.getTranslation());
-
-				const glm::quat yr0 = baseKeyFrame.getRotation();
-				const glm::quat xrt = layerKeyFrame1.getRotation();
-				const glm::quat inv_xr0 = glm::inverse(layerKeyFrame2.getRotation());
-
-				// Y'(t)= Y0 + (X(t) - X0)
-				blendTKF->setTranslation(glm::vec3(y0 + (xt - x0)));
-				// Yr'(t) = Xr(t) inv(Xr0) Yr0
-				blendTKF->setRotation(xrt * inv_xr0 * yr0);
-			}
-			break;
-
-			case MAP_ADDITIVE:
-			{
-				baseTrack->getInterpolatedKeyFrame(time, &baseKeyFrame);
-				layerTrack->getInterpolatedKeyFrame(time, &layerKeyFrame1);
-				layerTrack->getInterpolatedKeyFrame(time - playbackDelta, &layerKeyFrame2);
-
-				const glm::vec3 yt(baseKeyFrame.getTranslation());
-				const glm::vec3 xt(layerKeyFrame1.getTranslation());
-				const glm::vec3 xt_dt(layerKeyFrame2.getTranslation());
-
-				// Y'(t) = Y(t) + (X(t) - X(t - dt))
-				blendTKF->setTranslation(glm::vec3(yt + (xt - xt_dt)));
-				blendTKF->setRotation(glm::quat(baseKeyFrame.getRotation()));
-			}
-			break;
-
-			case MAP_TRAJECTORY_RELATIVE:
-			{
-				baseTrack->getInterpolatedKeyFrame(0.f, &baseKeyFrame);
-				layerTrack->getInterpolatedKeyFrame(time, &layerKeyFrame1);
-				layerTrack->getInterpolatedKeyFrame(0.f, &layerKeyFrame2);
-
-				const glm::vec3 boneOffsetPos = layerKeyFrame1.getTranslation() - layerRootPos;
-
-				const glm::vec3 y0(baseKeyFrame.getTranslation());
-				const glm::vec3 xt(baseRootPos + boneOffsetPos);
-				const glm::vec3 x0(layerKeyFrame2.getTranslation());
-
-				// Y'(t) = Y(t) + K(t)*(X(t) - X0)
-				blendTKF->setTranslation(glm::vec3(y0 + (xt - x0)));
-				blendTKF->setRotation(glm::quat(baseKeyFrame.getRotation()));
-			}
-			break;
-		}
-	}
+RecordingStats Recording::getStats() const {
+	RecordingStats stats;
+	stats.bytes       = animation->getMemoryUsage() + (packed ? packed->getMemoryUsage() : 0);
+	stats.keyFrames   = packed ? packed->getNumKeyFrames() : animation->getNumKeyFrames();
+	stats.captured    = stats.keyFrames + reducedKeyFrames;
+	stats.length      = getAnimationLength();
+	stats.captureRate = captureRate;
+	return stats;
 }
-*/
+
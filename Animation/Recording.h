@@ -5,26 +5,53 @@
 #include <memory>
 #include <string>
 
-class KinectDevice;
+class SkeletonSource;
+class RollingCapture;
 class Animation;
+class CompressedAnimation;
+class PoseSampler;
 class Skeleton;
+class BlendEngine;
+class TimeWarp;
+struct KeyFrameTolerance;
+
+// Snapshot of a recording's running totals, cheap enough to poll every gui frame
+struct RecordingStats
+{
+	size_t bytes;       // keyframe memory usage
+	size_t keyFrames;   // keyframes over all bone tracks
+	size_t captured;    // keyframes captured, before any were removed by reduceKeyFrames
+	float  length;      // take length in seconds
+	float  captureRate; // captured frames per second over the last second of recording
+};
 
 class Recording
 {
 public:
-	Recording(const std::string& name, const KinectDevice& kinect);
+	Recording(const std::string& name, const SkeletonSource& source);
 	~Recording();
 
 	void update(float delta);
 	void apply(Skeleton *skeleton, float time, const BoneMask& boneMask=default_bone_mask);
 	void apply(Skeleton *skeleton, const BoneMask& boneMask=default_bone_mask);
 
+	// Add one blended keyframe at time, the engine holds the layering session's reference poses
 	void saveBlendFrame( float time
+	                   , BlendEngine& engine
 	                   , const Recording& base
 	                   , const Recording& layer
 	                   , const BoneMask& boneMask=default_bone_mask
 	                   , const ELayerMappingMode& mappingMode=ELayerMappingMode::MAP_DIRECT );
 
+	// Replace this recording with layer blended over base for their whole shared timeline,
+	// or over the whole base with the layer played through timeWarp
+	void blend( const BlendEngine& engine
+	          , const Recording& base
+	          , const Recording& layer
+	          , const BoneMask& boneMask=default_bone_mask
+	          , const ELayerMappingMode& mappingMode=ELayerMappingMode::MAP_DIRECT
+	          , const TimeWarp *timeWarp=nullptr );
+
 	void showBonePaths();
 	void hideBonePaths();
 
@@ -45,20 +72,53 @@ public:
 	void stopRecording();
 	void clearRecording();
 
-	Animation *getAnimation();
+	// Allocate keyframes for seconds of capture up front, kept through clearRecording
+	void reserve(float seconds);
+
+	// Replace this recording with the last seconds held by capture, returns the number of frames kept
+	size_t keep(const RollingCapture& capture, float seconds);
+
+	// Remove keyframes that interpolation reproduces within tolerance, for finished takes
+	// Returns the number of keyframes removed
+	size_t reduceKeyFrames(const KeyFrameTolerance& tolerance);
+
+	// Set the recording's skeleton rest pose from its animation at time, or copy another's
+	bool calibrate(float time = 0.f);
+	void calibrate(const Recording& other);
+
+	// Store a finished take packed in a CompressedAnimation and free its keyframes,
+	// which are decoded again on demand, packing an already packed take frees the decoded copy
+	// Returns false, leaving the take as it is, while capturing or with no keyframes
+	// Anything that changes the take unpacks it for good
+	bool pack();
+	bool isPacked() const;
+
+	void setName(const std::string& name);
+
+	// Keyframes of the take, a packed take is decoded into them on demand and they stay until pack() is called
 	const Animation *getAnimation() const;
+	// What the take is played back from, the packed copy if there is one, so playing it decodes nothing up front
+	const PoseSampler& getPoses() const;
+	Skeleton& getSkeleton();
+	const Skeleton& getSkeleton() const;
 	float getAnimationLength() const;
 
+	RecordingStats getStats() const;
+	bool isRecording() const;
+
 private:
 	void updateRecording(float delta);
 	void updatePlayback(float delta);
 	size_t saveKeyFrame(float time);
+	void unpack();
 
 	static unsigned int nextAnimationID;
 
-	const KinectDevice& kinect;
+	const SkeletonSource& source;
 
-	std::unique_ptr<Animation> animation;
+	std::unique_ptr<Animation> animation;        // empty or a decoded copy while packed
+	std::unique_ptr<CompressedAnimation> packed; // nullptr unless packed
+	std::unique_ptr<Skeleton> skeleton;
 
 	bool bonepaths;
 	bool looping;
@@ -71,6 +131,12 @@ private:
 	float recordingTime;
 	float recordingDelta;
 
+	size_t reducedKeyFrames;
+
+	unsigned int captureFrames;
+	float captureElapsed;
+	float captureRate;
+
 };
 
 inline void Recording::startLooping()   { looping   = true;  }
@@ -81,10 +147,12 @@ inline void Recording::startPlayback()  { playback  = true;  }
 inline void Recording::stopPlayback()   { playback  = false; }
 inline void Recording::startRecording() { recording = true;  }
 inline void Recording::stopRecording()  { recording = false; }
+inline bool Recording::isRecording() const { return recording; }
 
 inline void Recording::resetPlaybackTime() { playbackTime = 0.f; }
 inline void Recording::setPlaybackDelta(float dt) { playbackDelta = dt; }
 inline float Recording::getPlaybackTime() const { return playbackTime; }
 
-inline Animation *Recording::getAnimation() { return animation.get(); }
-inline const Animation *Recording::getAnimation() const { return animation.get(); }
+inline bool Recording::isPacked() const { return nullptr != packed; }
+inline Skeleton& Recording::getSkeleton() { return *skeleton; }
+inline const Skeleton& Recording::getSkeleton() const { return *skeleton; }
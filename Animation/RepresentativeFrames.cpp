@@ -0,0 +1,358 @@
+#include "RepresentativeFrames.h"
+#include "Animation.h"
+#include "BoneAnimationTrack.h"
+#include "TransformKeyFrame.h"
+#include "Util/ThreadPool.h"
+#include "Util/zhPrereq.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	const size_t extract_block_frames = 256;  // frames per extraction job
+	const size_t refine_block_frames  = 4096; // frames per k-means job
+
+	// Positions only, a preview pose is about where the limbs are
+	PoseFeatureExtractor defaultExtractor()
+	{
+		PoseFeatureExtractor extractor;
+		extractor.addBone(HEAD);
+		extractor.addBone(ELBOW_LEFT);
+		extractor.addBone(HAND_LEFT);
+		extractor.addBone(ELBOW_RIGHT);
+		extractor.addBone(HAND_RIGHT);
+		extractor.addBone(KNEE_LEFT);
+		extractor.addBone(FOOT_LEFT);
+		extractor.addBone(KNEE_RIGHT);
+		extractor.addBone(FOOT_RIGHT);
+		return extractor;
+	}
+
+	bool earlierFrame(const RepresentativeFrame& a, const RepresentativeFrame& b) { return a.time < b.time; }
+}
+
+
+RepresentativeFrames::RepresentativeFrames()
+	: extractor(defaultExtractor())
+	, maxClusters(zhARFSS_NumClusters)
+	, frameDelta(1.f / zhAnimation_SampleRate)
+	, stride(extractor.getStride())
+	, features()
+	, centers()
+	, clusters()
+	, closestCost(std::numeric_limits<float>::infinity())
+	, closestA(0)
+	, closestB(0)
+	, closestDistance(std::numeric_limits<float>::infinity())
+{}
+
+RepresentativeFrames::RepresentativeFrames( const PoseFeatureExtractor& extractor, size_t numClusters, float frameDelta )
+	: extractor(extractor)
+	, maxClusters(numClusters)
+	, frameDelta(frameDelta)
+	, stride(extractor.getStride())
+	, features()
+	, centers()
+	, clusters()
+	, closestCost(std::numeric_limits<float>::infinity())
+	, closestA(0)
+	, closestB(0)
+	, closestDistance(std::numeric_limits<float>::infinity())
+{}
+
+void RepresentativeFrames::clear()
+{
+	features.clear();
+	centers.clear();
+	clusters.clear();
+	closestCost = std::numeric_limits<float>::infinity();
+	closestA = closestB = 0;
+	closestDistance = std::numeric_limits<float>::infinity();
+}
+
+size_t RepresentativeFrames::update( const Animation& animation, unsigned int numThreads )
+{
+	if (frameDelta <= 0.f || stride == 0 || maxClusters == 0) return 0;
+
+	const size_t numFrames = (animation.getNumKeyFrames() == 0) ? 0 : static_cast<size_t>(animation.getLength() / frameDelta) + 1;
+	if (numFrames < getNumFrames()) clear();
+	const size_t first = getNumFrames();
+	if (numFrames == first) return 0;
+
+	// Only the new frames' features are extracted, the ones seen before are kept for refine()
+	features.resize(numFrames * stride, 0.f);
+	const size_t numBlocks = (numFrames - first + extract_block_frames - 1) / extract_block_frames;
+	parallelFor(numThreads, numBlocks, [&](size_t block) {
+		const size_t begin = first + block * extract_block_frames;
+		const size_t end = std::min(numFrames, begin + extract_block_frames);
+		for (size_t frame = begin; frame < end; ++frame) {
+			extractor.extract(animation, frame * frameDelta, frameDelta, &features[frame * stride]);
+		}
+	});
+
+	for (size_t frame = first; frame < numFrames; ++frame) {
+		addFrame(frame);
+	}
+	return numFrames - first;
+}
+
+void RepresentativeFrames::addFrame( size_t frame )
+{
+	const float *feature = &features[frame * stride];
+
+	float distance = 0.f;
+	const size_t nearest = clusters.empty() ? 0 : nearestCluster(feature, distance);
+	if (clusters.size() < maxClusters || distance > closestDistance) {
+		// A pose unlike any cluster gets its own, making room by the cheapest merge
+		if (clusters.size() == maxClusters) {
+			mergeClosestClusters();
+		}
+		const Cluster cluster = { 1, frame, 0.f };
+		clusters.push_back(cluster);
+		centers.insert(centers.end(), feature, feature + stride);
+		updateClosestPair();
+		return;
+	}
+
+	// Otherwise the nearest cluster's center takes a running mean of its frames
+	Cluster& cluster = clusters[nearest];
+	float *mean = center(nearest);
+	++cluster.count;
+	const float rate = 1.f / cluster.count;
+	for (size_t k = 0; k < stride; ++k) {
+		mean[k] += (feature[k] - mean[k]) * rate;
+	}
+	const float medoidDistance = squaredDistance(feature, mean, stride);
+	if (medoidDistance < cluster.medoidDistance) {
+		cluster.medoid = frame;
+		cluster.medoidDistance = medoidDistance;
+	}
+
+	// The cluster moved and grew, a merge with it may now be the cheapest or its center the closest
+	if (nearest == closestA || nearest == closestB) {
+		updateClosestPair();
+		return;
+	}
+	for (size_t other = 0; other < clusters.size(); ++other) {
+		if (other == nearest) continue;
+		const float pairDistance = squaredDistance(mean, center(other), stride);
+		const float pairCost = mergeCost(nearest, other, pairDistance);
+		if (pairCost < closestCost) {
+			closestCost = pairCost;
+			closestA = std::min(nearest, other);
+			closestB = std::max(nearest, other);
+		}
+		closestDistance = std::min(closestDistance, pairDistance);
+	}
+}
+
+float RepresentativeFrames::mergeCost( size_t a, size_t b, float distance ) const
+{
+	// Ward's criterion, how much merging adds to the summed squared distances of frames to their centers
+	const float countA = static_cast<float>(clusters[a].count);
+	const float countB = static_cast<float>(clusters[b].count);
+	return distance * countA * countB / (countA + countB);
+}
+
+void RepresentativeFrames::mergeClosestClusters()
+{
+	Cluster& a = clusters[closestA];
+	const Cluster& b = clusters[closestB];
+
+	// Weighted mean of the two centers, keeping whichever medoid is nearer it
+	float *mean = center(closestA);
+	const float *other = center(closestB);
+	const float weight = float(b.count) / float(a.count + b.count);
+	for (size_t k = 0; k < stride; ++k) {
+		mean[k] += (other[k] - mean[k]) * weight;
+	}
+	const float distanceA = squaredDistance(&features[a.medoid * stride], mean, stride);
+	const float distanceB = squaredDistance(&features[b.medoid * stride], mean, stride);
+	a.count += b.count;
+	a.medoid = (distanceB < distanceA) ? b.medoid : a.medoid;
+	a.medoidDistance = std::min(distanceA, distanceB);
+
+	// The last cluster takes the merged one's place
+	const size_t last = clusters.size() - 1;
+	if (closestB != last) {
+		clusters[closestB] = clusters[last];
+		std::copy(centers.begin() + last * stride, centers.end(), centers.begin() + closestB * stride);
+	}
+	clusters.pop_back();
+	centers.resize(clusters.size() * stride);
+}
+
+void RepresentativeFrames::updateClosestPair()
+{
+	closestCost = std::numeric_limits<float>::infinity();
+	closestDistance = std::numeric_limits<float>::infinity();
+	closestA = closestB = 0;
+	for (size_t a = 0; a < clusters.size(); ++a) {
+		for (size_t b = a + 1; b < clusters.size(); ++b) {
+			const float distance = squaredDistance(&centers[a * stride], &centers[b * stride], stride);
+			const float cost = mergeCost(a, b, distance);
+			closestDistance = std::min(closestDistance, distance);
+			if (cost < closestCost) {
+				closestCost = cost;
+				closestA = a;
+				closestB = b;
+			}
+		}
+	}
+}
+
+size_t RepresentativeFrames::nearestCluster( const float *feature, float& distance ) const
+{
+	size_t nearest = 0;
+	distance = std::numeric_limits<float>::infinity();
+	for (size_t cluster = 0; cluster < clusters.size(); ++cluster) {
+		const float d = squaredDistance(feature, &centers[cluster * stride], stride);
+		if (d < distance) {
+			distance = d;
+			nearest = cluster;
+		}
+	}
+	return nearest;
+}
+
+void RepresentativeFrames::refine( unsigned int maxIterations, unsigned int numThreads )
+{
+	const size_t numFrames = getNumFrames();
+	const size_t numClusters = clusters.size();
+	if (numFrames == 0 || numClusters == 0) return;
+
+	// Each job sums its own frames per cluster, the sums are added up after
+	const size_t numBlocks = (numFrames + refine_block_frames - 1) / refine_block_frames;
+	std::vector<unsigned int> assignments(numFrames, static_cast<unsigned int>(numClusters));
+	std::vector<double> sums(numBlocks * numClusters * stride);
+	std::vector<size_t> counts(numBlocks * numClusters);
+	std::vector<size_t> changes(numBlocks);
+
+	for (unsigned int iteration = 0; iteration < maxIterations; ++iteration) {
+		std::fill(sums.begin(), sums.end(), 0.0);
+		std::fill(counts.begin(), counts.end(), 0);
+		parallelFor(numThreads, numBlocks, [&](size_t block) {
+			double *blockSums = &sums[block * numClusters * stride];
+			size_t *blockCounts = &counts[block * numClusters];
+			const size_t end = std::min(numFrames, (block + 1) * refine_block_frames);
+			size_t changed = 0;
+			for (size_t frame = block * refine_block_frames; frame < end; ++frame) {
+				const float *feature = &features[frame * stride];
+				float distance;
+				const unsigned int cluster = static_cast<unsigned int>(nearestCluster(feature, distance));
+				if (cluster != assignments[frame]) {
+					assignments[frame] = cluster;
+					++changed;
+				}
+				++blockCounts[cluster];
+				double *sum = &blockSums[cluster * stride];
+				for (size_t k = 0; k < stride; ++k) {
+					sum[k] += feature[k];
+				}
+			}
+			changes[block] = changed;
+		});
+
+		size_t changed = 0;
+		for (size_t block = 0; block < numBlocks; ++block) {
+			changed += changes[block];
+		}
+		if (changed == 0) break;
+
+		// A cluster left without frames keeps its center
+		for (size_t cluster = 0; cluster < numClusters; ++cluster) {
+			size_t count = 0;
+			for (size_t block = 0; block < numBlocks; ++block) {
+				count += counts[block * numClusters + cluster];
+			}
+			clusters[cluster].count = count;
+			if (count == 0) continue;
+
+			float *mean = center(cluster);
+			for (size_t k = 0; k < stride; ++k) {
+				double sum = 0.0;
+				for (size_t block = 0; block < numBlocks; ++block) {
+					sum += sums[(block * numClusters + cluster) * stride + k];
+				}
+				mean[k] = static_cast<float>(sum / count);
+			}
+		}
+	}
+
+	// Medoids, the member of each cluster nearest its center
+	const float inf = std::numeric_limits<float>::infinity();
+	std::vector<float> bestDistances(numBlocks * numClusters, inf);
+	std::vector<size_t> bestFrames(numBlocks * numClusters, 0);
+	parallelFor(numThreads, numBlocks, [&](size_t block) {
+		const size_t end = std::min(numFrames, (block + 1) * refine_block_frames);
+		for (size_t frame = block * refine_block_frames; frame < end; ++frame) {
+			const size_t cluster = assignments[frame];
+			const size_t best = block * numClusters + cluster;
+			const float distance = squaredDistance(&features[frame * stride], &centers[cluster * stride], stride);
+			if (distance < bestDistances[best]) {
+				bestDistances[best] = distance;
+				bestFrames[best] = frame;
+			}
+		}
+	});
+	for (size_t cluster = 0; cluster < numClusters; ++cluster) {
+		Cluster& c = clusters[cluster];
+		c.medoidDistance = inf;
+		for (size_t block = 0; block < numBlocks; ++block) {
+			const size_t best = block * numClusters + cluster;
+			if (bestDistances[best] < c.medoidDistance) {
+				c.medoidDistance = bestDistances[best];
+				c.medoid = bestFrames[best];
+			}
+		}
+	}
+
+	updateClosestPair();
+}
+
+void RepresentativeFrames::getFrames( std::vector<RepresentativeFrame>& frames ) const
+{
+	frames.clear();
+	for (auto& cluster : clusters) {
+		if (cluster.count == 0) continue;
+		frames.push_back(RepresentativeFrame(cluster.medoid * frameDelta, cluster.count));
+	}
+	std::sort(frames.begin(), frames.end(), earlierFrame);
+}
+
+void RepresentativeFrames::buildPreview( const Animation& animation, float holdSeconds, Animation& preview ) const
+{
+	for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		preview.createBoneTrack(boneID)->deleteAllKeyFrames();
+	}
+
+	std::vector<RepresentativeFrame> frames;
+	getFrames(frames);
+
+	TransformKeyFrame pose(0.f, 0);
+	for (size_t i = 0; i < frames.size(); ++i) {
+		for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+			const BoneAnimationTrack *track = animation.getBoneTrack(boneID);
+			if (nullptr == track || track->getNumKeyFrames() == 0) continue;
+			track->getInterpolatedKeyFrame(frames[i].time, &pose);
+
+			// Keyed at the start and middle of its slot so the pose holds, then blends into the next
+			BoneAnimationTrack *previewTrack = preview.getBoneTrack(boneID);
+			for (int held = 0; held < 2; ++held) {
+				TransformKeyFrame *keyFrame = static_cast<TransformKeyFrame*>(previewTrack->createKeyFrame((i + 0.5f * held) * holdSeconds));
+				keyFrame->setTranslation(pose.getTranslation());
+				keyFrame->setRotation(pose.getRotation());
+				keyFrame->setAbsRotation(pose.getAbsRotation());
+				keyFrame->setScale(pose.getScale());
+			}
+		}
+	}
+}
+
+size_t RepresentativeFrames::getMemoryUsage() const
+{
+	return features.capacity() * sizeof(float)
+	     + centers.capacity() * sizeof(float)
+	     + clusters.capacity() * sizeof(Cluster);
+}
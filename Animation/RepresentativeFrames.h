@@ -0,0 +1,92 @@
+#pragma once
+
+#include "PoseFeatures.h"
+
+#include <vector>
+
+class Animation;
+
+
+// One frame chosen to stand for a cluster of similar poses
+struct RepresentativeFrame
+{
+	float time;
+	size_t clusterSize; // frames of the take the pose stands for
+
+	RepresentativeFrame(float time, size_t clusterSize)
+		: time(time)
+		, clusterSize(clusterSize)
+	{}
+};
+
+
+// Adaptive representative frame set selection: a handful of frames that between them
+// show every distinct pose of a take, for previews
+//
+// Frames are clustered on pose features as they are appended, each new frame joins its
+// nearest cluster unless it is further from all of them than the closest two centers are
+// from each other, then it starts a cluster of its own and the pair whose merge adds the
+// least squared error merges. That keeps a rare pose its own cluster however long the take
+// runs, at about numClusters distances per frame.
+// refine() then runs k-means over every frame seen so far, warm started from the streamed
+// clusters. Each cluster is represented by its medoid, the member frame nearest its center
+class RepresentativeFrames
+{
+public:
+	// zhARFSS_NumClusters clusters over the default features sampled at zhAnimation_SampleRate
+	RepresentativeFrames();
+	RepresentativeFrames(const PoseFeatureExtractor& extractor, size_t numClusters, float frameDelta);
+
+	// Cluster the frames animation gained since the last update, starting over if it got shorter,
+	// numThreads of 0 uses one thread per hardware thread, returns the number of frames added
+	size_t update(const Animation& animation, unsigned int numThreads = 0);
+	// Lloyd iterations over every frame seen, stopping early once no frame changes cluster
+	void refine(unsigned int maxIterations = 10, unsigned int numThreads = 0);
+	void clear();
+
+	// Representative frames in time order
+	void getFrames(std::vector<RepresentativeFrame>& frames) const;
+	// Replace the keyframes of preview with the representative poses of animation in time order,
+	// each held for half of holdSeconds before blending into the next
+	void buildPreview(const Animation& animation, float holdSeconds, Animation& preview) const;
+
+	size_t getNumClusters() const;
+	size_t getNumFrames() const;
+	size_t getMemoryUsage() const;
+
+private:
+	struct Cluster
+	{
+		size_t count;
+		size_t medoid;
+		float medoidDistance; // squared, from the medoid to the center when it was last checked
+	};
+
+	float *center(size_t cluster);
+	size_t nearestCluster(const float *feature, float& distance) const;
+	void addFrame(size_t frame);
+	float mergeCost(size_t a, size_t b, float distance) const;
+	void mergeClosestClusters();
+	void updateClosestPair();
+
+	PoseFeatureExtractor extractor;
+	size_t maxClusters;
+	float frameDelta;
+	size_t stride;
+
+	std::vector<float> features; // stride floats per frame seen
+	std::vector<float> centers;  // stride floats per cluster
+	std::vector<Cluster> clusters;
+
+	// Pair of clusters whose merge adds the least squared error, closestA < closestB
+	float closestCost;
+	size_t closestA, closestB;
+	// Squared distance between the two closest centers, never above it between full updates,
+	// a frame further than this from every center starts a cluster
+	float closestDistance;
+
+};
+
+inline size_t RepresentativeFrames::getNumClusters() const { return clusters.size(); }
+inline size_t RepresentativeFrames::getNumFrames() const { return (stride > 0) ? features.size() / stride : 0; }
+inline float *RepresentativeFrames::center(size_t cluster) { return &centers[cluster * stride]; }
@@ -0,0 +1,73 @@
+#include "RollingCapture.h"
+#include "Animation.h"
+#include "BoneAnimationTrack.h"
+#include "TransformKeyFrame.h"
+
+#include <algorithm>
+
+
+RollingCapture::RollingCapture( const SkeletonSource& source, float capacitySeconds, float frameDelta/*=1 / 60.f*/ )
+	: source(source)
+	, frameDelta(frameDelta)
+	, frames(static_cast<size_t>(std::max(0.f, capacitySeconds) / frameDelta + 0.5f) + 1)
+	, next(0)
+	, numFrames(0)
+	, frameNumber(0)
+{}
+
+void RollingCapture::update()
+{
+	// Time moves on while nothing is tracked, as it does for Recording
+	const unsigned int number = frameNumber++;
+
+	const SkeletonData *skeletonData = source.getTrackedSkeletonData();
+	if (nullptr == skeletonData) return;
+
+	Frame& frame = frames[next];
+	frame.number   = number;
+	frame.skeleton = *skeletonData;
+
+	next = (next + 1) % frames.size();
+	numFrames = std::min(numFrames + 1, frames.size());
+}
+
+void RollingCapture::clear()
+{
+	next        = 0;
+	numFrames   = 0;
+	frameNumber = 0;
+}
+
+size_t RollingCapture::snapshot( float seconds, Animation& animation ) const
+{
+	for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		animation.createBoneTrack(boneID)->deleteAllKeyFrames();
+	}
+	if (0 == numFrames) return 0;
+
+	// Walk back from the newest frame to the oldest one within seconds of it
+	const size_t capacity = frames.size();
+	const size_t newest = (next + capacity - 1) % capacity;
+	const unsigned int span = static_cast<unsigned int>(std::max(0.f, seconds) / frameDelta + 0.5f);
+	size_t count = 1;
+	while (count < numFrames && frames[newest].number - frames[(newest + capacity - count) % capacity].number <= span) {
+		++count;
+	}
+	const size_t first = (newest + capacity + 1 - count) % capacity;
+	const unsigned int startNumber = frames[first].number;
+
+	for (auto boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		BoneAnimationTrack *track = animation.getBoneTrack(boneID);
+		for (size_t i = 0; i < count; ++i) {
+			const Frame& frame = frames[(first + i) % frames.size()];
+
+			TransformKeyFrame *keyFrame = static_cast<TransformKeyFrame*>(track->createKeyFrame((frame.number - startNumber) * frameDelta));
+			keyFrame->setTranslation(frame.skeleton.positions[boneID]);
+			keyFrame->setRotation(frame.skeleton.hierarchicalRotations[boneID]);
+			keyFrame->setAbsRotation(frame.skeleton.absoluteRotations[boneID]);
+			keyFrame->setScale(glm::vec3(1));
+		}
+	}
+
+	return count;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Kinect/SkeletonSource.h"
+
+#include <vector>
+
+class Animation;
+
+
+// Always-on capture of the last few seconds of a skeleton source
+// Frames are copied into a ring allocated up front, once it is full each new frame
+// overwrites the oldest, so memory stays the same however long the session runs
+// and capturing a frame never allocates
+class RollingCapture
+{
+public:
+	// Holds capacitySeconds of frames spaced frameDelta apart, like Recording::update
+	RollingCapture(const SkeletonSource& source, float capacitySeconds, float frameDelta = 1 / 60.f);
+
+	// Capture the source's current skeleton, if it is tracking one
+	void update();
+	void clear();
+
+	// Replace the keyframes of animation with the last seconds of captured frames,
+	// starting at time 0, returns the number of frames written
+	size_t snapshot(float seconds, Animation& animation) const;
+
+	size_t getNumFrames() const;
+	size_t getCapacity() const;
+	size_t getMemoryUsage() const;
+
+private:
+	RollingCapture(const RollingCapture&);
+	RollingCapture& operator=(const RollingCapture&);
+
+	struct Frame
+	{
+		unsigned int number; // frames since capture started, untracked ones included
+		SkeletonData skeleton;
+	};
+
+	const SkeletonSource& source;
+	const float frameDelta;
+
+	std::vector<Frame> frames;
+	size_t next;      // slot the next frame is written to
+	size_t numFrames; // frames held, up to frames.size()
+	unsigned int frameNumber;
+
+};
+
+inline size_t RollingCapture::getNumFrames() const { return numFrames; }
+inline size_t RollingCapture::getCapacity() const { return frames.size(); }
+inline size_t RollingCapture::getMemoryUsage() const { return frames.capacity() * sizeof(Frame); }
@@ -1,168 +1,144 @@
 #include "Skeleton.h"
-#include "Util/GLUtils.h"
-#include "Util/RenderUtils.h"
-#include "Shaders/Program.h"
+#include "PoseSampler.h"
+#include "TransformKeyFrame.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <algorithm>
-#include <map>
-
-const float s = 0.025f;
-const glm::vec3 scale(s);
-const glm::vec3 zero(0);
-const glm::vec3 y(0,1,0); // world up
-
-const BoneJointPairs Skeleton::jointPairs([]() {
-	BoneJointPairs bones;
-	bones[SHOULDER_CENTER] = HEAD;
-	bones[SHOULDER_LEFT  ] = SHOULDER_CENTER;
-	bones[SHOULDER_RIGHT ] = SHOULDER_CENTER;
-	bones[ELBOW_LEFT     ] = SHOULDER_LEFT;
-	bones[ELBOW_RIGHT    ] = SHOULDER_RIGHT;
-	bones[WRIST_LEFT     ] = ELBOW_LEFT;
-	bones[WRIST_RIGHT    ] = ELBOW_RIGHT;
-	bones[HAND_LEFT      ] = WRIST_LEFT;
-	bones[HAND_RIGHT     ] = WRIST_RIGHT;
-	bones[SPINE          ] = SHOULDER_CENTER;
-	bones[HIP_CENTER     ] = SPINE;
-	bones[HIP_LEFT       ] = HIP_CENTER;
-	bones[HIP_RIGHT      ] = HIP_CENTER;
-	bones[KNEE_LEFT      ] = HIP_LEFT;
-	bones[KNEE_RIGHT     ] = HIP_RIGHT;
-	bones[ANKLE_LEFT     ] = KNEE_LEFT;
-	bones[ANKLE_RIGHT    ] = KNEE_RIGHT;
-	bones[FOOT_LEFT      ] = ANKLE_LEFT;
-	bones[FOOT_RIGHT     ] = ANKLE_RIGHT;
-	return bones;
-}());
+#include <cassert>
+
+const EBoneID Skeleton::parentIDs[EBoneID::COUNT] = {
+	COUNT,           // HIP_CENTER
+	HIP_CENTER,      // SPINE
+	SPINE,           // SHOULDER_CENTER
+	SHOULDER_CENTER, // HEAD
+	SHOULDER_CENTER, // SHOULDER_LEFT
+	SHOULDER_LEFT,   // ELBOW_LEFT
+	ELBOW_LEFT,      // WRIST_LEFT
+	WRIST_LEFT,      // HAND_LEFT
+	SHOULDER_CENTER, // SHOULDER_RIGHT
+	SHOULDER_RIGHT,  // ELBOW_RIGHT
+	ELBOW_RIGHT,     // WRIST_RIGHT
+	WRIST_RIGHT,     // HAND_RIGHT
+	HIP_CENTER,      // HIP_LEFT
+	HIP_LEFT,        // KNEE_LEFT
+	KNEE_LEFT,       // ANKLE_LEFT
+	ANKLE_LEFT,      // FOOT_LEFT
+	HIP_CENTER,      // HIP_RIGHT
+	HIP_RIGHT,       // KNEE_RIGHT
+	KNEE_RIGHT,      // ANKLE_RIGHT
+	ANKLE_RIGHT      // FOOT_RIGHT
+};
 
 
 Skeleton::Skeleton()
-	: bones()
-	, render_bones(true)
+	: render_bones(true)
 	, render_joints(true)
 	, render_orientations(true)
+	, calibrated(false)
+	, dirtyBones(BONE_MASK_ALL)
 {
 	initBones();
+	clearCalibration();
 }
 
 Skeleton::~Skeleton()
+{}
+
+void Skeleton::initBones() 
 {
-	bones.clear();
+	for(int bone_id = EBoneID::HIP_CENTER; bone_id != EBoneID::COUNT; ++bone_id) {
+		const EBoneID boneID   = static_cast<EBoneID>(bone_id);
+		const EBoneID parentID = parentIDs[bone_id];
+		assert(parentID == COUNT ? boneID == HIP_CENTER : parentID < boneID);
+
+		bones[bone_id] = Bone(boneID, parentID, glm::vec3(), glm::quat(), glm::vec3(1));
+	}
+
+	// Walking backwards every child's subtree is known before its parent's
+	for(int bone_id = EBoneID::COUNT - 1; bone_id >= EBoneID::HIP_CENTER; --bone_id) {
+		subtreeEnds[bone_id] = static_cast<EBoneID>(bone_id + 1);
+	}
+	for(int bone_id = EBoneID::COUNT - 1; bone_id > EBoneID::HIP_CENTER; --bone_id) {
+		const EBoneID parentID = parentIDs[bone_id];
+		if( subtreeEnds[bone_id] > subtreeEnds[parentID] )
+			subtreeEnds[parentID] = subtreeEnds[bone_id];
+	}
 }
 
-void Skeleton::render() const
+void Skeleton::calibrate(const glm::vec3 (&positions)[EBoneID::COUNT])
 {
-	if (render_bones)        renderBones();
-	if (render_joints)       renderJoints();
-	if (render_orientations) renderOrientations();
+	restOffsets[HIP_CENTER] = glm::vec3();
+	boneLengths[HIP_CENTER] = 0.f;
+	for(int bone_id = EBoneID::SPINE; bone_id != EBoneID::COUNT; ++bone_id) {
+		restOffsets[bone_id] = positions[bone_id] - positions[parentIDs[bone_id]];
+		boneLengths[bone_id] = glm::length(restOffsets[bone_id]);
+	}
+
+	calibrated = true;
+	dirtyBones = BONE_MASK_ALL;
 }
 
-void Skeleton::renderBones() const
+bool Skeleton::calibrate(const PoseSampler& take, float time)
 {
-	glm::mat4 model;
-
-	std::for_each(begin(jointPairs), end(jointPairs), [&](const BoneJointPairs::value_type& joints) {
-		// Get the two joints for this bone
-		const Bone& bone1 = bones.at(joints.first);
-		const Bone& bone2 = bones.at(joints.second);
-
-		if (bone1.translation != zero && bone2.translation != zero) {
-			// Calculate orientation and position for cylinder connecting bone1 and bone2
-			const float dist        = glm::distance(bone1.translation, bone2.translation);
-			const glm::vec3 diff    = bone2.translation - bone1.translation;
-			const glm::vec3 forward = glm::normalize(diff);
-			const glm::vec3 axis    = glm::cross(y, forward);
-			const float angle       = glm::degrees(acos(glm::dot(y, forward)));
-
-			// Calculate the model matrix for this cylinder using the orientation and position
-			model = glm::rotate(glm::translate(glm::mat4(), bone1.translation), angle, axis);
-			model = glm::scale(model, glm::vec3(0.01f,dist,0.01f));
-			GLUtils::defaultProgram->setUniform("model", model);
-			GLUtils::defaultProgram->setUniform("color", glm::vec4(0,1,0,0.5f));
-
-			Render::cylinder();
-		}
-	});
+	TransformKeyFrame keyFrame(time, 0);
+	if( !take.sample(HIP_CENTER, time, &keyFrame) )
+		return false;
+
+	// Bones without keyframes get the root position, so a zero length
+	glm::vec3 positions[EBoneID::COUNT];
+	positions[HIP_CENTER] = keyFrame.getTranslation();
+	for(int bone_id = EBoneID::HIP_CENTER + 1; bone_id != EBoneID::COUNT; ++bone_id) {
+		positions[bone_id] = take.sample(bone_id, time, &keyFrame) ? keyFrame.getTranslation() : positions[HIP_CENTER];
+	}
+
+	calibrate(positions);
+	return true;
 }
 
-void Skeleton::renderJoints() const
+void Skeleton::calibrate(const Skeleton& other)
 {
-	std::for_each(begin(bones), end(bones), [&](const std::pair<EBoneID, Bone>& pair) {
-		const Bone& bone = pair.second;
-
-		if (bone.translation != zero) {
-			GLUtils::defaultProgram->setUniform("color", glm::vec4(0.5f,1,0.5f,1));
-			GLUtils::defaultProgram->setUniform("model",
-				glm::scale(glm::translate(glm::mat4(), bone.translation), scale));
-			Render::sphere();
-		}
-	});
+	if( !other.calibrated ) {
+		clearCalibration();
+		return;
+	}
+
+	std::copy(other.restOffsets, other.restOffsets + EBoneID::COUNT, restOffsets);
+	std::copy(other.boneLengths, other.boneLengths + EBoneID::COUNT, boneLengths);
+	calibrated = true;
+	dirtyBones = BONE_MASK_ALL;
 }
 
-void Skeleton::renderOrientations() const
+void Skeleton::clearCalibration()
 {
-	glm::mat4 model;
-
-	std::for_each(begin(bones), end(bones), [&](const std::pair<EBoneID, Bone>& pair) {
-		const Bone& bone = pair.second;
-		if (bone.translation != zero) {
-			// Calculate global rotation for this bone
-			glm::quat globalRotation = bone.rotation;
-			EBoneID boneID = bone.boneId;
-			EBoneID parentID = bone.parentId;
-			while (parentID != COUNT) {
-				// accumulate parent's rotation
-				globalRotation = bones.at(parentID).rotation * globalRotation;
-				// move up the hierarchy
-				boneID = parentID;
-				parentID = bones.at(boneID).parentId;
-			}
-
-			model = glm::translate(glm::mat4(), bone.translation);
-			model = model * glm::mat4_cast(globalRotation);
-			model = glm::scale(model, glm::vec3(0.1));
-			GLUtils::defaultProgram->setUniform("model", model);
-
-			Render::axis();
-		}
-	});
+	std::fill(restOffsets, restOffsets + EBoneID::COUNT, glm::vec3());
+	std::fill(boneLengths, boneLengths + EBoneID::COUNT, 0.f);
+	calibrated = false;
+	dirtyBones = BONE_MASK_ALL;
 }
 
-void Skeleton::initBones() 
+void Skeleton::updateWorldTransforms() const
 {
-	for(int bone_id = EBoneID::HIP_CENTER; bone_id != EBoneID::COUNT; ++bone_id) {
-		EBoneID boneID = static_cast<EBoneID>(bone_id);
-
-		EBoneID parentID = HIP_CENTER;
-		switch (boneID) {
-			case HIP_CENTER:      parentID = COUNT;           break;
-			case SPINE:           parentID = HIP_CENTER;      break;
-			case SHOULDER_CENTER: parentID = SPINE;           break;
-			case HEAD:            parentID = SHOULDER_CENTER; break;
-			case SHOULDER_LEFT:   parentID = SHOULDER_CENTER; break;
-			case ELBOW_LEFT:      parentID = SHOULDER_LEFT;   break;
-			case WRIST_LEFT:      parentID = ELBOW_LEFT;      break;
-			case HAND_LEFT:       parentID = WRIST_LEFT;      break;
-			case SHOULDER_RIGHT:  parentID = SHOULDER_CENTER; break;
-			case ELBOW_RIGHT:     parentID = SHOULDER_RIGHT;  break;
-			case WRIST_RIGHT:     parentID = ELBOW_RIGHT;     break;
-			case HAND_RIGHT:      parentID = WRIST_RIGHT;     break;
-			case HIP_LEFT:        parentID = HIP_CENTER;      break;
-			case KNEE_LEFT:       parentID = HIP_LEFT;        break;
-			case ANKLE_LEFT:      parentID = KNEE_LEFT;       break;
-			case FOOT_LEFT:       parentID = ANKLE_LEFT;      break;
-			case HIP_RIGHT:       parentID = HIP_CENTER;      break;
-			case KNEE_RIGHT:      parentID = HIP_RIGHT;       break;
-			case ANKLE_RIGHT:     parentID = KNEE_RIGHT;      break;
-			case FOOT_RIGHT:      parentID = ANKLE_RIGHT;     break;
-			default:              parentID = COUNT;
+	// Lowest ids first so a dirty parent is always updated before its children
+	for(unsigned int remaining = dirtyBones; 0 != remaining; remaining &= remaining - 1) {
+		const unsigned int bone_id = lowestSetBit(remaining);
+		const Bone& bone = bones[bone_id];
+
+		worldRotations[bone_id] = (bone.parentId == COUNT)
+			? bone.rotation
+			: worldRotations[bone.parentId] * bone.rotation;
+
+		// Calibrated joints hang their bone length off the parent joint along the rotated y axis
+		glm::vec3 position(bone.translation);
+		if( calibrated && bone.parentId != COUNT ) {
+			const glm::mat4& parent = worldTransforms[bone.parentId];
+			const glm::vec3 parentPosition(parent[3][0], parent[3][1], parent[3][2]);
+			position = parentPosition + worldRotations[bone_id] * glm::vec3(0, boneLengths[bone_id], 0);
 		}
 
-		Bone bone(boneID, parentID, glm::vec3(), glm::quat(), glm::vec3(1));
-		bones.insert(std::make_pair(boneID, bone));
+		worldTransforms[bone_id] = glm::translate(glm::mat4(), position) * glm::mat4_cast(worldRotations[bone_id]);
 	}
+	dirtyBones = 0;
 }
@@ -5,12 +5,20 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
-#include <map>
+class PoseSampler;
 
 
 class Bone
 {
 public:
+	Bone()
+		: boneId(COUNT)
+		, parentId(COUNT)
+		, translation()
+		, rotation()
+		, scale(1)
+	{}
+
 	Bone(EBoneID boneId, EBoneID parentId, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
 		: boneId(boneId)
 		, parentId(parentId)
@@ -19,8 +27,8 @@ public:
 		, scale(scale)
 	{}
 
-	const EBoneID boneId;
-	const EBoneID parentId;
+	EBoneID boneId;
+	EBoneID parentId;
 
 	glm::vec3 translation;
 	glm::quat rotation;
@@ -28,10 +36,24 @@ public:
 };
 
 
+// Fixed set of EBoneID::COUNT bones stored by id
+// Bone ids are in depth first order, every parent id is lower than its children's ids
+// and each bone's subtree is the contiguous run of ids [boneID, subtree end),
+// so a single forward pass over the bones visits parents before children
+//
+// World transforms are cached and only recomputed for bones whose subtree was invalidated,
+// fetching a bone through the non-const getBone() invalidates it and its descendants
+// The cache is filled lazily by the const getters so a skeleton shouldn't be read
+// from several threads while it's being posed, use one skeleton per thread instead
+//
+// An uncalibrated skeleton places each joint at its bone's captured translation
+// Once calibrated with a rest pose, only the root translation is used and every other
+// joint sits its rest bone length along its world rotated y axis from its parent joint
 class Skeleton
 {
 public:
-	static const BoneJointPairs jointPairs;
+	// Parent of each bone indexed by EBoneID, COUNT for the root
+	static const EBoneID parentIDs[EBoneID::COUNT];
 
 	bool render_bones;
 	bool render_joints;
@@ -49,11 +71,47 @@ public:
 	Bone* getBone(unsigned short boneID);
 	const Bone* getBone(unsigned short boneID) const;
 
+	static EBoneID getParentID(unsigned short boneID);
+
+	// Mark boneID and all its descendants as needing their world transforms recomputed
+	void invalidate(unsigned short boneID);
+
+	// Take the rest pose from captured joint positions, or from a take sampled at time
+	// Returns false and leaves the skeleton unchanged if the take has no root keyframes
+	void calibrate(const glm::vec3 (&positions)[EBoneID::COUNT]);
+	bool calibrate(const PoseSampler& take, float time = 0.f);
+	void calibrate(const Skeleton& other);
+	void clearCalibration();
+
+	bool isCalibrated() const;
+	// Rest pose joint position relative to the parent joint
+	const glm::vec3& getRestOffset(unsigned short boneID) const;
+	float getBoneLength(unsigned short boneID) const;
+
+	// Product of the rotations from the root down to boneID
+	const glm::quat& getWorldRotation(unsigned short boneID) const;
+	// Bone translation followed by its world rotation
+	const glm::mat4& getWorldTransform(unsigned short boneID) const;
+	glm::vec3 getWorldPosition(unsigned short boneID) const;
+
+	// Bring the world transform cache up to date now instead of on the next read
+	void updateWorldTransforms() const;
+
 private:
 	void initBones();
 
 private:
-	std::map<EBoneID, Bone> bones;
+	Bone bones[EBoneID::COUNT];
+	EBoneID subtreeEnds[EBoneID::COUNT];
+
+	bool calibrated;
+	glm::vec3 restOffsets[EBoneID::COUNT];
+	float boneLengths[EBoneID::COUNT];
+
+	// Bit per bone whose cached world transform is out of date
+	mutable unsigned int dirtyBones;
+	mutable glm::quat worldRotations[EBoneID::COUNT];
+	mutable glm::mat4 worldTransforms[EBoneID::COUNT];
 
 };
 
@@ -63,7 +121,9 @@ inline Bone* Skeleton::getBone(unsigned short boneID)
 	if( boneID >= EBoneID::COUNT ) {
 		return nullptr;
 	} else {
-		return &bones.at(static_cast<EBoneID>(boneID));
+		// Caller may change the bone, so its subtree needs new world transforms
+		invalidate(boneID);
+		return &bones[boneID];
 	}
 }
 
@@ -72,6 +132,42 @@ inline const Bone* Skeleton::getBone(unsigned short boneID) const
 	if( boneID >= EBoneID::COUNT ) {
 		return nullptr;
 	} else {
-		return &bones.at(static_cast<EBoneID>(boneID));
+		return &bones[boneID];
 	}
 }
+
+inline EBoneID Skeleton::getParentID(unsigned short boneID)
+{
+	return (boneID < EBoneID::COUNT) ? parentIDs[boneID] : COUNT;
+}
+
+inline void Skeleton::invalidate(unsigned short boneID)
+{
+	if( boneID < EBoneID::COUNT ) {
+		const unsigned int below_end   = (1u << subtreeEnds[boneID]) - 1;
+		const unsigned int below_start = (1u << boneID) - 1;
+		dirtyBones |= below_end & ~below_start;
+	}
+}
+
+inline bool Skeleton::isCalibrated() const { return calibrated; }
+inline const glm::vec3& Skeleton::getRestOffset(unsigned short boneID) const { return restOffsets[boneID]; }
+inline float Skeleton::getBoneLength(unsigned short boneID) const { return boneLengths[boneID]; }
+
+inline const glm::quat& Skeleton::getWorldRotation(unsigned short boneID) const
+{
+	if( 0 != dirtyBones ) updateWorldTransforms();
+	return worldRotations[boneID];
+}
+
+inline const glm::mat4& Skeleton::getWorldTransform(unsigned short boneID) const
+{
+	if( 0 != dirtyBones ) updateWorldTransforms();
+	return worldTransforms[boneID];
+}
+
+inline glm::vec3 Skeleton::getWorldPosition(unsigned short boneID) const
+{
+	const glm::mat4& world = getWorldTransform(boneID);
+	return glm::vec3(world[3][0], world[3][1], world[3][2]);
+}
@@ -0,0 +1,79 @@
+#include "Skeleton.h"
+#include "Util/GLUtils.h"
+#include "Util/RenderUtils.h"
+#include "Shaders/Program.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+const float s = 0.025f;
+const glm::vec3 scale(s);
+const glm::vec3 zero(0);
+const glm::vec3 y(0,1,0); // world up
+
+void Skeleton::render() const
+{
+	if (render_bones)        renderBones();
+	if (render_joints)       renderJoints();
+	if (render_orientations) renderOrientations();
+}
+
+void Skeleton::renderBones() const
+{
+	glm::mat4 model;
+
+	// One cylinder per bone from its joint to its parent's joint
+	for (int bone_id = EBoneID::SPINE; bone_id != EBoneID::COUNT; ++bone_id) {
+		// Get the two joints for this bone
+		const Bone& bone1 = bones[bone_id];
+		const Bone& bone2 = bones[parentIDs[bone_id]];
+
+		if (bone1.translation != zero && bone2.translation != zero) {
+			const glm::vec3 joint1 = getWorldPosition(bone_id);
+			const glm::vec3 joint2 = getWorldPosition(parentIDs[bone_id]);
+
+			// Calculate orientation and position for cylinder connecting bone1 and bone2
+			const float dist        = glm::distance(joint1, joint2);
+			const glm::vec3 diff    = joint2 - joint1;
+			const glm::vec3 forward = glm::normalize(diff);
+			const glm::vec3 axis    = glm::cross(y, forward);
+			const float angle       = glm::degrees(acos(glm::dot(y, forward)));
+
+			// Calculate the model matrix for this cylinder using the orientation and position
+			model = glm::rotate(glm::translate(glm::mat4(), joint1), angle, axis);
+			model = glm::scale(model, glm::vec3(0.01f,dist,0.01f));
+			GLUtils::defaultProgram->setUniform("model", model);
+			GLUtils::defaultProgram->setUniform("color", glm::vec4(0,1,0,0.5f));
+
+			Render::cylinder();
+		}
+	}
+}
+
+void Skeleton::renderJoints() const
+{
+	for (int bone_id = EBoneID::HIP_CENTER; bone_id != EBoneID::COUNT; ++bone_id) {
+		if (bones[bone_id].translation != zero) {
+			GLUtils::defaultProgram->setUniform("color", glm::vec4(0.5f,1,0.5f,1));
+			GLUtils::defaultProgram->setUniform("model",
+				glm::scale(glm::translate(glm::mat4(), getWorldPosition(bone_id)), scale));
+			Render::sphere();
+		}
+	}
+}
+
+void Skeleton::renderOrientations() const
+{
+	glm::mat4 model;
+
+	for (int bone_id = EBoneID::HIP_CENTER; bone_id != EBoneID::COUNT; ++bone_id) {
+		const Bone& bone = bones[bone_id];
+		if (bone.translation != zero) {
+			model = glm::scale(getWorldTransform(bone_id), glm::vec3(0.1));
+			GLUtils::defaultProgram->setUniform("model", model);
+
+			Render::axis();
+		}
+	}
+}
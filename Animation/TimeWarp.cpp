@@ -0,0 +1,197 @@
+#include "TimeWarp.h"
+#include "Animation.h"
+#include "PoseFeatures.h"
+#include "Util/ThreadPool.h"
+#include "Util/zhPrereq.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+	const size_t tile_rows = 64; // base frames per distance tile
+
+	// Back pointers of the accumulated cost, one byte per band cell
+	enum EStep { STEP_START, STEP_DIAGONAL, STEP_BASE, STEP_LAYER };
+
+	// Layer frames compared against each base frame, a fixed width window around the diagonal
+	struct Band
+	{
+		size_t width;
+		std::vector<size_t> lo, hi; // first and last layer frame of each base frame's window
+
+		Band(size_t numBase, size_t numLayer, size_t radius)
+			: width(2 * radius + 1)
+			, lo(numBase)
+			, hi(numBase)
+		{
+			const double slope = (numBase > 1) ? double(numLayer - 1) / double(numBase - 1) : 0.0;
+			for (size_t i = 0; i < numBase; ++i) {
+				const size_t center = static_cast<size_t>(i * slope + 0.5);
+				lo[i] = (center > radius) ? center - radius : 0;
+				hi[i] = std::min(numLayer - 1, center + radius);
+			}
+		}
+
+		bool contains(size_t i, size_t j) const { return j >= lo[i] && j <= hi[i]; }
+		size_t cell(size_t i, size_t j) const { return i * width + (j - lo[i]); }
+	};
+
+	// Mean of the window of up to width frames centered on each frame, narrowed at the ends
+	// so the first and last frames keep their values, the result stays monotonic
+	void smooth(std::vector<float>& values, unsigned int width)
+	{
+		const size_t half = width / 2;
+		if (half == 0 || values.size() < 3) return;
+
+		std::vector<double> sums(values.size() + 1, 0.0);
+		for (size_t i = 0; i < values.size(); ++i) {
+			sums[i + 1] = sums[i] + values[i];
+		}
+
+		const size_t last = values.size() - 1;
+		for (size_t i = 0; i <= last; ++i) {
+			const size_t radius = std::min(half, std::min(i, last - i));
+			values[i] = static_cast<float>((sums[i + radius + 1] - sums[i - radius]) / (2 * radius + 1));
+		}
+	}
+}
+
+
+TimeWarpSettings::TimeWarpSettings()
+	: frameDelta(1.f / zhAnimation_SampleRate)
+	, bandSeconds(2.f)
+	, smoothing(zhDTW_KernelSize)
+	, numThreads(0)
+{}
+
+
+TimeWarp::TimeWarp()
+	: frameDelta(1.f / zhAnimation_SampleRate)
+	, layerTimes()
+{}
+
+void TimeWarp::clear()
+{
+	layerTimes.clear();
+}
+
+float TimeWarp::align( const Animation& base
+                     , const Animation& layer
+                     , const BoneMask& boneMask
+                     , const TimeWarpSettings& settings )
+{
+	clear();
+	if (settings.frameDelta <= 0.f) return 0.f;
+
+	frameDelta = settings.frameDelta;
+	const size_t numBase  = static_cast<size_t>(base.getLength()  / frameDelta) + 1;
+	const size_t numLayer = static_cast<size_t>(layer.getLength() / frameDelta) + 1;
+	if (numBase < 2 || numLayer < 2) return 0.f;
+
+	const unsigned int numThreads = settings.numThreads;
+
+	// Bones compared and their weights
+	PoseFeatureExtractor extractor;
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		if (boneID == HIP_CENTER) continue;
+		extractor.addBone((EBoneID) boneID, boneMask.empty() ? 1.f : boneMask.weight((EBoneID) boneID));
+	}
+	if (extractor.getNumBones() == 0) return 0.f;
+
+	PoseFeatures baseFeatures, layerFeatures;
+	extractor.extract(base,  frameDelta, numBase,  numThreads, baseFeatures);
+	extractor.extract(layer, frameDelta, numLayer, numThreads, layerFeatures);
+
+	// Wide enough that neighbouring base frames' windows always overlap
+	const size_t minRadius = static_cast<size_t>(std::ceil(double(numLayer - 1) / double(numBase - 1)));
+	const size_t radius = std::max(minRadius, static_cast<size_t>(settings.bandSeconds / frameDelta + 0.5f));
+	const Band band(numBase, numLayer, radius);
+
+	// Pose distances over the band, a tile of base frames per job
+	const size_t stride = baseFeatures.stride;
+	std::vector<float> distances(numBase * band.width, 0.f);
+	const size_t numTiles = (numBase + tile_rows - 1) / tile_rows;
+	parallelFor(numThreads, numTiles, [&](size_t tile) {
+		const size_t first = tile * tile_rows;
+		const size_t last  = std::min(numBase, first + tile_rows) - 1;
+		for (size_t j = band.lo[first]; j <= band.hi[last]; ++j) {
+			const float *layerRow = layerFeatures.row(j);
+			for (size_t i = first; i <= last; ++i) {
+				if (!band.contains(i, j)) continue;
+				distances[band.cell(i, j)] = squaredDistance(baseFeatures.row(i), layerRow, stride);
+			}
+		}
+	});
+
+	// Accumulate cost a base frame at a time, keeping only the previous row of costs
+	const double inf = std::numeric_limits<double>::infinity();
+	std::vector<unsigned char> steps(numBase * band.width, STEP_START);
+	std::vector<double> prevCost(band.width, inf), cost(band.width, inf);
+	for (size_t i = 0; i < numBase; ++i) {
+		for (size_t j = band.lo[i]; j <= band.hi[i]; ++j) {
+			double best = (i == 0 && j == 0) ? 0.0 : inf;
+			unsigned char step = STEP_START;
+			if (i > 0 && j > 0 && band.contains(i - 1, j - 1) && prevCost[j - 1 - band.lo[i - 1]] < best) {
+				best = prevCost[j - 1 - band.lo[i - 1]];
+				step = STEP_DIAGONAL;
+			}
+			if (i > 0 && band.contains(i - 1, j) && prevCost[j - band.lo[i - 1]] < best) {
+				best = prevCost[j - band.lo[i - 1]];
+				step = STEP_BASE;
+			}
+			if (j > band.lo[i] && cost[j - 1 - band.lo[i]] < best) {
+				best = cost[j - 1 - band.lo[i]];
+				step = STEP_LAYER;
+			}
+			cost[j - band.lo[i]] = best + distances[band.cell(i, j)];
+			steps[band.cell(i, j)] = step;
+		}
+		std::swap(prevCost, cost);
+		std::fill(begin(cost), end(cost), inf);
+	}
+
+	// Walk back from the last pair of frames, each base frame takes the middle of the layer frames matched to it
+	std::vector<size_t> firstMatch(numBase), lastMatch(numBase);
+	double pathDistance = 0.0;
+	size_t pathLength = 0;
+	size_t i = numBase - 1, j = numLayer - 1;
+	lastMatch[i] = j;
+	for (;;) {
+		firstMatch[i] = j;
+		pathDistance += std::sqrt(distances[band.cell(i, j)]);
+		++pathLength;
+
+		const unsigned char step = steps[band.cell(i, j)];
+		if (step == STEP_START) break;
+		if (step != STEP_LAYER) {
+			--i;
+			lastMatch[i] = (step == STEP_DIAGONAL) ? j - 1 : j;
+		}
+		if (step != STEP_BASE) --j;
+	}
+
+	layerTimes.resize(numBase);
+	for (size_t frame = 0; frame < numBase; ++frame) {
+		layerTimes[frame] = 0.5f * (firstMatch[frame] + lastMatch[frame]) * frameDelta;
+	}
+	smooth(layerTimes, settings.smoothing);
+
+	return static_cast<float>(pathDistance / pathLength);
+}
+
+float TimeWarp::map( float baseTime ) const
+{
+	if (layerTimes.empty()) return baseTime;
+
+	const float length = getLength();
+	if (baseTime >= length) return layerTimes.back() + (baseTime - length);
+	if (baseTime <= 0.f)    return layerTimes.front() + baseTime;
+
+	const float frame = baseTime / frameDelta;
+	const size_t index = std::min(static_cast<size_t>(frame), layerTimes.size() - 2);
+	const float t = frame - index;
+	return layerTimes[index] + (layerTimes[index + 1] - layerTimes[index]) * t;
+}
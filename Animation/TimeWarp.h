@@ -0,0 +1,58 @@
+#pragma once
+
+#include "AnimationTypes.h"
+
+#include <vector>
+
+class Animation;
+
+
+// How a layer take is aligned against its base take
+struct TimeWarpSettings
+{
+	float frameDelta;         // seconds between compared poses
+	float bandSeconds;        // furthest the layer may lead or lag the base
+	unsigned int smoothing;   // frames in the moving average over the warp, 1 for none
+	unsigned int numThreads;  // 0 uses one thread per hardware thread
+
+	TimeWarpSettings();
+};
+
+
+// Monotonic mapping from base take time to layer take time, found by dynamic time warping
+//
+// Poses are compared by the positions of the masked bones relative to the hip center,
+// so an actor standing somewhere else still aligns. Only cells within bandSeconds of the
+// diagonal are considered, which keeps a 10 minute take to a few million cells:
+//   distances  base frames are split into tiles spread over worker threads, each tile
+//              streams the layer frames of its band once while its own poses stay in cache
+//   cost       accumulated in place over the band, then backtracked into the warp
+class TimeWarp
+{
+public:
+	TimeWarp();
+
+	// Replace the warp with the alignment of layer to base, bones not in boneMask are
+	// ignored, an empty mask compares every bone
+	// Returns the mean pose distance along the alignment, in the takes' units
+	float align( const Animation& base
+	           , const Animation& layer
+	           , const BoneMask& boneMask
+	           , const TimeWarpSettings& settings = TimeWarpSettings() );
+	void clear();
+
+	// Layer time to play at baseTime, 1:1 past the aligned range or when empty
+	float map(float baseTime) const;
+
+	bool empty() const;
+	// Base time covered by the warp
+	float getLength() const;
+
+private:
+	float frameDelta;
+	std::vector<float> layerTimes; // layer time at each base frame
+
+};
+
+inline bool TimeWarp::empty() const { return layerTimes.empty(); }
+inline float TimeWarp::getLength() const { return layerTimes.empty() ? 0.f : (layerTimes.size() - 1) * frameDelta; }
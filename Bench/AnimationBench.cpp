@@ -0,0 +1,1295 @@
+// Headless benchmark for the animation core
+// Measures keyframe capture, rolling capture, pose sampling, layer blending, BVH export,
+// keyframe reduction and compression on synthetic takes, heap traffic of capturing and clearing takes and of spline sampling, time warp alignment
+// of a layer performed late and early against its base, motion search over hours of takes, representative frames of hours long sessions,
+// cost and lag of the joint filters on replayed noisy skeletons, capturing several actors at once, fusing several sensors' skeletons,
+// player masks and bounds of depth frames, and how many frames of many takes can be posed per second
+// on one thread and across a PoseEvaluator, no Kinect, window or GL context required
+//
+// Usage: animation_bench [take length in seconds]...
+#include "Bench/SyntheticSkeleton.h"
+#include "Animation/ActorCapture.h"
+#include "Animation/Animation.h"
+#include "Animation/AnimationTypes.h"
+#include "Animation/BlendEngine.h"
+#include "Animation/BoneAnimationTrack.h"
+#include "Animation/BVHExport.h"
+#include "Animation/CompressedAnimation.h"
+#include "Animation/MotionIndex.h"
+#include "Animation/PoseEvaluator.h"
+#include "Animation/Recording.h"
+#include "Animation/RepresentativeFrames.h"
+#include "Animation/RollingCapture.h"
+#include "Animation/TimeWarp.h"
+#include "Animation/Skeleton.h"
+#include "Kinect/JointFilter.h"
+#include "Kinect/PlayerSegmentation.h"
+#include "Kinect/ReplaySensorSource.h"
+#include "Kinect/SkeletonFusion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Count every heap allocation and free made by the process
+static std::atomic<size_t> heap_allocs(0);
+static std::atomic<size_t> heap_frees(0);
+
+void *operator new(size_t size)
+{
+	++heap_allocs;
+	void *p = std::malloc(size ? size : 1);
+	if (nullptr == p) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void *p) throw()
+{
+	if (nullptr == p) return;
+	++heap_frees;
+	std::free(p);
+}
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	double secondsSince(const Clock::time_point& start)
+	{
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	// Keeps sampled results observable so the optimizer can't discard the work
+	volatile float sink = 0.f;
+
+	const float frame_delta = 1 / 60.f; // matches Recording::recordingDelta
+
+	const ELayerMappingMode mapping_modes[] = { MAP_DIRECT, MAP_ABSOLUTE, MAP_ADDITIVE, MAP_TRAJECTORY_RELATIVE };
+	const char *mapping_mode_names[]        = { "direct", "absolute", "additive", "trajectory" };
+	const int num_mapping_modes = sizeof(mapping_modes) / sizeof(mapping_modes[0]);
+
+	const size_t live_pose_lists = 24;         // matches GLWindow's live pose search
+	const double search_goal_seconds = 0.001;  // per query
+	const double search_goal_recall = 0.95;
+
+	struct BenchResult
+	{
+		float  takeLength;
+		size_t numFrames;
+		size_t takeBytes;
+		double keyFramesPerSec;
+		double posesPerSec;
+		double blendFramesPerSec;
+		double batchBlendFramesPerSec[num_mapping_modes];
+		double exportMBPerSec;
+		size_t exportBytes;
+		size_t capturedKeyFrames;
+		size_t reducedKeyFrames;    // keyframes left after reduction
+		double reduceSeconds;
+		double reducedPosesPerSec;
+		size_t reducedBytes;        // keyframe memory of the reduced take
+		size_t packedBytes;
+		float  maxAngularError;     // degrees
+		float  maxTranslationError; // millimeters
+		double packSeconds;
+		double unpackSeconds;       // decoding the packed take back into keyframes
+		double packedPosesPerSec;
+		size_t rollingBytes;
+		double rollingFramesPerSec;
+		double keepSeconds;
+		size_t captureAllocs;
+		size_t clearFrees;
+		double clearSeconds;
+		double destroySeconds;
+		double alignSeconds;
+		float  alignDistance;       // mean pose distance along the alignment, millimeters
+		float  alignError;          // mean error of the warp against the true timing, milliseconds
+		float  unalignedError;      // same for playing the layer 1:1
+		double splinePosesPerSec;
+		double splineAllocsPerPose;
+	};
+
+
+	// Capture a take through Recording::update, the same path the app uses every frame
+	double benchKeyFrameAppend(Recording& recording, SyntheticSkeleton& source, size_t numFrames)
+	{
+		recording.clearRecording();
+		recording.startRecording();
+
+		const Clock::time_point start = Clock::now();
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			source.setTime(frame * frame_delta);
+			recording.update(frame_delta);
+		}
+		const double elapsed = secondsSince(start);
+
+		recording.stopRecording();
+		return (numFrames * EBoneID::COUNT) / elapsed;
+	}
+
+	// Run a rolling capture for the whole take, then keep its last 30 seconds as the app's button does
+	void benchRollingCapture(Recording& recording, SyntheticSkeleton& source, BenchResult& result)
+	{
+		const float capacity_seconds = 60.f;
+		const float keep_seconds = 30.f;
+		RollingCapture capture(source, capacity_seconds, frame_delta);
+
+		const Clock::time_point start = Clock::now();
+		for (size_t frame = 0; frame < result.numFrames; ++frame) {
+			source.setTime(frame * frame_delta);
+			capture.update();
+		}
+		result.rollingFramesPerSec = result.numFrames / secondsSince(start);
+		result.rollingBytes        = capture.getMemoryUsage();
+
+		recording.clearRecording();
+		const Clock::time_point keepStart = Clock::now();
+		recording.keep(capture, keep_seconds);
+		result.keepSeconds = secondsSince(keepStart);
+	}
+
+	// Heap operations of capturing a take and clearing it, then the time to destroy a full take
+	void benchHeap(SyntheticSkeleton& source, BenchResult& result)
+	{
+		std::unique_ptr<Recording> recording(new Recording("heap", source));
+
+		size_t allocs = heap_allocs;
+		benchKeyFrameAppend(*recording, source, result.numFrames);
+		result.captureAllocs = heap_allocs - allocs;
+
+		const size_t frees = heap_frees;
+		Clock::time_point start = Clock::now();
+		recording->clearRecording();
+		result.clearSeconds = secondsSince(start);
+		result.clearFrees   = heap_frees - frees;
+
+		benchKeyFrameAppend(*recording, source, result.numFrames);
+		start = Clock::now();
+		recording.reset();
+		result.destroySeconds = secondsSince(start);
+	}
+
+	// Pose sampling with spline interpolation, halfway between keyframes so every bone evaluates its splines
+	void benchSplineSampling(BenchResult& result)
+	{
+		Animation animation(0, "spline");
+		generateSyntheticAnimation(animation, result.takeLength, 1 / frame_delta, 1);
+		animation.setKFInterpMethod(KFInterp_Spline);
+
+		Skeleton skeleton;
+
+		const size_t allocs = heap_allocs;
+		const Clock::time_point start = Clock::now();
+		for (size_t frame = 0; frame + 1 < result.numFrames; ++frame) {
+			animation.apply(&skeleton, (frame + 0.5f) * frame_delta);
+			sink = sink + skeleton.getBone(HAND_LEFT)->translation.x;
+		}
+		result.splinePosesPerSec   = (result.numFrames - 1) / secondsSince(start);
+		result.splineAllocsPerPose = static_cast<double>(heap_allocs - allocs) / (result.numFrames - 1);
+	}
+
+	// Layer time at which the base pose at time is performed, the layer drifts up to 0.6 s either side
+	float layerTiming(float time)
+	{
+		return time + 0.6f * std::sin(time * 2.f * 3.14159265f / 20.f);
+	}
+
+	// Capture the base's motion again with layerTiming, align it to the base and compare against the true timing
+	void benchTimeWarp(const Recording& base, SyntheticSkeleton& source, BenchResult& result)
+	{
+		Recording layer("warped", source);
+		layer.startRecording();
+		for (size_t frame = 0; frame < result.numFrames; ++frame) {
+			source.setTime(layerTiming(frame * frame_delta));
+			layer.update(frame_delta);
+		}
+		layer.stopRecording();
+
+		TimeWarp warp;
+		const Clock::time_point start = Clock::now();
+		result.alignDistance = 1000.f * warp.align(*base.getAnimation(), *layer.getAnimation(), BoneMask(BONE_MASK_ALL));
+		result.alignSeconds  = secondsSince(start);
+
+		// True layer time of each base time by bisection, away from the ends where the layer runs out
+		double error = 0.0, unaligned = 0.0;
+		size_t count = 0;
+		for (float time = 1.f; time < warp.getLength() - 1.f; time += 0.1f) {
+			float lo = 0.f, hi = result.takeLength;
+			for (int i = 0; i < 32; ++i) {
+				const float mid = 0.5f * (lo + hi);
+				if (layerTiming(mid) < time) lo = mid;
+				else                         hi = mid;
+			}
+			error     += std::fabs(warp.map(time) - lo);
+			unaligned += std::fabs(time - lo);
+			++count;
+		}
+		result.alignError     = (count > 0) ? static_cast<float>(1000.0 * error / count) : 0.f;
+		result.unalignedError = (count > 0) ? static_cast<float>(1000.0 * unaligned / count) : 0.f;
+	}
+
+	// Sample full skeleton poses at every frame time, like playback does
+	double benchPoseSampling(const PoseSampler& take, size_t numFrames)
+	{
+		Skeleton skeleton;
+
+		const Clock::time_point start = Clock::now();
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			take.apply(&skeleton, frame * frame_delta);
+			sink = sink + skeleton.getBone(HAND_LEFT)->translation.x;
+		}
+		return numFrames / secondsSince(start);
+	}
+
+	// Blend the seated layer over the whole base take, one blend frame per base frame
+	double benchBlend(Recording& blend, const Recording& base, const Recording& layer, size_t numFrames)
+	{
+		BlendEngine engine;
+		blend.clearRecording();
+
+		const Clock::time_point start = Clock::now();
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			blend.saveBlendFrame(frame * frame_delta, engine, base, layer, seated_bone_mask, MAP_DIRECT);
+		}
+		return numFrames / secondsSince(start);
+	}
+
+	// Re-blend the whole take in one pass, as when the bone mask or mapping mode changes
+	double benchBatchBlend(Recording& blend, const Recording& base, const Recording& layer, ELayerMappingMode mappingMode, size_t numFrames)
+	{
+		const BlendEngine engine;
+
+		const Clock::time_point start = Clock::now();
+		blend.blend(engine, base, layer, seated_bone_mask, mappingMode);
+		return numFrames / secondsSince(start);
+	}
+
+	// Reduce a finished take with the default tolerances, as the app does when recording stops
+	void benchReduction(Recording& recording, BenchResult& result)
+	{
+		result.capturedKeyFrames = recording.getStats().keyFrames;
+
+		const Clock::time_point start = Clock::now();
+		recording.reduceKeyFrames(KeyFrameTolerance());
+		result.reduceSeconds = secondsSince(start);
+
+		result.reducedKeyFrames   = recording.getStats().keyFrames;
+		result.reducedPosesPerSec = benchPoseSampling(*recording.getAnimation(), result.numFrames);
+	}
+
+	// Pack the reduced take as the app does once it's finished with, play it packed then decode it again
+	void benchCompression(Recording& recording, BenchResult& result)
+	{
+		result.reducedBytes = recording.getStats().bytes;
+
+		CompressedAnimation compressed;
+		compressed.compress(*recording.getAnimation());
+		const CompressionError error = measureCompressionError(*recording.getAnimation(), compressed);
+		result.maxAngularError     = glm::degrees(error.maxAngularError);
+		result.maxTranslationError = 1000.f * error.maxTranslationError;
+
+		Clock::time_point start = Clock::now();
+		recording.pack();
+		result.packSeconds = secondsSince(start);
+		result.packedBytes = recording.getStats().bytes;
+
+		result.packedPosesPerSec = benchPoseSampling(recording.getPoses(), result.numFrames);
+
+		start = Clock::now();
+		sink = sink + recording.getAnimation()->getLength();
+		result.unpackSeconds = secondsSince(start);
+	}
+
+	// Export to memory so disk speed doesn't enter into it
+	double benchExport(const Animation& animation, size_t& numBytes)
+	{
+		std::ostringstream out;
+
+		const Clock::time_point start = Clock::now();
+		exportAnimationAsBVH(animation, out);
+		const double elapsed = secondsSince(start);
+
+		numBytes = static_cast<size_t>(out.tellp());
+		return (numBytes / (1024.0 * 1024.0)) / elapsed;
+	}
+
+	struct LayerResult
+	{
+		size_t numTakes;
+		double serialFramesPerSec;
+		double pooledFramesPerSec;
+	};
+
+	// Pose numTakes takes at the same time every frame, as the comparison view does,
+	// first one after another then all together on the pose evaluator
+	LayerResult benchLayerEvaluation(PoseEvaluator& evaluator, size_t numTakes)
+	{
+		const float take_length = 10.f;
+		const size_t num_frames = 300;
+
+		std::vector<std::unique_ptr<Animation>> takes;
+		std::vector<std::unique_ptr<Skeleton>> skeletons;
+		std::vector<PoseJob> jobs;
+		for (size_t i = 0; i < numTakes; ++i) {
+			takes.push_back(std::unique_ptr<Animation>(new Animation(static_cast<unsigned short>(i), "take")));
+			generateSyntheticAnimation(*takes.back(), take_length, 1 / frame_delta, static_cast<unsigned int>(i + 1));
+			skeletons.push_back(std::unique_ptr<Skeleton>(new Skeleton()));
+			skeletons.back()->calibrate(*takes.back());
+			jobs.push_back(PoseJob(takes.back().get(), skeletons.back().get(), 0.f));
+		}
+
+		LayerResult result;
+		result.numTakes = numTakes;
+
+		Clock::time_point start = Clock::now();
+		for (size_t frame = 0; frame < num_frames; ++frame) {
+			for (auto& job : jobs) {
+				job.take->apply(job.skeleton, frame * frame_delta);
+				job.skeleton->updateWorldTransforms();
+			}
+			sink = sink + skeletons.back()->getWorldPosition(HAND_LEFT).x;
+		}
+		result.serialFramesPerSec = num_frames / secondsSince(start);
+
+		start = Clock::now();
+		for (size_t frame = 0; frame < num_frames; ++frame) {
+			for (auto& job : jobs) {
+				job.time = frame * frame_delta;
+			}
+			evaluator.evaluate(jobs);
+			sink = sink + skeletons.back()->getWorldPosition(HAND_LEFT).x;
+		}
+		result.pooledFramesPerSec = num_frames / secondsSince(start);
+
+		return result;
+	}
+
+	struct SearchResult
+	{
+		float  libraryHours;
+		size_t numFrames;
+		size_t indexBytes;
+		size_t numLists;
+		double buildSeconds;
+		double exactSeconds;   // per query
+		double boundedSeconds; // per query
+		double boundedRecall;  // fraction of the exact 10 nearest a bounded search also finds
+	};
+
+	// Index a library of one minute takes then look up poses of a take that isn't in it, as the live pose search does
+	SearchResult benchMotionSearch(float libraryHours)
+	{
+		const float take_length = 60.f;
+		const size_t num_queries = 200;
+		const size_t k = 10;
+		const size_t bounded_lists = live_pose_lists;
+
+		SearchResult result;
+		result.libraryHours = libraryHours;
+
+		std::vector<std::unique_ptr<Animation>> takes;
+		std::vector<const PoseSampler*> library;
+		const size_t numTakes = static_cast<size_t>(libraryHours * 3600.f / take_length + 0.5f);
+		for (size_t i = 0; i < numTakes; ++i) {
+			takes.push_back(std::unique_ptr<Animation>(new Animation(static_cast<unsigned short>(i), "take")));
+			generateSyntheticAnimation(*takes.back(), take_length, 30.f, static_cast<unsigned int>(i + 1));
+			library.push_back(takes.back().get());
+		}
+		Animation live(0, "live");
+		generateSyntheticAnimation(live, take_length, 30.f, static_cast<unsigned int>(numTakes + 1));
+
+		MotionIndex index;
+		Clock::time_point start = Clock::now();
+		index.build(library);
+		result.buildSeconds = secondsSince(start);
+		result.numFrames    = index.getNumFrames();
+		result.indexBytes   = index.getMemoryUsage();
+		result.numLists     = index.getNumLists();
+
+		std::vector<float> feature(index.getExtractor().getStride());
+		std::vector<MotionMatch> exact, bounded;
+		size_t found = 0;
+		result.exactSeconds = result.boundedSeconds = 0.0;
+		for (size_t query = 0; query < num_queries; ++query) {
+			index.getExtractor().extract(live, query * take_length / num_queries, index.getFrameDelta(), &feature[0]);
+
+			start = Clock::now();
+			index.search(&feature[0], k, exact);
+			result.exactSeconds += secondsSince(start);
+
+			start = Clock::now();
+			index.search(&feature[0], k, bounded, bounded_lists);
+			result.boundedSeconds += secondsSince(start);
+
+			for (auto& match : bounded) {
+				for (auto& nearest : exact) {
+					if (match.take == nearest.take && match.time == nearest.time) { ++found; break; }
+				}
+			}
+		}
+		result.exactSeconds   /= num_queries;
+		result.boundedSeconds /= num_queries;
+		result.boundedRecall   = static_cast<double>(found) / (num_queries * k);
+		return result;
+	}
+
+	struct KeyPoseResult
+	{
+		float  sessionHours;
+		size_t numFrames;
+		size_t bytes;
+		double streamSeconds; // per frame
+		double refineSeconds;
+	};
+
+	// Cluster a whole session as it would be while capturing, then refine it as finishing the take does
+	KeyPoseResult benchKeyPoses(float sessionHours)
+	{
+		KeyPoseResult result;
+		result.sessionHours = sessionHours;
+
+		Animation session(0, "session");
+		generateSyntheticAnimation(session, sessionHours * 3600.f, 30.f, 1);
+
+		RepresentativeFrames keyPoses;
+		Clock::time_point start = Clock::now();
+		result.numFrames     = keyPoses.update(session);
+		result.streamSeconds = secondsSince(start) / std::max<size_t>(1, result.numFrames);
+
+		start = Clock::now();
+		keyPoses.refine();
+		result.refineSeconds = secondsSince(start);
+		result.bytes = keyPoses.getMemoryUsage();
+		return result;
+	}
+
+	struct FilterResult
+	{
+		std::string name;
+		double frameSeconds;  // per skeleton
+		float  measuredLag;   // milliseconds, the filter's own estimate
+		float  trueLag;       // milliseconds, shift of the ground truth that best fits the output
+		float  rmsError;      // millimeters, against the ground truth
+		float  rmsJitter;     // millimeters, second difference of the error
+	};
+
+	// Replay noisy skeletons at the Kinect's 30 Hz through a joint filter, "Off" scores the raw replay
+	FilterResult benchJointFilter(const std::string& name)
+	{
+		const float replay_seconds = 60.f;
+		const float skeleton_delta = 1 / 30.f;
+		const float noise_meters = 0.005f;    // jitter of the replayed joints
+		const float settle_seconds = 1.f;     // left out of the error while the filter settles
+		const float max_lag_seconds = 0.25f;
+		const float lag_step_seconds = 0.002f;
+		const size_t timing_passes = 20;
+
+		FilterResult result;
+		result.name = name;
+
+		// Replay data, same for every filter
+		const size_t numFrames = static_cast<size_t>(replay_seconds / skeleton_delta);
+		SyntheticSkeleton source(3);
+		std::mt19937 random(3);
+		std::normal_distribution<float> noise(0.f, noise_meters);
+		std::vector<SkeletonData> replay(numFrames);
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			source.setTime(frame * skeleton_delta);
+			replay[frame] = *source.getTrackedSkeletonData();
+			for (int bone = 0; bone < EBoneID::COUNT; ++bone) {
+				replay[frame].positions[bone] += glm::vec3(noise(random), noise(random), noise(random));
+			}
+		}
+
+		std::unique_ptr<JointFilter> filter(createJointFilter(name));
+		std::vector<SkeletonData> filtered(replay);
+		result.frameSeconds = 0.0;
+		result.measuredLag  = 0.f;
+		if (nullptr != filter) {
+			const Clock::time_point start = Clock::now();
+			for (size_t pass = 0; pass < timing_passes; ++pass) {
+				filtered = replay;
+				filter->reset();
+				for (auto& skeleton : filtered) {
+					filter->apply(skeleton, skeleton_delta);
+				}
+			}
+			result.frameSeconds = secondsSince(start) / (timing_passes * numFrames);
+			result.measuredLag  = 1000.f * filter->getLatency();
+		}
+
+		// Error against the ground truth as replayed, and jitter as the second difference of the error,
+		// which leaves out the smooth error lag adds
+		const size_t firstFrame = std::max<size_t>(2, static_cast<size_t>(settle_seconds / skeleton_delta));
+		std::vector<SkeletonData> truth(numFrames);
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			source.setTime(frame * skeleton_delta);
+			truth[frame] = *source.getTrackedSkeletonData();
+		}
+		double error = 0.0, jitter = 0.0;
+		for (size_t frame = firstFrame; frame < numFrames; ++frame) {
+			for (int bone = 0; bone < EBoneID::COUNT; ++bone) {
+				const glm::vec3 offset = filtered[frame].positions[bone] - truth[frame].positions[bone];
+				const glm::vec3 lastOffset = filtered[frame - 1].positions[bone] - truth[frame - 1].positions[bone];
+				const glm::vec3 firstOffset = filtered[frame - 2].positions[bone] - truth[frame - 2].positions[bone];
+				const glm::vec3 shake = offset - 2.f * lastOffset + firstOffset;
+				error  += glm::dot(offset, offset);
+				jitter += glm::dot(shake, shake);
+			}
+		}
+		const double samples = static_cast<double>((numFrames - firstFrame) * EBoneID::COUNT);
+		result.rmsError  = static_cast<float>(1000.0 * std::sqrt(error / samples));
+		result.rmsJitter = static_cast<float>(1000.0 * std::sqrt(jitter / samples));
+
+		// Shift of the ground truth the output fits best
+		double bestError = -1.0;
+		result.trueLag = 0.f;
+		for (float lag = -max_lag_seconds; lag <= max_lag_seconds; lag += lag_step_seconds) {
+			double shiftedError = 0.0;
+			for (size_t frame = firstFrame; frame < numFrames; ++frame) {
+				source.setTime(frame * skeleton_delta - lag);
+				const SkeletonData& shifted = *source.getTrackedSkeletonData();
+				for (int bone = 0; bone < EBoneID::COUNT; ++bone) {
+					const glm::vec3 offset = filtered[frame].positions[bone] - shifted.positions[bone];
+					shiftedError += glm::dot(offset, offset);
+				}
+			}
+			if (bestError < 0.0 || shiftedError < bestError) {
+				bestError = shiftedError;
+				result.trueLag = 1000.f * lag;
+			}
+		}
+		return result;
+	}
+
+	// Several synthetic skeletons tracked at once, each with its own tracking ID
+	class SyntheticCrowd : public SkeletonSource
+	{
+	public:
+		explicit SyntheticCrowd(size_t numActors)
+			: actors(numActors)
+		{
+			for (size_t actor = 0; actor < numActors; ++actor) {
+				performers.push_back(std::unique_ptr<SyntheticSkeleton>(new SyntheticSkeleton(static_cast<unsigned int>(actor + 10))));
+			}
+		}
+
+		void setTime(float time)
+		{
+			for (size_t actor = 0; actor < actors.size(); ++actor) {
+				performers[actor]->setTime(time);
+				actors[actor] = *performers[actor]->getTrackedSkeletonData();
+				actors[actor].trackingID = static_cast<unsigned int>(actor + 1);
+			}
+		}
+
+		const SkeletonData *getTrackedSkeletonData() const { return getActorSkeletonData(0); }
+		size_t getNumActors() const { return actors.size(); }
+		const SkeletonData *getActorSkeletonData(size_t actor) const { return (actor < actors.size()) ? &actors[actor] : nullptr; }
+
+	private:
+		std::vector< std::unique_ptr<SyntheticSkeleton> > performers;
+		std::vector<SkeletonData> actors;
+	};
+
+	struct ActorResult
+	{
+		size_t numActors;
+		double frameSeconds; // capturing every actor
+		size_t captureAllocs;
+		size_t bytes;
+	};
+
+	// Capture a minute of every actor of a crowd into takes reserved for that minute
+	ActorResult benchActorCapture(size_t numActors)
+	{
+		const float take_length = 60.f;
+		const size_t numFrames = static_cast<size_t>(take_length / frame_delta);
+
+		ActorResult result;
+		result.numActors = numActors;
+
+		SyntheticCrowd crowd(numActors);
+		ActorCapture capture(crowd, numActors, take_length);
+		crowd.setTime(0.f);
+		capture.update(frame_delta);
+		capture.start();
+
+		const size_t allocsBefore = heap_allocs;
+		const Clock::time_point start = Clock::now();
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			crowd.setTime(frame * frame_delta);
+			capture.update(frame_delta);
+		}
+		result.frameSeconds  = secondsSince(start) / numFrames;
+		result.captureAllocs = heap_allocs - allocsBefore;
+		capture.stop();
+		result.bytes = capture.getMemoryUsage();
+		return result;
+	}
+
+	struct FusionResult
+	{
+		size_t numSensors;
+		double fuseSeconds;      // per fused skeleton
+		float  rmsError;         // millimeters, against the ground truth at the fused time
+		float  meanLag;          // milliseconds from the latest frame to the fused time
+		float  calibDegrees;     // worst sensor's extrinsics after calibrating from the identity
+		float  calibMillimeters;
+		float  replayRate;       // fused skeletons per second of capture, replayed on acquisition threads
+	};
+
+	// Sensors placed around one actor at 30 Hz, each out of step with the others, with 5 mm of noise
+	// on the joints it sees and 4 cm on the ones the body hides from it, which it only infers
+	void generateSensorFrames(size_t numSensors, float seconds, std::vector<SensorExtrinsics>& extrinsics, std::vector< std::vector<SensorFrame> >& frames)
+	{
+		const float sensor_delta = 1 / 30.f;
+		const float sensor_spacing = 0.87f;      // radians between neighboring sensors, about 50 degrees
+		const float occlusion_depth = 0.05f;     // meters behind the hips, as seen from a sensor, a joint is hidden
+		const float tracked_noise = 0.005f;
+		const float inferred_noise = 0.04f;
+		const float inferred_confidence = 0.2f;
+		const float clock_jitter = 0.001f;
+		const glm::vec3 actor_center(0.f, 0.f, 2.f);
+
+		SyntheticSkeleton source(4);
+		std::mt19937 random(4);
+		std::uniform_real_distribution<float> jitter(-clock_jitter, clock_jitter);
+
+		extrinsics.clear();
+		frames.assign(numSensors, std::vector<SensorFrame>());
+		for (size_t sensor = 0; sensor < numSensors; ++sensor) {
+			// Sensor 0 is the shared space, the others alternate either side of it
+			const float side = (sensor % 2) ? -1.f : 1.f;
+			const float angle = side * static_cast<float>((sensor + 1) / 2) * sensor_spacing;
+			const glm::quat rotation(std::cos(0.5f * angle), 0.f, std::sin(0.5f * angle), 0.f);
+			extrinsics.push_back(SensorExtrinsics(rotation, actor_center - rotation * actor_center));
+			const glm::quat toSensor = glm::inverse(rotation);
+			const glm::vec3 towardSensor = rotation * glm::vec3(0.f, 0.f, -1.f);
+
+			std::normal_distribution<float> trackedNoise(0.f, tracked_noise);
+			std::normal_distribution<float> inferredNoise(0.f, inferred_noise);
+			const size_t numFrames = static_cast<size_t>(seconds / sensor_delta);
+			frames[sensor].resize(numFrames);
+			for (size_t frame = 0; frame < numFrames; ++frame) {
+				SensorFrame& sensorFrame = frames[sensor][frame];
+				sensorFrame.timeStamp = (frame + static_cast<float>(sensor) / numSensors) * sensor_delta + jitter(random);
+				source.setTime(static_cast<float>(sensorFrame.timeStamp));
+				const SkeletonData& truth = *source.getTrackedSkeletonData();
+
+				sensorFrame.skeleton = truth;
+				sensorFrame.skeleton.trackingID = static_cast<unsigned int>(sensor + 1);
+				for (int bone = 0; bone < EBoneID::COUNT; ++bone) {
+					const bool hidden = glm::dot(truth.positions[bone] - truth.positions[HIP_CENTER], towardSensor) < -occlusion_depth;
+					std::normal_distribution<float>& noise = hidden ? inferredNoise : trackedNoise;
+					const glm::vec3 seen = truth.positions[bone] + glm::vec3(noise(random), noise(random), noise(random));
+					sensorFrame.skeleton.positions[bone] = toSensor * (seen - extrinsics[sensor].translation);
+					sensorFrame.skeleton.absoluteRotations[bone] = toSensor * truth.absoluteRotations[bone];
+					sensorFrame.confidence[bone] = hidden ? inferred_confidence : 1.f;
+				}
+			}
+		}
+	}
+
+	// Fuse a minute of sensors as a 60 Hz app would, calibrate them starting from the identity,
+	// then replay them through text files' worth of frames on acquisition threads
+	FusionResult benchSensorFusion(size_t numSensors)
+	{
+		const float fusion_seconds = 60.f;
+		const float settle_seconds = 1.f;
+		const float calibration_seconds = 20.f;
+		const float replay_seconds = 8.f;
+		const float replay_speed = 8.f;
+
+		FusionResult result;
+		result.numSensors = numSensors;
+
+		std::vector<SensorExtrinsics> extrinsics;
+		std::vector< std::vector<SensorFrame> > frames;
+		generateSensorFrames(numSensors, fusion_seconds, extrinsics, frames);
+		SyntheticSkeleton truth(4);
+
+		// Frames are pushed as they would have arrived, fused every app frame
+		SkeletonFusion fusion;
+		SkeletonFusion calibration;
+		for (size_t sensor = 0; sensor < numSensors; ++sensor) {
+			fusion.addSensor(std::unique_ptr<SensorSource>(new ReplaySensorSource(std::vector<SensorFrame>(), "sensor")), extrinsics[sensor]);
+			calibration.addSensor(std::unique_ptr<SensorSource>(new ReplaySensorSource(std::vector<SensorFrame>(), "sensor")));
+		}
+		calibration.startCalibration();
+
+		std::vector<size_t> next(numSensors, 0);
+		double fuseSeconds = 0.0, error = 0.0, lag = 0.0;
+		size_t numFused = 0, numScored = 0;
+		const size_t numAppFrames = static_cast<size_t>(fusion_seconds / frame_delta);
+		for (size_t appFrame = 0; appFrame < numAppFrames; ++appFrame) {
+			const double now = appFrame * frame_delta;
+			for (size_t sensor = 0; sensor < numSensors; ++sensor) {
+				for (; next[sensor] < frames[sensor].size() && frames[sensor][next[sensor]].timeStamp <= now; ++next[sensor]) {
+					fusion.push(sensor, frames[sensor][next[sensor]]);
+					if (now < calibration_seconds) calibration.push(sensor, frames[sensor][next[sensor]]);
+				}
+			}
+			if (now < calibration_seconds) calibration.update();
+
+			const Clock::time_point start = Clock::now();
+			const bool fused = fusion.update();
+			fuseSeconds += secondsSince(start);
+			if (!fused) continue;
+			++numFused;
+			if (now < settle_seconds) continue;
+
+			truth.setTime(static_cast<float>(fusion.getFusedTime()));
+			const SkeletonData& expected = *truth.getTrackedSkeletonData();
+			const SkeletonData& actual = *fusion.getTrackedSkeletonData();
+			for (int bone = 0; bone < EBoneID::COUNT; ++bone) {
+				const glm::vec3 offset = actual.positions[bone] - expected.positions[bone];
+				error += glm::dot(offset, offset);
+			}
+			lag += now - fusion.getFusedTime();
+			++numScored;
+		}
+		result.fuseSeconds = (numFused > 0) ? fuseSeconds / numFused : 0.0;
+		result.rmsError = (numScored > 0) ? static_cast<float>(1000.0 * std::sqrt(error / (numScored * EBoneID::COUNT))) : 0.f;
+		result.meanLag  = (numScored > 0) ? static_cast<float>(1000.0 * lag / numScored) : 0.f;
+
+		calibration.finishCalibration();
+		result.calibDegrees = result.calibMillimeters = 0.f;
+		for (size_t sensor = 1; sensor < numSensors; ++sensor) {
+			const SensorExtrinsics& solved = calibration.getExtrinsics(sensor);
+			const float cosHalfAngle = std::min(1.f, std::abs(glm::dot(solved.rotation, extrinsics[sensor].rotation)));
+			result.calibDegrees = std::max(result.calibDegrees, 2.f * std::acos(cosHalfAngle) * 57.2957795f);
+			result.calibMillimeters = std::max(result.calibMillimeters, 1000.f * glm::length(solved.translation - extrinsics[sensor].translation));
+		}
+
+		// Replay a few seconds through the text format on the fusion's own threads
+		SkeletonFusion replay;
+		for (size_t sensor = 0; sensor < numSensors; ++sensor) {
+			const size_t numFrames = std::min(frames[sensor].size(), static_cast<size_t>(replay_seconds * 30.f));
+			std::stringstream file;
+			writeSensorFrames(std::vector<SensorFrame>(frames[sensor].begin(), frames[sensor].begin() + numFrames), file);
+			std::vector<SensorFrame> replayed;
+			readSensorFrames(file, replayed);
+			replay.addSensor(std::unique_ptr<SensorSource>(new ReplaySensorSource(replayed, "replay", replay_speed)), extrinsics[sensor]);
+		}
+		size_t numReplayFused = 0;
+		const Clock::time_point start = Clock::now();
+		replay.start();
+		while (secondsSince(start) < replay_seconds / replay_speed + 0.1f) {
+			if (replay.update()) ++numReplayFused;
+			std::this_thread::sleep_for(std::chrono::microseconds(500));
+		}
+		replay.stop();
+		result.replayRate = numReplayFused / replay_seconds;
+
+		return result;
+	}
+
+	struct SegmentationResult
+	{
+		size_t numPlayers;
+		double frameSeconds;       // segmenting a 640x480 frame
+		double pixelFrameSeconds;  // the same a pixel at a time, into a byte mask per player
+		size_t maskBytes;          // every player's mask
+		size_t cropBytes;          // mean depth crop of player 1's silhouette
+		bool   matches;            // masks and bounds agree with the pixel at a time ones
+	};
+
+	// Depth frames of players walking across a room, a wall 3.5 m away and players between
+	// 1.5 and 3 m, nearer ones hiding those behind them, with a few mm of noise and dropouts
+	void generateDepthFrames(size_t numPlayers, int width, int height, size_t numFrames, std::vector< std::vector<DepthPixel> >& frames)
+	{
+		const unsigned short wall_depth = 3500;
+		const float player_half_width = 0.25f;  // meters, an ellipse of a body
+		const float player_half_height = 0.9f;
+		const float focal_length = 571.26f;     // pixels at 640x480
+		const float walk_speed = 0.8f;          // meters per second
+		const float sensor_delta = 1 / 30.f;
+
+		std::mt19937 random(8);
+		std::uniform_int_distribution<int> noise(-4, 4);
+		std::uniform_int_distribution<int> dropout(0, 99);
+
+		frames.assign(numFrames, std::vector<DepthPixel>(static_cast<size_t>(width) * height));
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			std::vector<DepthPixel>& pixels = frames[frame];
+			for (size_t i = 0; i < pixels.size(); ++i) {
+				pixels[i].playerIndex = 0;
+				pixels[i].depth = static_cast<unsigned short>(wall_depth + noise(random));
+			}
+
+			// Farthest first, so nearer players are drawn over them
+			for (size_t n = numPlayers; n-- > 0; ) {
+				const float z = 1.5f + 1.5f * n / PlayerSegmentation::max_players;
+				const float phase = walk_speed * frame * sensor_delta + 0.9f * n;
+				const float x = 1.2f * std::sin(phase / 1.2f);
+				const int cu = static_cast<int>(width / 2 + x * focal_length / z);
+				const int cv = height / 2;
+				const int hu = static_cast<int>(player_half_width * focal_length / z);
+				const int hv = static_cast<int>(player_half_height * focal_length / z);
+				for (int v = std::max(0, cv - hv); v <= std::min(height - 1, cv + hv); ++v) {
+					for (int u = std::max(0, cu - hu); u <= std::min(width - 1, cu + hu); ++u) {
+						const float du = static_cast<float>(u - cu) / hu;
+						const float dv = static_cast<float>(v - cv) / hv;
+						if (du * du + dv * dv > 1.f) continue;
+						DepthPixel& pixel = pixels[static_cast<size_t>(v) * width + u];
+						pixel.playerIndex = static_cast<unsigned short>(n + 1);
+						pixel.depth = (0 == dropout(random)) ? 0 : static_cast<unsigned short>(1000.f * z + noise(random));
+					}
+				}
+			}
+		}
+	}
+
+	// Segment 10 s of 30 Hz depth frames, then the same a pixel at a time for comparison
+	SegmentationResult benchSegmentation(size_t numPlayers)
+	{
+		const int width = 640;
+		const int height = 480;
+		const size_t numFrames = 300;
+
+		SegmentationResult result;
+		result.numPlayers = numPlayers;
+		result.matches = true;
+
+		std::vector< std::vector<DepthPixel> > frames;
+		generateDepthFrames(numPlayers, width, height, numFrames, frames);
+
+		PlayerSegmentation segmentation(width, height);
+		PlayerCrop crop;
+		crop.pixels.reserve(frames[0].size() * sizeof(DepthPixel));
+		size_t cropBytes = 0;
+		const Clock::time_point start = Clock::now();
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			segmentation.segment(&frames[frame][0]);
+			segmentation.crop(&frames[frame][0], sizeof(DepthPixel), segmentation.getBounds(1), crop, 1);
+			cropBytes += crop.pixels.size();
+		}
+		result.frameSeconds = secondsSince(start) / numFrames;
+		result.maskBytes = PlayerSegmentation::max_players * segmentation.getMaskStride() * height * sizeof(unsigned short);
+		result.cropBytes = cropBytes / numFrames;
+
+		std::vector<unsigned char> masks(PlayerSegmentation::max_players * frames[0].size());
+		std::vector<unsigned int> silhouette(frames[0].size());
+		PlayerBounds bounds[PlayerSegmentation::max_players];
+		const Clock::time_point pixelStart = Clock::now();
+		for (size_t frame = 0; frame < numFrames; ++frame) {
+			for (size_t player = 0; player < PlayerSegmentation::max_players; ++player) {
+				bounds[player] = PlayerBounds();
+				bounds[player].left = width;
+				bounds[player].top = height;
+			}
+			const DepthPixel *pixels = &frames[frame][0];
+			for (int y = 0; y < height; ++y) {
+				for (int x = 0; x < width; ++x) {
+					const size_t i = static_cast<size_t>(y) * width + x;
+					const unsigned short index = pixels[i].playerIndex;
+					silhouette[i] = (0 != index) ? 0xffffffffu : 0u;
+					for (size_t player = 0; player < PlayerSegmentation::max_players; ++player) {
+						const bool on = (index == player + 1);
+						masks[player * frames[0].size() + i] = on ? 255 : 0;
+						if (!on) continue;
+						PlayerBounds& b = bounds[player];
+						b.left = std::min(b.left, x);
+						b.right = std::max(b.right, x);
+						b.top = std::min(b.top, y);
+						b.bottom = y;
+						++b.numPixels;
+					}
+				}
+			}
+			sink = sink + silhouette[frame];
+		}
+		result.pixelFrameSeconds = secondsSince(pixelStart) / numFrames;
+
+		// The last frame of each is still around to compare
+		segmentation.segment(&frames[numFrames - 1][0]);
+		for (size_t player = 0; player < PlayerSegmentation::max_players; ++player) {
+			const PlayerBounds& a = segmentation.getBounds(player + 1);
+			const PlayerBounds& b = bounds[player];
+			if (a.numPixels != b.numPixels) result.matches = false;
+			if (a.numPixels > 0 && (a.left != b.left || a.right != b.right || a.top != b.top || a.bottom != b.bottom)) result.matches = false;
+			for (int y = 0; y < height; ++y) {
+				for (int x = 0; x < width; ++x) {
+					const bool on = 0 != masks[player * frames[0].size() + static_cast<size_t>(y) * width + x];
+					if (on != segmentation.isPlayerPixel(player + 1, x, y)) result.matches = false;
+				}
+			}
+		}
+		return result;
+	}
+
+	BenchResult runBench(float takeLength)
+	{
+		BenchResult result;
+		result.takeLength = takeLength;
+		result.numFrames  = static_cast<size_t>(takeLength / frame_delta);
+
+		SyntheticSkeleton baseSource(1);
+		SyntheticSkeleton layerSource(2);
+		Recording base("base", baseSource);
+		Recording layer("layer", layerSource);
+		Recording blend("blend", baseSource);
+
+		result.keyFramesPerSec = benchKeyFrameAppend(base, baseSource, result.numFrames);
+		benchKeyFrameAppend(layer, layerSource, result.numFrames);
+		result.takeBytes = base.getStats().bytes;
+
+		result.posesPerSec       = benchPoseSampling(*base.getAnimation(), result.numFrames);
+		result.blendFramesPerSec = benchBlend(blend, base, layer, result.numFrames);
+		for (int mode = 0; mode < num_mapping_modes; ++mode) {
+			result.batchBlendFramesPerSec[mode] = benchBatchBlend(blend, base, layer, mapping_modes[mode], result.numFrames);
+		}
+		result.exportMBPerSec    = benchExport(*blend.getAnimation(), result.exportBytes);
+		benchReduction(layer, result);
+		benchCompression(layer, result);
+		benchRollingCapture(blend, baseSource, result);
+		benchHeap(baseSource, result);
+		benchSplineSampling(result);
+		benchTimeWarp(base, baseSource, result);
+
+		return result;
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	std::vector<float> takeLengths;
+	for (int i = 1; i < argc; ++i) {
+		const float length = static_cast<float>(std::atof(argv[i]));
+		if (length > 0.f) {
+			takeLengths.push_back(length);
+		} else {
+			std::cerr << "Ignoring invalid take length '" << argv[i] << "'" << std::endl;
+		}
+	}
+	if (takeLengths.empty()) {
+		takeLengths.push_back(10.f);
+		takeLengths.push_back(60.f);
+		takeLengths.push_back(180.f);
+	}
+
+	std::cout << std::setw(8)  << "take(s)"
+	          << std::setw(9)  << "frames"
+	          << std::setw(11) << "take MB"
+	          << std::setw(15) << "keyframes/s"
+	          << std::setw(13) << "poses/s"
+	          << std::setw(14) << "blends/s"
+	          << std::setw(16) << "batch blends/s"
+	          << std::setw(12) << "bvh MB"
+	          << std::setw(12) << "bvh MB/s"
+	          << std::endl;
+
+	std::vector<BenchResult> results;
+	for (auto length : takeLengths) {
+		results.push_back(runBench(length));
+		const BenchResult& result = results.back();
+		std::cout << std::fixed
+		          << std::setw(8)  << std::setprecision(1) << result.takeLength
+		          << std::setw(9)  << result.numFrames
+		          << std::setw(11) << std::setprecision(2) << (result.takeBytes / (1024.0 * 1024.0))
+		          << std::setw(15) << std::setprecision(0) << result.keyFramesPerSec
+		          << std::setw(13) << result.posesPerSec
+		          << std::setw(14) << result.blendFramesPerSec
+		          << std::setw(16) << result.batchBlendFramesPerSec[0]
+		          << std::setw(12) << std::setprecision(2) << (result.exportBytes / (1024.0 * 1024.0))
+		          << std::setw(12) << result.exportMBPerSec
+		          << std::endl;
+	}
+
+	// Batch blend frames/s for each mapping mode
+	std::cout << std::endl << std::setw(8) << "take(s)";
+	for (int mode = 0; mode < num_mapping_modes; ++mode) {
+		std::cout << std::setw(12) << mapping_mode_names[mode];
+	}
+	std::cout << std::endl;
+	for (auto& result : results) {
+		std::cout << std::setw(8) << std::setprecision(1) << result.takeLength << std::setprecision(0);
+		for (int mode = 0; mode < num_mapping_modes; ++mode) {
+			std::cout << std::setw(12) << result.batchBlendFramesPerSec[mode];
+		}
+		std::cout << std::endl;
+	}
+
+	// Keyframe reduction of a finished take
+	std::cout << std::endl
+	          << std::setw(8)  << "take(s)"
+	          << std::setw(11) << "keyframes"
+	          << std::setw(11) << "reduced"
+	          << std::setw(8)  << "kept"
+	          << std::setw(12) << "reduce ms"
+	          << std::setw(13) << "poses/s"
+	          << std::setw(16) << "reduced poses/s"
+	          << std::endl;
+	for (auto& result : results) {
+		std::cout << std::setw(8)  << std::setprecision(1) << result.takeLength
+		          << std::setw(11) << result.capturedKeyFrames
+		          << std::setw(11) << result.reducedKeyFrames
+		          << std::setw(7)  << (100.0 * result.reducedKeyFrames / result.capturedKeyFrames) << "%"
+		          << std::setw(12) << (1000.0 * result.reduceSeconds)
+		          << std::setw(13) << std::setprecision(0) << result.posesPerSec
+		          << std::setw(16) << result.reducedPosesPerSec
+		          << std::endl;
+	}
+
+	// Packed takes, sizes against the keyframe memory of the reduced take
+	std::cout << std::endl
+	          << std::setw(8)  << "take(s)"
+	          << std::setw(11) << "take MB"
+	          << std::setw(11) << "packed MB"
+	          << std::setw(8)  << "ratio"
+	          << std::setw(13) << "max err deg"
+	          << std::setw(12) << "max err mm"
+	          << std::setw(10) << "pack ms"
+	          << std::setw(11) << "unpack ms"
+	          << std::setw(13) << "poses/s"
+	          << std::setw(15) << "packed poses/s"
+	          << std::endl;
+	for (auto& result : results) {
+		std::cout << std::setw(8)  << std::setprecision(1) << result.takeLength
+		          << std::setw(11) << std::setprecision(2) << (result.reducedBytes / (1024.0 * 1024.0))
+		          << std::setw(11) << (result.packedBytes / (1024.0 * 1024.0))
+		          << std::setw(8)  << std::setprecision(1) << (static_cast<double>(result.reducedBytes) / result.packedBytes)
+		          << std::setw(13) << std::setprecision(3) << result.maxAngularError
+		          << std::setw(12) << result.maxTranslationError
+		          << std::setw(10) << std::setprecision(1) << (1000.0 * result.packSeconds)
+		          << std::setw(11) << (1000.0 * result.unpackSeconds)
+		          << std::setw(13) << std::setprecision(0) << result.reducedPosesPerSec
+		          << std::setw(15) << result.packedPosesPerSec
+		          << std::endl;
+	}
+
+	// Rolling capture, memory stays at the ring's size however long the take
+	std::cout << std::endl
+	          << std::setw(8)  << "take(s)"
+	          << std::setw(11) << "take MB"
+	          << std::setw(11) << "ring MB"
+	          << std::setw(12) << "frames/s"
+	          << std::setw(13) << "keep 30s ms"
+	          << std::endl;
+	for (auto& result : results) {
+		std::cout << std::setw(8)  << std::setprecision(1) << result.takeLength
+		          << std::setw(11) << std::setprecision(2) << (result.takeBytes / (1024.0 * 1024.0))
+		          << std::setw(11) << (result.rollingBytes / (1024.0 * 1024.0))
+		          << std::setw(12) << std::setprecision(0) << result.rollingFramesPerSec
+		          << std::setw(13) << std::setprecision(1) << (1000.0 * result.keepSeconds)
+		          << std::endl;
+	}
+
+	// Heap traffic of a take's keyframes
+	std::cout << std::endl
+	          << std::setw(8)  << "take(s)"
+	          << std::setw(11) << "keyframes"
+	          << std::setw(16) << "capture allocs"
+	          << std::setw(13) << "clear frees"
+	          << std::setw(11) << "clear ms"
+	          << std::setw(13) << "destroy ms"
+	          << std::endl;
+	for (auto& result : results) {
+		std::cout << std::setw(8)  << std::setprecision(1) << result.takeLength
+		          << std::setw(11) << result.numFrames * EBoneID::COUNT
+		          << std::setw(16) << result.captureAllocs
+		          << std::setw(13) << result.clearFrees
+		          << std::setw(11) << std::setprecision(2) << (1000.0 * result.clearSeconds)
+		          << std::setw(13) << (1000.0 * result.destroySeconds)
+		          << std::endl;
+	}
+
+	// Spline interpolated poses, the spline math runs on the stack
+	std::cout << std::endl
+	          << std::setw(8)  << "take(s)"
+	          << std::setw(13) << "poses/s"
+	          << std::setw(16) << "spline poses/s"
+	          << std::setw(16) << "allocs/pose"
+	          << std::endl;
+	for (auto& result : results) {
+		std::cout << std::setw(8)  << std::setprecision(1) << result.takeLength
+		          << std::setw(13) << std::setprecision(0) << result.posesPerSec
+		          << std::setw(16) << result.splinePosesPerSec
+		          << std::setw(16) << std::setprecision(2) << result.splineAllocsPerPose
+		          << std::endl;
+	}
+
+	// Time warp of a layer against its base
+	std::cout << std::endl
+	          << std::setw(8)  << "take(s)"
+	          << std::setw(11) << "align ms"
+	          << std::setw(14) << "pose dist mm"
+	          << std::setw(14) << "warp err ms"
+	          << std::setw(13) << "1:1 err ms"
+	          << std::endl;
+	for (auto& result : results) {
+		std::cout << std::setw(8)  << std::setprecision(1) << result.takeLength
+		          << std::setw(11) << (1000.0 * result.alignSeconds)
+		          << std::setw(14) << result.alignDistance
+		          << std::setw(14) << result.alignError
+		          << std::setw(13) << result.unalignedError
+		          << std::endl;
+	}
+
+	// Nearest poses over a library of takes, bounded searches scan as many lists as the live pose search,
+	// which should take under search_goal_seconds per query and find at least search_goal_recall of the exact matches
+	std::cout << std::endl
+	          << std::setw(8)  << "hours"
+	          << std::setw(10) << "frames"
+	          << std::setw(8)  << "lists"
+	          << std::setw(11) << "index MB"
+	          << std::setw(11) << "build ms"
+	          << std::setw(11) << "exact us"
+	          << std::setw(13) << "bounded us"
+	          << std::setw(16) << "bounded recall"
+	          << std::setw(11) << "goal met"
+	          << std::endl;
+	const float library_hours[] = { 0.5f, 1.f, 3.f };
+	for (auto hours : library_hours) {
+		const SearchResult result = benchMotionSearch(hours);
+		const bool goalMet = result.boundedSeconds < search_goal_seconds && result.boundedRecall >= search_goal_recall;
+		std::cout << std::setw(8)  << std::setprecision(1) << result.libraryHours
+		          << std::setw(10) << result.numFrames
+		          << std::setw(8)  << result.numLists
+		          << std::setw(11) << (result.indexBytes / (1024.0 * 1024.0))
+		          << std::setw(11) << std::setprecision(0) << (1000.0 * result.buildSeconds)
+		          << std::setw(11) << std::setprecision(1) << (1000000.0 * result.exactSeconds)
+		          << std::setw(13) << (1000000.0 * result.boundedSeconds)
+		          << std::setw(15) << (100.0 * result.boundedRecall) << "%"
+		          << std::setw(11) << (goalMet ? "yes" : "no")
+		          << std::endl;
+	}
+
+	// Representative frames of one long session, streamed then refined with k-means
+	std::cout << std::endl
+	          << std::setw(8)  << "hours"
+	          << std::setw(10) << "frames"
+	          << std::setw(8)  << "MB"
+	          << std::setw(16) << "stream us/frame"
+	          << std::setw(12) << "refine ms"
+	          << std::endl;
+	const float session_hours[] = { 0.5f, 1.f, 3.f };
+	for (auto hours : session_hours) {
+		const KeyPoseResult result = benchKeyPoses(hours);
+		std::cout << std::setw(8)  << std::setprecision(1) << result.sessionHours
+		          << std::setw(10) << result.numFrames
+		          << std::setw(8)  << (result.bytes / (1024.0 * 1024.0))
+		          << std::setw(16) << std::setprecision(2) << (1000000.0 * result.streamSeconds)
+		          << std::setw(12) << std::setprecision(0) << (1000.0 * result.refineSeconds)
+		          << std::endl;
+	}
+
+	// Joint filters on 60 s of skeletons replayed at 30 Hz with 5 mm of noise on every joint
+	std::cout << std::endl
+	          << std::setw(20) << "filter"
+	          << std::setw(12) << "ns/frame"
+	          << std::setw(13) << "est lag ms"
+	          << std::setw(14) << "true lag ms"
+	          << std::setw(11) << "error mm"
+	          << std::setw(12) << "jitter mm"
+	          << std::endl;
+	const char *filter_names[] = { "Off", "One Euro", "Double Exponential", "Kalman" };
+	for (auto name : filter_names) {
+		const FilterResult result = benchJointFilter(name);
+		std::cout << std::setw(20) << result.name
+		          << std::setw(12) << std::setprecision(0) << (1000000000.0 * result.frameSeconds)
+		          << std::setw(13) << std::setprecision(1) << result.measuredLag
+		          << std::setw(14) << result.trueLag
+		          << std::setw(11) << std::setprecision(2) << result.rmsError
+		          << std::setw(12) << result.rmsJitter
+		          << std::endl;
+	}
+
+	// Every tracked actor captured at once, a minute of keyframes reserved up front
+	std::cout << std::endl
+	          << std::setw(8)  << "actors"
+	          << std::setw(11) << "us/frame"
+	          << std::setw(16) << "capture allocs"
+	          << std::setw(8)  << "MB"
+	          << std::endl;
+	const size_t actor_counts[] = { 1, 2, 4, 6 };
+	for (auto numActors : actor_counts) {
+		const ActorResult result = benchActorCapture(numActors);
+		std::cout << std::setw(8)  << result.numActors
+		          << std::setw(11) << std::setprecision(2) << (1000000.0 * result.frameSeconds)
+		          << std::setw(16) << result.captureAllocs
+		          << std::setw(8)  << (result.bytes / (1024.0 * 1024.0))
+		          << std::endl;
+	}
+
+	// Sensors around one actor fused at 60 Hz, a minute each, frames in their own camera space
+	// A fused skeleton follows each frame of any sensor, so out of step sensors fuse faster than 30 Hz
+	std::cout << std::endl
+	          << std::setw(8)  << "sensors"
+	          << std::setw(11) << "us/fuse"
+	          << std::setw(11) << "error mm"
+	          << std::setw(9)  << "lag ms"
+	          << std::setw(12) << "calib deg"
+	          << std::setw(11) << "calib mm"
+	          << std::setw(13) << "replay Hz"
+	          << std::endl;
+	const size_t sensor_counts[] = { 1, 2, 3, 4 };
+	for (auto numSensors : sensor_counts) {
+		const FusionResult result = benchSensorFusion(numSensors);
+		std::cout << std::setw(8)  << result.numSensors
+		          << std::setw(11) << std::setprecision(2) << (1000000.0 * result.fuseSeconds)
+		          << std::setw(11) << result.rmsError
+		          << std::setw(9)  << std::setprecision(1) << result.meanLag
+		          << std::setw(12) << std::setprecision(2) << result.calibDegrees
+		          << std::setw(11) << result.calibMillimeters
+		          << std::setw(13) << std::setprecision(0) << result.replayRate
+		          << std::endl;
+	}
+
+	// Player masks and bounds of 640x480 depth frames, against a pixel at a time
+	std::cout << std::endl
+	          << std::setw(8)  << "players"
+	          << std::setw(11) << "us/frame"
+	          << std::setw(10) << "Mpix/s"
+	          << std::setw(15) << "per pixel us"
+	          << std::setw(10) << "speedup"
+	          << std::setw(10) << "mask KB"
+	          << std::setw(10) << "crop KB"
+	          << std::setw(10) << "matches"
+	          << std::endl;
+	const size_t player_counts[] = { 0, 1, 2, 4, 6 };
+	for (auto numPlayers : player_counts) {
+		const SegmentationResult result = benchSegmentation(numPlayers);
+		std::cout << std::setw(8)  << result.numPlayers
+		          << std::setw(11) << std::setprecision(1) << (1000000.0 * result.frameSeconds)
+		          << std::setw(10) << std::setprecision(0) << (640.0 * 480.0 / result.frameSeconds / 1000000.0)
+		          << std::setw(15) << std::setprecision(1) << (1000000.0 * result.pixelFrameSeconds)
+		          << std::setw(10) << (result.pixelFrameSeconds / result.frameSeconds)
+		          << std::setw(10) << (result.maskBytes / 1024.0)
+		          << std::setw(10) << (result.cropBytes / 1024.0)
+		          << std::setw(10) << (result.matches ? "yes" : "NO")
+		          << std::endl;
+	}
+
+	// Frames/s when every take is posed each frame, serial and on the pose evaluator
+	PoseEvaluator evaluator;
+	std::cout << std::endl
+	          << std::setw(8)  << "takes"
+	          << std::setw(16) << "serial fps"
+	          << std::setw(16) << "pooled fps"
+	          << "   (" << evaluator.getNumThreads() << " threads)"
+	          << std::endl;
+	const size_t take_counts[] = { 1, 4, 16, 64 };
+	for (auto numTakes : take_counts) {
+		const LayerResult result = benchLayerEvaluation(evaluator, numTakes);
+		std::cout << std::setw(8)  << result.numTakes
+		          << std::setw(16) << result.serialFramesPerSec
+		          << std::setw(16) << result.pooledFramesPerSec
+		          << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,119 @@
+#include "SyntheticSkeleton.h"
+
+#include "Animation/Animation.h"
+#include "Animation/BoneAnimationTrack.h"
+#include "Animation/TransformKeyFrame.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+
+namespace
+{
+	// Rest pose bone offsets from parent joint, in meters (Kinect camera space)
+	const glm::vec3 rest_offsets[EBoneID::COUNT] = {
+		glm::vec3( 0.00f,  0.00f, 2.00f), // HIP_CENTER (root position)
+		glm::vec3( 0.00f,  0.10f, 0.00f), // SPINE
+		glm::vec3( 0.00f,  0.35f, 0.00f), // SHOULDER_CENTER
+		glm::vec3( 0.00f,  0.20f, 0.00f), // HEAD
+		glm::vec3(-0.18f, -0.05f, 0.00f), // SHOULDER_LEFT
+		glm::vec3( 0.00f, -0.28f, 0.00f), // ELBOW_LEFT
+		glm::vec3( 0.00f, -0.25f, 0.00f), // WRIST_LEFT
+		glm::vec3( 0.00f, -0.08f, 0.00f), // HAND_LEFT
+		glm::vec3( 0.18f, -0.05f, 0.00f), // SHOULDER_RIGHT
+		glm::vec3( 0.00f, -0.28f, 0.00f), // ELBOW_RIGHT
+		glm::vec3( 0.00f, -0.25f, 0.00f), // WRIST_RIGHT
+		glm::vec3( 0.00f, -0.08f, 0.00f), // HAND_RIGHT
+		glm::vec3(-0.08f, -0.07f, 0.00f), // HIP_LEFT
+		glm::vec3( 0.00f, -0.42f, 0.00f), // KNEE_LEFT
+		glm::vec3( 0.00f, -0.40f, 0.00f), // ANKLE_LEFT
+		glm::vec3( 0.00f, -0.05f, 0.10f), // FOOT_LEFT
+		glm::vec3( 0.08f, -0.07f, 0.00f), // HIP_RIGHT
+		glm::vec3( 0.00f, -0.42f, 0.00f), // KNEE_RIGHT
+		glm::vec3( 0.00f, -0.40f, 0.00f), // ANKLE_RIGHT
+		glm::vec3( 0.00f, -0.05f, 0.10f)  // FOOT_RIGHT
+	};
+
+	// Parent of each bone, in the same order as the Kinect joints
+	const EBoneID parents[EBoneID::COUNT] = {
+		HIP_CENTER, HIP_CENTER, SPINE, SHOULDER_CENTER,
+		SHOULDER_CENTER, SHOULDER_LEFT, ELBOW_LEFT, WRIST_LEFT,
+		SHOULDER_CENTER, SHOULDER_RIGHT, ELBOW_RIGHT, WRIST_RIGHT,
+		HIP_CENTER, HIP_LEFT, KNEE_LEFT, ANKLE_LEFT,
+		HIP_CENTER, HIP_RIGHT, KNEE_RIGHT, ANKLE_RIGHT
+	};
+
+	// Small deterministic generator so takes are reproducible across platforms
+	float nextRandom(unsigned int& state)
+	{
+		state = state * 1664525u + 1013904223u;
+		return (state >> 8) / 16777216.f;
+	}
+}
+
+
+SyntheticSkeleton::SyntheticSkeleton(unsigned int seed)
+	: data()
+{
+	unsigned int state = seed * 2654435761u + 1u;
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const glm::vec3 axis(nextRandom(state) - 0.5f, nextRandom(state) - 0.5f, nextRandom(state) - 0.5f);
+		axes[boneID]        = glm::normalize(axis + glm::vec3(0.f, 0.f, 0.01f));
+		amplitudes[boneID]  = 0.1f + 0.5f * nextRandom(state);
+		frequencies[boneID] = 0.2f + 1.3f * nextRandom(state);
+		phases[boneID]      = 6.2831853f * nextRandom(state);
+	}
+	setTime(0.f);
+}
+
+void SyntheticSkeleton::setTime(float time)
+{
+	// Note: id ordering ensures parents are posed before their children
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const float angle = amplitudes[boneID] * std::sin(6.2831853f * frequencies[boneID] * time + phases[boneID]);
+		const glm::vec3 v = axes[boneID] * std::sin(0.5f * angle);
+		const glm::quat local(std::cos(0.5f * angle), v.x, v.y, v.z);
+
+		data.hierarchicalRotations[boneID] = local;
+		if (boneID == HIP_CENTER) {
+			const glm::vec3 sway(0.2f * std::sin(0.5f * time), 0.02f * std::sin(2.f * time), 0.3f * std::sin(0.3f * time));
+			data.absoluteRotations[boneID] = local;
+			data.positions[boneID] = rest_offsets[boneID] + sway;
+		} else {
+			const EBoneID parentID = parents[boneID];
+			const glm::quat& parentRotation = data.absoluteRotations[parentID];
+			data.absoluteRotations[boneID] = glm::normalize(parentRotation * local);
+			data.positions[boneID] = data.positions[parentID] + parentRotation * rest_offsets[boneID];
+		}
+	}
+}
+
+
+void generateSyntheticAnimation(Animation& animation, float length, float sampleRate, unsigned int seed)
+{
+	SyntheticSkeleton skeleton(seed);
+
+	BoneAnimationTrack *tracks[EBoneID::COUNT];
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		tracks[boneID] = animation.getBoneTrack(boneID);
+		if (nullptr == tracks[boneID]) {
+			tracks[boneID] = animation.createBoneTrack(boneID);
+		}
+	}
+
+	const int numFrames = static_cast<int>(length * sampleRate) + 1;
+	for (int frame = 0; frame < numFrames; ++frame) {
+		const float time = frame / sampleRate;
+		skeleton.setTime(time);
+
+		const SkeletonData& data = *skeleton.getTrackedSkeletonData();
+		for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+			TransformKeyFrame *keyFrame = static_cast<TransformKeyFrame*>(tracks[boneID]->createKeyFrame(time));
+			keyFrame->setTranslation(data.positions[boneID]);
+			keyFrame->setRotation(data.hierarchicalRotations[boneID]);
+			keyFrame->setAbsRotation(data.absoluteRotations[boneID]);
+			keyFrame->setScale(glm::vec3(1));
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Kinect/SkeletonSource.h"
+
+class Animation;
+
+
+// Procedurally animated skeleton, stands in for a Kinect when benchmarking
+// Each bone swings about its own axis with a seeded amplitude, frequency and phase,
+// joint positions are derived from the rotations so the data is hierarchically consistent
+class SyntheticSkeleton : public SkeletonSource
+{
+public:
+	explicit SyntheticSkeleton(unsigned int seed = 0);
+
+	void setTime(float time);
+
+	const SkeletonData *getTrackedSkeletonData() const;
+
+private:
+	SkeletonData data;
+
+	glm::vec3 axes[EBoneID::COUNT];
+	float amplitudes[EBoneID::COUNT];
+	float frequencies[EBoneID::COUNT];
+	float phases[EBoneID::COUNT];
+
+};
+
+inline const SkeletonData *SyntheticSkeleton::getTrackedSkeletonData() const { return &data; }
+
+
+// Fills every bone track of animation with keyframes sampled from a SyntheticSkeleton
+// Bone tracks that don't exist yet are created
+void generateSyntheticAnimation(Animation& animation, float length, float sampleRate = 30.f, unsigned int seed = 0);
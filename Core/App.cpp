@@ -23,6 +23,7 @@ App::App()
 	msg::gDispatcher.registerHandler(msg::START_KINECT_DEVICE,      this);
 	msg::gDispatcher.registerHandler(msg::STOP_KINECT_DEVICE,       this);
 	msg::gDispatcher.registerHandler(msg::TOGGLE_SEATED_MODE,       this);
+	msg::gDispatcher.registerHandler(msg::TOGGLE_SENSOR_CALIBRATION, this);
 	msg::gDispatcher.registerHandler(msg::FILTER_LEVEL_SELECT,      this);
 }
 
@@ -42,6 +43,9 @@ void App::run()
 		guiWindow.update();
 		glWindow.update();
 
+		// Deliver messages posted during this frame's updates
+		msg::gDispatcher.dispatchQueuedMessages();
+
 		if (!guiWindow.getWindow().isOpen() || !glWindow.getWindow().isOpen()) {
 			done = true;
 			break;
@@ -77,7 +81,12 @@ void App::process( const msg::ToggleSeatedModeMessage *message )
 	kinect.toggleSeatedMode();
 }
 
+void App::process( const msg::ToggleSensorCalibrationMessage *message )
+{
+	kinect.toggleSensorCalibration();
+}
+
 void App::process( const msg::FilterLevelSelectMessage *message )
 {
-	kinect.setSkeletonSmoothingLevel(message->level);
+	kinect.setJointFilter(message->level);
 }
@@ -22,11 +22,13 @@ public:
 	sf::Time getDeltaTime() const;
 
 	KinectDevice& getKinect();
+	const GLWindow& getGLWindow() const;
 
 	void process(const msg::QuitProgramMessage       *message);
 	void process(const msg::StartKinectDeviceMessage *message);
 	void process(const msg::StopKinectDeviceMessage  *message);
 	void process(const msg::ToggleSeatedModeMessage  *message);
+	void process(const msg::ToggleSensorCalibrationMessage *message);
 	void process(const msg::FilterLevelSelectMessage *message);
 
 private:
@@ -45,3 +47,4 @@ private:
 inline sf::Time App::getDeltaTime() const { return timer.getElapsedTime(); }
 
 inline KinectDevice& App::getKinect() { return kinect; }
+inline const GLWindow& App::getGLWindow() const { return glWindow; }
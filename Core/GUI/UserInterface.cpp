@@ -8,6 +8,7 @@
 
 #include <SFML/Graphics/RenderWindow.hpp>
 
+#include <sstream>
 #include <string>
 
 
@@ -28,6 +29,7 @@ GUI::GUI()
 	, recordStopButton(sfg::Button::Create("Stop Recording"))
 	, recordClearButton(sfg::Button::Create("Clear Recorded Keyframes"))
 	, recordExportButton(sfg::Button::Create("Export as BVH"))
+	, recordKeepButton(sfg::Button::Create("Keep Last 30 s"))
 	, playbackLabel(sfg::Label::Create("Playback Controls:"))
 	, playbackProgressBar(sfg::ProgressBar::Create())
 	, playbackFirstButton(sfg::Button::Create("<<"))
@@ -38,11 +40,17 @@ GUI::GUI()
 	, playbackLastButton(sfg::Button::Create(">>"))
 	, playbackDeltaScale(sfg::Scale::Create(0.00000111f, 0.1f, 0.0000222222f))
 	, startLayeringButton(sfg::Button::Create("Create New Layer"))
+	, findPoseButton(sfg::Button::Create("Find Live Pose"))
 	, animLayersComboBox(sfg::ComboBox::Create())
 	, mappingModesComboBox(sfg::ComboBox::Create())
+	, timeWarpCheckButton(sfg::CheckButton::Create("Time warp layer to base"))
 	, filterLevelsComboBox(sfg::ComboBox::Create())
+	, reductionLevelsComboBox(sfg::ComboBox::Create())
+	, keyPosesComboBox(sfg::ComboBox::Create())
+	, keyPosesExportButton(sfg::Button::Create("Export Preview"))
 	, infoLabel(sfg::Label::Create(""))
 	, seatedModeEnabledButton(sfg::Button::Create("Seated Mode"))
+	, calibrateSensorsButton(sfg::Button::Create("Calibrate Sensors"))
 	, liveSkeletonVisibleCheckButton(sfg::CheckButton::Create("Show Live Skeleton"))
 	, renderColorStreamCheckButton(sfg::CheckButton::Create("Show Color Stream"))
 	, renderDepthStreamCheckButton(sfg::CheckButton::Create("Show Depth Stream"))
@@ -111,6 +119,7 @@ void GUI::layoutWidgets( sf::RenderWindow& parentWindow )
 	playbackDeltaScale->SetValue(1.f / 60.f);
 	liveSkeletonVisibleCheckButton->SetActive(true);
 	renderPathCheckButton->SetActive(false);
+	timeWarpCheckButton->SetActive(false);
 	renderColorStreamCheckButton->SetActive(true);
 	renderDepthStreamCheckButton->SetActive(true);
 
@@ -124,11 +133,18 @@ void GUI::layoutWidgets( sf::RenderWindow& parentWindow )
 	//mappingModesComboBox->AppendItem("Trajectory Relative");
 	mappingModesComboBox->SelectItem(0);
 
-	filterLevelsComboBox->AppendItem("Light");
-	filterLevelsComboBox->AppendItem("Medium");
-	filterLevelsComboBox->AppendItem("Heavy");
+	filterLevelsComboBox->AppendItem("Off");
+	filterLevelsComboBox->AppendItem("One Euro");
+	filterLevelsComboBox->AppendItem("Double Exponential");
+	filterLevelsComboBox->AppendItem("Kalman");
 	filterLevelsComboBox->SelectItem(1);
 
+	reductionLevelsComboBox->AppendItem("Off");
+	reductionLevelsComboBox->AppendItem("Fine");
+	reductionLevelsComboBox->AppendItem("Medium");
+	reductionLevelsComboBox->AppendItem("Coarse");
+	reductionLevelsComboBox->SelectItem(1);
+
 	const sf::Uint32 colspan = 6;
 	table->SetColumnSpacings(2.f);
 
@@ -142,7 +158,8 @@ void GUI::layoutWidgets( sf::RenderWindow& parentWindow )
 	table->Attach(startKinectButton,    sf::Rect<sf::Uint32>(0, 3, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->Attach(stopKinectButton,     sf::Rect<sf::Uint32>(3, 3, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->SetRowSpacing(3, 5.f);
-	table->Attach(seatedModeEnabledButton,        sf::Rect<sf::Uint32>(0, 4, colspan, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(seatedModeEnabledButton,        sf::Rect<sf::Uint32>(0, 4, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(calibrateSensorsButton,         sf::Rect<sf::Uint32>(3, 4, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->SetRowSpacing(4, 5.f);
 	table->Attach(liveSkeletonVisibleCheckButton, sf::Rect<sf::Uint32>(0, 5, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 8.f));
 
@@ -151,83 +168,93 @@ void GUI::layoutWidgets( sf::RenderWindow& parentWindow )
 	table->Attach(recordingLabel,      sf::Rect<sf::Uint32>(0,  6, colspan    , 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 8.f));
 	table->Attach(animLayersComboBox,  sf::Rect<sf::Uint32>(0,  7, colspan    , 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->SetRowSpacing(7, 2.5f);
-	table->Attach(recordExportButton,  sf::Rect<sf::Uint32>(0,  8, colspan    , 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(recordExportButton,  sf::Rect<sf::Uint32>(0,  8, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(recordKeepButton,    sf::Rect<sf::Uint32>(3,  8, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->SetRowSpacing(8, 5.f);
 	table->Attach(recordStartButton,   sf::Rect<sf::Uint32>(0,  9, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->Attach(recordStopButton,    sf::Rect<sf::Uint32>(3,  9, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->SetRowSpacing(9, 2.5f);
 	table->Attach(recordClearButton,   sf::Rect<sf::Uint32>(0, 10, colspan,     1), sfg::Table::FILL, sfg::Table::FILL);
 	table->SetRowSpacing(10, 2.5f);
-	table->Attach(startLayeringButton, sf::Rect<sf::Uint32>(0, 11, colspan    , 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(startLayeringButton, sf::Rect<sf::Uint32>(0, 11, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(findPoseButton,      sf::Rect<sf::Uint32>(3, 11, colspan / 2, 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->SetRowSpacing(11, 2.5f);
 	table->Attach(sfg::Label::Create("Filtering:"), sf::Rect<sf::Uint32>(0, 12,           2, 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->Attach(filterLevelsComboBox,             sf::Rect<sf::Uint32>(2, 12, colspan - 2, 1), sfg::Table::FILL, sfg::Table::FILL);
 	table->SetRowSpacing(12, 2.5f);
-	table->Attach(sfg::Label::Create("Mapping:"), sf::Rect<sf::Uint32>(0, 13,           2, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(mappingModesComboBox,           sf::Rect<sf::Uint32>(2, 13, colspan - 2, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(sfg::Label::Create("Reduction:"), sf::Rect<sf::Uint32>(0, 13,           2, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(reductionLevelsComboBox,          sf::Rect<sf::Uint32>(2, 13, colspan - 2, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->SetRowSpacing(13, 2.5f);
+	table->Attach(sfg::Label::Create("Mapping:"), sf::Rect<sf::Uint32>(0, 14,           2, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(mappingModesComboBox,           sf::Rect<sf::Uint32>(2, 14, colspan - 2, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->SetRowSpacing(14, 2.5f);
+	table->Attach(timeWarpCheckButton, sf::Rect<sf::Uint32>(0, 15, colspan, 1), sfg::Table::FILL, sfg::Table::FILL);
+
+	table->Attach(keyPosesComboBox,     sf::Rect<sf::Uint32>(0, 16, colspan - 2, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(keyPosesExportButton, sf::Rect<sf::Uint32>(4, 16,           2, 1), sfg::Table::FILL, sfg::Table::FILL);
 
 	playbackLabel->SetAlignment(sf::Vector2f(0.f, 0.75f));
-	table->Attach(playbackLabel,       sf::Rect<sf::Uint32>(0, 14, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 8.));
-	table->Attach(playbackProgressBar, sf::Rect<sf::Uint32>(0, 15, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 10.f));
-	table->SetRowSpacing(15, 5.f);
-	table->Attach(playbackFirstButton,    sf::Rect<sf::Uint32>(0, 16, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(playbackPreviousButton, sf::Rect<sf::Uint32>(1, 16, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(playbackStopButton,     sf::Rect<sf::Uint32>(2, 16, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(playbackStartButton,    sf::Rect<sf::Uint32>(3, 16, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(playbackNextButton,     sf::Rect<sf::Uint32>(4, 16, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(playbackLastButton,     sf::Rect<sf::Uint32>(5, 16, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->SetRowSpacing(16, 5.f);
+	table->Attach(playbackLabel,       sf::Rect<sf::Uint32>(0, 17, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 8.));
+	table->Attach(playbackProgressBar, sf::Rect<sf::Uint32>(0, 18, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 10.f));
+	table->SetRowSpacing(18, 5.f);
+	table->Attach(playbackFirstButton,    sf::Rect<sf::Uint32>(0, 19, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(playbackPreviousButton, sf::Rect<sf::Uint32>(1, 19, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(playbackStopButton,     sf::Rect<sf::Uint32>(2, 19, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(playbackStartButton,    sf::Rect<sf::Uint32>(3, 19, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(playbackNextButton,     sf::Rect<sf::Uint32>(4, 19, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(playbackLastButton,     sf::Rect<sf::Uint32>(5, 19, 1, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->SetRowSpacing(19, 5.f);
 	sfg::Label::Ptr deltaScaleLabel(sfg::Label::Create("Delta"));
-	table->Attach(deltaScaleLabel,    sf::Rect<sf::Uint32>(0, 17,           2, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 2.f));
-	table->Attach(playbackDeltaScale, sf::Rect<sf::Uint32>(2, 17, colspan - 2, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 2.f));
+	table->Attach(deltaScaleLabel,    sf::Rect<sf::Uint32>(0, 20,           2, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 2.f));
+	table->Attach(playbackDeltaScale, sf::Rect<sf::Uint32>(2, 20, colspan - 2, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 2.f));
 
 
-	table->SetRowSpacing(17, 20.f);
+	table->SetRowSpacing(20, 20.f);
 	sfg::Label::Ptr boneMaskLabel = sfg::Label::Create("Bone Mask:");
 	boneMaskLabel->SetAlignment(sf::Vector2f(0.f, 0.75f));
-	table->Attach(boneMaskLabel, sf::Rect<sf::Uint32>(0, 18, 2, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 2.f));
+	table->Attach(boneMaskLabel, sf::Rect<sf::Uint32>(0, 21, 2, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 2.f));
 
 	table->SetColumnSpacing(1, 5.f);
 	table->SetColumnSpacing(3, 5.f);
-	table->Attach(sfg::Label::Create("Left"),  sf::Rect<sf::Uint32>(0, 19, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(headToggleButton,            sf::Rect<sf::Uint32>(2, 19, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(sfg::Label::Create("Right"), sf::Rect<sf::Uint32>(4, 19, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-
-	table->SetRowSpacing(19, 5.f);
-	table->Attach(shoulderCenterToggleButton, sf::Rect<sf::Uint32>(2, 20, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(spineToggleButton,          sf::Rect<sf::Uint32>(2, 23, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(hipCenterToggleButton,      sf::Rect<sf::Uint32>(2, 24, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-
-	table->Attach(shoulderLeftToggleButton,   sf::Rect<sf::Uint32>(0, 20, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(elbowLeftToggleButton,      sf::Rect<sf::Uint32>(0, 21, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(wristLeftToggleButton,      sf::Rect<sf::Uint32>(0, 22, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(handLeftToggleButton,       sf::Rect<sf::Uint32>(0, 23, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-
-	table->Attach(shoulderRightToggleButton,  sf::Rect<sf::Uint32>(4, 20, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(elbowRightToggleButton,     sf::Rect<sf::Uint32>(4, 21, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(wristRightToggleButton,     sf::Rect<sf::Uint32>(4, 22, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(handRightToggleButton,      sf::Rect<sf::Uint32>(4, 23, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-
-	table->SetRowSpacing(23, 10.f);
-	table->Attach(hipLeftToggleButton,        sf::Rect<sf::Uint32>(0, 24, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(kneeLeftToggleButton,       sf::Rect<sf::Uint32>(0, 25, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(ankleLeftToggleButton,      sf::Rect<sf::Uint32>(0, 26, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(footLeftToggleButton,       sf::Rect<sf::Uint32>(0, 27, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-
-	table->Attach(hipRightToggleButton,       sf::Rect<sf::Uint32>(4, 24, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(kneeRightToggleButton,      sf::Rect<sf::Uint32>(4, 25, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(ankleRightToggleButton,     sf::Rect<sf::Uint32>(4, 26, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-	table->Attach(footRightToggleButton,      sf::Rect<sf::Uint32>(4, 27, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
-
-	table->SetRowSpacing(27, 5.f);
-	table->Attach(renderPathCheckButton, sf::Rect<sf::Uint32>(0, 28, colspan, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(sfg::Label::Create("Left"),  sf::Rect<sf::Uint32>(0, 22, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(headToggleButton,            sf::Rect<sf::Uint32>(2, 22, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(sfg::Label::Create("Right"), sf::Rect<sf::Uint32>(4, 22, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+
+	table->SetRowSpacing(22, 5.f);
+	table->Attach(shoulderCenterToggleButton, sf::Rect<sf::Uint32>(2, 23, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(spineToggleButton,          sf::Rect<sf::Uint32>(2, 26, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(hipCenterToggleButton,      sf::Rect<sf::Uint32>(2, 27, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+
+	table->Attach(shoulderLeftToggleButton,   sf::Rect<sf::Uint32>(0, 23, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(elbowLeftToggleButton,      sf::Rect<sf::Uint32>(0, 24, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(wristLeftToggleButton,      sf::Rect<sf::Uint32>(0, 25, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(handLeftToggleButton,       sf::Rect<sf::Uint32>(0, 26, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+
+	table->Attach(shoulderRightToggleButton,  sf::Rect<sf::Uint32>(4, 23, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(elbowRightToggleButton,     sf::Rect<sf::Uint32>(4, 24, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(wristRightToggleButton,     sf::Rect<sf::Uint32>(4, 25, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(handRightToggleButton,      sf::Rect<sf::Uint32>(4, 26, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+
+	table->SetRowSpacing(26, 10.f);
+	table->Attach(hipLeftToggleButton,        sf::Rect<sf::Uint32>(0, 27, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(kneeLeftToggleButton,       sf::Rect<sf::Uint32>(0, 28, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(ankleLeftToggleButton,      sf::Rect<sf::Uint32>(0, 29, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(footLeftToggleButton,       sf::Rect<sf::Uint32>(0, 30, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+
+	table->Attach(hipRightToggleButton,       sf::Rect<sf::Uint32>(4, 27, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(kneeRightToggleButton,      sf::Rect<sf::Uint32>(4, 28, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(ankleRightToggleButton,     sf::Rect<sf::Uint32>(4, 29, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+	table->Attach(footRightToggleButton,      sf::Rect<sf::Uint32>(4, 30, colspan/3, 1), sfg::Table::FILL, sfg::Table::FILL);
+
+	table->SetRowSpacing(30, 5.f);
+	table->Attach(renderPathCheckButton, sf::Rect<sf::Uint32>(0, 31, colspan, 1), sfg::Table::FILL, sfg::Table::FILL);
 
 	infoLabel->SetAlignment(sf::Vector2f(0.f, 0.5f));
-	table->Attach(infoLabel, sf::Rect<sf::Uint32>(0, 29, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 10.f));
+	table->Attach(infoLabel, sf::Rect<sf::Uint32>(0, 32, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 10.f));
 
-	//table->SetRowSpacing(30, 1.f);
-	table->Attach(renderColorStreamCheckButton, sf::Rect<sf::Uint32>(0, 30, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 8.f));
-	table->Attach(renderDepthStreamCheckButton, sf::Rect<sf::Uint32>(0, 31, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 8.f));
+	//table->SetRowSpacing(33, 1.f);
+	table->Attach(renderColorStreamCheckButton, sf::Rect<sf::Uint32>(0, 33, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 8.f));
+	table->Attach(renderDepthStreamCheckButton, sf::Rect<sf::Uint32>(0, 34, colspan, 1), sfg::Table::FILL, sfg::Table::FILL, sf::Vector2f(0.f, 8.f));
 
 	window->SetTitle("Kinected Acting");
 	window->SetRequisition(winsize);
@@ -247,8 +274,10 @@ void GUI::connectSignals()
 	recordStopButton  ->GetSignal(sfg::Button::OnLeftClick).Connect(&GUI::onRecordStopButtonClick,   this);
 	recordClearButton ->GetSignal(sfg::Button::OnLeftClick).Connect(&GUI::onRecordClearButtonClick,  this);
 	recordExportButton->GetSignal(sfg::Button::OnLeftClick).Connect(&GUI::onRecordExportButtonClick, this);
+	recordKeepButton  ->GetSignal(sfg::Button::OnLeftClick).Connect(&GUI::onRecordKeepButtonClick,   this);
 
 	seatedModeEnabledButton       ->GetSignal(sfg::Button::OnLeftClick).Connect(&GUI::onSeatedModeEnabledButtonClick, this);
+	calibrateSensorsButton        ->GetSignal(sfg::Button::OnLeftClick).Connect(&GUI::onCalibrateSensorsButtonClick,  this);
 	liveSkeletonVisibleCheckButton->GetSignal(sfg::CheckButton::OnLeftClick).Connect(&GUI::onLiveSkeletonVisibleCheckButtonClick, this);
 	renderColorStreamCheckButton  ->GetSignal(sfg::CheckButton::OnLeftClick).Connect(&GUI::onRenderColorStreamCheckButtonClick,   this);
 	renderDepthStreamCheckButton  ->GetSignal(sfg::CheckButton::OnLeftClick).Connect(&GUI::onRenderDepthStreamCheckButtonClick,   this);
@@ -264,9 +293,14 @@ void GUI::connectSignals()
 	playbackDeltaScale    ->GetSignal(sfg::Scale::OnLeftClick ).Connect(&GUI::onPlaybackDeltaScaleClick,     this);
 
 	startLayeringButton ->GetSignal(sfg::Button::OnLeftClick ).Connect(&GUI::onStartLayeringButtonClick,     this);
+	findPoseButton      ->GetSignal(sfg::Button::OnLeftClick ).Connect(&GUI::onFindPoseButtonClick,          this);
 	animLayersComboBox  ->GetSignal(sfg::ComboBox::OnSelect  ).Connect(&GUI::onAnimLayersComboBoxSelect,     this);
 	mappingModesComboBox->GetSignal(sfg::ComboBox::OnSelect  ).Connect(&GUI::onMappingModeComboBoxSelect,    this);
+	timeWarpCheckButton ->GetSignal(sfg::CheckButton::OnLeftClick).Connect(&GUI::onTimeWarpCheckButtonClick, this);
 	filterLevelsComboBox->GetSignal(sfg::ComboBox::OnSelect  ).Connect(&GUI::onFilteringLevelComboBoxSelect, this);
+	reductionLevelsComboBox->GetSignal(sfg::ComboBox::OnSelect).Connect(&GUI::onReductionLevelComboBoxSelect, this);
+	keyPosesComboBox    ->GetSignal(sfg::ComboBox::OnSelect  ).Connect(&GUI::onKeyPosesComboBoxSelect,       this);
+	keyPosesExportButton->GetSignal(sfg::Button::OnLeftClick ).Connect(&GUI::onKeyPosesExportButtonClick,    this);
 
 	headToggleButton          ->GetSignal(sfg::ToggleButton::OnLeftClick).Connect(&GUI::onBoneMaskToggleButtonClick, this);
 	shoulderCenterToggleButton->GetSignal(sfg::ToggleButton::OnLeftClick).Connect(&GUI::onBoneMaskToggleButtonClick, this);
@@ -337,6 +371,22 @@ void GUI::appendLayerItem( const std::string& text )
 	animLayersComboBox->SelectItem(index - 1);
 }
 
+void GUI::setKeyPoseItems( const std::vector<float>& times )
+{
+	while (keyPosesComboBox->GetItemCount() > 0) {
+		keyPosesComboBox->RemoveItem(0);
+	}
+
+	std::ostringstream text;
+	text.setf(std::ios::fixed);
+	text.precision(1);
+	for (size_t i = 0; i < times.size(); ++i) {
+		text.str("");
+		text << "Key pose " << (i + 1) << " at " << times[i] << " s";
+		keyPosesComboBox->AppendItem(text.str());
+	}
+}
+
 void GUI::onRecordStartButtonClick()
 {
 	msg::gDispatcher.dispatchMessage(msg::StartRecordingMessage());
@@ -357,11 +407,22 @@ void GUI::onRecordExportButtonClick()
 	msg::gDispatcher.dispatchMessage(msg::ExportSkeletonBVHMessage());
 }
 
+void GUI::onRecordKeepButtonClick()
+{
+	// Matches the button text
+	msg::gDispatcher.dispatchMessage(msg::KeepRollingCaptureMessage(30.f));
+}
+
 void GUI::onSeatedModeEnabledButtonClick()
 {
 	msg::gDispatcher.dispatchMessage(msg::ToggleSeatedModeMessage());
 }
 
+void GUI::onCalibrateSensorsButtonClick()
+{
+	msg::gDispatcher.dispatchMessage(msg::ToggleSensorCalibrationMessage());
+}
+
 void GUI::onLiveSkeletonVisibleCheckButtonClick()
 {
 	const bool active = liveSkeletonVisibleCheckButton->IsActive();
@@ -438,6 +499,11 @@ void GUI::onStartLayeringButtonClick()
 	msg::gDispatcher.dispatchMessage(msg::StartLayeringMessage());
 }
 
+void GUI::onFindPoseButtonClick()
+{
+	msg::gDispatcher.dispatchMessage(msg::FindLivePoseMessage());
+}
+
 void GUI::onAnimLayersComboBoxSelect()
 {
 	const std::string layerName = animLayersComboBox->GetSelectedText();
@@ -450,12 +516,38 @@ void GUI::onMappingModeComboBoxSelect()
 	msg::gDispatcher.dispatchMessage(msg::MappingModeSelectMessage(mode));
 }
 
+void GUI::onTimeWarpCheckButtonClick()
+{
+	const bool active = timeWarpCheckButton->IsActive();
+	if (active) {
+		msg::gDispatcher.dispatchMessage(msg::EnableTimeWarpMessage());
+	} else {
+		msg::gDispatcher.dispatchMessage(msg::DisableTimeWarpMessage());
+	}
+}
+
 void GUI::onFilteringLevelComboBoxSelect()
 {
 	const std::string level = filterLevelsComboBox->GetSelectedText();
 	msg::gDispatcher.dispatchMessage(msg::FilterLevelSelectMessage(level));
 }
 
+void GUI::onReductionLevelComboBoxSelect()
+{
+	const std::string level = reductionLevelsComboBox->GetSelectedText();
+	msg::gDispatcher.dispatchMessage(msg::ReductionLevelSelectMessage(level));
+}
+
+void GUI::onKeyPosesComboBoxSelect()
+{
+	msg::gDispatcher.dispatchMessage(msg::KeyPoseSelectMessage(keyPosesComboBox->GetSelectedItem()));
+}
+
+void GUI::onKeyPosesExportButtonClick()
+{
+	msg::gDispatcher.dispatchMessage(msg::ExportKeyPosesMessage());
+}
+
 void GUI::onRenderPathCheckButtonClick()
 {
 	const bool active = renderPathCheckButton->IsActive();
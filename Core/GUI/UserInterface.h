@@ -4,6 +4,8 @@
 #include <SFML/Window/Event.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 
+#include <vector>
+
 
 class GUI
 {
@@ -22,6 +24,7 @@ public: // External interface
 	void setInfoLabel(const std::string& text);
 	void setProgressFraction(const float fraction);
 	void appendLayerItem(const std::string& text);
+	void setKeyPoseItems(const std::vector<float>& times);
 
 	bool isLiveSkeletonVisible() const;
 
@@ -37,7 +40,9 @@ private:
 	void onRecordStopButtonClick();
 	void onRecordClearButtonClick();
 	void onRecordExportButtonClick();
+	void onRecordKeepButtonClick();
 	void onSeatedModeEnabledButtonClick();
+	void onCalibrateSensorsButtonClick();
 	void onLiveSkeletonVisibleCheckButtonClick();
 	void onRenderColorStreamCheckButtonClick();
 	void onRenderDepthStreamCheckButtonClick();
@@ -50,9 +55,14 @@ private:
 	void onPlaybackLastButtonClick();
 	void onPlaybackDeltaScaleClick();
 	void onStartLayeringButtonClick();
+	void onFindPoseButtonClick();
 	void onAnimLayersComboBoxSelect();
 	void onMappingModeComboBoxSelect();
+	void onTimeWarpCheckButtonClick();
 	void onFilteringLevelComboBoxSelect();
+	void onReductionLevelComboBoxSelect();
+	void onKeyPosesComboBoxSelect();
+	void onKeyPosesExportButtonClick();
 	void onRenderPathCheckButtonClick();
 	void onBoneMaskToggleButtonClick();
 
@@ -72,6 +82,7 @@ private:
 	sfg::Button::Ptr stopKinectButton;
 
 	sfg::Button::Ptr seatedModeEnabledButton;
+	sfg::Button::Ptr calibrateSensorsButton;
 	sfg::CheckButton::Ptr liveSkeletonVisibleCheckButton;
 	sfg::CheckButton::Ptr renderColorStreamCheckButton;
 	sfg::CheckButton::Ptr renderDepthStreamCheckButton;
@@ -81,6 +92,7 @@ private:
 	sfg::Button::Ptr recordStopButton;
 	sfg::Button::Ptr recordClearButton;
 	sfg::Button::Ptr recordExportButton;
+	sfg::Button::Ptr recordKeepButton;
 
 	sfg::Label::Ptr playbackLabel;
 	sfg::ProgressBar::Ptr playbackProgressBar;
@@ -93,9 +105,14 @@ private:
 	sfg::Scale::Ptr playbackDeltaScale;
 
 	sfg::Button::Ptr startLayeringButton;
+	sfg::Button::Ptr findPoseButton;
 	sfg::ComboBox::Ptr animLayersComboBox;
 	sfg::ComboBox::Ptr mappingModesComboBox;
+	sfg::CheckButton::Ptr timeWarpCheckButton;
 	sfg::ComboBox::Ptr filterLevelsComboBox;
+	sfg::ComboBox::Ptr reductionLevelsComboBox;
+	sfg::ComboBox::Ptr keyPosesComboBox;
+	sfg::Button::Ptr keyPosesExportButton;
 
 	sfg::CheckButton::Ptr renderPathCheckButton;
 
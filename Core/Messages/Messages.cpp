@@ -2,3 +2,93 @@
 
 
 msg::Dispatcher msg::gDispatcher;
+
+namespace
+{
+	const unsigned long long node_index_mask = 0xFFFFFFFFull;
+	const unsigned long long node_pop_count  = 0x100000000ull;
+}
+
+
+msg::Dispatcher::Dispatcher()
+	: queueHead(nullptr)
+	, queueTail(nullptr)
+	, freeNodes(0)
+{
+	// Every pool node starts out free, linked in order, node_pool_size ends the list
+	for (unsigned int i = 0; i < node_pool_size; ++i) {
+		nextFreeNode[i].store(i + 1);
+	}
+
+	for (int type = 0; type < NUM_MESSAGE_TYPES; ++type) {
+		latestStatus[type].store(nullptr);
+	}
+
+	QueuedMessage *stub = new (allocateNode()) QueuedMessage();
+	queueHead.store(stub);
+	queueTail = stub;
+}
+
+msg::Dispatcher::~Dispatcher()
+{
+	while (nullptr != queueTail) {
+		QueuedMessage *next = queueTail->next.load();
+		releaseNode(queueTail);
+		queueTail = next;
+	}
+}
+
+void *msg::Dispatcher::allocateNode()
+{
+	unsigned long long head = freeNodes.load(std::memory_order_acquire);
+	for (;;) {
+		const unsigned int index = static_cast<unsigned int>(head & node_index_mask);
+		if (index >= node_pool_size) {
+			// More messages pending than the pool holds
+			return ::operator new(node_size);
+		}
+
+		const unsigned long long next = ((head & ~node_index_mask) + node_pop_count)
+		                              | nextFreeNode[index].load(std::memory_order_relaxed);
+		if (freeNodes.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+			return &nodePool[index];
+		}
+	}
+}
+
+void msg::Dispatcher::releaseNode(QueuedMessage *node)
+{
+	node->~QueuedMessage();
+
+	const char *address   = reinterpret_cast<const char*>(node);
+	const char *poolBegin = reinterpret_cast<const char*>(nodePool);
+	if (address < poolBegin || address >= poolBegin + sizeof(nodePool)) {
+		::operator delete(node);
+		return;
+	}
+
+	const unsigned int index = static_cast<unsigned int>((address - poolBegin) / sizeof(nodePool[0]));
+	unsigned long long head = freeNodes.load(std::memory_order_relaxed);
+	unsigned long long next;
+	do {
+		nextFreeNode[index].store(static_cast<unsigned int>(head & node_index_mask), std::memory_order_relaxed);
+		next = (head & ~node_index_mask) | index;
+	} while (!freeNodes.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void msg::Dispatcher::dispatchQueuedMessages()
+{
+	// Drain the queue, a producer that is midway through a post
+	// may hide messages behind it until the next frame
+	QueuedMessage *next = queueTail->next.load(std::memory_order_acquire);
+	while (nullptr != next) {
+		releaseNode(queueTail);
+		queueTail = next;
+
+		// A status message only goes out if no later one of its type was posted
+		if (!isStatusMessage(next->type) || latestStatus[next->type].load(std::memory_order_acquire) == next) {
+			next->dispatch(*this);
+		}
+		next = queueTail->next.load(std::memory_order_acquire);
+	}
+}
@@ -2,7 +2,11 @@
 
 #include "Animation/AnimationTypes.h"
 
-#include <map>
+#include <atomic>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 
 namespace msg
@@ -32,6 +36,7 @@ namespace msg
 		, SHOW_DEPTH_STREAM
 		, HIDE_DEPTH_STREAM
 		, TOGGLE_SEATED_MODE
+		, TOGGLE_SENSOR_CALIBRATION
 		// Skeleton recording controls
 		, START_SKELETON_RECORDING
 		, STOP_SKELETON_RECORDING
@@ -39,6 +44,7 @@ namespace msg
 		, SAVE_SKELETON_RECORDING
 		, LOAD_SKELETON_RECORDING
 		, EXPORT_SKELETON_BVH
+		, KEEP_ROLLING_CAPTURE
 		, SET_RECORDING_LABEL
 		// Skeleton playback controls
 		, PLAYBACK_START
@@ -54,14 +60,33 @@ namespace msg
 		, LAYER_SELECT
 		, ADD_LAYER_ITEM
 		, FILTER_LEVEL_SELECT
+		, REDUCTION_LEVEL_SELECT
 		, MAPPING_MODE_SELECT
+		, ENABLE_TIME_WARP
+		, DISABLE_TIME_WARP
 		// Misc
 		, SET_INFO_LABEL
 		, SHOW_BONE_PATH
 		, HIDE_BONE_PATH
 		, UPDATE_BONE_MASK
+		, FIND_LIVE_POSE
+		, SET_KEY_POSES
+		, KEY_POSE_SELECT
+		, EXPORT_KEY_POSES
+		// Number of message types, not a message
+		, NUM_MESSAGE_TYPES
 	};
 
+	// Per-frame status messages, when posted only the most recent value
+	// of each of these is delivered by Dispatcher::dispatchQueuedMessages(),
+	// in the position it was posted
+	inline bool isStatusMessage(EType type)
+	{
+		return type == SET_RECORDING_LABEL
+		    || type == SET_INFO_LABEL
+		    || type == PLAYBACK_SET_PROGRESS;
+	}
+
 	// ------------------------------------------------------------------------
 	// Base Message Class -----------------------------------------------------
 	// ------------------------------------------------------------------------
@@ -114,6 +139,16 @@ namespace msg
 	public: ExportSkeletonBVHMessage() : Message(EXPORT_SKELETON_BVH) {}
 	};
 	// ------------------------------------------------------------------------
+	class KeepRollingCaptureMessage : public Message
+	{
+	public:
+		KeepRollingCaptureMessage(const float seconds)
+			: Message(KEEP_ROLLING_CAPTURE)
+			, seconds(seconds)
+		{}
+		const float seconds;
+	};
+	// ------------------------------------------------------------------------
 	class SetRecordingLabelMessage : public Message
 	{
 	public:
@@ -159,6 +194,11 @@ namespace msg
 	public: ToggleSeatedModeMessage() : Message(TOGGLE_SEATED_MODE) {}
 	};
 	// ------------------------------------------------------------------------
+	class ToggleSensorCalibrationMessage : public Message
+	{
+	public: ToggleSensorCalibrationMessage() : Message(TOGGLE_SENSOR_CALIBRATION) {}
+	};
+	// ------------------------------------------------------------------------
 	class PlaybackFirstFrameMessage : public Message
 	{
 	public: PlaybackFirstFrameMessage() : Message(PLAYBACK_FIRST_FRAME) {}
@@ -234,6 +274,16 @@ namespace msg
 		const unsigned int mode;
 	};
 	// ------------------------------------------------------------------------
+	class EnableTimeWarpMessage : public Message
+	{
+	public: EnableTimeWarpMessage() : Message(ENABLE_TIME_WARP) {}
+	};
+	// ------------------------------------------------------------------------
+	class DisableTimeWarpMessage : public Message
+	{
+	public: DisableTimeWarpMessage() : Message(DISABLE_TIME_WARP) {}
+	};
+	// ------------------------------------------------------------------------
 	class FilterLevelSelectMessage : public Message
 	{
 	public:
@@ -244,6 +294,16 @@ namespace msg
 		const std::string level;
 	};
 	// ------------------------------------------------------------------------
+	class ReductionLevelSelectMessage : public Message
+	{
+	public:
+		ReductionLevelSelectMessage(const std::string& level)
+			: Message(REDUCTION_LEVEL_SELECT)
+			, level(level)
+		{}
+		const std::string level;
+	};
+	// ------------------------------------------------------------------------
 	class SetInfoLabelMessage : public Message
 	{
 	public:
@@ -284,6 +344,36 @@ namespace msg
 		const BoneMask boneMask;
 	};
 	// ------------------------------------------------------------------------
+	class FindLivePoseMessage : public Message
+	{
+	public: FindLivePoseMessage() : Message(FIND_LIVE_POSE) {}
+	};
+	// ------------------------------------------------------------------------
+	class SetKeyPosesMessage : public Message
+	{
+	public:
+		SetKeyPosesMessage(const std::vector<float>& times)
+			: Message(SET_KEY_POSES)
+			, times(times)
+		{}
+		const std::vector<float> times;
+	};
+	// ------------------------------------------------------------------------
+	class KeyPoseSelectMessage : public Message
+	{
+	public:
+		KeyPoseSelectMessage(const int index)
+			: Message(KEY_POSE_SELECT)
+			, index(index)
+		{}
+		const int index;
+	};
+	// ------------------------------------------------------------------------
+	class ExportKeyPosesMessage : public Message
+	{
+	public: ExportKeyPosesMessage() : Message(EXPORT_KEY_POSES) {}
+	};
+	// ------------------------------------------------------------------------
 	//class Message : public Message
 	//{
 	//public: Message() : Message() {}
@@ -306,6 +396,7 @@ namespace msg
 		virtual void process(const StopRecordingMessage     *message) {}
 		virtual void process(const ClearRecordingMessage    *message) {}
 		virtual void process(const ExportSkeletonBVHMessage *message) {}
+		virtual void process(const KeepRollingCaptureMessage *message) {}
 		virtual void process(const SetRecordingLabelMessage *message) {}
 		virtual void process(const ShowLiveSkeletonMessage  *message) {}
 		virtual void process(const HideLiveSkeletonMessage  *message) {}
@@ -314,6 +405,7 @@ namespace msg
 		virtual void process(const ShowDepthStreamMessage   *message) {}
 		virtual void process(const HideDepthStreamMessage   *message) {}
 		virtual void process(const ToggleSeatedModeMessage  *message) {}
+		virtual void process(const ToggleSensorCalibrationMessage *message) {}
 		virtual void process(const PlaybackFirstFrameMessage *message) {}
 		virtual void process(const PlaybackLastFrameMessage  *message) {}
 		virtual void process(const PlaybackNextFrameMessage  *message) {}
@@ -326,11 +418,45 @@ namespace msg
 		virtual void process(const LayerSelectMessage         *message) {}
 		virtual void process(const AddLayerItemMessage        *message) {}
 		virtual void process(const MappingModeSelectMessage   *message) {}
+		virtual void process(const EnableTimeWarpMessage      *message) {}
+		virtual void process(const DisableTimeWarpMessage     *message) {}
 		virtual void process(const FilterLevelSelectMessage   *message) {}
+		virtual void process(const ReductionLevelSelectMessage *message) {}
 		virtual void process(const SetInfoLabelMessage        *message) {}
 		virtual void process(const ShowBonePathMessage        *message) {}
 		virtual void process(const HideBonePathMessage        *message) {}
 		virtual void process(const UpdateBoneMaskMessage      *message) {}
+		virtual void process(const FindLivePoseMessage        *message) {}
+		virtual void process(const SetKeyPosesMessage         *message) {}
+		virtual void process(const KeyPoseSelectMessage       *message) {}
+		virtual void process(const ExportKeyPosesMessage      *message) {}
+	};
+
+
+	// ------------------------------------------------------------------------
+
+
+	// Node in the dispatcher's posted message queue,
+	// holds a copy of a message posted from any thread until it is dispatched
+	class QueuedMessage
+	{
+	public:
+		explicit QueuedMessage(EType type = NUM_MESSAGE_TYPES) : next(nullptr), type(type) {}
+		virtual ~QueuedMessage() {}
+		virtual void dispatch(Dispatcher& dispatcher) const {}
+
+		std::atomic<QueuedMessage*> next;
+		const EType type;
+	};
+
+	template<class MsgType>
+	class TypedQueuedMessage : public QueuedMessage
+	{
+	public:
+		explicit TypedQueuedMessage(const MsgType& msg) : QueuedMessage(msg.type()), msg(msg) {}
+		void dispatch(Dispatcher& dispatcher) const;
+
+		const MsgType msg;
 	};
 
 
@@ -340,23 +466,82 @@ namespace msg
 	class Dispatcher
 	{
 	public:
+		Dispatcher();
+		~Dispatcher();
+
 		void registerHandler(EType type, Handler* handler)
 		{
-			handlers.insert(std::make_pair(type, handler));
+			handlers[type].push_back(handler);
 		}
 
+		// Immediately process msg with every handler registered for its type,
+		// main thread only
 		template<class MsgType> inline void dispatchMessage(const MsgType& msg)
 		{
-			auto range = handlers.equal_range(msg.type());
-
-			for (auto it = range.first; it != range.second; ++it) {
-				Handler *handler = (*it).second;
-				handler->process(&msg);
+			const std::vector<Handler*>& typeHandlers = handlers[msg.type()];
+			for (size_t i = 0; i < typeHandlers.size(); ++i) {
+				typeHandlers[i]->process(&msg);
 			}
 		}
 
+		// Queue msg for the next dispatchQueuedMessages(), safe to call from any thread
+		// A status message supersedes any pending message of the same type,
+		// which is then dropped rather than dispatched
+		template<class MsgType> inline void postMessage(const MsgType& msg);
+
+		// Dispatch posted messages in the order they were posted, skipping
+		// superseded status messages, main thread only, once per frame
+		void dispatchQueuedMessages();
+
 	private:
-		std::multimap<EType, Handler*> handlers;
+		Dispatcher(const Dispatcher&);
+		Dispatcher& operator=(const Dispatcher&);
+
+		// Queue nodes come from a fixed pool, the heap is only used once it runs out
+		enum { node_size = 128, node_pool_size = 256 };
+
+		void *allocateNode();
+		void releaseNode(QueuedMessage *node);
+
+		std::vector<Handler*> handlers[NUM_MESSAGE_TYPES];
+
+		// Lock-free multiple producer, single consumer queue
+		// Producers exchange the head, the consumer owns the tail which is
+		// always the last message dispatched (or the initial stub)
+		std::atomic<QueuedMessage*> queueHead;
+		QueuedMessage *queueTail;
+
+		// Latest posted message of each status message type, only compared, never dereferenced
+		std::atomic<QueuedMessage*> latestStatus[NUM_MESSAGE_TYPES];
+
+		// Free list of pool nodes, popped by producers and pushed by the consumer
+		// The head packs a pop count above the node index so a node that was
+		// popped and pushed back meanwhile can't be mistaken for the same head
+		std::aligned_storage<node_size, 16>::type nodePool[node_pool_size];
+		std::atomic<unsigned int> nextFreeNode[node_pool_size];
+		std::atomic<unsigned long long> freeNodes;
 	};
 
+
+	template<class MsgType>
+	inline void TypedQueuedMessage<MsgType>::dispatch(Dispatcher& dispatcher) const
+	{
+		dispatcher.dispatchMessage(msg);
+	}
+
+	template<class MsgType>
+	inline void Dispatcher::postMessage(const MsgType& msg)
+	{
+		static_assert(sizeof(TypedQueuedMessage<MsgType>) <= node_size, "Message too large for a dispatcher queue node");
+		QueuedMessage *message = new (allocateNode()) TypedQueuedMessage<MsgType>(msg);
+
+		// Marked latest before it is queued, so the consumer never skips it for an older one
+		if (isStatusMessage(msg.type())) {
+			latestStatus[msg.type()].store(message, std::memory_order_release);
+		}
+
+		QueuedMessage *prev = queueHead.exchange(message, std::memory_order_acq_rel);
+		prev->next.store(message, std::memory_order_release);
+	}
+
 } // end namespace Messages
@@ -5,6 +5,7 @@
 #include "Core/Messages/Messages.h"
 #include "Kinect/KinectDevice.h"
 #include "Scene/Camera.h"
+#include "Scene/DepthPointCloud.h"
 #include "Shaders/Shader.h"
 #include "Shaders/Program.h"
 #include "Util/GLUtils.h"
@@ -13,7 +14,11 @@
 #include "Animation/BoneAnimationTrack.h"
 #include "Animation/TransformKeyFrame.h"
 #include "Animation/Recording.h"
+#include "Animation/RollingCapture.h"
+#include "Animation/ActorCapture.h"
 #include "Animation/AnimationUtils.h"
+#include "Animation/BVHExport.h"
+#include "Util/zhPrereq.h"
 
 #include <SFML/OpenGL.hpp>
 #include <SFML/Window/Event.hpp>
@@ -26,6 +31,7 @@
 
 #include <iostream>
 #include <memory>
+#include <sstream>
 
 static const int color_bits      = 32;
 static const int depth_bits      = 24;
@@ -36,15 +42,22 @@ static const int gl_minor_version = 3;
 static const int framerate_limit = 60;
 static const int initial_pos_x   = 260;
 static const int initial_pos_y   = 5;
+static const float rolling_capture_seconds = 60.f;
+static const float actor_reserve_seconds = 60.f;    // keyframes made up front for each extra actor
+static const float live_pose_seconds = 0.25f;       // live frames snapshot for a pose search
+static const float live_pose_merge_seconds = 0.5f;  // matches this close in one take are one moment
+static const size_t live_pose_moments_shown = 3;
+static const size_t live_pose_lists = 24;           // motion index lists searched, under 1 ms at 3 hours of takes
+static const float key_pose_hold_seconds = 1.f;     // each pose's slot in an exported preview
 
 static glm::vec2 mouse_pos_current;
 
 // For SFML overlays
 sf::Uint8 color_bytes[KinectDevice::color_bytes];
 sf::Sprite colorSprite;
-sf::Sprite depthSprite;
+sf::Sprite silhouetteSprite;
 sf::Texture sfColorTexture;
-sf::Texture sfDepthTexture;
+sf::Texture sfSilhouetteTexture;
 
 
 struct Light
@@ -63,6 +76,7 @@ GLWindow::GLWindow(const std::string& title, App& app)
 	, renderDepthStream(true)
 	, liveSkeletonVisible(true)
 	, bonePathsVisible(false)
+	, compareTakesVisible(false)
 	, playbackRunning(false)
 	, recording(false)
 	, layering(false)
@@ -72,15 +86,27 @@ GLWindow::GLWindow(const std::string& title, App& app)
 	, layerID(0)
 	, camera()
 	, colorTexture(nullptr)
-	, depthTexture(nullptr)
 	, gridTexture(nullptr)
 	, redTileTexture(nullptr)
-	, selectedSkeleton(nullptr)
-	, blendSkeleton(nullptr)
 	, currentRecording(nullptr)
+	, finishedRecording(nullptr)
+	, rollingCapture(nullptr)
+	, actorCapture(nullptr)
 	, recordings()
 	, boneMask(default_bone_mask)
 	, mappingMode(ELayerMappingMode::MAP_DIRECT)
+	, blendEngine()
+	, timeWarping(false)
+	, timeWarp()
+	, keyFrameReduction(true)
+	, keyFrameTolerance(0.001f, glm::radians(0.5f))
+	, poseEvaluator()
+	, poseJobs()
+	, motionIndex()
+	, motionIndexStale(true)
+	, keyPoses()
+	, keyPosesTake(nullptr)
+	, keyPoseFrames()
 {
 	const sf::Uint32 style = sf::Style::Default;
 	const sf::ContextSettings contextSettings(depth_bits, stencil_bits, antialias_level, gl_major_version, gl_minor_version);
@@ -105,14 +131,13 @@ void GLWindow::init()
 
 	loadTextures();
 
-	selectedSkeleton = std::unique_ptr<Skeleton>(new Skeleton());
-	blendSkeleton = std::unique_ptr<Skeleton>(new Skeleton());
-	blendSkeleton->render_orientations = false;
 
 	recordings["base"]  = std::unique_ptr<Recording>(new Recording("base",  app.getKinect()));
 	recordings["blend"] = std::unique_ptr<Recording>(new Recording("blend", app.getKinect()));
 
 	currentRecording = recordings["base"].get();
+	rollingCapture = std::unique_ptr<RollingCapture>(new RollingCapture(app.getKinect(), rolling_capture_seconds));
+	actorCapture = std::unique_ptr<ActorCapture>(new ActorCapture(app.getKinect(), KinectDevice::max_actors - 1, actor_reserve_seconds, true));
 
 	light0.position = glm::vec3(0,1,0);
 	light0.intensities = glm::vec3(1,1,1);
@@ -120,18 +145,19 @@ void GLWindow::init()
 	light0.ambientCoefficient = 0.01f;
 
 	sfColorTexture.create(KinectDevice::image_stream_width, KinectDevice::image_stream_height);
-	sfDepthTexture.create(KinectDevice::image_stream_width, KinectDevice::image_stream_height);
+	sfSilhouetteTexture.create(KinectDevice::image_stream_width, KinectDevice::image_stream_height);
 
 	colorSprite.setTexture(sfColorTexture);
-	depthSprite.setTexture(sfDepthTexture);
+	silhouetteSprite.setTexture(sfSilhouetteTexture);
 
 	colorSprite.setScale(0.5f, 0.5f);
-	depthSprite.setScale(0.5f, 0.5f);
+	silhouetteSprite.setScale(0.5f, 0.5f);
+	silhouetteSprite.setColor(sf::Color(0, 255, 0, 160));
 
 	colorSprite.setPosition(0, 0);
 	const float leftEdge   = (float) sf::VideoMode::getDesktopMode().width - 300;
 	const float leftOffset = KinectDevice::image_stream_width / 2.f;
-	depthSprite.setPosition(leftEdge - leftOffset, 0);
+	silhouetteSprite.setPosition(leftEdge - leftOffset, 0);
 }
 
 void GLWindow::update()
@@ -141,29 +167,34 @@ void GLWindow::update()
 	updateCamera();
 	updateTextures();
 
-	updateRecording();
-	updatePlayback();
+	rollingCapture->update();
+	actorCapture->update(app.getDeltaTime().asSeconds());
+	const Recording *captured = updateRecording();
 
 	static float dt = 0.f;
 	dt += app.getDeltaTime().asSeconds() / 3.f;
 
-	// Update current recording
+	// Update current recording, unless it is the take updateRecording() already advanced,
+	// so a capturing take gets one frame per update like the actor takes alongside it
 	if (nullptr == currentRecording) return;
-	currentRecording->update(app.getDeltaTime().asSeconds());
-	currentRecording->apply(selectedSkeleton.get());
+	if (currentRecording != captured) {
+		currentRecording->update(app.getDeltaTime().asSeconds());
+	}
 
 	// Update blend recording
 	if (layering) {
 		recordings["blend"]->setPlaybackDelta(1 / 60.f);//app.getDeltaTime().asSeconds());
 		recordings["blend"]->update(app.getDeltaTime().asSeconds());
-		recordings["blend"]->apply(blendSkeleton.get());
 	}
 
+	// Pose every take drawn this frame across the pool, rendering reads each take's own skeleton
+	evaluatePoses();
+
 	// Update gui playback progress bar
 	const float totalLength = currentRecording->getAnimationLength();
 	const float currentTime = currentRecording->getPlaybackTime();
 	const float progress = (totalLength == 0.f) ? 0.f : currentTime / totalLength;
-	msg::gDispatcher.dispatchMessage(msg::PlaybackSetProgressMessage(progress));
+	msg::gDispatcher.postMessage(msg::PlaybackSetProgressMessage(progress));
 }
 
 void GLWindow::render()
@@ -174,9 +205,11 @@ void GLWindow::render()
 	renderBasisAxes();
 
 	renderLiveSkeleton();
+	renderDepthPointCloud();
 
 	renderCurrentLayer();
 	renderBlendLayer();
+	renderComparison();
 
 	renderLights();
 
@@ -184,7 +217,7 @@ void GLWindow::render()
 
 	window.pushGLStates();
 	if (renderColorStream) window.draw(colorSprite);
-	if (renderDepthStream) window.draw(depthSprite);
+	if (renderDepthStream) window.draw(silhouetteSprite);
 	window.popGLStates();
 
 	window.display();
@@ -205,6 +238,7 @@ void GLWindow::handleEvents()
 			switch (event.key.code) {
 				case sf::Keyboard::Escape: window.close(); break;
 				case sf::Keyboard::BackSpace: resetCamera(); break;
+				case sf::Keyboard::C: compareTakesVisible = !compareTakesVisible; break;
 			}
 		}
 	}
@@ -251,11 +285,9 @@ void GLWindow::updateCamera()
 void GLWindow::updateTextures()
 {
 	unsigned char *colorData = (unsigned char*) app.getKinect().getColorData();
-	unsigned char *depthData = (unsigned char*) app.getKinect().getDepthData();
 
 	// Update kinect image stream textures
 	colorTexture->subImage2D(colorData, KinectDevice::image_stream_width, KinectDevice::image_stream_height);
-	depthTexture->subImage2D(depthData, KinectDevice::image_stream_width, KinectDevice::image_stream_height);
 
 	if (renderColorStream) {
 		// Reorder Kinect BGRA color data into RGBA for SFML
@@ -268,12 +300,15 @@ void GLWindow::updateTextures()
 		sfColorTexture.update(color_bytes);
 	}
 
+	// Raw depth goes up as it is, once a frame, the point cloud shader does the rest
 	if (renderDepthStream) {
-		sfDepthTexture.update(depthData);
+		depthPointCloud->setDepthRange(app.getKinect().getMinDepth(), app.getKinect().getMaxDepth());
+		depthPointCloud->update(reinterpret_cast<const GLushort *>(app.getKinect().getDepthData()));
+		sfSilhouetteTexture.update(app.getKinect().getPlayerSegmentation().getSilhouette());
 	}
 }
 
-void GLWindow::updateRecording()
+Recording *GLWindow::updateRecording()
 {
 	// Select recording to save keyframe to
 	Recording *record = nullptr;
@@ -283,10 +318,11 @@ void GLWindow::updateRecording()
 		record = currentRecording;
 		record->startRecording();
 	}
-	if (nullptr == record) return;
+	if (nullptr == record) return nullptr;
 
 	// Save a new keyframe 
 	record->update(app.getDeltaTime().asSeconds());
+	updateKeyPoses(record, false);
 
 	if (layering) {
 		const float now = record->getAnimationLength();
@@ -296,7 +332,7 @@ void GLWindow::updateRecording()
 			std::string baseLayerName = (baseSaved ? "blend" : "base");
 			const Recording& base  = *recordings[baseLayerName];
 			const Recording& layer = *record;
-			recordings["blend"]->saveBlendFrame(now, base, layer, boneMask, mappingMode);
+			recordings["blend"]->saveBlendFrame(now, blendEngine, base, layer, boneMask, mappingMode);
 			recordings["blend"]->setPlaybackTime(now);
 		} else {
 			recordings["blend"]->startLooping();
@@ -306,21 +342,54 @@ void GLWindow::updateRecording()
 			MessageBoxA(NULL, "Done recording layer", "Done", MB_OK);
 		}
 	}
+	return record;
+}
+
+bool GLWindow::getRecordingStats(RecordingStats& stats) const
+{
+	// Report on whichever recording is capturing keyframes, or the last take finished
+	const Recording *record = nullptr;
+	if (recording) {
+		auto it = recordings.find("base");
+		if (end(recordings) != it) record = it->second.get();
+	} else if (layering) {
+		record = currentRecording;
+	} else {
+		record = finishedRecording;
+	}
+	if (nullptr == record) return false;
 
-	// Update gui label text
-	const std::string text = "Mem usage: " + std::to_string(record->getAnimation()->_calcMemoryUsage()) + " bytes\n";
-	msg::gDispatcher.dispatchMessage(msg::SetRecordingLabelMessage(text));
+	stats = record->getStats();
+	return true;
 }
 
-void GLWindow::updatePlayback()
+void GLWindow::evaluatePoses()
 {
-	if (!playbackRunning || nullptr == currentRecording) return;
+	poseJobs.clear();
+	if (nullptr == currentRecording) return;
 
+	// Every take the render helpers will draw this frame, each posed into its own skeleton
+	const float now = currentRecording->getPlaybackTime();
+	Recording *blendRecording = recordings["blend"].get();
 	if (layering) {
-		recordings["blend"]->apply(selectedSkeleton.get());
+		if (blendRecording->getAnimationLength() > 0.f) {
+			poseJobs.push_back(PoseJob(&blendRecording->getPoses(), &blendRecording->getSkeleton(), blendRecording->getPlaybackTime()));
+		}
 	} else if (currentRecording->getAnimationLength() > 0.f) {
-		currentRecording->apply(selectedSkeleton.get());
+		poseJobs.push_back(PoseJob(&currentRecording->getPoses(), &currentRecording->getSkeleton(), now));
+	}
+
+	// Side by side comparison shows the other takes at the current take's time
+	if (compareTakesVisible) {
+		for (auto& pair : recordings) {
+			Recording *take = pair.second.get();
+			if (take == currentRecording || (layering && take == blendRecording)) continue;
+			if (take->getAnimationLength() == 0.f) continue;
+			poseJobs.push_back(PoseJob(&take->getPoses(), &take->getSkeleton(), now));
+		}
 	}
+
+	poseEvaluator.evaluate(poseJobs);
 }
 
 // ----------------------------------------------------------------------------
@@ -383,7 +452,22 @@ void GLWindow::renderLiveSkeleton() const
 	if (liveSkeletonVisible) {
 		GLUtils::defaultProgram->setUniform("useLighting", 0);
 		GLUtils::defaultProgram->setUniform("color", glm::vec4(0,1,0,0.6f));
-		app.getKinect().getLiveSkeleton()->render();
+		const size_t numActors = app.getKinect().getNumActors();
+		for (size_t actor = 0; actor < numActors; ++actor) {
+			app.getKinect().getLiveSkeleton(actor)->render();
+		}
+	}
+}
+
+void GLWindow::renderDepthPointCloud() const
+{
+	// Draw live depth as points, in the space the live skeletons are in ------
+	if (renderDepthStream) {
+		GLUtils::pointCloudProgram->use();
+		GLUtils::pointCloudProgram->setUniform("camera", camera.matrix());
+		GLUtils::pointCloudProgram->setUniform("model", glm::mat4());
+		depthPointCloud->render(*GLUtils::pointCloudProgram);
+		GLUtils::defaultProgram->use();
 	}
 }
 
@@ -403,17 +487,17 @@ void GLWindow::renderCurrentLayer() const
 			// Draw bone paths for joints that are enabled in the bone mask ----
 			GLUtils::defaultProgram->setUniform("useLighting", 0);
 			GLUtils::defaultProgram->setUniform("color", glm::vec4(1.f, 0.843f, 0.f, 0.7f));
-			for (const auto& boneID : boneMask) {
+			boneMask.forEach([&](EBoneID boneID) {
 				animation->getPositions(boneID, positions, currentRecording->getPlaybackTime());
 				Render::pipe(positions);
-			}
+			});
 
 			// TODO : highlight on live skeleton when layering
 			// Highlight joints that are enabled in the bone mask --------------
 			GLUtils::simpleProgram->use();
 			GLUtils::simpleProgram->setUniform("camera", camera.matrix());
 			GLUtils::simpleProgram->setUniform("color", glm::vec4(1.f, 0.843f, 0.f, 0.85f));
-			for (const auto& boneID : boneMask) {
+			boneMask.forEach([&](EBoneID boneID) {
 				TransformKeyFrame kf(playback_time, 0);
 				animation->getBoneTrack(boneID)->getInterpolatedKeyFrame(playback_time, &kf);
 
@@ -424,7 +508,7 @@ void GLWindow::renderCurrentLayer() const
 				glCullFace(GL_FRONT);
 				Render::sphere();
 				glCullFace(GL_BACK);
-			}
+			});
 		}
 
 		// Draw the skeleton ---------------------------------------------------
@@ -440,8 +524,7 @@ void GLWindow::renderCurrentLayer() const
 		GLUtils::defaultProgram->setUniform("tex", 0);
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, redTileTexture->object());
-		//selectedSkeleton->render();
-		renderAnimation(*currentRecording->getAnimation(), currentRecording->getPlaybackTime());
+		renderPose(currentRecording->getSkeleton());
 	}
 }
 
@@ -452,9 +535,7 @@ void GLWindow::renderBlendLayer() const
 		GLUtils::defaultProgram->setUniform("useLighting", 0);
 		GLUtils::defaultProgram->setUniform("color", glm::vec4(1,1,0,0.8f));
 		GLUtils::defaultProgram->setUniform("model", glm::mat4());
-		//blendSkeleton->render();
-		const Recording *blendRecording = recordings.at("blend").get();
-		renderAnimation(*blendRecording->getAnimation(), blendRecording->getPlaybackTime());
+		renderPose(recordings.at("blend")->getSkeleton());
 
 		// TODO : render bone paths more simply, and extract method for uniformity
 		if (bonePathsVisible) {
@@ -467,22 +548,46 @@ void GLWindow::renderBlendLayer() const
 			// Draw bone paths for joints that are enabled in the bone mask ----
 			GLUtils::defaultProgram->setUniform("useLighting", 0);
 			GLUtils::defaultProgram->setUniform("color", glm::vec4(1.f, 1.f, 0.f, 0.5f));
-			for (const auto& boneID : boneMask) {
+			boneMask.forEach([&](EBoneID boneID) {
 				animation->getPositions(boneID, positions, blend_playback_time);
 				Render::pipe(positions);
-			}
+			});
 
 			animation = recordings.at("base")->getAnimation();
 			const float base_playback_time = recordings.at("base")->getPlaybackTime();
 			GLUtils::defaultProgram->setUniform("color", glm::vec4(0.f, 0.f, 1.f, 0.5f));
-			for (const auto& boneID : boneMask) {
+			boneMask.forEach([&](EBoneID boneID) {
 				animation->getPositions(boneID, positions, base_playback_time);
 				Render::pipe(positions);
-			}
+			});
 		}
 	}
 }
 
+void GLWindow::renderComparison() const
+{
+	// Draw the other takes in a row beside the current one -------------------
+	if (!compareTakesVisible || nullptr == currentRecording) return;
+
+	const float spacing = 1.f;
+	const Recording *blendRecording = recordings.at("blend").get();
+
+	GLUtils::defaultProgram->use();
+	GLUtils::defaultProgram->setUniform("camera", camera.matrix());
+	GLUtils::defaultProgram->setUniform("color", glm::vec4(1));
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, redTileTexture->object());
+
+	int column = 0;
+	for (const auto& pair : recordings) {
+		const Recording *take = pair.second.get();
+		if (take == currentRecording || (layering && take == blendRecording)) continue;
+		if (take->getAnimationLength() == 0.f) continue;
+
+		renderPose(take->getSkeleton(), glm::vec3(spacing * ++column, 0.f, 0.f));
+	}
+}
+
 void GLWindow::renderLights() const
 {
 	// Draw light --------------------------------------------------------------
@@ -511,10 +616,10 @@ void GLWindow::loadTextures()
 		                 , KinectDevice::image_stream_width, KinectDevice::image_stream_height
 		                 , (unsigned char *) app.getKinect().getColorData()));
 
-	depthTexture = std::unique_ptr<tdogl::Texture>(
-		new tdogl::Texture(tdogl::Texture::Format::BGRA
-		                 , KinectDevice::image_stream_width, KinectDevice::image_stream_height
-		                 , (unsigned char *) app.getKinect().getColorData()));
+	// Nominal focal length is given for 320x240 depth, it scales with the resolution
+	const float depth_focal_length = NUI_CAMERA_DEPTH_NOMINAL_FOCAL_LENGTH_IN_PIXELS * (KinectDevice::image_stream_width / 320.f);
+	depthPointCloud = std::unique_ptr<DepthPointCloud>(
+		new DepthPointCloud(KinectDevice::image_stream_width, KinectDevice::image_stream_height, depth_focal_length));
 
 	sf::Image gridImage(GetImage("grid.png"));
 	gridTexture = std::unique_ptr<tdogl::Texture>(
@@ -554,11 +659,131 @@ void GLWindow::recordLayer()
 	recordings["blend"]->setPlaybackDelta(playbackDelta);
 	recordings["blend"]->setPlaybackTime(0.f);
 	recordings["blend"]->startPlayback();
+	recordings["blend"]->calibrate(*recordings["base"]);
+	blendEngine.beginLayer();
+	actorCapture->start();
 
 	// Update ui layer combo box
 	msg::gDispatcher.dispatchMessage(msg::AddLayerItemMessage(layerName));
 }
 
+void GLWindow::reblendLayer()
+{
+	// Only finished layers are re-blended, a layer being recorded is blended live
+	if (layering || recording || nullptr == currentRecording) return;
+	if (currentRecording == recordings["base"].get() || currentRecording == recordings["blend"].get()) return;
+	if (currentRecording->getAnimationLength() == 0.f) return;
+
+	// Rebuild the blend from the base and the selected layer with the current mask and mapping,
+	// aligning the layer's timing to the base on the masked bones first if enabled
+	timeWarp.clear();
+	if (timeWarping) {
+		timeWarp.align(*recordings["base"]->getAnimation(), *currentRecording->getAnimation(), boneMask);
+	}
+	recordings["blend"]->blend(blendEngine, *recordings["base"], *currentRecording, boneMask, mappingMode, &timeWarp);
+	recordings["blend"]->calibrate(*recordings["base"]);
+	recordings["blend"]->setPlaybackTime(recordings["blend"]->getPlaybackTime()); // clamp to the new length
+}
+
+void GLWindow::finishTake(Recording *take)
+{
+	// Reduce before calibrating, bone lengths then come from the first pose as it will be played
+	if (keyFrameReduction) {
+		take->reduceKeyFrames(keyFrameTolerance);
+	}
+	take->calibrate();
+	finishedRecording = take;
+	motionIndexStale = true;
+	updateKeyPoses(take, true);
+}
+
+void GLWindow::keepActorTakes()
+{
+	// Each actor that was captured becomes a take of its own, ready to be layered like any other
+	for (size_t slot = 0; slot < actorCapture->getNumSlots(); ++slot) {
+		if (!actorCapture->isBound(slot) || actorCapture->getRecording(slot).getAnimationLength() == 0.f) continue;
+
+		std::ostringstream ss;
+		ss << "actor " << actorCapture->getTrackingID(slot);
+		std::string takeName = ss.str();
+		for (int n = 2; end(recordings) != recordings.find(takeName); ++n) {
+			std::ostringstream numbered;
+			numbered << ss.str() << " (" << n << ")";
+			takeName = numbered.str();
+		}
+
+		std::unique_ptr<Recording> take(actorCapture->release(slot));
+		take->setName(takeName);
+		if (keyFrameReduction) {
+			take->reduceKeyFrames(keyFrameTolerance);
+		}
+		take->calibrate();
+		take->setPlaybackDelta(playbackDelta);
+		recordings[takeName] = std::move(take);
+		motionIndexStale = true;
+
+		msg::gDispatcher.dispatchMessage(msg::AddLayerItemMessage(takeName));
+	}
+	packTakes();
+}
+
+void GLWindow::packTakes()
+{
+	// Finished takes are kept packed until selected, the base stays as it is while a layer is blended over it
+	const Recording *blend = recordings["blend"].get();
+	auto base = recordings.find("base");
+	const Recording *layerBase = (layering && end(recordings) != base) ? base->second.get() : nullptr;
+
+	for (auto& it : recordings) {
+		Recording *take = it.second.get();
+		if (take == currentRecording || take == blend || take == layerBase || take->isRecording()) continue;
+
+		// The motion index points at what each take is played back from
+		const PoseSampler *poses = &take->getPoses();
+		take->pack();
+		if (poses != &take->getPoses()) motionIndexStale = true;
+	}
+}
+
+void GLWindow::updateMotionIndex()
+{
+	if (!motionIndexStale) return;
+
+	// Index every finished take but the blend, which only repeats the others
+	std::vector<const PoseSampler*> takes;
+	for (auto& it : recordings) {
+		const Recording *take = it.second.get();
+		if (take == recordings["blend"].get() || take->isRecording() || take->getAnimationLength() == 0.f) continue;
+		takes.push_back(&take->getPoses());
+	}
+	motionIndex.build(takes);
+	motionIndexStale = false;
+}
+
+void GLWindow::updateKeyPoses( const Recording *take, bool finished )
+{
+	// Clusters follow one take, another one starts them over
+	if (take != keyPosesTake) {
+		keyPoses.clear();
+		keyPosesTake = take;
+	}
+
+	// Frames captured since the last update join the clusters, a finished take gets a full k-means pass
+	if (nullptr != take) {
+		keyPoses.update(*take->getAnimation());
+	}
+	if (!finished) return;
+
+	keyPoses.refine();
+	keyPoses.getFrames(keyPoseFrames);
+
+	std::vector<float> times;
+	for (auto& frame : keyPoseFrames) {
+		times.push_back(frame.time);
+	}
+	msg::gDispatcher.dispatchMessage(msg::SetKeyPosesMessage(times));
+}
+
 // ----------------------------------------------------------------------------
 // Message processing methods -------------------------------------------------
 // ----------------------------------------------------------------------------
@@ -568,6 +793,7 @@ void GLWindow::registerMessageHandlers()
 	msg::gDispatcher.registerHandler(msg::STOP_SKELETON_RECORDING,  this);
 	msg::gDispatcher.registerHandler(msg::CLEAR_SKELETON_RECORDING, this);
 	msg::gDispatcher.registerHandler(msg::EXPORT_SKELETON_BVH,      this);
+	msg::gDispatcher.registerHandler(msg::KEEP_ROLLING_CAPTURE,     this);
 	msg::gDispatcher.registerHandler(msg::SHOW_LIVE_SKELETON,       this);
 	msg::gDispatcher.registerHandler(msg::HIDE_LIVE_SKELETON,       this);
 	msg::gDispatcher.registerHandler(msg::SHOW_COLOR_STREAM,        this);
@@ -584,9 +810,15 @@ void GLWindow::registerMessageHandlers()
 	msg::gDispatcher.registerHandler(msg::START_LAYERING,           this);
 	msg::gDispatcher.registerHandler(msg::LAYER_SELECT,             this);
 	msg::gDispatcher.registerHandler(msg::MAPPING_MODE_SELECT,      this);
+	msg::gDispatcher.registerHandler(msg::ENABLE_TIME_WARP,         this);
+	msg::gDispatcher.registerHandler(msg::DISABLE_TIME_WARP,        this);
+	msg::gDispatcher.registerHandler(msg::REDUCTION_LEVEL_SELECT,   this);
 	msg::gDispatcher.registerHandler(msg::SHOW_BONE_PATH,           this);
 	msg::gDispatcher.registerHandler(msg::HIDE_BONE_PATH,           this);
 	msg::gDispatcher.registerHandler(msg::UPDATE_BONE_MASK,         this);
+	msg::gDispatcher.registerHandler(msg::FIND_LIVE_POSE,           this);
+	msg::gDispatcher.registerHandler(msg::KEY_POSE_SELECT,          this);
+	msg::gDispatcher.registerHandler(msg::EXPORT_KEY_POSES,         this);
 }
 
 void GLWindow::process( const msg::StartRecordingMessage *message )
@@ -596,16 +828,36 @@ void GLWindow::process( const msg::StartRecordingMessage *message )
 	if (nullptr != currentRecording) {
 		currentRecording->startRecording();
 	}
+	actorCapture->start();
 }
 
 void GLWindow::process( const msg::StopRecordingMessage *message )
 {
+	const bool captured = recording || layering;
+	const bool layered  = layering;
 	recording = false;
 	layering = false;
 
 	if (nullptr != currentRecording) {
 		currentRecording->stopRecording();
+		// Bone lengths come from the take's own first pose, the blend is drawn with the base's
+		if (currentRecording != recordings["blend"].get()) {
+			// Only finish a take once per capture, reducing again would measure against already reduced keys
+			if (captured) finishTake(currentRecording);
+			else          currentRecording->calibrate();
+		}
+	}
+
+	// The live blend played the layer 1:1, replace it with the aligned one
+	if (layered && timeWarping) {
+		reblendLayer();
+	}
+
+	if (actorCapture->isCapturing()) {
+		actorCapture->stop();
+		keepActorTakes();
 	}
+	packTakes();
 }
 
 void GLWindow::process( const msg::ClearRecordingMessage *message )
@@ -617,6 +869,10 @@ void GLWindow::process( const msg::ClearRecordingMessage *message )
 	if (nullptr != currentRecording) {
 		currentRecording->clearRecording();
 	}
+	finishedRecording = nullptr;
+	motionIndexStale = true;
+	keyPosesTake = nullptr;
+	updateKeyPoses(currentRecording, true);
 
 	// Update gui label
 	msg::gDispatcher.dispatchMessage(msg::SetRecordingLabelMessage("Skeleton Recording:"));
@@ -632,6 +888,18 @@ void GLWindow::process( const msg::ExportSkeletonBVHMessage *message )
 	MessageBoxA(NULL, text.c_str(), "BVH Export", MB_OK);
 }
 
+void GLWindow::process( const msg::KeepRollingCaptureMessage *message )
+{
+	// Kept frames replace the selected take, never one that is capturing or the blend
+	if (recording || layering || nullptr == currentRecording) return;
+	if (currentRecording == recordings["blend"].get()) return;
+
+	if (currentRecording->keep(*rollingCapture, message->seconds) > 0) {
+		keyPosesTake = nullptr; // every frame was replaced
+		finishTake(currentRecording);
+	}
+}
+
 void GLWindow::process( const msg::ShowLiveSkeletonMessage *message )
 {
 	liveSkeletonVisible = true;
@@ -666,7 +934,6 @@ void GLWindow::process( const msg::PlaybackFirstFrameMessage *message )
 {
 	if (nullptr != currentRecording) {
 		currentRecording->resetPlaybackTime();
-		currentRecording->apply(selectedSkeleton.get());
 	}
 }
 
@@ -674,7 +941,6 @@ void GLWindow::process( const msg::PlaybackLastFrameMessage *message )
 {
 	if (nullptr != currentRecording) {
 		currentRecording->setPlaybackTime(currentRecording->getAnimationLength());
-		currentRecording->apply(selectedSkeleton.get());
 	}
 }
 
@@ -682,7 +948,6 @@ void GLWindow::process( const msg::PlaybackPrevFrameMessage *message )
 {
 	if (nullptr != currentRecording) {
 		currentRecording->playbackPreviousFrame();
-		currentRecording->apply(selectedSkeleton.get());
 	}
 }
 
@@ -690,7 +955,6 @@ void GLWindow::process( const msg::PlaybackNextFrameMessage *message )
 {
 	if (nullptr != currentRecording) {
 		currentRecording->playbackNextFrame();
-		currentRecording->apply(selectedSkeleton.get());
 	}
 }
 
@@ -700,7 +964,6 @@ void GLWindow::process( const msg::PlaybackStartMessage *message )
 
 	if (nullptr != currentRecording) {
 		currentRecording->startPlayback();
-		currentRecording->apply(selectedSkeleton.get());
 	}
 }
 
@@ -710,7 +973,6 @@ void GLWindow::process( const msg::PlaybackStopMessage *message )
 
 	if (nullptr != currentRecording) {
 		currentRecording->stopPlayback();
-		currentRecording->apply(selectedSkeleton.get());
 	}
 }
 
@@ -742,13 +1004,36 @@ void GLWindow::process( const msg::LayerSelectMessage *message )
 			currentRecording->stopPlayback();
 		}
 		currentRecording->resetPlaybackTime();
-		currentRecording->apply(selectedSkeleton.get());
 	}
+	updateKeyPoses(currentRecording, true);
+	packTakes();
 }
 
 void GLWindow::process( const msg::MappingModeSelectMessage *message )
 {
 	mappingMode = (ELayerMappingMode) message->mode;
+	reblendLayer();
+}
+
+void GLWindow::process( const msg::EnableTimeWarpMessage *message )
+{
+	timeWarping = true;
+	reblendLayer();
+}
+
+void GLWindow::process( const msg::DisableTimeWarpMessage *message )
+{
+	timeWarping = false;
+	reblendLayer();
+}
+
+void GLWindow::process( const msg::ReductionLevelSelectMessage *message )
+{
+	// Applies to takes finished from now on
+	keyFrameReduction = (message->level != "Off");
+	     if (message->level == "Fine")   keyFrameTolerance = KeyFrameTolerance(0.001f, glm::radians(0.5f));
+	else if (message->level == "Medium") keyFrameTolerance = KeyFrameTolerance(0.003f, glm::radians(1.f));
+	else if (message->level == "Coarse") keyFrameTolerance = KeyFrameTolerance(0.01f,  glm::radians(3.f));
 }
 
 void GLWindow::process( const msg::ShowBonePathMessage *message )
@@ -772,4 +1057,70 @@ void GLWindow::process( const msg::HideBonePathMessage *message )
 void GLWindow::process( const msg::UpdateBoneMaskMessage *message )
 {
 	boneMask = message->boneMask;
+	reblendLayer();
+}
+
+void GLWindow::process( const msg::KeyPoseSelectMessage *message )
+{
+	if (nullptr == currentRecording || currentRecording != keyPosesTake) return;
+	if (message->index < 0 || static_cast<size_t>(message->index) >= keyPoseFrames.size()) return;
+
+	currentRecording->setPlaybackTime(keyPoseFrames[message->index].time);
+}
+
+void GLWindow::process( const msg::ExportKeyPosesMessage *message )
+{
+	if (nullptr == currentRecording || currentRecording != keyPosesTake || keyPoseFrames.empty()) return;
+
+	Animation preview(0, currentRecording->getAnimation()->getName() + "_keyposes");
+	keyPoses.buildPreview(*currentRecording->getAnimation(), key_pose_hold_seconds, preview);
+	exportAnimationAsBVH(&preview);
+
+	const std::string text = "Exported key poses as '" + preview.getName() + ".bvh'";
+	MessageBoxA(NULL, text.c_str(), "BVH Export", MB_OK);
+}
+
+void GLWindow::process( const msg::FindLivePoseMessage *message )
+{
+	// A short snapshot gives the live pose's velocities as well as its positions
+	Animation live(0, "live");
+	if (rollingCapture->snapshot(live_pose_seconds, live) < 2) {
+		msg::gDispatcher.postMessage(msg::SetInfoLabelMessage("No live skeleton to search for"));
+		return;
+	}
+
+	updateMotionIndex();
+	std::vector<MotionMatch> matches;
+	motionIndex.search(live, live.getLength(), zhAnimationParam_SampleInterpK, matches, live_pose_lists);
+	if (matches.empty()) {
+		msg::gDispatcher.postMessage(msg::SetInfoLabelMessage("No finished takes to search"));
+		return;
+	}
+
+	// Neighbouring frames of a take are the same moment, list each moment once, closest first
+	std::vector<MotionMatch> moments;
+	for (auto& match : matches) {
+		bool seen = false;
+		for (auto& moment : moments) {
+			seen = seen || (moment.take == match.take && std::abs(moment.time - match.time) < live_pose_merge_seconds);
+		}
+		if (!seen) moments.push_back(match);
+	}
+
+	std::ostringstream text;
+	text.setf(std::ios::fixed);
+	text.precision(2);
+	text << "Live pose found in:";
+	for (size_t i = 0; i < moments.size() && i < live_pose_moments_shown; ++i) {
+		// Matches point at what the take plays from, packed takes have no name of their own
+		for (auto& it : recordings) {
+			if (&it.second->getPoses() == moments[i].take) text << "\n  " << it.first << " at " << moments[i].time << " s";
+		}
+	}
+	msg::gDispatcher.postMessage(msg::SetInfoLabelMessage(text.str()));
+
+	// Jump to the closest moment when it's in the selected take
+	if (nullptr != currentRecording && &currentRecording->getPoses() == moments.front().take) {
+		currentRecording->setPlaybackTime(moments.front().time);
+	}
 }
@@ -3,6 +3,12 @@
 #include "Scene/Camera.h"
 #include "Core/Messages/Messages.h"
 #include "Animation/AnimationTypes.h"
+#include "Animation/BlendEngine.h"
+#include "Animation/BoneAnimationTrack.h"
+#include "Animation/MotionIndex.h"
+#include "Animation/PoseEvaluator.h"
+#include "Animation/RepresentativeFrames.h"
+#include "Animation/TimeWarp.h"
 
 #include <SFML/System/Time.hpp>
 
@@ -10,12 +16,17 @@
 #include <memory>
 #include <list>
 #include <map>
+#include <vector>
 
 namespace tdogl { class Texture; }
 
 class Animation;
 class Skeleton;
 class Recording;
+class RollingCapture;
+class ActorCapture;
+class DepthPointCloud;
+struct RecordingStats;
 
 
 class GLWindow : public Window, msg::Handler
@@ -28,26 +39,38 @@ public:
 	void update();
 	void render();
 
+	// Fills stats for the recording currently capturing keyframes, or else the last one finished
+	bool getRecordingStats(RecordingStats& stats) const;
+
 private:
 	// Update helpers 
 	void handleEvents();
 	void updateCamera();
-	void updateRecording();
-	void updatePlayback();
+	// Save a keyframe to the take being captured, returns that take or nullptr
+	Recording *updateRecording();
 	void updateTextures();
+	void evaluatePoses();
 
 	// Render helpers
 	void renderSetup()        const;
 	void renderGroundPlane()  const;
 	void renderBasisAxes()    const;
 	void renderLiveSkeleton() const;
+	void renderDepthPointCloud() const;
 	void renderCurrentLayer() const;
 	void renderBlendLayer()   const;
+	void renderComparison()   const;
 	void renderLights()       const;
 
 	// Misc helpers
 	void resetCamera();
 	void recordLayer();
+	void reblendLayer();
+	void finishTake(Recording *take);
+	void keepActorTakes();
+	void packTakes();
+	void updateMotionIndex();
+	void updateKeyPoses(const Recording *take, bool finished);
 	void loadTextures();
 
 private:
@@ -55,6 +78,7 @@ private:
 	bool renderDepthStream;
 	bool liveSkeletonVisible;
 	bool bonePathsVisible;
+	bool compareTakesVisible;
 	bool playbackRunning;
 	bool recording;
 	bool layering;
@@ -68,19 +92,46 @@ private:
 	tdogl::Camera camera;
 
 	std::unique_ptr<tdogl::Texture> colorTexture;
-	std::unique_ptr<tdogl::Texture> depthTexture;
 	std::unique_ptr<tdogl::Texture> gridTexture;
 	std::unique_ptr<tdogl::Texture> redTileTexture;
 
-	std::unique_ptr<Skeleton> selectedSkeleton;
-	std::unique_ptr<Skeleton> blendSkeleton;
+	// Live depth frames unprojected into the scene, alongside the skeletons
+	std::unique_ptr<DepthPointCloud> depthPointCloud;
 
 	BoneMask boneMask;
 	ELayerMappingMode mappingMode;
+	BlendEngine blendEngine;
+
+	// Finished layers are re-blended with their timing aligned to the base
+	bool timeWarping;
+	TimeWarp timeWarp;
+
+	// Finished takes drop keyframes that interpolation reproduces within tolerance
+	bool keyFrameReduction;
+	KeyFrameTolerance keyFrameTolerance;
+
+	// Poses of every visible take, evaluated together once per frame
+	PoseEvaluator poseEvaluator;
+	std::vector<PoseJob> poseJobs;
 
 	Recording *currentRecording;
+	const Recording *finishedRecording;
+
+	// Last minute of the live skeleton, always capturing so a take can be kept after the fact
+	std::unique_ptr<RollingCapture> rollingCapture;
+	// Every actor but the first, captured alongside the base or a layer into takes of their own
+	std::unique_ptr<ActorCapture> actorCapture;
 	std::map< std::string, std::unique_ptr<Recording> > recordings;
 
+	// Every frame of the finished takes, searched for the live pose, rebuilt after a take changes
+	MotionIndex motionIndex;
+	bool motionIndexStale;
+
+	// Representative poses of the selected take, clustered as it is captured
+	RepresentativeFrames keyPoses;
+	const Recording *keyPosesTake;
+	std::vector<RepresentativeFrame> keyPoseFrames;
+
 	// Message processing methods ----------------------------
 	void registerMessageHandlers();
 
@@ -89,6 +140,7 @@ public:
 	void process(const msg::StopRecordingMessage      *message);
 	void process(const msg::ClearRecordingMessage     *message);
 	void process(const msg::ExportSkeletonBVHMessage  *message);
+	void process(const msg::KeepRollingCaptureMessage *message);
 	void process(const msg::ShowLiveSkeletonMessage   *message);
 	void process(const msg::HideLiveSkeletonMessage   *message);
 	void process(const msg::ShowColorStreamMessage    *message);
@@ -105,8 +157,14 @@ public:
 	void process(const msg::StartLayeringMessage      *message);
 	void process(const msg::LayerSelectMessage        *message);
 	void process(const msg::MappingModeSelectMessage  *message);
+	void process(const msg::EnableTimeWarpMessage     *message);
+	void process(const msg::DisableTimeWarpMessage    *message);
+	void process(const msg::ReductionLevelSelectMessage *message);
 	void process(const msg::ShowBonePathMessage       *message);
 	void process(const msg::HideBonePathMessage       *message);
 	void process(const msg::UpdateBoneMaskMessage     *message);
+	void process(const msg::FindLivePoseMessage       *message);
+	void process(const msg::KeyPoseSelectMessage      *message);
+	void process(const msg::ExportKeyPosesMessage     *message);
 
 };
@@ -1,7 +1,10 @@
 #include "Core/App.h"
 #include "GUIWindow.h"
 #include "Core/Messages/Messages.h"
+#include "Animation/Recording.h"
 
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 
 static const int window_width    = 256;
@@ -16,7 +19,10 @@ static const sf::Uint32 style    = sf::Style::None;
 GUIWindow::GUIWindow(const std::string& title, App& app)
 	: Window(title, app)
 	, gui()
+	, statsTimer()
 {
+	recordingLabel[0] = '\0';
+
 	videoMode = sf::VideoMode(window_width
 	                        , sf::VideoMode::getDesktopMode().height - height_offset
 							, color_depth);
@@ -43,6 +49,39 @@ void GUIWindow::update()
 		gui.handleEvent(event);
 	}
 	gui.update();
+
+	// Poll recording stats at the gui rate instead of being sent a label every frame
+	if (statsTimer.getElapsedTime().asSeconds() >= 1.f / framerate_limit) {
+		statsTimer.restart();
+		updateRecordingLabel();
+	}
+}
+
+void GUIWindow::updateRecordingLabel()
+{
+	RecordingStats stats;
+	if (!app.getGLWindow().getRecordingStats(stats)) return;
+
+	const JointFilter *filter = app.getKinect().getJointFilter();
+
+	// Format into fixed buffers, the label is only set when the text shown changes
+	char captured[32] = "";
+	if (stats.captured > stats.keyFrames) {
+		_snprintf_s(captured, _TRUNCATE, " of %lu captured", static_cast<unsigned long>(stats.captured));
+	}
+	char filterLag[64] = "";
+	if (nullptr != filter) {
+		_snprintf_s(filterLag, _TRUNCATE, "\n%s filter lag: %d ms", filter->getName(), static_cast<int>(filter->getLatency() * 1000.f + 0.5f));
+	}
+
+	char text[recording_label_size];
+	_snprintf_s(text, _TRUNCATE, "Mem usage: %lu bytes\nKeyframes: %lu%s\nLength: %.1f s @ %.1f fps%s"
+	          , static_cast<unsigned long>(stats.bytes), static_cast<unsigned long>(stats.keyFrames), captured
+	          , stats.length, stats.captureRate, filterLag);
+
+	if (0 == std::strcmp(text, recordingLabel)) return;
+	strcpy_s(recordingLabel, text);
+	gui.setRecordingLabel(recordingLabel);
 }
 
 void GUIWindow::render()
@@ -63,6 +102,7 @@ void GUIWindow::registerMessageHandlers()
 	msg::gDispatcher.registerHandler(msg::PLAYBACK_SET_PROGRESS, this);
 	msg::gDispatcher.registerHandler(msg::SET_INFO_LABEL,        this);
 	msg::gDispatcher.registerHandler(msg::ADD_LAYER_ITEM,        this);
+	msg::gDispatcher.registerHandler(msg::SET_KEY_POSES,         this);
 }
 
 void GUIWindow::process( const msg::SetRecordingLabelMessage *message )
@@ -84,3 +124,8 @@ void GUIWindow::process( const msg::AddLayerItemMessage *message )
 {
 	gui.appendLayerItem(message->item);
 }
+
+void GUIWindow::process( const msg::SetKeyPosesMessage *message )
+{
+	gui.setKeyPoseItems(message->times);
+}
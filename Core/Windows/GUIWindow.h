@@ -3,6 +3,8 @@
 #include "Core/GUI/UserInterface.h"
 #include "Core/Messages/Messages.h"
 
+#include <SFML/System/Clock.hpp>
+
 #include <string>
 
 
@@ -20,8 +22,14 @@ public:
 	const GUI& getGUI() const;
 
 private:
+	void updateRecordingLabel();
+
 	GUI gui;
 
+	sf::Clock statsTimer;
+	static const size_t recording_label_size = 256;
+	char recordingLabel[recording_label_size]; // text last shown by the recording label
+
 	// Message processing methods ----------------------------
 	void registerMessageHandlers();
 
@@ -30,6 +38,7 @@ public:
 	void process(const msg::PlaybackSetProgressMessage *message);
 	void process(const msg::SetInfoLabelMessage        *message);
 	void process(const msg::AddLayerItemMessage        *message);
+	void process(const msg::SetKeyPosesMessage         *message);
 
 };
 
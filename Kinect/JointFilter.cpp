@@ -0,0 +1,349 @@
+#include "JointFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define JOINT_FILTER_SSE 1
+#endif
+
+namespace
+{
+	// Filters are written once against these, four lanes per step with SSE, one without
+#if defined(JOINT_FILTER_SSE)
+	typedef __m128 Lane;
+	const size_t lane_width = 4;
+	inline Lane vload(const float *p)        { return _mm_loadu_ps(p); }
+	inline void vstore(float *p, Lane value) { _mm_storeu_ps(p, value); }
+	inline Lane vset(float value)            { return _mm_set1_ps(value); }
+	inline Lane vadd(Lane a, Lane b)         { return _mm_add_ps(a, b); }
+	inline Lane vsub(Lane a, Lane b)         { return _mm_sub_ps(a, b); }
+	inline Lane vmul(Lane a, Lane b)         { return _mm_mul_ps(a, b); }
+	inline Lane vdiv(Lane a, Lane b)         { return _mm_div_ps(a, b); }
+	inline Lane vabs(Lane a)                 { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+#else
+	typedef float Lane;
+	const size_t lane_width = 1;
+	inline Lane vload(const float *p)        { return *p; }
+	inline void vstore(float *p, Lane value) { *p = value; }
+	inline Lane vset(float value)            { return value; }
+	inline Lane vadd(Lane a, Lane b)         { return a + b; }
+	inline Lane vsub(Lane a, Lane b)         { return a - b; }
+	inline Lane vmul(Lane a, Lane b)         { return a * b; }
+	inline Lane vdiv(Lane a, Lane b)         { return a / b; }
+	inline Lane vabs(Lane a)                 { return std::fabs(a); }
+#endif
+
+	const float two_pi = 6.28318531f;
+	const float min_cutoff_hz = 0.001f;
+	const float initial_velocity_variance = 1.f; // (m/s)^2, of a joint nothing is known about yet
+	const double latency_window_seconds = 2.0;   // time constant of the latency estimate
+
+	// Smoothing factor of a first order low pass with cutoff Hz over frameDelta seconds
+	inline Lane lowPassAlpha(Lane cutoff, Lane timeConstantScale)
+	{
+		const Lane one = vset(1.f);
+		return vdiv(one, vadd(one, vdiv(timeConstantScale, cutoff)));
+	}
+}
+
+
+void JointLanes::load( const SkeletonData& skeleton )
+{
+	for (int i = 0; i < EBoneID::COUNT; ++i) {
+		values[i]                      = skeleton.positions[i].x;
+		values[i + EBoneID::COUNT]     = skeleton.positions[i].y;
+		values[i + 2 * EBoneID::COUNT] = skeleton.positions[i].z;
+	}
+}
+
+void JointLanes::store( SkeletonData& skeleton ) const
+{
+	for (int i = 0; i < EBoneID::COUNT; ++i) {
+		skeleton.positions[i] = glm::vec3(values[i], values[i + EBoneID::COUNT], values[i + 2 * EBoneID::COUNT]);
+	}
+}
+
+void JointLanes::set( EBoneID boneID, float value )
+{
+	values[boneID]                      = value;
+	values[boneID + EBoneID::COUNT]     = value;
+	values[boneID + 2 * EBoneID::COUNT] = value;
+}
+
+void JointLanes::set( float value )
+{
+	for (size_t i = 0; i < count; ++i) {
+		values[i] = value;
+	}
+}
+
+float JointLanes::get( EBoneID boneID ) const
+{
+	return values[boneID];
+}
+
+
+JointFilter::JointFilter()
+	: primed(false)
+	, lagProduct(0.0)
+	, speedSquared(0.0)
+{
+	previousOutput.set(0.f);
+}
+
+void JointFilter::apply( SkeletonData& skeleton, float frameDelta )
+{
+	if (frameDelta <= 0.f) {
+		// Repeated frame, nothing to filter or measure
+		if (primed) previousOutput.store(skeleton);
+		return;
+	}
+
+	JointLanes input;
+	input.load(skeleton);
+	JointLanes output = input;
+	filter(output, frameDelta, !primed);
+
+	// Output lagging by L is close to input - L * velocity, so L is the least squares fit
+	// of (input - output) against velocity, which is taken from the output for its lack of noise
+	if (primed) {
+		double product = 0.0, speed = 0.0;
+		for (size_t i = 0; i < JointLanes::count; ++i) {
+			const double velocity = (output.values[i] - previousOutput.values[i]) / frameDelta;
+			product += (input.values[i] - output.values[i]) * velocity;
+			speed   += velocity * velocity;
+		}
+		const double decay = std::exp(-frameDelta / latency_window_seconds);
+		lagProduct   = lagProduct * decay + product;
+		speedSquared = speedSquared * decay + speed;
+	}
+
+	previousOutput = output;
+	primed = true;
+	output.store(skeleton);
+}
+
+void JointFilter::reset()
+{
+	primed = false;
+	lagProduct = 0.0;
+	speedSquared = 0.0;
+}
+
+
+OneEuroJointFilter::OneEuroJointFilter( const OneEuroParams& params )
+{
+	setParams(params);
+	value.set(0.f);
+	derivative.set(0.f);
+}
+
+void OneEuroJointFilter::setParams( const OneEuroParams& params )
+{
+	minCutoff.set(std::max(min_cutoff_hz, params.minCutoff));
+	beta.set(std::max(0.f, params.beta));
+	derivativeCutoff.set(std::max(min_cutoff_hz, params.derivativeCutoff));
+}
+
+void OneEuroJointFilter::setParams( EBoneID boneID, const OneEuroParams& params )
+{
+	minCutoff.set(boneID, std::max(min_cutoff_hz, params.minCutoff));
+	beta.set(boneID, std::max(0.f, params.beta));
+	derivativeCutoff.set(boneID, std::max(min_cutoff_hz, params.derivativeCutoff));
+}
+
+OneEuroParams OneEuroJointFilter::getParams( EBoneID boneID ) const
+{
+	return OneEuroParams(minCutoff.get(boneID), beta.get(boneID), derivativeCutoff.get(boneID));
+}
+
+const char *OneEuroJointFilter::getName() const
+{
+	return "One Euro";
+}
+
+void OneEuroJointFilter::filter( JointLanes& lanes, float frameDelta, bool first )
+{
+	if (first) {
+		value = lanes;
+		derivative.set(0.f);
+		return;
+	}
+
+	const Lane rate  = vset(1.f / frameDelta);
+	const Lane scale = vset(1.f / (two_pi * frameDelta));
+	for (size_t i = 0; i < JointLanes::count; i += lane_width) {
+		const Lane raw      = vload(&lanes.values[i]);
+		const Lane previous = vload(&value.values[i]);
+
+		// Smoothed speed raises the cutoff
+		const Lane rawDerivative  = vmul(vsub(raw, previous), rate);
+		const Lane lastDerivative = vload(&derivative.values[i]);
+		const Lane dAlpha         = lowPassAlpha(vload(&derivativeCutoff.values[i]), scale);
+		const Lane newDerivative  = vadd(lastDerivative, vmul(dAlpha, vsub(rawDerivative, lastDerivative)));
+
+		const Lane cutoff   = vadd(vload(&minCutoff.values[i]), vmul(vload(&beta.values[i]), vabs(newDerivative)));
+		const Lane alpha    = lowPassAlpha(cutoff, scale);
+		const Lane filtered = vadd(previous, vmul(alpha, vsub(raw, previous)));
+
+		vstore(&derivative.values[i], newDerivative);
+		vstore(&value.values[i], filtered);
+		vstore(&lanes.values[i], filtered);
+	}
+}
+
+
+DoubleExponentialJointFilter::DoubleExponentialJointFilter( const DoubleExponentialParams& params )
+{
+	setParams(params);
+	smoothed.set(0.f);
+	trend.set(0.f);
+}
+
+void DoubleExponentialJointFilter::setParams( const DoubleExponentialParams& params )
+{
+	smoothing.set(std::min(0.99f, std::max(0.f, params.smoothing)));
+	correction.set(std::min(1.f, std::max(0.f, params.correction)));
+	prediction.set(std::max(0.f, params.prediction));
+}
+
+void DoubleExponentialJointFilter::setParams( EBoneID boneID, const DoubleExponentialParams& params )
+{
+	smoothing.set(boneID, std::min(0.99f, std::max(0.f, params.smoothing)));
+	correction.set(boneID, std::min(1.f, std::max(0.f, params.correction)));
+	prediction.set(boneID, std::max(0.f, params.prediction));
+}
+
+DoubleExponentialParams DoubleExponentialJointFilter::getParams( EBoneID boneID ) const
+{
+	return DoubleExponentialParams(smoothing.get(boneID), correction.get(boneID), prediction.get(boneID));
+}
+
+const char *DoubleExponentialJointFilter::getName() const
+{
+	return "Double Exponential";
+}
+
+void DoubleExponentialJointFilter::filter( JointLanes& lanes, float /*frameDelta*/, bool first )
+{
+	if (first) {
+		smoothed = lanes;
+		trend.set(0.f);
+		return;
+	}
+
+	const Lane one = vset(1.f);
+	for (size_t i = 0; i < JointLanes::count; i += lane_width) {
+		const Lane raw          = vload(&lanes.values[i]);
+		const Lane lastSmoothed = vload(&smoothed.values[i]);
+		const Lane lastTrend    = vload(&trend.values[i]);
+		const Lane s            = vload(&smoothing.values[i]);
+		const Lane c            = vload(&correction.values[i]);
+
+		// smoothed = (1 - s) raw + s (last smoothed + last trend)
+		const Lane newSmoothed = vadd(vmul(vsub(one, s), raw), vmul(s, vadd(lastSmoothed, lastTrend)));
+		// trend = c (smoothed - last smoothed) + (1 - c) last trend
+		const Lane newTrend    = vadd(vmul(c, vsub(newSmoothed, lastSmoothed)), vmul(vsub(one, c), lastTrend));
+
+		vstore(&smoothed.values[i], newSmoothed);
+		vstore(&trend.values[i], newTrend);
+		vstore(&lanes.values[i], vadd(newSmoothed, vmul(vload(&prediction.values[i]), newTrend)));
+	}
+}
+
+
+KalmanJointFilter::KalmanJointFilter( const KalmanParams& params )
+{
+	setParams(params);
+	position.set(0.f);
+	velocity.set(0.f);
+	covariance00.set(0.f);
+	covariance01.set(0.f);
+	covariance11.set(0.f);
+}
+
+void KalmanJointFilter::setParams( const KalmanParams& params )
+{
+	processNoise.set(std::max(0.f, params.processNoise));
+	measurementNoise.set(std::max(1e-8f, params.measurementNoise));
+}
+
+void KalmanJointFilter::setParams( EBoneID boneID, const KalmanParams& params )
+{
+	processNoise.set(boneID, std::max(0.f, params.processNoise));
+	measurementNoise.set(boneID, std::max(1e-8f, params.measurementNoise));
+}
+
+KalmanParams KalmanJointFilter::getParams( EBoneID boneID ) const
+{
+	return KalmanParams(processNoise.get(boneID), measurementNoise.get(boneID));
+}
+
+const char *KalmanJointFilter::getName() const
+{
+	return "Kalman";
+}
+
+void KalmanJointFilter::filter( JointLanes& lanes, float frameDelta, bool first )
+{
+	if (first) {
+		position = lanes;
+		velocity.set(0.f);
+		covariance00 = measurementNoise;
+		covariance01.set(0.f);
+		covariance11.set(initial_velocity_variance);
+		return;
+	}
+
+	// Process noise of an acceleration held over the frame: q [dt^4/4, dt^3/2; dt^3/2, dt^2]
+	const float dt = frameDelta;
+	const Lane step = vset(dt);
+	const Lane q00  = vset(0.25f * dt * dt * dt * dt);
+	const Lane q01  = vset(0.5f * dt * dt * dt);
+	const Lane q11  = vset(dt * dt);
+	const Lane one  = vset(1.f);
+	const Lane two  = vset(2.f);
+	for (size_t i = 0; i < JointLanes::count; i += lane_width) {
+		const Lane q = vload(&processNoise.values[i]);
+		const Lane r = vload(&measurementNoise.values[i]);
+		Lane x   = vload(&position.values[i]);
+		Lane v   = vload(&velocity.values[i]);
+		Lane p00 = vload(&covariance00.values[i]);
+		Lane p01 = vload(&covariance01.values[i]);
+		Lane p11 = vload(&covariance11.values[i]);
+
+		// Predict
+		x   = vadd(x, vmul(v, step));
+		p00 = vadd(vadd(p00, vmul(step, vadd(vmul(two, p01), vmul(step, p11)))), vmul(q, q00));
+		p01 = vadd(vadd(p01, vmul(step, p11)), vmul(q, q01));
+		p11 = vadd(p11, vmul(q, q11));
+
+		// Correct with the raw position
+		const Lane innovation = vsub(vload(&lanes.values[i]), x);
+		const Lane gain0 = vdiv(p00, vadd(p00, r));
+		const Lane gain1 = vdiv(p01, vadd(p00, r));
+		x   = vadd(x, vmul(gain0, innovation));
+		v   = vadd(v, vmul(gain1, innovation));
+		p11 = vsub(p11, vmul(gain1, p01));
+		p00 = vmul(vsub(one, gain0), p00);
+		p01 = vmul(vsub(one, gain0), p01);
+
+		vstore(&position.values[i], x);
+		vstore(&velocity.values[i], v);
+		vstore(&covariance00.values[i], p00);
+		vstore(&covariance01.values[i], p01);
+		vstore(&covariance11.values[i], p11);
+		vstore(&lanes.values[i], x);
+	}
+}
+
+
+std::unique_ptr<JointFilter> createJointFilter( const std::string& name )
+{
+	if (name == "One Euro")           return std::unique_ptr<JointFilter>(new OneEuroJointFilter());
+	if (name == "Double Exponential") return std::unique_ptr<JointFilter>(new DoubleExponentialJointFilter());
+	if (name == "Kalman")             return std::unique_ptr<JointFilter>(new KalmanJointFilter());
+	return std::unique_ptr<JointFilter>();
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "SkeletonSource.h"
+
+#include <memory>
+#include <string>
+
+
+// Joint positions as a structure of arrays, the x of every joint then every y then every z,
+// so a filter step runs down all of them four lanes at a time
+struct JointLanes
+{
+	static const size_t count = 3 * EBoneID::COUNT; // a multiple of 4
+	float values[count];
+
+	void load(const SkeletonData& skeleton);
+	void store(SkeletonData& skeleton) const;
+	// Same value in the x, y and z lanes of one joint, or of every joint
+	void set(EBoneID boneID, float value);
+	void set(float value);
+	float get(EBoneID boneID) const;
+};
+
+
+// Smooths the joint positions of a stream of skeletons, the SDK independent replacement
+// for NuiTransformSmooth, subclasses hold one filter's per joint parameters and state
+// How far the output trails the raw positions is measured as frames go through
+class JointFilter
+{
+public:
+	JointFilter();
+	virtual ~JointFilter() {}
+
+	// Filter the joint positions of skeleton in place, frameDelta seconds after the previous frame
+	void apply(SkeletonData& skeleton, float frameDelta);
+	// Forget previous frames, the next one passes through as is
+	void reset();
+
+	virtual const char *getName() const = 0;
+
+	// Least squares time shift between output and input over the last few seconds of movement,
+	// in seconds: the output is close to the input this long ago
+	float getLatency() const;
+
+protected:
+	// Filter lanes in place, first is set for the first frame after a reset
+	virtual void filter(JointLanes& lanes, float frameDelta, bool first) = 0;
+
+private:
+	JointLanes previousOutput;
+	bool primed;
+	// Decaying sums of (input - output) . velocity and velocity . velocity, velocities of the output
+	double lagProduct;
+	double speedSquared;
+
+};
+
+inline float JointFilter::getLatency() const { return (speedSquared > 0.0) ? static_cast<float>(lagProduct / speedSquared) : 0.f; }
+
+
+// One Euro filter (Casiez et al. 2012), a low pass whose cutoff rises with speed,
+// so still joints lose their jitter and fast ones keep up
+struct OneEuroParams
+{
+	float minCutoff;        // Hz, cutoff of a still joint
+	float beta;             // Hz of cutoff added per m/s of speed
+	float derivativeCutoff; // Hz, cutoff of the speed estimate
+
+	OneEuroParams(float minCutoff = 1.f, float beta = 3.f, float derivativeCutoff = 1.f)
+		: minCutoff(minCutoff)
+		, beta(beta)
+		, derivativeCutoff(derivativeCutoff)
+	{}
+};
+
+class OneEuroJointFilter : public JointFilter
+{
+public:
+	explicit OneEuroJointFilter(const OneEuroParams& params = OneEuroParams());
+
+	void setParams(const OneEuroParams& params);
+	void setParams(EBoneID boneID, const OneEuroParams& params);
+	OneEuroParams getParams(EBoneID boneID) const;
+
+	const char *getName() const;
+
+protected:
+	void filter(JointLanes& lanes, float frameDelta, bool first);
+
+private:
+	JointLanes minCutoff, beta, derivativeCutoff;
+	JointLanes value, derivative;
+
+};
+
+
+// Holt double exponential smoothing with trend prediction, what NuiTransformSmooth does
+// without its jitter and deviation clamps, values are per frame like the SDK's
+struct DoubleExponentialParams
+{
+	float smoothing;  // [0, 1), weight of the prediction over the raw position
+	float correction; // [0, 1], how fast the trend follows the smoothed positions
+	float prediction; // frames of trend added to the output
+
+	DoubleExponentialParams(float smoothing = 0.5f, float correction = 0.1f, float prediction = 0.5f)
+		: smoothing(smoothing)
+		, correction(correction)
+		, prediction(prediction)
+	{}
+};
+
+class DoubleExponentialJointFilter : public JointFilter
+{
+public:
+	explicit DoubleExponentialJointFilter(const DoubleExponentialParams& params = DoubleExponentialParams());
+
+	void setParams(const DoubleExponentialParams& params);
+	void setParams(EBoneID boneID, const DoubleExponentialParams& params);
+	DoubleExponentialParams getParams(EBoneID boneID) const;
+
+	const char *getName() const;
+
+protected:
+	void filter(JointLanes& lanes, float frameDelta, bool first);
+
+private:
+	JointLanes smoothing, correction, prediction;
+	JointLanes smoothed, trend;
+
+};
+
+
+// Kalman filter of each coordinate with a constant velocity model driven by white noise acceleration
+struct KalmanParams
+{
+	float processNoise;     // (m/s^2)^2, variance of the acceleration
+	float measurementNoise; // m^2, variance of a raw position
+
+	KalmanParams(float processNoise = 25.f, float measurementNoise = 0.0001f)
+		: processNoise(processNoise)
+		, measurementNoise(measurementNoise)
+	{}
+};
+
+class KalmanJointFilter : public JointFilter
+{
+public:
+	explicit KalmanJointFilter(const KalmanParams& params = KalmanParams());
+
+	void setParams(const KalmanParams& params);
+	void setParams(EBoneID boneID, const KalmanParams& params);
+	KalmanParams getParams(EBoneID boneID) const;
+
+	const char *getName() const;
+
+protected:
+	void filter(JointLanes& lanes, float frameDelta, bool first);
+
+private:
+	JointLanes processNoise, measurementNoise;
+	JointLanes position, velocity;
+	JointLanes covariance00, covariance01, covariance11;
+
+};
+
+
+// Filter by name as listed in the GUI: "One Euro", "Double Exponential" or "Kalman",
+// with default parameters, nullptr for "Off" or an unknown name
+std::unique_ptr<JointFilter> createJointFilter(const std::string& name);
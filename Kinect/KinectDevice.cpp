@@ -1,4 +1,5 @@
 #include "KinectDevice.h"
+#include "KinectSensorSource.h"
 #include "Animation/Skeleton.h"
 
 #include <NuiApi.h>
@@ -6,7 +7,10 @@
 #include <SFML/System/Clock.hpp>
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -16,9 +20,11 @@ using namespace std;
 
 const DWORD seated_mode_enabled = NUI_SKELETON_TRACKING_FLAG_ENABLE_SEATED_SUPPORT;
 
-const NUI_TRANSFORM_SMOOTH_PARAMETERS lightSmoothing  = { 0.5f, 0.5f, 0.5f, 0.05f, 0.04f };
-const NUI_TRANSFORM_SMOOTH_PARAMETERS mediumSmoothing = { 0.5f, 0.1f, 0.5f, 0.1f , 0.1f  };
-const NUI_TRANSFORM_SMOOTH_PARAMETERS heavySmoothing  = { 0.7f, 0.3f, 1.0f, 1.0f , 1.0f  };
+const char *const default_joint_filter = "One Euro";
+const float max_filter_gap_seconds = 0.5f; // skeleton frames further apart restart the joint filter
+const char *const sensor_extrinsics_file = "sensor_extrinsics.txt"; // per device id, from calibration
+
+static_assert(sizeof(DepthPixel) == sizeof(NUI_DEPTH_IMAGE_PIXEL), "DepthPixel must match NUI_DEPTH_IMAGE_PIXEL");
 
 
 KinectDevice::KinectDevice()
@@ -27,35 +33,52 @@ KinectDevice::KinectDevice()
 	, colorStream(INVALID_HANDLE_VALUE)
 	, depthStream(INVALID_HANDLE_VALUE)
 	, colorData(new byte[image_stream_width * image_stream_height * bytes_per_pixel])
-	, depthData(new byte[image_stream_width * image_stream_height * bytes_per_pixel])
-	, liveSkeleton(new Skeleton())
+	, depthData(new NUI_DEPTH_IMAGE_PIXEL[depth_pixels])
+	, minDepth(NUI_IMAGE_DEPTH_MINIMUM >> NUI_IMAGE_PLAYER_INDEX_SHIFT)
+	, maxDepth(NUI_IMAGE_DEPTH_MAXIMUM >> NUI_IMAGE_PLAYER_INDEX_SHIFT)
+	, playerSegmentation(image_stream_width, image_stream_height)
 	, skeletonFrame()
-	, skeletonData(nullptr)
-	, skeletonSmoothParams(mediumSmoothing)
+	, numTrackedSkeletons(0)
+	, lastSkeletonTimeStamp(0)
 	, skeletonTrackingFlags(0)
 	, seatedMode(false)
+	, fusion(nullptr)
+	, fusionSources()
+	, fusedSkeletonData()
+	, fusedSkeletonClock()
 	, nextColorFrameEvent()
 	, nextDepthFrameEvent()
 	, nextSkeletonFrameEvent()
-{}
+{
+	for (size_t actor = 0; actor < max_actors; ++actor) {
+		liveSkeletons[actor] = new Skeleton();
+		jointFilters[actor] = createJointFilter(default_joint_filter);
+		filterTrackingIDs[actor] = 0;
+		actorPlayerIndices[actor] = 0;
+	}
+}
 
 KinectDevice::~KinectDevice()
 {
-	delete liveSkeleton;
+	for (size_t actor = 0; actor < max_actors; ++actor) {
+		delete liveSkeletons[actor];
+	}
 	delete[] depthData;
 	delete[] colorData;
 }
 
 bool KinectDevice::init()
 {
-	liveSkeleton->render_orientations = false;
+	for (size_t actor = 0; actor < max_actors; ++actor) {
+		liveSkeletons[actor]->render_orientations = false;
+	}
 
 	nextColorFrameEvent = CreateEventA(NULL, TRUE, FALSE, "Next Color Frame Event");
 	nextDepthFrameEvent = CreateEventA(NULL, TRUE, FALSE, "Next Depth Frame Event");
 	nextSkeletonFrameEvent = CreateEventA(NULL, TRUE, FALSE, "Next Skeleton Frame Event");
 
 	ZeroMemory(colorData, image_stream_width * image_stream_height * bytes_per_pixel);
-	ZeroMemory(depthData, image_stream_width * image_stream_height * bytes_per_pixel);
+	ZeroMemory(depthData, depth_pixels * sizeof(NUI_DEPTH_IMAGE_PIXEL));
 
 	sf::Clock timer;
 
@@ -67,8 +90,7 @@ bool KinectDevice::init()
 		return false;
 	}
 
-	// Create the main sensor
-	// NOTE : this class only supports a single Kinect device
+	// Create the main sensor, the one color and depth come from
 	hr = NuiCreateSensorByIndex(0, &sensor);
 	if (FAILED(hr) || nullptr == sensor) {
 		MessageBoxA(NULL, "Failed to create Kinect sensor.", "Kinect Error", MB_OK | MB_ICONERROR);
@@ -96,8 +118,8 @@ bool KinectDevice::init()
 		return false;
 	}
 
-	// Open depth stream to receive depth data
-	hr = sensor->NuiImageStreamOpen(NUI_IMAGE_TYPE_DEPTH
+	// Open depth stream to receive depth data, with the player index of each pixel on a tracked skeleton
+	hr = sensor->NuiImageStreamOpen(NUI_IMAGE_TYPE_DEPTH_AND_PLAYER_INDEX
 	                              , depth_resolution
 	                              , 0                   // Image stream flags, eg. near mode...
 	                              , 2                   // Number of frames to buffer
@@ -108,17 +130,34 @@ bool KinectDevice::init()
 		return false;
 	}
 
-	// Enable skeleton tracking to receive skeleton data
-	hr = sensor->NuiSkeletonTrackingEnable(nextSkeletonFrameEvent, skeletonTrackingFlags);
-	if (FAILED(hr)) {
-		MessageBoxA(NULL, "Failed to enable skeleton tracking for Kinect sensor.", "Kinect Error", MB_OK | MB_ICONERROR);
-		return false;
+	// With more sensors every one of them tracks skeletons on its own thread, to be fused
+	if (numSensors > 1) {
+		fusion = std::unique_ptr<SkeletonFusion>(new SkeletonFusion());
+		for (int index = 0; index < numSensors; ++index) {
+			KinectSensorSource *source = (0 == index) ? new KinectSensorSource(sensor) : new KinectSensorSource(index);
+			fusionSources.push_back(source);
+			fusion->addSensor(std::unique_ptr<SensorSource>(source));
+		}
+		loadSensorExtrinsics();
+		fusion->start();
+	} else {
+		// Enable skeleton tracking to receive skeleton data
+		hr = sensor->NuiSkeletonTrackingEnable(nextSkeletonFrameEvent, skeletonTrackingFlags);
+		if (FAILED(hr)) {
+			MessageBoxA(NULL, "Failed to enable skeleton tracking for Kinect sensor.", "Kinect Error", MB_OK | MB_ICONERROR);
+			return false;
+		}
 	}
 
 	// Get the device id for this sensor
 	BSTR bstr = sensor->NuiDeviceConnectionId();
 	const wstring wstr(bstr, SysStringLen(bstr));
 	deviceId.assign(begin(wstr), end(wstr));
+	if (nullptr != fusion) {
+		stringstream ss;
+		ss << deviceId << " + " << (numSensors - 1) << " fused";
+		deviceId = ss.str();
+	}
 	//stringstream ss;
 	//ss << "Initialized Kinect in " << timer.getElapsedTime().asSeconds() << " seconds.\n"
 	//   << "Connection id: [" << deviceId << "]";
@@ -129,6 +168,13 @@ bool KinectDevice::init()
 
 void KinectDevice::shutdown()
 {
+	// Sources shut down the sensors they opened, the main one is left to us
+	if (nullptr != fusion) {
+		fusion->stop();
+		fusion = nullptr;
+		fusionSources.clear();
+	}
+
 	if (nullptr != sensor) {
 		sensor->NuiShutdown();
 		sensor = nullptr;
@@ -164,12 +210,69 @@ void KinectDevice::toggleSeatedMode()
 		seatedMode = true;
 	}
 
+	if (nullptr != fusion) {
+		for (auto source : fusionSources) {
+			source->setSeatedMode(seatedMode);
+		}
+		return;
+	}
+
 	HRESULT hr = sensor->NuiSkeletonTrackingEnable(nextSkeletonFrameEvent, skeletonTrackingFlags);
 	if (FAILED(hr)) {
 		MessageBoxA(NULL, "Kinect failed to toggle skeleton tracking mode.", "Kinect Error", MB_OK | MB_ICONINFORMATION);
 	}
 }
 
+void KinectDevice::toggleSensorCalibration()
+{
+	if (nullptr == fusion) {
+		MessageBoxA(NULL, "Calibration needs more than one Kinect sensor.", "Sensor Calibration", MB_OK | MB_ICONINFORMATION);
+		return;
+	}
+
+	if (!fusion->isCalibrating()) {
+		fusion->startCalibration();
+		MessageBoxA(NULL, "Move about where every sensor can see you, then calibrate again to finish.", "Sensor Calibration", MB_OK | MB_ICONINFORMATION);
+		return;
+	}
+
+	const size_t calibrated = fusion->finishCalibration();
+	saveSensorExtrinsics();
+
+	stringstream ss;
+	ss << "Calibrated " << calibrated << " of " << (fusion->getNumSensors() - 1) << " sensors against the first.";
+	MessageBoxA(NULL, ss.str().c_str(), "Sensor Calibration", MB_OK | MB_ICONINFORMATION);
+}
+
+void KinectDevice::loadSensorExtrinsics()
+{
+	// One line per device: id, rotation (w x y z), translation (x y z)
+	ifstream in(sensor_extrinsics_file);
+	string id;
+	glm::quat rotation;
+	glm::vec3 translation;
+	while (in >> id >> rotation.w >> rotation.x >> rotation.y >> rotation.z >> translation.x >> translation.y >> translation.z) {
+		for (size_t i = 0; i < fusion->getNumSensors(); ++i) {
+			if (fusion->getSensorName(i) == id) {
+				fusion->setExtrinsics(i, SensorExtrinsics(glm::normalize(rotation), translation));
+			}
+		}
+	}
+}
+
+void KinectDevice::saveSensorExtrinsics() const
+{
+	ofstream out(sensor_extrinsics_file);
+	for (size_t i = 0; i < fusion->getNumSensors(); ++i) {
+		const SensorExtrinsics& extrinsics = fusion->getExtrinsics(i);
+		const glm::quat& r = extrinsics.rotation;
+		const glm::vec3& t = extrinsics.translation;
+		out << fusion->getSensorName(i) << " "
+		    << r.w << " " << r.x << " " << r.y << " " << r.z << " "
+		    << t.x << " " << t.y << " " << t.z << "\n";
+	}
+}
+
 void KinectDevice::checkForColorFrame()
 {
 	if (WAIT_OBJECT_0 == WaitForSingleObject(nextColorFrameEvent, 0)) {
@@ -190,6 +293,12 @@ void KinectDevice::checkForDepthFrame()
 
 void KinectDevice::checkForSkeletonFrame()
 {
+	// Fused skeletons arrive on the sensors' own threads, there's no event to wait for
+	if (nullptr != fusion) {
+		processFusedSkeletonData();
+		return;
+	}
+
 	if (WAIT_OBJECT_0 == WaitForSingleObject(nextSkeletonFrameEvent, 0)) {
 		if (FAILED(processSkeletonData())) {
 			//cerr << "Kinect failed to process skeleton data.\n";
@@ -202,12 +311,11 @@ HRESULT KinectDevice::processImageStreamData( const EStreamType& eStreamType )
 {
 	if (nullptr == sensor) return E_FAIL;
 
-	// Get the specified stream type handle and data pointer
+	// Get the specified stream type handle
 	HANDLE imageStream;
-	byte *imageData;
 	switch (eStreamType) {
-		case COLOR_STREAM: imageStream = colorStream; imageData = colorData; break;
-		case DEPTH_STREAM: imageStream = depthStream; imageData = depthData; break;
+		case COLOR_STREAM: imageStream = colorStream; break;
+		case DEPTH_STREAM: imageStream = depthStream; break;
 	}
 
 	HRESULT hr = S_OK;
@@ -236,40 +344,17 @@ HRESULT KinectDevice::processImageStreamData( const EStreamType& eStreamType )
 	if (lockedRect.Pitch != 0) {
 		// Color stream is a straight memcopy
 		if (COLOR_STREAM == eStreamType) {
-			memcpy(imageData, lockedRect.pBits, lockedRect.size);
+			memcpy(colorData, lockedRect.pBits, lockedRect.size);
 		}
-		// Depth stream is packed with player index, so depth bits must be unpacked
+		// Depth pixels are kept as they are, player index and depth, to be unprojected on the GPU
 		else if (DEPTH_STREAM == eStreamType) {
+			memcpy(depthData, lockedRect.pBits, depth_pixels * sizeof(NUI_DEPTH_IMAGE_PIXEL));
+
 			// Get the min and max reliable depth for the current frame
-			int minDepth = (nearMode ? NUI_IMAGE_DEPTH_MINIMUM_NEAR_MODE : NUI_IMAGE_DEPTH_MINIMUM) >> NUI_IMAGE_PLAYER_INDEX_SHIFT;
-			int maxDepth = (nearMode ? NUI_IMAGE_DEPTH_MAXIMUM_NEAR_MODE : NUI_IMAGE_DEPTH_MAXIMUM) >> NUI_IMAGE_PLAYER_INDEX_SHIFT;
-
-			const NUI_DEPTH_IMAGE_PIXEL *pBufferRun = reinterpret_cast<const NUI_DEPTH_IMAGE_PIXEL *>(lockedRect.pBits);
-			const NUI_DEPTH_IMAGE_PIXEL *pBufferEnd = pBufferRun + (image_stream_width * image_stream_height);
-
-			// Write out depth pixel data to dest buffer
-			while (pBufferRun < pBufferEnd) {
-				// discard the portion of the depth that contains only the player index
-				USHORT depth = pBufferRun->depth;
-
-				// To convert to a byte, we're discarding the most-significant
-				// rather than least-significant bits.
-				// We're preserving detail, although the intensity will "wrap."
-				// Values outside the reliable depth range are mapped to 0 (black).
-
-				// Note: Using conditionals in this loop could degrade performance.
-				// Consider using a lookup table instead when writing production code.
-				BYTE intensity = static_cast<BYTE>(depth >= minDepth && depth <= maxDepth ? depth % 256 : 0);
-
-				// Write out color bytes...
-				*(imageData++) = intensity; // blue
-				*(imageData++) = intensity; // green
-				*(imageData++) = intensity; // red
-				*(imageData++) = 255;       // alpha
-
-				// Increment our index into the Kinect's depth buffer
-				++pBufferRun;
-			}
+			minDepth = static_cast<USHORT>((nearMode ? NUI_IMAGE_DEPTH_MINIMUM_NEAR_MODE : NUI_IMAGE_DEPTH_MINIMUM) >> NUI_IMAGE_PLAYER_INDEX_SHIFT);
+			maxDepth = static_cast<USHORT>((nearMode ? NUI_IMAGE_DEPTH_MAXIMUM_NEAR_MODE : NUI_IMAGE_DEPTH_MAXIMUM) >> NUI_IMAGE_PLAYER_INDEX_SHIFT);
+
+			playerSegmentation.segment(reinterpret_cast<const DepthPixel *>(depthData));
 		}
 	} // end if (lockedRect.pBits != 0)
 	texture->UnlockRect(0);
@@ -290,37 +375,140 @@ HRESULT KinectDevice::processSkeletonData()
 		return hr;
 	}
 
-	sensor->NuiTransformSmooth(&skeletonFrame, &skeletonSmoothParams);
-
-	// Get skeleton data for the first tracked skeleton
-	for (auto data : skeletonFrame.SkeletonData) {
-		if (data.eTrackingState == NUI_SKELETON_TRACKED) {
-			skeletonData = &data;
-			break;
+	// Find the tracked skeletons, the one that was actor 0 stays first
+	const DWORD firstTrackingID = (numTrackedSkeletons > 0) ? trackedSkeletons[0].trackingID : 0;
+	NUI_SKELETON_DATA *actors[max_actors];
+	size_t numActors = 0;
+	for (int i = 0; i < NUI_SKELETON_COUNT && numActors < max_actors; ++i) {
+		NUI_SKELETON_DATA *data = &skeletonFrame.SkeletonData[i];
+		if (data->eTrackingState != NUI_SKELETON_TRACKED) continue;
+
+		actors[numActors] = data;
+		if (data->dwTrackingID == firstTrackingID) {
+			std::swap(actors[0], actors[numActors]);
 		}
+		++numActors;
 	}
+	numTrackedSkeletons = 0;
+
+	const LONGLONG timeStamp = skeletonFrame.liTimeStamp.QuadPart;
+	const float frameDelta = (timeStamp - lastSkeletonTimeStamp) / 1000.f;
+	const bool filterGap = (frameDelta < 0.f || frameDelta > max_filter_gap_seconds);
+	lastSkeletonTimeStamp = timeStamp;
 
 	// Make sure the data is valid 
-	if (nullptr == skeletonData) {
+	if (0 == numActors) {
 		//MessageBoxA(NULL, "Failed to find tracked skeleton data.", "Kinect Error", MB_OK | MB_ICONERROR);
+		std::fill(filterTrackingIDs, filterTrackingIDs + max_actors, 0);
 		return E_FAIL;
 	}
 
+	for (size_t actor = 0; actor < numActors; ++actor) {
+		hr = processActor(actor, actors[actor], frameDelta, filterGap);
+		if (FAILED(hr)) {
+			return hr;
+		}
+		// Depth pixels are labeled with the skeleton's slot in the frame, counting from 1
+		actorPlayerIndices[actor] = static_cast<size_t>(actors[actor] - skeletonFrame.SkeletonData) + 1;
+		numTrackedSkeletons = actor + 1;
+	}
+
+	return hr;
+}
+
+HRESULT KinectDevice::processFusedSkeletonData()
+{
+	// Sensors only send frames with a skeleton in them, so a quiet fusion means nobody is tracked
+	if (!fusion->update()) {
+		if (fusedSkeletonClock.getElapsedTime().asSeconds() > max_filter_gap_seconds) {
+			numTrackedSkeletons = 0;
+			std::fill(filterTrackingIDs, filterTrackingIDs + max_actors, 0);
+		}
+		return S_FALSE;
+	}
+	fusedSkeletonClock.restart();
+
+	const LONGLONG timeStamp = static_cast<LONGLONG>(fusion->getFusedTime() * 1000.0);
+	const float frameDelta = (timeStamp - lastSkeletonTimeStamp) / 1000.f;
+	const bool filterGap = (frameDelta < 0.f || frameDelta > max_filter_gap_seconds);
+	lastSkeletonTimeStamp = timeStamp;
+
+	// Fused joints go through the same filtering and orientations as a single sensor's
+	const SkeletonData *fused = fusion->getTrackedSkeletonData();
+	ZeroMemory(&fusedSkeletonData, sizeof(fusedSkeletonData));
+	fusedSkeletonData.eTrackingState = NUI_SKELETON_TRACKED;
+	fusedSkeletonData.dwTrackingID = fused->trackingID;
+	for (unsigned short boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const glm::vec3& p = fused->positions[boneID];
+		fusedSkeletonData.SkeletonPositions[boneID].x = p.x;
+		fusedSkeletonData.SkeletonPositions[boneID].y = p.y;
+		fusedSkeletonData.SkeletonPositions[boneID].z = p.z;
+		fusedSkeletonData.SkeletonPositions[boneID].w = 1.f;
+		fusedSkeletonData.eSkeletonPositionTrackingState[boneID] = NUI_SKELETON_POSITION_TRACKED;
+	}
+	fusedSkeletonData.Position = fusedSkeletonData.SkeletonPositions[NUI_SKELETON_POSITION_HIP_CENTER];
+
+	numTrackedSkeletons = 0;
+	actorPlayerIndices[0] = 0; // no one sensor's slot
+	HRESULT hr = processActor(0, &fusedSkeletonData, frameDelta, filterGap);
+	if (SUCCEEDED(hr)) {
+		numTrackedSkeletons = 1;
+	}
+	return hr;
+}
+
+HRESULT KinectDevice::processActor( size_t actor, NUI_SKELETON_DATA *skeletonData, float frameDelta, bool filterGap )
+{
+	SkeletonData& skeleton = trackedSkeletons[actor];
+	skeleton.trackingID = skeletonData->dwTrackingID;
+
+	// Filter joint positions, bone orientations are then calculated from the filtered ones
+	// Each actor's filter starts over when another actor takes its place
+	JointFilter *filter = jointFilters[actor].get();
+	if (nullptr != filter) {
+		if (filterGap || filterTrackingIDs[actor] != skeletonData->dwTrackingID) {
+			filter->reset();
+		}
+
+		for (unsigned short boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+			const Vector4& p = skeletonData->SkeletonPositions[boneID];
+			skeleton.positions[boneID] = glm::vec3(p.x, p.y, p.z);
+		}
+		filter->apply(skeleton, frameDelta);
+		for (unsigned short boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+			Vector4& p = skeletonData->SkeletonPositions[boneID];
+			p.x = skeleton.positions[boneID].x;
+			p.y = skeleton.positions[boneID].y;
+			p.z = skeleton.positions[boneID].z;
+		}
+	}
+	filterTrackingIDs[actor] = skeletonData->dwTrackingID;
+
 	// Get bone orientations
-	hr = NuiSkeletonCalculateBoneOrientations(skeletonData, boneOrientations);
+	HRESULT hr = NuiSkeletonCalculateBoneOrientations(skeletonData, boneOrientations[actor]);
 	if (FAILED(hr)) {
 		return hr;
 	}
 
-	// Apply skeleton data to live Skeleton object
+	// Convert to SDK independent skeleton data for recordings
 	for (unsigned short boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
-		Bone *bone = liveSkeleton->getBone(boneID);
+		const Vector4& p = skeletonData->SkeletonPositions[boneID];
+		const Vector4& q = boneOrientations[actor][boneID].hierarchicalRotation.rotationQuaternion;
+		const Vector4& a = boneOrientations[actor][boneID].absoluteRotation.rotationQuaternion;
+		skeleton.positions[boneID] = glm::vec3(p.x, p.y, p.z);
+		skeleton.hierarchicalRotations[boneID] = glm::normalize(glm::quat(q.w, q.x, q.y, q.z));
+		skeleton.absoluteRotations[boneID] = glm::normalize(glm::quat(a.w, a.x, a.y, a.z));
+	}
+
+	// Apply skeleton data to the actor's live Skeleton object
+	for (unsigned short boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		Bone *bone = liveSkeletons[actor]->getBone(boneID);
 		if (nullptr == bone) continue;
 
 		const Vector4& p = skeletonData->SkeletonPositions[boneID];
 		bone->translation = glm::vec3(p.x, p.y, p.z);
 
-		const Vector4& o = boneOrientations[boneID].absoluteRotation.rotationQuaternion;
+		const Vector4& o = boneOrientations[actor][boneID].absoluteRotation.rotationQuaternion;
 		bone->rotation = glm::quat(o.w, o.x, o.y, o.z);
 
 		// Scale is constant
@@ -330,21 +518,11 @@ HRESULT KinectDevice::processSkeletonData()
 	return hr;
 }
 
-const NUI_SKELETON_DATA *KinectDevice::getFirstTrackedSkeletonData(const NUI_SKELETON_FRAME& skeletonFrame ) const
+void KinectDevice::setJointFilter( const std::string& name )
 {
-	for (int i = 0; i < NUI_SKELETON_COUNT; ++i) {
-		const NUI_SKELETON_DATA *data = &skeletonFrame.SkeletonData[i];
-		if (data->eTrackingState == NUI_SKELETON_TRACKED) {
-			return data;
-		}
+	for (size_t actor = 0; actor < max_actors; ++actor) {
+		if (nullptr != jointFilters[actor] && name == jointFilters[actor]->getName()) continue;
+		jointFilters[actor] = createJointFilter(name);
+		filterTrackingIDs[actor] = 0;
 	}
-
-	return nullptr;
-}
-
-void KinectDevice::setSkeletonSmoothingLevel( const std::string& level )
-{
-	     if (level == "Light")  skeletonSmoothParams = lightSmoothing;
-	else if (level == "Medium") skeletonSmoothParams = mediumSmoothing;
-	else if (level == "Heavy")  skeletonSmoothParams = heavySmoothing;
 }
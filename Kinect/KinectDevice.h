@@ -4,16 +4,23 @@
 
 #include <NuiApi.h>
 
+#include "JointFilter.h"
+#include "PlayerSegmentation.h"
+#include "SkeletonFusion.h"
+#include "SkeletonSource.h"
+
 #include <SFML/System/Clock.hpp>
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
 class Skeleton;
+class KinectSensorSource;
 
 
-class KinectDevice
+class KinectDevice : public SkeletonSource
 {
 private:
 	enum EStreamType { COLOR_STREAM, DEPTH_STREAM };
@@ -27,6 +34,8 @@ public:
 	static const int bytes_per_pixel     = 4;
 	static const int color_pixels        = image_stream_width * image_stream_height;
 	static const int color_bytes         = color_pixels * bytes_per_pixel;
+	static const int depth_pixels        = image_stream_width * image_stream_height;
+	static const size_t max_actors       = NUI_SKELETON_MAX_TRACKED_COUNT; // skeletons tracked with joints
 
 public:
 	KinectDevice();
@@ -37,25 +46,40 @@ public:
 	void update();
 
 	void toggleSeatedMode();
-	void setSkeletonSmoothingParms( float smoothing
-	                              , float correction
-	                              , float prediction
-	                              , float jitterRadius
-	                              , float maxDeviationRadius );
-	void setSkeletonSmoothingLevel(const std::string& level);
+	// With several sensors, start collecting joints to calibrate them against the first, or solve and save
+	void toggleSensorCalibration();
+	// Filter applied to tracked joint positions by name, see createJointFilter, "Off" for raw positions
+	void setJointFilter(const std::string& name);
 
 	const INuiSensor *getSensor() const;
 	const std::string& getDeviceId() const;
 	const byte *getColorData() const;
-	const byte *getDepthData() const;
-	const Skeleton *getLiveSkeleton() const;
+	// Raw depth frame, depth_pixels of player index and depth in mm, both unsigned shorts
+	const NUI_DEPTH_IMAGE_PIXEL *getDepthData() const;
+	// Depths the latest frame measures reliably in mm, narrower in near mode
+	USHORT getMinDepth() const;
+	USHORT getMaxDepth() const;
+	// Player masks, bounds and silhouette of the latest depth frame
+	const PlayerSegmentation& getPlayerSegmentation() const;
+	// Player index of an actor's pixels in depth frames, 0 if it has none (a fused skeleton)
+	size_t getActorPlayerIndex(size_t actor) const;
+	const Skeleton *getLiveSkeleton(size_t actor = 0) const;
 	const NUI_SKELETON_FRAME& getSkeletonFrame() const;
-	const NUI_SKELETON_BONE_ORIENTATION *getOrientations() const;
+	const NUI_SKELETON_BONE_ORIENTATION *getOrientations(size_t actor = 0) const;
+	// Filter of the first actor, each actor has its own
+	JointFilter *getJointFilter();
+	const JointFilter *getJointFilter() const;
 
 	bool isInitialized() const;
 	bool isSeatedModeEnabled() const;
+	// Skeletons of every connected sensor fused into actor 0, when there are several
+	bool isFusingSensors() const;
+	const SkeletonFusion *getFusion() const;
 
-	const NUI_SKELETON_DATA *getFirstTrackedSkeletonData(const NUI_SKELETON_FRAME& skeletonFrame) const;
+	// Actor 0 is the first skeleton tracked, it stays first for as long as it is tracked
+	const SkeletonData *getTrackedSkeletonData() const;
+	size_t getNumActors() const;
+	const SkeletonData *getActorSkeletonData(size_t actor) const;
 
 public: // External interface
 	static void initRequest();
@@ -67,6 +91,11 @@ private:
 
 	HRESULT processImageStreamData(const EStreamType& eStreamType);
 	HRESULT processSkeletonData();
+	HRESULT processFusedSkeletonData();
+	HRESULT processActor(size_t actor, NUI_SKELETON_DATA *skeletonData, float frameDelta, bool filterGap);
+
+	void loadSensorExtrinsics();
+	void saveSensorExtrinsics() const;
 
 private:
 	INuiSensor *sensor;
@@ -76,40 +105,58 @@ private:
 	HANDLE depthStream;
 
 	byte *colorData;
-	byte *depthData;
+	NUI_DEPTH_IMAGE_PIXEL *depthData;
+	USHORT minDepth;
+	USHORT maxDepth;
 
-	Skeleton *liveSkeleton;
+	// Depth frames split by player
+	PlayerSegmentation playerSegmentation;
+
+	// Per actor, in actor order
+	Skeleton *liveSkeletons[max_actors];
 	NUI_SKELETON_FRAME skeletonFrame;
-	NUI_SKELETON_DATA *skeletonData;
-	NUI_SKELETON_BONE_ORIENTATION boneOrientations[NUI_SKELETON_POSITION_COUNT];
-	NUI_TRANSFORM_SMOOTH_PARAMETERS skeletonSmoothParams;
+	NUI_SKELETON_BONE_ORIENTATION boneOrientations[max_actors][NUI_SKELETON_POSITION_COUNT];
+	SkeletonData trackedSkeletons[max_actors];
+	size_t numTrackedSkeletons;
+	std::unique_ptr<JointFilter> jointFilters[max_actors];
+	DWORD filterTrackingIDs[max_actors]; // actor each filter last smoothed, 0 for none
+	size_t actorPlayerIndices[max_actors];
+	LONGLONG lastSkeletonTimeStamp; // ms
 	DWORD  skeletonTrackingFlags;
 	bool seatedMode;
 
+	// Every sensor's skeleton stream on a thread of its own, the first is sensor
+	std::unique_ptr<SkeletonFusion> fusion;
+	std::vector<KinectSensorSource*> fusionSources; // owned by fusion
+	NUI_SKELETON_DATA fusedSkeletonData;
+	sf::Clock fusedSkeletonClock; // since the last fused skeleton
+
 	HANDLE nextColorFrameEvent;
 	HANDLE nextDepthFrameEvent;
 	HANDLE nextSkeletonFrameEvent;
 
 };
 
-inline void KinectDevice::setSkeletonSmoothingParms( float smoothing
-                                                   , float correction
-                                                   , float prediction
-                                                   , float jitterRadius
-                                                   , float maxDeviationRadius )
-{
-	NUI_TRANSFORM_SMOOTH_PARAMETERS params = { smoothing, correction, prediction, jitterRadius, maxDeviationRadius };
-	skeletonSmoothParams = params;
-}
-
 inline const INuiSensor *KinectDevice::getSensor() const { return sensor; }
 inline const std::string& KinectDevice::getDeviceId() const { return deviceId; }
 
 inline const byte *KinectDevice::getColorData() const { return colorData; }
-inline const byte *KinectDevice::getDepthData() const { return depthData; }
-inline const Skeleton *KinectDevice::getLiveSkeleton() const { return liveSkeleton; }
+inline const NUI_DEPTH_IMAGE_PIXEL *KinectDevice::getDepthData() const { return depthData; }
+inline USHORT KinectDevice::getMinDepth() const { return minDepth; }
+inline USHORT KinectDevice::getMaxDepth() const { return maxDepth; }
+inline const PlayerSegmentation& KinectDevice::getPlayerSegmentation() const { return playerSegmentation; }
+inline size_t KinectDevice::getActorPlayerIndex(size_t actor) const { return (actor < numTrackedSkeletons) ? actorPlayerIndices[actor] : 0; }
+inline const Skeleton *KinectDevice::getLiveSkeleton(size_t actor) const { return liveSkeletons[actor]; }
 inline const NUI_SKELETON_FRAME& KinectDevice::getSkeletonFrame() const { return skeletonFrame; }
-inline const NUI_SKELETON_BONE_ORIENTATION *KinectDevice::getOrientations() const { return boneOrientations; }
+inline const NUI_SKELETON_BONE_ORIENTATION *KinectDevice::getOrientations(size_t actor) const { return boneOrientations[actor]; }
+inline JointFilter *KinectDevice::getJointFilter() { return jointFilters[0].get(); }
+inline const JointFilter *KinectDevice::getJointFilter() const { return jointFilters[0].get(); }
+
+inline const SkeletonData *KinectDevice::getTrackedSkeletonData() const { return getActorSkeletonData(0); }
+inline size_t KinectDevice::getNumActors() const { return numTrackedSkeletons; }
+inline const SkeletonData *KinectDevice::getActorSkeletonData(size_t actor) const { return (actor < numTrackedSkeletons) ? &trackedSkeletons[actor] : nullptr; }
 
 inline bool KinectDevice::isInitialized()       const { return (nullptr != sensor); }
 inline bool KinectDevice::isSeatedModeEnabled() const { return seatedMode; }
+inline bool KinectDevice::isFusingSensors()     const { return (nullptr != fusion); }
+inline const SkeletonFusion *KinectDevice::getFusion() const { return fusion.get(); }
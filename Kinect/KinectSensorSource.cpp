@@ -0,0 +1,149 @@
+#include "KinectSensorSource.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+using namespace std;
+
+const float inferred_confidence = 0.2f;    // an inferred joint next to a tracked one from another sensor
+const double clock_drift_per_frame = 1e-5; // seconds the clock offset may creep up per frame, for device clock drift
+
+
+KinectSensorSource::KinectSensorSource( int index )
+	: sensor(nullptr)
+	, ownsSensor(true)
+	, deviceId("[ offline ]")
+	, nextSkeletonFrameEvent(INVALID_HANDLE_VALUE)
+	, failed(true)
+	, clockOffset(0.0)
+	, clockSynced(false)
+	, skeletonFrame()
+	, trackingID(0)
+{
+	QueryPerformanceFrequency(&counterFrequency);
+
+	HRESULT hr = NuiCreateSensorByIndex(index, &sensor);
+	if (FAILED(hr) || nullptr == sensor) {
+		sensor = nullptr;
+		return;
+	}
+
+	hr = sensor->NuiInitialize(NUI_INITIALIZE_FLAG_USES_SKELETON);
+	if (FAILED(hr)) return;
+
+	open();
+}
+
+KinectSensorSource::KinectSensorSource( INuiSensor *sensor )
+	: sensor(sensor)
+	, ownsSensor(false)
+	, deviceId("[ offline ]")
+	, nextSkeletonFrameEvent(INVALID_HANDLE_VALUE)
+	, failed(true)
+	, clockOffset(0.0)
+	, clockSynced(false)
+	, skeletonFrame()
+	, trackingID(0)
+{
+	QueryPerformanceFrequency(&counterFrequency);
+
+	if (nullptr != sensor) {
+		open();
+	}
+}
+
+KinectSensorSource::~KinectSensorSource()
+{
+	if (nullptr != sensor && ownsSensor) {
+		sensor->NuiShutdown();
+	}
+
+	if (INVALID_HANDLE_VALUE != nextSkeletonFrameEvent) {
+		CloseHandle(nextSkeletonFrameEvent);
+	}
+}
+
+bool KinectSensorSource::enableTracking( DWORD flags )
+{
+	HRESULT hr = sensor->NuiSkeletonTrackingEnable(nextSkeletonFrameEvent, flags);
+	return SUCCEEDED(hr);
+}
+
+void KinectSensorSource::open()
+{
+	BSTR bstr = sensor->NuiDeviceConnectionId();
+	const wstring wstr(bstr, SysStringLen(bstr));
+	deviceId.assign(begin(wstr), end(wstr));
+
+	nextSkeletonFrameEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+	failed = !enableTracking(0);
+}
+
+void KinectSensorSource::setSeatedMode( bool seated )
+{
+	if (failed) return;
+
+	if (!enableTracking(seated ? NUI_SKELETON_TRACKING_FLAG_ENABLE_SEATED_SUPPORT : 0)) {
+		failed = true;
+	}
+}
+
+double KinectSensorSource::hostSeconds() const
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return static_cast<double>(counter.QuadPart) / static_cast<double>(counterFrequency.QuadPart);
+}
+
+bool KinectSensorSource::readFrame( SensorFrame& frame, unsigned int timeoutMs )
+{
+	if (failed) return false;
+	if (WAIT_OBJECT_0 != WaitForSingleObject(nextSkeletonFrameEvent, timeoutMs)) return false;
+
+	const double arrived = hostSeconds();
+	HRESULT hr = sensor->NuiSkeletonGetNextFrame(0, &skeletonFrame);
+	if (FAILED(hr)) return false;
+
+	// Follow the same skeleton for as long as it's tracked, else the first one tracked
+	NUI_SKELETON_DATA *skeletonData = nullptr;
+	for (int i = 0; i < NUI_SKELETON_COUNT; ++i) {
+		NUI_SKELETON_DATA *data = &skeletonFrame.SkeletonData[i];
+		if (data->eTrackingState != NUI_SKELETON_TRACKED) continue;
+
+		if (nullptr == skeletonData || data->dwTrackingID == trackingID) {
+			skeletonData = data;
+		}
+	}
+	if (nullptr == skeletonData) {
+		trackingID = 0;
+		return false;
+	}
+	trackingID = skeletonData->dwTrackingID;
+
+	hr = NuiSkeletonCalculateBoneOrientations(skeletonData, boneOrientations);
+	if (FAILED(hr)) return false;
+
+	// Device time stamps are ms since the device started, each device has its own
+	const double device = skeletonFrame.liTimeStamp.QuadPart / 1000.0;
+	const double offset = arrived - device;
+	clockOffset = (clockSynced && offset > clockOffset + clock_drift_per_frame) ? clockOffset + clock_drift_per_frame : offset;
+	clockSynced = true;
+
+	frame.timeStamp = device + clockOffset;
+	frame.skeleton.trackingID = skeletonData->dwTrackingID;
+	for (unsigned short boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const Vector4& p = skeletonData->SkeletonPositions[boneID];
+		const Vector4& q = boneOrientations[boneID].hierarchicalRotation.rotationQuaternion;
+		const Vector4& a = boneOrientations[boneID].absoluteRotation.rotationQuaternion;
+		frame.skeleton.positions[boneID] = glm::vec3(p.x, p.y, p.z);
+		frame.skeleton.hierarchicalRotations[boneID] = glm::normalize(glm::quat(q.w, q.x, q.y, q.z));
+		frame.skeleton.absoluteRotations[boneID] = glm::normalize(glm::quat(a.w, a.x, a.y, a.z));
+
+		switch (skeletonData->eSkeletonPositionTrackingState[boneID]) {
+			case NUI_SKELETON_POSITION_TRACKED:  frame.confidence[boneID] = 1.f; break;
+			case NUI_SKELETON_POSITION_INFERRED: frame.confidence[boneID] = inferred_confidence; break;
+			default:                             frame.confidence[boneID] = 0.f; break;
+		}
+	}
+	return true;
+}
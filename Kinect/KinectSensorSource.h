@@ -0,0 +1,57 @@
+#pragma once
+#include <Windows.h>
+#define WIN32_LEAN_AND_MEAN
+
+#include <NuiApi.h>
+
+#include "SensorSource.h"
+
+#include <string>
+
+
+// One Kinect's skeleton stream as a sensor of a SkeletonFusion
+// Frames carry the first skeleton tracked, with its joints' tracking states as confidence,
+// and a time stamp moved from the device's clock onto the host's performance counter,
+// so frames of different devices can be lined up
+class KinectSensorSource : public SensorSource
+{
+public:
+	// Opens the sensor at index for skeleton tracking only, it's shut down with the source
+	explicit KinectSensorSource(int index);
+	// Tracks skeletons on a sensor that was already initialized, the caller keeps it
+	explicit KinectSensorSource(INuiSensor *sensor);
+	~KinectSensorSource();
+
+	bool readFrame(SensorFrame& frame, unsigned int timeoutMs);
+	bool isOpen() const;
+	std::string getName() const;
+
+	void setSeatedMode(bool seated);
+
+private:
+	KinectSensorSource(const KinectSensorSource&);
+	KinectSensorSource& operator=(const KinectSensorSource&);
+
+	void open();
+	bool enableTracking(DWORD flags);
+	double hostSeconds() const;
+
+	INuiSensor *sensor;
+	const bool ownsSensor;
+	std::string deviceId;
+	HANDLE nextSkeletonFrameEvent;
+	volatile bool failed;
+
+	// Host time minus device time, the smallest seen is the one with the least delivery delay
+	LARGE_INTEGER counterFrequency;
+	double clockOffset;
+	bool clockSynced;
+
+	NUI_SKELETON_FRAME skeletonFrame;
+	NUI_SKELETON_BONE_ORIENTATION boneOrientations[NUI_SKELETON_POSITION_COUNT];
+	DWORD trackingID; // skeleton followed, kept while it's tracked
+
+};
+
+inline bool KinectSensorSource::isOpen() const { return !failed; }
+inline std::string KinectSensorSource::getName() const { return deviceId; }
@@ -0,0 +1,217 @@
+#include "PlayerSegmentation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PLAYER_SEGMENTATION_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+	const int chunk_pixels = 16; // mask bits per word, pixels per SSE2 step
+
+	inline unsigned int highestSetBit(unsigned int bits)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse(&index, bits);
+		return index;
+#else
+		return 31 - __builtin_clz(bits);
+#endif
+	}
+
+	inline unsigned int lowestSetBit(unsigned int bits)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, bits);
+		return index;
+#else
+		return __builtin_ctz(bits);
+#endif
+	}
+
+	inline unsigned int countSetBits(unsigned int bits)
+	{
+		bits = bits - ((bits >> 1) & 0x5555);
+		bits = (bits & 0x3333) + ((bits >> 2) & 0x3333);
+		bits = (bits + (bits >> 4)) & 0x0f0f;
+		return (bits + (bits >> 8)) & 0x1f;
+	}
+
+	// Player index of count pixels packed into bytes, one at a time, what the end of a row
+	// narrower than a chunk and builds without SSE2 do
+	inline void packPlayerIndices(const DepthPixel *pixels, int count, unsigned char *indices)
+	{
+		for (int i = 0; i < count; ++i) {
+			indices[i] = static_cast<unsigned char>(std::min<unsigned short>(pixels[i].playerIndex, 255));
+		}
+	}
+
+	inline unsigned int playerBits(const unsigned char *indices, int count, unsigned char player)
+	{
+		unsigned int bits = 0;
+		for (int i = 0; i < count; ++i) {
+			if (indices[i] == player) bits |= 1u << i;
+		}
+		return bits;
+	}
+}
+
+
+PlayerSegmentation::PlayerSegmentation( int width, int height )
+	: width(width)
+	, height(height)
+	, maskStride((width + chunk_pixels - 1) / chunk_pixels)
+	, masks(max_players * maskStride * height, 0)
+	, silhouette(static_cast<size_t>(width) * height * 4, 0)
+{
+	assert(width > 0 && height > 0);
+}
+
+void PlayerSegmentation::segment( const DepthPixel *pixels )
+{
+	for (size_t player = 0; player < max_players; ++player) {
+		bounds[player] = PlayerBounds();
+		bounds[player].left = width;
+		bounds[player].top  = height;
+	}
+
+	for (int y = 0; y < height; ++y) {
+		const DepthPixel *row = pixels + static_cast<size_t>(y) * width;
+		unsigned char *silhouetteRow = &silhouette[static_cast<size_t>(y) * width * 4];
+		unsigned short *maskRow = &masks[y * maskStride];
+		const size_t maskSize = maskStride * height;
+
+		int x = 0;
+#if defined(PLAYER_SEGMENTATION_SSE2)
+		const __m128i index_bits = _mm_set1_epi32(0xffff);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i ones = _mm_cmpeq_epi8(zero, zero);
+		for (; x + chunk_pixels <= width; x += chunk_pixels) {
+			// Player index is the low half of each pixel, narrowed to 16 bytes with saturation
+			const __m128i *chunk = reinterpret_cast<const __m128i *>(row + x);
+			const __m128i p0 = _mm_and_si128(_mm_loadu_si128(chunk + 0), index_bits);
+			const __m128i p1 = _mm_and_si128(_mm_loadu_si128(chunk + 1), index_bits);
+			const __m128i p2 = _mm_and_si128(_mm_loadu_si128(chunk + 2), index_bits);
+			const __m128i p3 = _mm_and_si128(_mm_loadu_si128(chunk + 3), index_bits);
+			const __m128i indices = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+
+			// Any player, each byte widened to a whole RGBA pixel, bytes compare signed so not none
+			const __m128i any = _mm_xor_si128(_mm_cmpeq_epi8(indices, zero), ones);
+			const unsigned int anyBits = static_cast<unsigned int>(_mm_movemask_epi8(any));
+			const __m128i lo = _mm_unpacklo_epi8(any, any);
+			const __m128i hi = _mm_unpackhi_epi8(any, any);
+			__m128i *out = reinterpret_cast<__m128i *>(silhouetteRow + x * 4);
+			_mm_storeu_si128(out + 0, _mm_unpacklo_epi16(lo, lo));
+			_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(lo, lo));
+			_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(hi, hi));
+			_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(hi, hi));
+
+			// Most of a frame is background, nobody's mask has a bit there
+			const size_t word = x / chunk_pixels;
+			if (0 == anyBits) {
+				for (size_t player = 0; player < max_players; ++player) {
+					maskRow[player * maskSize + word] = 0;
+				}
+				continue;
+			}
+			for (size_t player = 0; player < max_players; ++player) {
+				const __m128i on = _mm_cmpeq_epi8(indices, _mm_set1_epi8(static_cast<char>(player + 1)));
+				const unsigned int bits = static_cast<unsigned int>(_mm_movemask_epi8(on));
+				maskRow[player * maskSize + word] = static_cast<unsigned short>(bits);
+				if (0 != bits) addChunk(player, bits, x, y);
+			}
+		}
+#endif
+		// Whatever is left of the row, at most one chunk with SSE2, all of it without
+		for (; x < width; x += chunk_pixels) {
+			const int count = std::min(chunk_pixels, width - x);
+			unsigned char indices[chunk_pixels];
+			packPlayerIndices(row + x, count, indices);
+
+			unsigned int *out = reinterpret_cast<unsigned int *>(silhouetteRow + x * 4);
+			for (int i = 0; i < count; ++i) {
+				out[i] = (0 != indices[i]) ? 0xffffffffu : 0u;
+			}
+
+			const size_t word = x / chunk_pixels;
+			for (size_t player = 0; player < max_players; ++player) {
+				const unsigned int bits = playerBits(indices, count, static_cast<unsigned char>(player + 1));
+				maskRow[player * maskSize + word] = static_cast<unsigned short>(bits);
+				if (0 != bits) addChunk(player, bits, x, y);
+			}
+		}
+	}
+
+	for (size_t player = 0; player < max_players; ++player) {
+		if (0 == bounds[player].numPixels) bounds[player] = PlayerBounds();
+	}
+}
+
+void PlayerSegmentation::addChunk( size_t player, unsigned int bits, int x, int y )
+{
+	PlayerBounds& b = bounds[player];
+	b.left   = std::min(b.left,  x + static_cast<int>(lowestSetBit(bits)));
+	b.right  = std::max(b.right, x + static_cast<int>(highestSetBit(bits)));
+	b.top    = std::min(b.top, y);
+	b.bottom = y;
+	b.numPixels += countSetBits(bits);
+}
+
+bool PlayerSegmentation::isPlayerPixel( size_t player, int x, int y ) const
+{
+	const unsigned short word = getMask(player)[y * maskStride + x / chunk_pixels];
+	return 0 != ((word >> (x % chunk_pixels)) & 1);
+}
+
+size_t PlayerSegmentation::getNumPlayers() const
+{
+	size_t numPlayers = 0;
+	for (size_t player = 0; player < max_players; ++player) {
+		if (bounds[player].numPixels > 0) ++numPlayers;
+	}
+	return numPlayers;
+}
+
+void PlayerSegmentation::crop( const void *image, size_t bytesPerPixel, const PlayerBounds& region, PlayerCrop& cropped, size_t maskPlayer/*=0*/ ) const
+{
+	cropped.bounds = region;
+	cropped.bytesPerPixel = bytesPerPixel;
+	const size_t rowBytes = region.getWidth() * bytesPerPixel;
+	cropped.pixels.resize(rowBytes * region.getHeight());
+	if (cropped.pixels.empty()) return;
+
+	const unsigned char *source = static_cast<const unsigned char *>(image);
+	unsigned char *dest = &cropped.pixels[0];
+	for (int y = region.top; y <= region.bottom; ++y, dest += rowBytes) {
+		memcpy(dest, source + (static_cast<size_t>(y) * width + region.left) * bytesPerPixel, rowBytes);
+		if (0 == maskPlayer) continue;
+
+		for (int x = region.left; x <= region.right; ++x) {
+			if (!isPlayerPixel(maskPlayer, x, y)) {
+				memset(dest + (x - region.left) * bytesPerPixel, 0, bytesPerPixel);
+			}
+		}
+	}
+}
+
+PlayerBounds PlayerSegmentation::grow( const PlayerBounds& region, int margin ) const
+{
+	if (region.isEmpty()) return region;
+
+	PlayerBounds grown(region);
+	grown.left   = std::max(0, region.left - margin);
+	grown.top    = std::max(0, region.top - margin);
+	grown.right  = std::min(width - 1, region.right + margin);
+	grown.bottom = std::min(height - 1, region.bottom + margin);
+	return grown;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+
+// One pixel of a depth frame, laid out as NUI_DEPTH_IMAGE_PIXEL so SDK frames are segmented as they are
+struct DepthPixel
+{
+	unsigned short playerIndex; // 0 off every player, else the player's skeleton slot + 1
+	unsigned short depth;       // mm
+};
+
+// Pixel rectangle of a frame, edges inclusive, with how many player pixels are in it
+struct PlayerBounds
+{
+	int left, top, right, bottom;
+	size_t numPixels;
+
+	PlayerBounds() : left(0), top(0), right(-1), bottom(-1), numPixels(0) {}
+
+	bool isEmpty() const { return right < left || bottom < top; }
+	int getWidth() const { return isEmpty() ? 0 : right - left + 1; }
+	int getHeight() const { return isEmpty() ? 0 : bottom - top + 1; }
+};
+
+// Part of a frame, the pixels inside bounds row after row
+struct PlayerCrop
+{
+	PlayerBounds bounds;
+	size_t bytesPerPixel;
+	std::vector<unsigned char> pixels;
+
+	PlayerCrop() : bounds(), bytesPerPixel(0), pixels() {}
+};
+
+
+// Per player masks and bounding boxes of depth frames with player indices
+// A frame is read once, 16 pixels a step with SSE2: their player indices are packed into
+// bytes, compared against every player at once, and each player's 16 mask bits come
+// straight from the comparison. Bounds and pixel counts follow from the bits, and an
+// RGBA silhouette of every player for overlays from the packed indices
+//
+// Masks are a bit per pixel, rows of getMaskStride() words with bit n of a word the
+// n-th pixel of its 16, 1/32 of the frame each, small enough to keep or send along with a crop
+class PlayerSegmentation
+{
+public:
+	static const size_t max_players = 6;
+
+	PlayerSegmentation(int width, int height);
+
+	// Segment a frame of width * height pixels, row after row
+	void segment(const DepthPixel *pixels);
+
+	// Players are 1 to max_players, as in the pixels' player index
+	const unsigned short *getMask(size_t player) const;
+	const PlayerBounds& getBounds(size_t player) const;
+	bool isPlayerPixel(size_t player, int x, int y) const;
+	// Players with at least one pixel in the latest frame
+	size_t getNumPlayers() const;
+
+	// Opaque white on every player, transparent everywhere else, 4 bytes a pixel
+	const unsigned char *getSilhouette() const;
+
+	// Copy the part of image inside region, an image with the frame's size and bytesPerPixel,
+	// into cropped, with maskPlayer pixels off that player's mask are cleared, 0 keeps every pixel
+	// The crop's storage is reused, so cropping into the same one again doesn't allocate
+	void crop(const void *image, size_t bytesPerPixel, const PlayerBounds& region, PlayerCrop& cropped, size_t maskPlayer = 0) const;
+	// region grown by margin pixels on every side, within the frame
+	PlayerBounds grow(const PlayerBounds& region, int margin) const;
+
+	int getWidth() const;
+	int getHeight() const;
+	size_t getMaskStride() const;
+
+private:
+	void addChunk(size_t player, unsigned int bits, int x, int y);
+
+	int width;
+	int height;
+	size_t maskStride; // words per mask row
+
+	std::vector<unsigned short> masks; // max_players masks, one after the other
+	PlayerBounds bounds[max_players];
+	std::vector<unsigned char> silhouette;
+
+};
+
+inline const unsigned short *PlayerSegmentation::getMask(size_t player) const { return &masks[(player - 1) * maskStride * height]; }
+inline const PlayerBounds& PlayerSegmentation::getBounds(size_t player) const { return bounds[player - 1]; }
+inline const unsigned char *PlayerSegmentation::getSilhouette() const { return &silhouette[0]; }
+inline int PlayerSegmentation::getWidth() const { return width; }
+inline int PlayerSegmentation::getHeight() const { return height; }
+inline size_t PlayerSegmentation::getMaskStride() const { return maskStride; }
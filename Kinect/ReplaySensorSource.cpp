@@ -0,0 +1,115 @@
+#include "ReplaySensorSource.h"
+
+#include <fstream>
+#include <limits>
+#include <thread>
+
+namespace
+{
+	const char *const sensor_frames_header = "KinectedActing sensor frames 1";
+
+	void writeQuat(std::ostream& out, const glm::quat& q)
+	{
+		out << " " << q.w << " " << q.x << " " << q.y << " " << q.z;
+	}
+
+	bool readQuat(std::istream& in, glm::quat& q)
+	{
+		in >> q.w >> q.x >> q.y >> q.z;
+		return !in.fail();
+	}
+}
+
+
+ReplaySensorSource::ReplaySensorSource( const std::string& path, float speed/*=1.f*/ )
+	: name(path)
+	, frames()
+	, speed(speed)
+	, next(0)
+	, started(false)
+	, startTime()
+{
+	std::ifstream in(path.c_str());
+	if (!in || !readSensorFrames(in, frames)) {
+		frames.clear();
+	}
+}
+
+ReplaySensorSource::ReplaySensorSource( const std::vector<SensorFrame>& frames, const std::string& name, float speed/*=1.f*/ )
+	: name(name)
+	, frames(frames)
+	, speed(speed)
+	, next(0)
+	, started(false)
+	, startTime()
+{}
+
+bool ReplaySensorSource::readFrame( SensorFrame& frame, unsigned int timeoutMs )
+{
+	if (!isOpen()) return false;
+
+	if (!started) {
+		startTime = std::chrono::steady_clock::now();
+		started = true;
+	}
+
+	// Wait for the frame's turn, or as much of the wait as the timeout allows
+	if (speed > 0.f) {
+		const double seconds = (frames[next].timeStamp - frames[0].timeStamp) / speed;
+		const std::chrono::steady_clock::time_point due = startTime + std::chrono::microseconds(static_cast<long long>(seconds * 1e6));
+		const std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		if (due > timeout) {
+			std::this_thread::sleep_until(timeout);
+			return false;
+		}
+		std::this_thread::sleep_until(due);
+	}
+
+	frame = frames[next++];
+	return true;
+}
+
+
+void writeSensorFrames( const std::vector<SensorFrame>& frames, std::ostream& out )
+{
+	out.precision(std::numeric_limits<float>::digits10 + 2);
+	out << sensor_frames_header << "\n" << frames.size() << "\n";
+	for (auto& frame : frames) {
+		// Time stamps need a double's precision after a long session
+		out.precision(std::numeric_limits<double>::digits10 + 2);
+		out << frame.timeStamp << " " << frame.skeleton.trackingID << "\n";
+		out.precision(std::numeric_limits<float>::digits10 + 2);
+
+		for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+			const glm::vec3& p = frame.skeleton.positions[boneID];
+			out << p.x << " " << p.y << " " << p.z;
+			writeQuat(out, frame.skeleton.hierarchicalRotations[boneID]);
+			writeQuat(out, frame.skeleton.absoluteRotations[boneID]);
+			out << " " << frame.confidence[boneID] << "\n";
+		}
+	}
+}
+
+bool readSensorFrames( std::istream& in, std::vector<SensorFrame>& frames )
+{
+	std::string header;
+	if (!std::getline(in, header) || header != sensor_frames_header) return false;
+
+	size_t count = 0;
+	if (!(in >> count)) return false;
+
+	SensorFrame frame;
+	for (size_t i = 0; i < count; ++i) {
+		if (!(in >> frame.timeStamp >> frame.skeleton.trackingID)) return false;
+
+		for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+			glm::vec3& p = frame.skeleton.positions[boneID];
+			if (!(in >> p.x >> p.y >> p.z)) return false;
+			if (!readQuat(in, frame.skeleton.hierarchicalRotations[boneID])) return false;
+			if (!readQuat(in, frame.skeleton.absoluteRotations[boneID])) return false;
+			if (!(in >> frame.confidence[boneID])) return false;
+		}
+		frames.push_back(frame);
+	}
+	return true;
+}
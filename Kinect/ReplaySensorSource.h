@@ -0,0 +1,48 @@
+#pragma once
+
+#include "SensorSource.h"
+
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+// Recorded skeleton frames standing in for a sensor, so fusion runs without the devices
+// Frames are handed out at the pace their time stamps were captured at times speed,
+// or as fast as they are read with a speed of 0, and keep their recorded time stamps
+class ReplaySensorSource : public SensorSource
+{
+public:
+	// Every frame of the file at path is loaded up front, the source is closed if that fails
+	explicit ReplaySensorSource(const std::string& path, float speed = 1.f);
+	ReplaySensorSource(const std::vector<SensorFrame>& frames, const std::string& name, float speed = 1.f);
+
+	bool readFrame(SensorFrame& frame, unsigned int timeoutMs);
+	bool isOpen() const;
+	std::string getName() const;
+
+	size_t getNumFrames() const;
+
+private:
+	const std::string name;
+	std::vector<SensorFrame> frames;
+	const float speed;
+
+	size_t next;
+	bool started;
+	std::chrono::steady_clock::time_point startTime; // when the first frame was read
+
+};
+
+inline bool ReplaySensorSource::isOpen() const { return next < frames.size(); }
+inline std::string ReplaySensorSource::getName() const { return name; }
+inline size_t ReplaySensorSource::getNumFrames() const { return frames.size(); }
+
+
+// Sensor frames as text, a header line then per frame its time stamp and tracking id followed
+// by a line per joint: position, hierarchical and absolute rotation (w x y z) and confidence
+void writeSensorFrames(const std::vector<SensorFrame>& frames, std::ostream& out);
+// Appends the frames read to frames, false if the stream isn't sensor frames or ends early
+bool readSensorFrames(std::istream& in, std::vector<SensorFrame>& frames);
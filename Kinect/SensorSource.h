@@ -0,0 +1,31 @@
+#pragma once
+
+#include "SkeletonSource.h"
+
+#include <string>
+
+
+// One skeleton as one sensor saw it, in that sensor's camera space
+struct SensorFrame
+{
+	double timeStamp; // seconds, on a clock every sensor of a fusion shares
+	SkeletonData skeleton;
+	float confidence[EBoneID::COUNT]; // per joint, 0 for not tracked up to 1 for tracked
+};
+
+
+// A capture device, or a stand in for one, delivering skeleton frames to a SkeletonFusion
+// Once fusion starts readFrame is called over and over on the sensor's own acquisition
+// thread, and nothing else is called from any other thread but getName
+class SensorSource
+{
+public:
+	virtual ~SensorSource() {}
+
+	// Wait up to timeoutMs for the sensor's next frame, false if none came
+	virtual bool readFrame(SensorFrame& frame, unsigned int timeoutMs) = 0;
+	// False once no frame will come anymore, at the end of a replay or after a device failed
+	virtual bool isOpen() const = 0;
+
+	virtual std::string getName() const = 0;
+};
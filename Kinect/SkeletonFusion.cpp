@@ -0,0 +1,344 @@
+#include "SkeletonFusion.h"
+#include "Animation/Skeleton.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	const size_t history_frames = 16;          // about half a second of a 30 Hz sensor
+	const unsigned int read_timeout_ms = 100;  // how long an acquisition thread waits before checking for stop()
+	const double max_sensor_lag = 0.25;        // seconds a sensor can trail the newest one before it's left out
+	const double max_frame_gap = 0.1;          // seconds, frames further apart aren't interpolated between
+	const double max_sample_offset = 1.0 / 30; // seconds a lone frame can be from the fused time
+	const float min_joint_weight = 0.001f;     // so a joint no sensor tracks is still averaged
+	const float calibration_confidence = 1.f;  // only tracked joints calibrate
+	const size_t min_calibration_points = 100;
+	const size_t max_calibration_points = EBoneID::COUNT * 30 * 120;
+
+	// Largest eigenvalue's eigenvector of symmetric m, by repeated squaring of m shifted positive definite
+	void dominantEigenvector(double m[4][4], double v[4])
+	{
+		double shift = 0.0;
+		for (int i = 0; i < 4; ++i) {
+			double row = 0.0;
+			for (int j = 0; j < 4; ++j) row += std::abs(m[i][j]);
+			shift = std::max(shift, row);
+		}
+		for (int i = 0; i < 4; ++i) m[i][i] += shift;
+
+		for (int iteration = 0; iteration < 32; ++iteration) {
+			double squared[4][4];
+			double largest = 0.0;
+			for (int i = 0; i < 4; ++i) {
+				for (int j = 0; j < 4; ++j) {
+					squared[i][j] = 0.0;
+					for (int k = 0; k < 4; ++k) squared[i][j] += m[i][k] * m[k][j];
+					largest = std::max(largest, std::abs(squared[i][j]));
+				}
+			}
+			if (largest == 0.0) break;
+			for (int i = 0; i < 4; ++i) {
+				for (int j = 0; j < 4; ++j) m[i][j] = squared[i][j] / largest;
+			}
+		}
+
+		// Every column is now a multiple of the eigenvector, take the longest
+		double best = -1.0;
+		for (int j = 0; j < 4; ++j) {
+			double length = 0.0;
+			for (int i = 0; i < 4; ++i) length += m[i][j] * m[i][j];
+			if (length <= best) continue;
+			best = length;
+			for (int i = 0; i < 4; ++i) v[i] = m[i][j];
+		}
+		const double length = std::sqrt(std::max(best, 0.0));
+		for (int i = 0; i < 4; ++i) v[i] = (length > 0.0) ? v[i] / length : (i == 0 ? 1.0 : 0.0);
+	}
+}
+
+
+SensorExtrinsics solveExtrinsics( const std::vector<glm::vec3>& from, const std::vector<glm::vec3>& to )
+{
+	const size_t count = std::min(from.size(), to.size());
+	if (count < 3) return SensorExtrinsics();
+
+	double fromCenter[3] = { 0.0 }, toCenter[3] = { 0.0 };
+	for (size_t i = 0; i < count; ++i) {
+		for (int axis = 0; axis < 3; ++axis) {
+			fromCenter[axis] += from[i][axis];
+			toCenter[axis]   += to[i][axis];
+		}
+	}
+	for (int axis = 0; axis < 3; ++axis) {
+		fromCenter[axis] /= count;
+		toCenter[axis]   /= count;
+	}
+
+	// Cross covariance s[a][b], sum of from's a coordinate times to's b coordinate about the centers
+	double s[3][3] = { { 0.0 } };
+	for (size_t i = 0; i < count; ++i) {
+		for (int r = 0; r < 3; ++r) {
+			for (int c = 0; c < 3; ++c) s[r][c] += (from[i][r] - fromCenter[r]) * (to[i][c] - toCenter[c]);
+		}
+	}
+
+	// The rotation is the unit quaternion (w, x, y, z) maximizing q^T n q
+	double n[4][4] = {
+		{ s[0][0] + s[1][1] + s[2][2], s[1][2] - s[2][1],            s[2][0] - s[0][2],            s[0][1] - s[1][0]           },
+		{ s[1][2] - s[2][1],           s[0][0] - s[1][1] - s[2][2],  s[0][1] + s[1][0],            s[2][0] + s[0][2]           },
+		{ s[2][0] - s[0][2],           s[0][1] + s[1][0],           -s[0][0] + s[1][1] - s[2][2],  s[1][2] + s[2][1]           },
+		{ s[0][1] - s[1][0],           s[2][0] + s[0][2],            s[1][2] + s[2][1],           -s[0][0] - s[1][1] + s[2][2] }
+	};
+	double q[4];
+	dominantEigenvector(n, q);
+
+	const glm::quat rotation = glm::normalize(glm::quat(static_cast<float>(q[0]), static_cast<float>(q[1]), static_cast<float>(q[2]), static_cast<float>(q[3])));
+	const glm::vec3 fromPoint(static_cast<float>(fromCenter[0]), static_cast<float>(fromCenter[1]), static_cast<float>(fromCenter[2]));
+	const glm::vec3 toPoint(static_cast<float>(toCenter[0]), static_cast<float>(toCenter[1]), static_cast<float>(toCenter[2]));
+	const glm::vec3 translation = toPoint - rotation * fromPoint;
+	return SensorExtrinsics(rotation, translation);
+}
+
+
+SkeletonFusion::SkeletonFusion()
+	: sensors()
+	, running(false)
+	, calibrating(false)
+	, fused()
+	, fusedTime(-std::numeric_limits<double>::max())
+	, numFusedSensors(0)
+{}
+
+SkeletonFusion::~SkeletonFusion()
+{
+	stop();
+}
+
+size_t SkeletonFusion::addSensor( std::unique_ptr<SensorSource> source, const SensorExtrinsics& extrinsics )
+{
+	// Acquisition threads hold on to their sensor, so none is added while they run
+	if (running) return sensors.size();
+
+	std::unique_ptr<Sensor> sensor(new Sensor());
+	sensor->source = std::move(source);
+	sensor->extrinsics = extrinsics;
+	sensor->history.resize(history_frames);
+	sensor->next = 0;
+	sensor->numFrames = 0;
+	sensor->latestTime = 0.0;
+	sensor->sampled = false;
+	sensors.push_back(std::move(sensor));
+	return sensors.size() - 1;
+}
+
+void SkeletonFusion::start()
+{
+	if (running) return;
+
+	running = true;
+	for (size_t i = 0; i < sensors.size(); ++i) {
+		sensors[i]->thread = std::thread(&SkeletonFusion::acquire, this, i);
+	}
+}
+
+void SkeletonFusion::stop()
+{
+	running = false;
+	for (auto& sensor : sensors) {
+		if (sensor->thread.joinable()) {
+			sensor->thread.join();
+		}
+	}
+}
+
+void SkeletonFusion::acquire( size_t sensor )
+{
+	SensorSource& source = *sensors[sensor]->source;
+	SensorFrame frame;
+	while (running && source.isOpen()) {
+		if (source.readFrame(frame, read_timeout_ms)) {
+			push(sensor, frame);
+		}
+	}
+}
+
+void SkeletonFusion::push( size_t sensor, const SensorFrame& frame )
+{
+	Sensor& s = *sensors[sensor];
+	std::lock_guard<std::mutex> lock(s.mutex);
+	s.history[s.next] = frame;
+	s.next = (s.next + 1) % s.history.size();
+	s.numFrames = std::min(s.numFrames + 1, s.history.size());
+}
+
+bool SkeletonFusion::update()
+{
+	// Latest frame of each sensor, frames arrive in time order so it's the one written last
+	const double none = -std::numeric_limits<double>::max();
+	double newest = none;
+	for (auto& sensor : sensors) {
+		std::lock_guard<std::mutex> lock(sensor->mutex);
+		sensor->latestTime = none;
+		if (0 == sensor->numFrames) continue;
+
+		const size_t last = (sensor->next + sensor->history.size() - 1) % sensor->history.size();
+		sensor->latestTime = sensor->history[last].timeStamp;
+		newest = std::max(newest, sensor->latestTime);
+	}
+	if (newest == none) return false;
+
+	// Every live sensor has a frame at or after the earliest of their latest frames
+	double time = newest;
+	for (auto& sensor : sensors) {
+		if (sensor->latestTime >= newest - max_sensor_lag) {
+			time = std::min(time, sensor->latestTime);
+		}
+	}
+	if (time <= fusedTime) return false;
+
+	return fuse(time);
+}
+
+bool SkeletonFusion::sample( Sensor& sensor, double time )
+{
+	std::lock_guard<std::mutex> lock(sensor.mutex);
+
+	// Closest frames either side of time
+	const SensorFrame *before = nullptr;
+	const SensorFrame *after  = nullptr;
+	for (size_t i = 0; i < sensor.numFrames; ++i) {
+		const size_t slot = (sensor.next + sensor.history.size() - sensor.numFrames + i) % sensor.history.size();
+		const SensorFrame& frame = sensor.history[slot];
+		if (frame.timeStamp <= time && (nullptr == before || frame.timeStamp > before->timeStamp)) before = &frame;
+		if (frame.timeStamp >= time && (nullptr == after  || frame.timeStamp < after->timeStamp))  after  = &frame;
+	}
+
+	if (nullptr != before && nullptr != after && after->timeStamp - before->timeStamp <= max_frame_gap) {
+		const double gap = after->timeStamp - before->timeStamp;
+		const float t = (gap > 0.0) ? static_cast<float>((time - before->timeStamp) / gap) : 0.f;
+		SkeletonData& skeleton = sensor.sample.skeleton;
+		for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+			skeleton.positions[boneID] = glm::mix(before->skeleton.positions[boneID], after->skeleton.positions[boneID], t);
+			skeleton.absoluteRotations[boneID] = glm::slerp(before->skeleton.absoluteRotations[boneID], after->skeleton.absoluteRotations[boneID], t);
+			sensor.sample.confidence[boneID] = before->confidence[boneID] + t * (after->confidence[boneID] - before->confidence[boneID]);
+		}
+		sensor.sample.timeStamp = time;
+		return true;
+	}
+
+	// No pair to interpolate, a frame close enough stands in for the time
+	const SensorFrame *nearest = before;
+	if (nullptr == nearest || (nullptr != after && after->timeStamp - time < time - before->timeStamp)) {
+		nearest = after;
+	}
+	if (nullptr == nearest || std::abs(nearest->timeStamp - time) > max_sample_offset) return false;
+
+	sensor.sample = *nearest;
+	return true;
+}
+
+bool SkeletonFusion::fuse( double time )
+{
+	numFusedSensors = 0;
+	for (auto& sensor : sensors) {
+		sensor->sampled = sample(*sensor, time);
+		if (sensor->sampled) ++numFusedSensors;
+	}
+	if (0 == numFusedSensors) return false;
+
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		glm::vec3 position(0.f);
+		glm::quat orientation(0.f, 0.f, 0.f, 0.f);
+		glm::quat reference;
+		float weights = 0.f;
+		bool first = true;
+
+		for (auto& sensor : sensors) {
+			if (!sensor->sampled) continue;
+
+			const float weight = std::max(sensor->sample.confidence[boneID], min_joint_weight);
+			const glm::vec3 p = sensor->extrinsics.transform(sensor->sample.skeleton.positions[boneID]);
+			glm::quat q = sensor->extrinsics.transform(sensor->sample.skeleton.absoluteRotations[boneID]);
+
+			// q and -q are the same rotation, average them all on one side
+			if (first) {
+				reference = q;
+				first = false;
+			} else if (glm::dot(reference, q) < 0.f) {
+				q = -q;
+			}
+
+			position += weight * p;
+			orientation.w += weight * q.w;
+			orientation.x += weight * q.x;
+			orientation.y += weight * q.y;
+			orientation.z += weight * q.z;
+			weights += weight;
+		}
+
+		fused.positions[boneID] = position / weights;
+		fused.absoluteRotations[boneID] = glm::normalize(orientation);
+	}
+
+	// Note: id ordering ensures parents are done before their children
+	for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+		const EBoneID parentID = Skeleton::getParentID(boneID);
+		fused.hierarchicalRotations[boneID] = (parentID < EBoneID::COUNT)
+			? glm::inverse(fused.absoluteRotations[parentID]) * fused.absoluteRotations[boneID]
+			: fused.absoluteRotations[boneID];
+	}
+	fused.trackingID = 1; // the one actor every sensor follows
+	fusedTime = time;
+
+	if (calibrating) {
+		collectCalibration();
+	}
+	return true;
+}
+
+void SkeletonFusion::startCalibration()
+{
+	for (auto& sensor : sensors) {
+		sensor->calibrationPoints.clear();
+		sensor->referencePoints.clear();
+	}
+	calibrating = true;
+}
+
+void SkeletonFusion::collectCalibration()
+{
+	if (sensors.empty() || !sensors[0]->sampled) return;
+
+	const Sensor& reference = *sensors[0];
+	for (size_t i = 1; i < sensors.size(); ++i) {
+		Sensor& sensor = *sensors[i];
+		if (!sensor.sampled) continue;
+
+		for (int boneID = 0; boneID < EBoneID::COUNT; ++boneID) {
+			if (sensor.calibrationPoints.size() >= max_calibration_points) break;
+			if (reference.sample.confidence[boneID] < calibration_confidence) continue;
+			if (sensor.sample.confidence[boneID] < calibration_confidence) continue;
+
+			sensor.calibrationPoints.push_back(sensor.sample.skeleton.positions[boneID]);
+			sensor.referencePoints.push_back(reference.extrinsics.transform(reference.sample.skeleton.positions[boneID]));
+		}
+	}
+}
+
+size_t SkeletonFusion::finishCalibration()
+{
+	size_t calibrated = 0;
+	for (size_t i = 1; i < sensors.size(); ++i) {
+		Sensor& sensor = *sensors[i];
+		if (sensor.calibrationPoints.size() >= min_calibration_points) {
+			sensor.extrinsics = solveExtrinsics(sensor.calibrationPoints, sensor.referencePoints);
+			++calibrated;
+		}
+		std::vector<glm::vec3>().swap(sensor.calibrationPoints);
+		std::vector<glm::vec3>().swap(sensor.referencePoints);
+	}
+	calibrating = false;
+	return calibrated;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "SensorSource.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Rigid transform from a sensor's camera space into the space its skeletons are fused in
+struct SensorExtrinsics
+{
+	glm::quat rotation;
+	glm::vec3 translation;
+
+	SensorExtrinsics(const glm::quat& rotation = glm::quat(), const glm::vec3& translation = glm::vec3(0.f))
+		: rotation(rotation)
+		, translation(translation)
+	{}
+
+	glm::vec3 transform(const glm::vec3& point) const { return rotation * point + translation; }
+	glm::quat transform(const glm::quat& orientation) const { return rotation * orientation; }
+};
+
+// Least squares rigid transform taking each of from onto the matching to point (Horn 1987),
+// the identity if there are fewer than 3 pairs
+SensorExtrinsics solveExtrinsics(const std::vector<glm::vec3>& from, const std::vector<glm::vec3>& to);
+
+
+// Several sensors watching the same actor, fused into one skeleton
+//
+// Each sensor runs on an acquisition thread of its own that pushes its frames into a short
+// per sensor history. update() picks the latest time every live sensor has a frame at or past,
+// interpolates each sensor's history to that time, moves the joints into the shared space with
+// the sensor's extrinsics, then averages them weighted by each joint's confidence, so a joint
+// one sensor only infers is taken from the sensors that track it
+// A sensor that stops delivering frames drops out rather than holding up the others
+//
+// Extrinsics come from the caller or from calibration against sensor 0, which the others
+// are solved relative to from joints both see tracked while the actor moves about
+class SkeletonFusion : public SkeletonSource
+{
+public:
+	SkeletonFusion();
+	~SkeletonFusion();
+
+	// Sensors are added before start(), returns the sensor's index
+	size_t addSensor(std::unique_ptr<SensorSource> source, const SensorExtrinsics& extrinsics = SensorExtrinsics());
+	// One acquisition thread per sensor, until stop() or the fusion is destroyed
+	void start();
+	void stop();
+
+	// Add a frame to sensor's history, what its acquisition thread does, safe from any thread
+	void push(size_t sensor, const SensorFrame& frame);
+
+	// Fuse at the latest time every live sensor has reached, true if that's a new skeleton
+	bool update();
+	// Fuse whatever the sensors have close to time, true if at least one sensor had something
+	bool fuse(double time);
+
+	// While calibrating each fused frame collects the joints sensor 0 and another sensor both track
+	void startCalibration();
+	// Solve the extrinsics of every sensor that saw enough joints, returns how many were
+	size_t finishCalibration();
+
+	const SkeletonData *getTrackedSkeletonData() const;
+
+	size_t getNumSensors() const;
+	std::string getSensorName(size_t sensor) const;
+	const SensorExtrinsics& getExtrinsics(size_t sensor) const;
+	void setExtrinsics(size_t sensor, const SensorExtrinsics& extrinsics);
+
+	bool isRunning() const;
+	bool isCalibrating() const;
+	// Time of the latest fused skeleton and how many sensors it was fused from
+	double getFusedTime() const;
+	size_t getNumFusedSensors() const;
+
+private:
+	SkeletonFusion(const SkeletonFusion&);
+	SkeletonFusion& operator=(const SkeletonFusion&);
+
+	struct Sensor
+	{
+		std::unique_ptr<SensorSource> source;
+		SensorExtrinsics extrinsics;
+		std::thread thread;
+
+		// Ring of the latest frames, guarded by mutex
+		std::mutex mutex;
+		std::vector<SensorFrame> history;
+		size_t next;
+		size_t numFrames;
+		double latestTime; // of the history when last updated
+
+		// The sensor's frame at the time being fused, and the joints it shares with sensor 0
+		SensorFrame sample;
+		bool sampled;
+		std::vector<glm::vec3> calibrationPoints;
+		std::vector<glm::vec3> referencePoints;
+	};
+
+	void acquire(size_t sensor);
+	bool sample(Sensor& sensor, double time);
+	void collectCalibration();
+
+	std::vector< std::unique_ptr<Sensor> > sensors;
+	std::atomic<bool> running;
+	bool calibrating;
+
+	SkeletonData fused;
+	double fusedTime;
+	size_t numFusedSensors;
+
+};
+
+inline const SkeletonData *SkeletonFusion::getTrackedSkeletonData() const { return (numFusedSensors > 0) ? &fused : nullptr; }
+inline size_t SkeletonFusion::getNumSensors() const { return sensors.size(); }
+inline std::string SkeletonFusion::getSensorName(size_t sensor) const { return sensors[sensor]->source->getName(); }
+inline const SensorExtrinsics& SkeletonFusion::getExtrinsics(size_t sensor) const { return sensors[sensor]->extrinsics; }
+inline void SkeletonFusion::setExtrinsics(size_t sensor, const SensorExtrinsics& extrinsics) { sensors[sensor]->extrinsics = extrinsics; }
+inline bool SkeletonFusion::isRunning() const { return running; }
+inline bool SkeletonFusion::isCalibrating() const { return calibrating; }
+inline double SkeletonFusion::getFusedTime() const { return fusedTime; }
+inline size_t SkeletonFusion::getNumFusedSensors() const { return numFusedSensors; }
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Animation/AnimationTypes.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+
+
+// Joint data for a single tracked skeleton, indexed by EBoneID
+struct SkeletonData
+{
+	unsigned int trackingID; // tells the actors of one source apart, 0 if it doesn't
+	glm::vec3 positions[EBoneID::COUNT];
+	glm::quat hierarchicalRotations[EBoneID::COUNT];
+	glm::quat absoluteRotations[EBoneID::COUNT];
+};
+
+
+// Anything that produces skeleton data for a Recording to capture,
+// keeps the animation code independent of the Kinect SDK
+class SkeletonSource
+{
+public:
+	virtual ~SkeletonSource() {}
+
+	// Returns the most recently tracked skeleton, or nullptr if none is tracked
+	virtual const SkeletonData *getTrackedSkeletonData() const = 0;
+
+	// Every skeleton tracked in the latest frame, actor 0 is the one getTrackedSkeletonData returns
+	// Sources that track one skeleton needn't override these
+	virtual size_t getNumActors() const;
+	virtual const SkeletonData *getActorSkeletonData(size_t actor) const;
+};
+
+inline size_t SkeletonSource::getNumActors() const { return (nullptr != getTrackedSkeletonData()) ? 1 : 0; }
+inline const SkeletonData *SkeletonSource::getActorSkeletonData(size_t actor) const { return (actor == 0) ? getTrackedSkeletonData() : nullptr; }
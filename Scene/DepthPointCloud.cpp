@@ -0,0 +1,67 @@
+#include <gl/glew.h>
+
+#include "DepthPointCloud.h"
+#include "Shaders/Program.h"
+
+#include <cassert>
+
+
+DepthPointCloud::DepthPointCloud( GLsizei width, GLsizei height, float focalLength )
+	: width(width)
+	, height(height)
+	, focalLength(focalLength)
+	, minDepth(0)
+	, maxDepth(0xffff)
+	, playerColor(0.f, 1.f, 0.f, 1.f)
+	, pointSize(2.f)
+	, texture(0)
+	, vao(0)
+{
+	// Integer textures can't be filtered, each point fetches its own pixel anyway
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16UI, width, height, 0, GL_RG_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// Core profiles draw nothing without a vertex array bound, even with no attributes
+	glGenVertexArrays(1, &vao);
+}
+
+DepthPointCloud::~DepthPointCloud()
+{
+	glDeleteVertexArrays(1, &vao);
+	glDeleteTextures(1, &texture);
+}
+
+void DepthPointCloud::update( const GLushort *pixels )
+{
+	assert(nullptr != pixels);
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RG_INTEGER, GL_UNSIGNED_SHORT, pixels);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void DepthPointCloud::render( tdogl::Program& program ) const
+{
+	program.setUniform("depthFrame", 0);
+	program.setUniform("focalLength", focalLength);
+	program.setUniform("depthRange", glm::vec2((float) minDepth, (float) maxDepth));
+	program.setUniform("playerColor", playerColor);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPointSize(pointSize);
+
+	glBindVertexArray(vao);
+	glDrawArrays(GL_POINTS, 0, width * height);
+	glBindVertexArray(0);
+
+	glPointSize(1.f);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <gl/glew.h>
+
+#include <glm/glm.hpp>
+
+namespace tdogl { class Program; }
+
+
+// A depth sensor's frames drawn as points in the space its skeletons are tracked in
+// Each frame's pixels, pairs of player index and depth in millimeters, are uploaded as they
+// are into an integer texture, and the point cloud vertex shader unprojects one point per
+// pixel from it with the sensor's focal length, so no per pixel work is left on the CPU
+class DepthPointCloud
+{
+public:
+	// width x height depth pixels, focal length in pixels at that resolution
+	DepthPointCloud(GLsizei width, GLsizei height, float focalLength);
+	~DepthPointCloud();
+
+	// Replace the frame with width * height (player index, depth) pairs
+	void update(const GLushort *pixels);
+	// One point per pixel whose depth is in the reliable range, program is the point cloud
+	// program, in use with its camera and model already set
+	void render(tdogl::Program& program) const;
+
+	// Reliable depths in millimeters, pixels outside it have no point
+	void setDepthRange(GLushort minDepth, GLushort maxDepth);
+	// Color of points on a tracked player, the rest are shaded grey by distance
+	void setPlayerColor(const glm::vec4& color);
+	void setPointSize(float size);
+
+	GLsizei getWidth() const;
+	GLsizei getHeight() const;
+
+private:
+	DepthPointCloud(const DepthPointCloud&);
+	DepthPointCloud& operator=(const DepthPointCloud&);
+
+	GLsizei width;
+	GLsizei height;
+	float focalLength;
+	GLushort minDepth;
+	GLushort maxDepth;
+	glm::vec4 playerColor;
+	float pointSize;
+
+	GLuint texture;
+	GLuint vao; // no attributes, points are placed by gl_VertexID
+
+};
+
+inline void DepthPointCloud::setDepthRange(GLushort minDepth, GLushort maxDepth) { this->minDepth = minDepth; this->maxDepth = maxDepth; }
+inline void DepthPointCloud::setPlayerColor(const glm::vec4& color) { playerColor = color; }
+inline void DepthPointCloud::setPointSize(float size) { pointSize = size; }
+inline GLsizei DepthPointCloud::getWidth() const { return width; }
+inline GLsizei DepthPointCloud::getHeight() const { return height; }
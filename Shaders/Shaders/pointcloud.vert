@@ -0,0 +1,36 @@
+#version 330
+
+uniform mat4 camera;
+uniform mat4 model;
+
+uniform usampler2D depthFrame; // (player index, depth in mm) per pixel
+uniform float focalLength;     // pixels, at the frame's resolution
+uniform vec2 depthRange;       // reliable depths, mm
+uniform vec4 playerColor;
+
+out vec4 fragColor;
+
+void main()
+{
+	// One point per depth pixel, in row order
+	ivec2 size = textureSize(depthFrame, 0);
+	ivec2 pixel = ivec2(gl_VertexID % size.x, gl_VertexID / size.x);
+	uvec2 texel = texelFetch(depthFrame, pixel, 0).rg;
+
+	// Unreliable depths are put past the far plane, so they are clipped
+	float depth = float(texel.g);
+	if (depth < depthRange.x || depth > depthRange.y) {
+		fragColor = vec4(0);
+		gl_Position = vec4(0, 0, 2, 1);
+		return;
+	}
+
+	// Unproject into skeleton space, as NuiTransformDepthImageToSkeleton does
+	float z = depth / 1000.0;
+	vec2 xy = (vec2(pixel) - vec2(size) / 2.0) * vec2(1, -1) * z / focalLength;
+	vec3 vertex = vec3(xy, z);
+
+	float shade = clamp(1.0 - z / 8.0, 0.2, 1.0);
+	fragColor = (texel.r != 0u) ? playerColor : vec4(vec3(shade), 1);
+	gl_Position = camera * model * vec4(vertex, 1);
+}
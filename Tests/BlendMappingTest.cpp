@@ -0,0 +1,207 @@
+// Checks every layer mapping mode of the BlendEngine against hand computed poses
+// The clips are two bones, the hip center and the spine, keyed at 0 and 1 seconds
+// and blended every half second, both as a batch and frame by frame while layering live
+//
+// Usage: blend_mapping_test, exits with a non-zero status on any mismatch
+#include "Animation/Animation.h"
+#include "Animation/AnimationTypes.h"
+#include "Animation/BlendEngine.h"
+#include "Animation/BoneAnimationTrack.h"
+#include "Animation/TransformKeyFrame.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+	const float tolerance = 1e-5f;
+	const float frame_delta = 0.5f;
+	const int num_frames = 3;
+
+	const float c45 = 0.70710678f;
+	const float c22 = 0.92387953f; // cos(22.5 degrees)
+	const float s22 = 0.38268343f; // sin(22.5 degrees)
+
+	// Quaternions are (w, x, y, z)
+	const glm::quat identity(1.f, 0.f, 0.f, 0.f);
+	const glm::quat rot_x90(c45, c45, 0.f, 0.f);
+	const glm::quat rot_y45(c22, 0.f, s22, 0.f);
+	const glm::quat rot_y90(c45, 0.f, c45, 0.f);
+	const glm::quat rot_z90(c45, 0.f, 0.f, c45);
+	const glm::quat rot_y45_z90(c22 * c45, s22 * c45, s22 * c45, c22 * c45);
+	const glm::quat rot_y90_z90(0.5f, 0.5f, 0.5f, 0.5f);
+	const glm::quat rot_y45_x90(c22 * c45, c22 * c45, s22 * c45, -s22 * c45);
+	const glm::quat rot_y90_x90(0.5f, 0.5f, 0.5f, -0.5f);
+
+	// Expected pose of one bone at each blended frame
+	struct ExpectedBone
+	{
+		glm::vec3 translation[num_frames];
+		glm::quat rotation[num_frames];
+		glm::quat absRotation[num_frames];
+	};
+
+	struct Expected
+	{
+		ELayerMappingMode mode;
+		const char *name;
+		ExpectedBone root, spine;
+	};
+
+	// Base: root moves 0 -> 1 along x unrotated, spine one unit above it rotated 90 degrees about z
+	// Layer: root at x = 5 moves 0 -> 2 along z turning 0 -> 90 degrees about y,
+	//        spine two units above it rising one more, rotated 90 degrees about x
+	const Expected expected[] = {
+		// Y'(t) = X(t)
+		{ MAP_DIRECT, "direct",
+			{ { glm::vec3(5, 0, 0), glm::vec3(5, 0, 1), glm::vec3(5, 0, 2) },
+			  { identity, rot_y45, rot_y90 },
+			  { identity, rot_y45, rot_y90 } },
+			{ { glm::vec3(5, 2, 0), glm::vec3(5, 2.5f, 1), glm::vec3(5, 3, 2) },
+			  { rot_x90, rot_x90, rot_x90 },
+			  { rot_x90, rot_y45_x90, rot_y90_x90 } } },
+		// Y'(t) = Y(0) + (X(t) - X(0)) + (Ry(t) - Rx(t)), Yr'(t) = Xr(t) inv(Xr(0)) Yr(0)
+		{ MAP_ABSOLUTE, "absolute",
+			{ { glm::vec3(-5, 0, 0), glm::vec3(-4.5f, 0, 0), glm::vec3(-4, 0, 0) },
+			  { identity, rot_y45, rot_y90 },
+			  { identity, rot_y45, rot_y90 } },
+			{ { glm::vec3(-5, 1, 0), glm::vec3(-4.5f, 1.5f, 0), glm::vec3(-4, 2, 0) },
+			  { rot_z90, rot_z90, rot_z90 },
+			  { rot_z90, rot_y45_z90, rot_y90_z90 } } },
+		// Y'(t) = Y(t) + (X(t) - X(t - dt)), Yr'(t) = Yr(t)
+		{ MAP_ADDITIVE, "additive",
+			{ { glm::vec3(0, 0, 0), glm::vec3(0.5f, 0, 1), glm::vec3(1, 0, 1) },
+			  { identity, identity, identity },
+			  { identity, identity, identity } },
+			{ { glm::vec3(0, 1, 0), glm::vec3(0.5f, 1.5f, 1), glm::vec3(1, 1.5f, 1) },
+			  { rot_z90, rot_z90, rot_z90 },
+			  { rot_z90, rot_z90, rot_z90 } } },
+		// Y'(t) = Y(0) + (X(t) - X(0)) + (Ry(t) - Rx(t)), Yr'(t) = Yr(0)
+		{ MAP_TRAJECTORY_RELATIVE, "trajectory relative",
+			{ { glm::vec3(-5, 0, 0), glm::vec3(-4.5f, 0, 0), glm::vec3(-4, 0, 0) },
+			  { identity, identity, identity },
+			  { identity, identity, identity } },
+			{ { glm::vec3(-5, 1, 0), glm::vec3(-4.5f, 1.5f, 0), glm::vec3(-4, 2, 0) },
+			  { rot_z90, rot_z90, rot_z90 },
+			  { rot_z90, rot_z90, rot_z90 } } }
+	};
+
+	void addKeyFrame(Animation& animation, EBoneID boneID, float time, const glm::vec3& translation, const glm::quat& rotation, const glm::quat& absRotation)
+	{
+		BoneAnimationTrack *track = animation.getBoneTrack(boneID);
+		if (nullptr == track) {
+			track = animation.createBoneTrack(boneID);
+		}
+
+		TransformKeyFrame *keyFrame = static_cast<TransformKeyFrame*>(track->createKeyFrame(time));
+		keyFrame->setTranslation(translation);
+		keyFrame->setRotation(rotation);
+		keyFrame->setAbsRotation(absRotation);
+		keyFrame->setScale(glm::vec3(1));
+	}
+
+	void makeBase(Animation& base)
+	{
+		addKeyFrame(base, HIP_CENTER, 0.f, glm::vec3(0, 0, 0), identity, identity);
+		addKeyFrame(base, HIP_CENTER, 1.f, glm::vec3(1, 0, 0), identity, identity);
+		addKeyFrame(base, SPINE, 0.f, glm::vec3(0, 1, 0), rot_z90, rot_z90);
+		addKeyFrame(base, SPINE, 1.f, glm::vec3(1, 1, 0), rot_z90, rot_z90);
+	}
+
+	void makeLayer(Animation& layer)
+	{
+		addKeyFrame(layer, HIP_CENTER, 0.f, glm::vec3(5, 0, 0), identity, identity);
+		addKeyFrame(layer, HIP_CENTER, 1.f, glm::vec3(5, 0, 2), rot_y90, rot_y90);
+		addKeyFrame(layer, SPINE, 0.f, glm::vec3(5, 2, 0), rot_x90, rot_x90);
+		addKeyFrame(layer, SPINE, 1.f, glm::vec3(5, 3, 2), rot_x90, rot_y90_x90);
+	}
+
+	bool near(const glm::vec3& a, const glm::vec3& b)
+	{
+		return std::fabs(a.x - b.x) < tolerance && std::fabs(a.y - b.y) < tolerance && std::fabs(a.z - b.z) < tolerance;
+	}
+
+	// q and -q are the same rotation
+	bool near(const glm::quat& a, const glm::quat& b)
+	{
+		const float dot = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+		return std::fabs(std::fabs(dot) - 1.f) < tolerance;
+	}
+
+	std::ostream& operator<<(std::ostream& out, const glm::vec3& v) { return out << "(" << v.x << ", " << v.y << ", " << v.z << ")"; }
+	std::ostream& operator<<(std::ostream& out, const glm::quat& q) { return out << "(" << q.w << ", " << q.x << ", " << q.y << ", " << q.z << ")"; }
+
+	template<class T>
+	int check(const char *path, const char *mode, const char *bone, const char *component, int frame, const T& actual, const T& wanted)
+	{
+		if (near(actual, wanted)) return 0;
+
+		std::cerr << path << " " << mode << ": " << bone << " " << component << " at frame " << frame
+		          << " is " << actual << ", expected " << wanted << std::endl;
+		return 1;
+	}
+
+	int checkBone(const char *path, const char *mode, const char *bone, const BoneAnimationTrack *track, const ExpectedBone& wanted)
+	{
+		if (nullptr == track || num_frames != static_cast<int>(track->getNumKeyFrames())) {
+			std::cerr << path << " " << mode << ": " << bone << " doesn't have " << num_frames << " keyframes" << std::endl;
+			return 1;
+		}
+
+		int failures = 0;
+		for (int frame = 0; frame < num_frames; ++frame) {
+			const TransformKeyFrame *keyFrame = static_cast<const TransformKeyFrame*>(track->getKeyFrame(frame));
+			failures += check(path, mode, bone, "translation", frame, keyFrame->getTranslation(), wanted.translation[frame]);
+			failures += check(path, mode, bone, "rotation", frame, keyFrame->getRotation(), wanted.rotation[frame]);
+			failures += check(path, mode, bone, "absolute rotation", frame, keyFrame->getAbsRotation(), wanted.absRotation[frame]);
+		}
+		return failures;
+	}
+
+	int checkBlend(const char *path, const Expected& wanted, const Animation& blend)
+	{
+		return checkBone(path, wanted.name, "hip center", blend.getBoneTrack(HIP_CENTER), wanted.root)
+		     + checkBone(path, wanted.name, "spine", blend.getBoneTrack(SPINE), wanted.spine);
+	}
+}
+
+
+int main()
+{
+	Animation base(0, "base"), layer(1, "layer");
+	makeBase(base);
+	makeLayer(layer);
+
+	BoneMask boneMask;
+	boneMask.insert(HIP_CENTER);
+	boneMask.insert(SPINE);
+
+	BlendEngine engine(2);
+	int failures = 0;
+	for (const auto& wanted : expected) {
+		Animation batch(2, "batch");
+		batch.createBoneTrack(HIP_CENTER);
+		batch.createBoneTrack(SPINE);
+		engine.blend(base, layer, boneMask, wanted.mode, batch, frame_delta);
+		failures += checkBlend("batch", wanted, batch);
+
+		Animation live(3, "live");
+		live.createBoneTrack(HIP_CENTER);
+		live.createBoneTrack(SPINE);
+		engine.beginLayer();
+		for (int frame = 0; frame < num_frames; ++frame) {
+			engine.blendFrame(frame * frame_delta, frame_delta, base, layer, boneMask, wanted.mode, live);
+		}
+		failures += checkBlend("live", wanted, live);
+	}
+
+	if (0 != failures) {
+		std::cerr << failures << " mismatches" << std::endl;
+		return 1;
+	}
+	std::cout << "all mapping modes match" << std::endl;
+	return 0;
+}
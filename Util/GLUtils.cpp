@@ -15,6 +15,7 @@ using namespace std;
 
 tdogl::Program *GLUtils::defaultProgram = nullptr;
 tdogl::Program *GLUtils::simpleProgram = nullptr;
+tdogl::Program *GLUtils::pointCloudProgram = nullptr;
 
 tdogl::Program *createShaderProgram(const string& vertexShaderFilename, const string& fragmentShaderFilename);
 
@@ -50,6 +51,8 @@ void GLUtils::init()
 		defaultProgram = createShaderProgram(default_vertex_shader, default_fragment_shader);
 		cout << "Creating simple shader program...\n";
 		simpleProgram = createShaderProgram(simple_vertex_shader, simple_fragment_shader);
+		cout << "Creating point cloud shader program...\n";
+		pointCloudProgram = createShaderProgram(pointcloud_vertex_shader, pointcloud_fragment_shader);
 	} catch(const exception& e) {
 		cerr << "Failed to create shader program\n Exception: " << e.what();
 		exit(EXIT_FAILURE);
@@ -58,6 +61,7 @@ void GLUtils::init()
 
 void GLUtils::cleanup()
 {
+	delete pointCloudProgram;
 	delete simpleProgram;
 	delete defaultProgram;
 }
@@ -19,9 +19,12 @@ namespace GLUtils
 	const std::string default_fragment_shader("Shaders/Shaders/default.frag");
 	const std::string simple_vertex_shader("Shaders/Shaders/simple.vert");
 	const std::string simple_fragment_shader("Shaders/Shaders/simple.frag");
+	const std::string pointcloud_vertex_shader("Shaders/Shaders/pointcloud.vert");
+	const std::string pointcloud_fragment_shader("Shaders/Shaders/pointcloud.frag");
 
 	extern tdogl::Program *defaultProgram;
 	extern tdogl::Program *simpleProgram;
+	extern tdogl::Program *pointCloudProgram;
 
 	void init();
 	void cleanup();
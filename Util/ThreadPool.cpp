@@ -0,0 +1,117 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+	: job(nullptr)
+	, jobCount(0)
+	, nextIndex(0)
+	, busyWorkers(0)
+	, generation(0)
+	, stopping(false)
+{
+	if (0 == numThreads) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// The calling thread works too, so one less worker than threads
+	for (unsigned int i = 1; i < numThreads; ++i) {
+		workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+	if (0 == count) return;
+
+	// Not worth waking anyone for
+	if (workers.empty() || 1 == count) {
+		for (size_t i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> callLock(callMutex);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job         = &func;
+		jobCount    = count;
+		nextIndex   = 0;
+		busyWorkers = static_cast<unsigned int>(workers.size());
+		++generation;
+	}
+	wake.notify_all();
+
+	runJobs();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this]() { return 0 == busyWorkers; });
+	job = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+	unsigned int seenGeneration = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+			if (stopping) return;
+			seenGeneration = generation;
+		}
+
+		runJobs();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (0 == --busyWorkers) {
+			done.notify_one();
+		}
+	}
+}
+
+void ThreadPool::runJobs()
+{
+	for (size_t i = nextIndex++; i < jobCount; i = nextIndex++) {
+		(*job)(i);
+	}
+}
+
+
+void parallelFor(unsigned int numThreads, size_t count, const std::function<void(size_t)>& func)
+{
+	if (0 == numThreads) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	std::atomic<size_t> next(0);
+	auto worker = [&]() {
+		for (size_t index = next++; index < count; index = next++) {
+			func(index);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	const size_t numWorkers = std::min<size_t>(numThreads, count);
+	for (size_t i = 1; i < numWorkers; ++i) {
+		threads.push_back(std::thread(worker));
+	}
+	worker();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
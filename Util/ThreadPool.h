@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of worker threads that split indexed jobs between them
+// Workers are started once and sleep between jobs, so handing out work every frame
+// costs a wake up rather than a thread creation
+class ThreadPool
+{
+public:
+	// numThreads counts the calling thread, 0 uses one thread per hardware thread
+	explicit ThreadPool(unsigned int numThreads = 0);
+	~ThreadPool();
+
+	// Call func(i) for every i in [0, count) on the workers and the calling thread,
+	// returns once all calls have finished
+	// Calls from several threads at once are run one after another
+	void parallelFor(size_t count, const std::function<void(size_t)>& func);
+
+	unsigned int getNumThreads() const;
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	void workerLoop();
+	void runJobs();
+
+private:
+	std::vector<std::thread> workers;
+
+	std::mutex callMutex;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	// Current job, written under mutex before generation changes
+	const std::function<void(size_t)> *job;
+	size_t jobCount;
+	std::atomic<size_t> nextIndex;
+	unsigned int busyWorkers;
+	unsigned int generation;
+	bool stopping;
+
+};
+
+inline unsigned int ThreadPool::getNumThreads() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+
+// Call func(i) for every i in [0, count) on threads started for this call, the calling thread included,
+// for one-off jobs over a whole take where keeping a pool around isn't worth it
+// numThreads of 0 uses one thread per hardware thread
+void parallelFor(unsigned int numThreads, size_t count, const std::function<void(size_t)>& func);
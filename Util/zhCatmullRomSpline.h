@@ -34,9 +34,37 @@ SOFTWARE.
 namespace zh
 {
 
+/**
+* @brief Operations splines need on their control points
+* besides arithmetic operators. Specialize for types
+* whose == operator doesn't tolerate rounding errors,
+* and for quaternion types (see QuatCatmullRomSpline).
+*/
+template <typename T>
+struct SplineMath
+{
+	static bool equals( const T& a, const T& b ) { return a == b; }
+};
+
+/**
+* @brief Specialization of SplineMath for quaternions.
+*/
+template <>
+struct SplineMath<Quat>
+{
+	static bool equals( const Quat& a, const Quat& b ) { return a == b; }
+	static Quat inverse( const Quat& q ) { return q.getInverse(); }
+	static Quat log( const Quat& q ) { return q.log(); }
+	static Quat exp( const Quat& q ) { return q.exp(); }
+	static Quat squad( const Quat& q1, const Quat& qa, const Quat& qb, const Quat& q2, float t ) { return q1.squad( qa, qb, q2, t ); }
+};
+
 /**
 * @brief Generic implementation of a Catmull-Rom spline,
 * suitable for interpolating between key-frame values.
+*
+* T needs + and - operators and multiplication by a float,
+* e.g. zh::Vector3 or glm::vec3.
 */
 template <typename T>
 class CatmullRomSpline
@@ -49,7 +77,6 @@ public:
 	*/
 	CatmullRomSpline()
 	{
-		mCoeffs = Matrix(4);
 		mCoeffs.set( 0, 0, 2 );
 		mCoeffs.set( 0, 1, -2 );
 		mCoeffs.set( 0, 2, 1 );
@@ -89,6 +116,7 @@ public:
 	void clearControlPoints()
 	{
 		mCtrlPoints.clear();
+		mTangents.clear();
 	}
 
 	/**
@@ -176,7 +204,7 @@ public:
 			return mCtrlPoints[index+1];
 
 		float t2 = t*t;
-		Vector tv(4);
+		Vector4 tv;
 		tv.set( 0, t2*t );
 		tv.set( 1, t2 );
 		tv.set( 2, t );
@@ -187,17 +215,9 @@ public:
 		const T& cpt2 = mCtrlPoints[index+1];
 		const T& tan1 = mTangents[index];
 		const T& tan2 = mTangents[index+1];
-		T pt = cpt1;
-
-		for( unsigned int ei = 0; ei < cpt1.size(); ++ei )
-		{
-			pt.set( ei, tv.get(0) * cpt1.get(ei) +
-				tv.get(1) * cpt2.get(ei) +
-				tv.get(2) * tan1.get(ei) +
-				tv.get(3) * tan2.get(ei) );
-		}
 
-		return pt;
+		return cpt1 * tv.get(0) + cpt2 * tv.get(1) +
+			tan1 * tv.get(2) + tan2 * tv.get(3);
 	}
 
 	/**
@@ -245,7 +265,7 @@ public:
 			return mTangents[index+1];
 
 		float t2 = t*t;
-		Vector tv(4);
+		Vector4 tv;
 		tv.set( 0, 3.f*t2 );
 		tv.set( 1, 2.f*t );
 		tv.set( 2, 1 );
@@ -256,17 +276,9 @@ public:
 		const T& cpt2 = mCtrlPoints[index+1];
 		const T& tan1 = mTangents[index];
 		const T& tan2 = mTangents[index+1];
-		T tang = cpt1;
 
-		for( unsigned int ei = 0; ei < tang.size(); ++ei )
-		{
-			tang.set( ei, tv.get(0) * cpt1.get(ei) +
-				tv.get(1) * cpt2.get(ei) +
-				tv.get(2) * tan1.get(ei) +
-				tv.get(3) * tan2.get(ei) );
-		}
-
-		return tang;
+		return cpt1 * tv.get(0) + cpt2 * tv.get(1) +
+			tan1 * tv.get(2) + tan2 * tv.get(3);
 	}
 
 	/**
@@ -282,8 +294,7 @@ public:
 		if( ncpts < 2 )
 			return;
 
-		bool closed = mCtrlPoints[0] == mCtrlPoints[ncpts-1] ? 
-			true : false;
+		bool closed = SplineMath<T>::equals( mCtrlPoints[0], mCtrlPoints[ncpts-1] );
 
 		mTangents.resize(ncpts);
 
@@ -312,18 +323,21 @@ public:
 
 private:
 
-	Matrix mCoeffs;
+	Matrix<4> mCoeffs;
 	std::vector<T> mCtrlPoints;
 	std::vector<T> mTangents;
 
 };
 
 /**
-* @brief Specialization of CatmullRomSpline for quaternions,
+* @brief Catmull-Rom spline of quaternions,
 * suitable for interpolating between rotations.
+*
+* Q can be any quaternion type with * and + operators,
+* multiplication by a float and a SplineMath specialization.
 */
-template <>
-class CatmullRomSpline<Quat>
+template <typename Q>
+class QuatCatmullRomSpline
 {
 
 public:
@@ -331,21 +345,21 @@ public:
 	/**
 	* Constructor.
 	*/
-	CatmullRomSpline()
+	QuatCatmullRomSpline()
 	{
 	}
 
 	/**
 	* Destructor.
 	*/
-	~CatmullRomSpline()
+	~QuatCatmullRomSpline()
 	{
 	}
 
 	/**
 	* Adds a control point to the spline.
 	*/
-	void addControlPoint( const Quat& pt )
+	void addControlPoint( const Q& pt )
 	{
 		mCtrlPoints.push_back(pt);
 	}
@@ -356,12 +370,13 @@ public:
 	void clearControlPoints()
 	{
 		mCtrlPoints.clear();
+		mTangents.clear();
 	}
 
 	/**
 	* Gets a control point on the spline.
 	*/
-	const Quat& getControlPoint( unsigned int index ) const
+	const Q& getControlPoint( unsigned int index ) const
 	{
 		zhAssert( index < getNumControlPoints() );
 
@@ -372,7 +387,7 @@ public:
 	* Sets a control point on the spline
 	* (remember to call calcTangents afterwards).
 	*/
-	void setControlPoint( unsigned int index, const Quat& pt )
+	void setControlPoint( unsigned int index, const Q& pt )
 	{
 		zhAssert( index < getNumControlPoints() );
 
@@ -382,7 +397,7 @@ public:
 	/**
 	* Gets the tangent at the specified control point.
 	*/
-	const Quat& getTangentAtCPt( unsigned int index ) const
+	const Q& getTangentAtCPt( unsigned int index ) const
 	{
 		zhAssert( index < getNumControlPoints() );
 		zhAssert( mTangents.size() == getNumControlPoints() );
@@ -408,7 +423,7 @@ public:
 	* @param t Interpolation parameter.
 	* @return Interpolated point.
 	*/
-	Quat getPoint( float t ) const
+	Q getPoint( float t ) const
 	{
 		// compute left-hand control point index
         float fcpi = t * ( float )( mCtrlPoints.size() - 1 );
@@ -429,7 +444,7 @@ public:
 	* @param t Interpolation parameter.
 	* @return Interpolated point.
 	*/
-	Quat getPoint( unsigned int index, float t) const
+	Q getPoint( unsigned int index, float t) const
 	{
 		zhAssert( mTangents.size() == getNumControlPoints() );
 
@@ -441,12 +456,12 @@ public:
 		else if( zhEqualf( t, 1 ) )
 			return mCtrlPoints[index+1];
 
-		const Quat& cpt1 = mCtrlPoints[index];
-		const Quat& cpt2 = mCtrlPoints[index+1];
-		const Quat& tan1 = mTangents[index];
-		const Quat& tan2 = mTangents[index+1];
+		const Q& cpt1 = mCtrlPoints[index];
+		const Q& cpt2 = mCtrlPoints[index+1];
+		const Q& tan1 = mTangents[index];
+		const Q& tan2 = mTangents[index+1];
 
-		return cpt1.squad( tan1, tan2, cpt2, t );
+		return SplineMath<Q>::squad( cpt1, tan1, tan2, cpt2, t );
 	}
 
 	/**
@@ -459,7 +474,7 @@ public:
 	* @param t Interpolation parameter.
 	* @return Interpolated tangent.
 	*/
-	Quat getTangent( float t ) const
+	Q getTangent( float t ) const
 	{
 		// compute left-hand control point index
         float fcpi = t * ( float )( mCtrlPoints.size() - 1 );
@@ -480,12 +495,12 @@ public:
 	* @param t Interpolation parameter.
 	* @return Interpolated tangent.
 	*/
-	Quat getTangent( unsigned int index, float t) const
+	Q getTangent( unsigned int index, float t) const
 	{
 		zhAssert( mTangents.size() == getNumControlPoints() );
 
 		// TODO: how to implement this? (who needs this, anyway?)
-		return Quat();
+		return Q();
 	}
 
 	/**
@@ -501,27 +516,26 @@ public:
 		if( ncpts < 2 )
 			return;
 
-		bool closed = mCtrlPoints[0] == mCtrlPoints[ncpts-1] ? 
-			true : false;
+		bool closed = SplineMath<Q>::equals( mCtrlPoints[0], mCtrlPoints[ncpts-1] );
 
 		mTangents.resize(ncpts);
 
-		Quat inv_cp, qlog1, qlog2, qlog;
+		Q inv_cp, qlog1, qlog2, qlog;
 		for( unsigned int cpi = 0; cpi < ncpts; ++cpi )
 		{
-			inv_cp = mCtrlPoints[cpi].getInverse();
+			inv_cp = SplineMath<Q>::inverse( mCtrlPoints[cpi] );
 
 			if( cpi == 0 )
 			{
 				qlog1 = inv_cp * mCtrlPoints[cpi+1];
-				qlog1 = qlog1.log();
+				qlog1 = SplineMath<Q>::log( qlog1 );
 
 				if(closed)
 					qlog2 = inv_cp * mCtrlPoints[ncpts-2];
 				else
 					qlog2 = inv_cp * mCtrlPoints[cpi];
 
-				qlog2 = qlog2.log();
+				qlog2 = SplineMath<Q>::log( qlog2 );
 			}
 			else if( cpi == ncpts - 1 )
 			{
@@ -530,32 +544,41 @@ public:
 				else
 					qlog1 = inv_cp * mCtrlPoints[cpi];
 
-				qlog1 = qlog1.log();
+				qlog1 = SplineMath<Q>::log( qlog1 );
 				
 				qlog2 = inv_cp * mCtrlPoints[cpi-1];
-				qlog2 = qlog2.log();
+				qlog2 = SplineMath<Q>::log( qlog2 );
 			}
 			else
 			{
 				qlog1 = inv_cp * mCtrlPoints[cpi+1];
-				qlog1 = qlog1.log();
+				qlog1 = SplineMath<Q>::log( qlog1 );
 
 				qlog2 = inv_cp * mCtrlPoints[cpi-1];
-				qlog2 = qlog2.log();
+				qlog2 = SplineMath<Q>::log( qlog2 );
 			}
 
 			qlog = ( qlog1 + qlog2 ) * -0.25f;
-			mTangents[cpi] = mCtrlPoints[cpi] * qlog.exp();
+			mTangents[cpi] = mCtrlPoints[cpi] * SplineMath<Q>::exp( qlog );
 		}
 	}
 
 private:
 
-	std::vector<Quat> mCtrlPoints;
-	std::vector<Quat> mTangents;
+	std::vector<Q> mCtrlPoints;
+	std::vector<Q> mTangents;
 
 };
 
+/**
+* @brief Specialization of CatmullRomSpline for quaternions,
+* suitable for interpolating between rotations.
+*/
+template <>
+class CatmullRomSpline<Quat> : public QuatCatmullRomSpline<Quat>
+{
+};
+
 }
 
 #endif // __zhCatmullRomSpline_h__
@@ -0,0 +1,70 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+
+#include "zhGlm.h"
+
+namespace zh
+{
+
+void getEuler( const glm::quat& q, float& ax, float& ay, float& az, EulerRotOrder order )
+{
+	// rotation matrix as built by Matrix4::quat
+	float xx = q.x * q.x,
+		xy = q.x * q.y,
+		xz = q.x * q.z,
+		xw = q.x * q.w,
+		yy = q.y * q.y,
+		yz = q.y * q.z,
+		yw = q.y * q.w,
+		zz = q.z * q.z,
+		zw = q.z * q.w;
+
+	float rot[3][4];
+
+	rot[0][0] = 1.f - 2.f * ( yy + zz );
+	rot[0][1] = 2.f * ( xy - zw );
+	rot[0][2] = 2.f * ( xz + yw );
+
+	rot[1][0] = 2.f * ( xy + zw );
+	rot[1][1] = 1.f - 2.f * ( xx + zz );
+	rot[1][2] = 2.f * ( yz - xw );
+
+	rot[2][0] = 2.f * ( xz - yw );
+	rot[2][1] = 2.f * ( yz + xw );
+	rot[2][2] = 1.f - 2.f * ( xx + yy );
+
+	rot[0][3] = rot[1][3] = rot[2][3] = 0.f;
+
+	// remove scale, as Matrix4::getRotationMatrix does
+	for( int j = 0; j < 3; ++j )
+	{
+		float inv_s = 1.f / sqrt( rot[0][j] * rot[0][j] + rot[1][j] * rot[1][j] + rot[2][j] * rot[2][j] );
+
+		for( int i = 0; i < 3; ++i )
+			rot[i][j] *= inv_s;
+	}
+
+	getEulerFromRotation( rot, ax, ay, az, order );
+}
+
+}
@@ -0,0 +1,180 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+
+/**
+* @file zhGlm.h
+* @brief zh math on glm types, so glm vectors and quaternions
+* can be interpolated and decomposed without converting them first.
+*/
+
+#ifndef __zhGlm_h__
+#define __zhGlm_h__
+
+#include "zhPrereq.h"
+#include "zhMathMacros.h"
+#include "zhMatrix4.h"
+#include "zhCatmullRomSpline.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace zh
+{
+
+/**
+* Gets Euler angles from a quaternion, same as Quat::getEuler.
+*/
+void getEuler( const glm::quat& q, float& ax, float& ay, float& az, EulerRotOrder order = EulerRotOrder_YXZ );
+
+/**
+* @brief Specialization of SplineMath for glm vectors,
+* equal within the same tolerance as Vector3.
+*/
+template <>
+struct SplineMath<glm::vec3>
+{
+	static bool equals( const glm::vec3& a, const glm::vec3& b )
+	{
+		return zhEqualf( a.x, b.x ) && zhEqualf( a.y, b.y ) && zhEqualf( a.z, b.z );
+	}
+};
+
+/**
+* @brief Specialization of SplineMath for glm quaternions,
+* computed the same way as the Quat methods.
+*/
+template <>
+struct SplineMath<glm::quat>
+{
+	static bool equals( const glm::quat& a, const glm::quat& b )
+	{
+		return zhEqualf( a.x, b.x ) && zhEqualf( a.y, b.y ) &&
+			zhEqualf( a.z, b.z ) && zhEqualf( a.w, b.w );
+	}
+
+	static glm::quat inverse( const glm::quat& q )
+	{
+		float inv_qmag = 1.f / ( q.w*q.w + q.x*q.x + q.y*q.y + q.z*q.z );
+
+		return glm::quat( q.w * inv_qmag, q.x * -inv_qmag, q.y * -inv_qmag, q.z * -inv_qmag );
+	}
+
+	static glm::quat exp( const glm::quat& q )
+	{
+		glm::quat q1 = q;
+		float a = sqrt( q.x*q.x + q.y*q.y + q.z*q.z );
+		float sin_a = sin(a);
+
+		if( fabs(sin_a) >= 0.005f )
+		{
+			float c = sin_a / a;
+			q1.x *= c;
+			q1.y *= c;
+			q1.z *= c;
+		}
+
+		q1.w = cos(a);
+
+		return q1;
+	}
+
+	static glm::quat log( const glm::quat& q )
+	{
+		glm::quat q1 = q;
+
+		if( fabs(q.w) < 1.f )
+		{
+			float a = acos(q.w);
+			float sin_a = sin(a);
+
+			if( fabs(sin_a) >= 0.005f )
+			{
+				float c = a/sin_a;
+				q1.x *= c;
+				q1.y *= c;
+				q1.z *= c;
+			}
+		}
+
+		q1.w = 0;
+
+		return q1;
+	}
+
+	static glm::quat slerp( const glm::quat& q0, const glm::quat& q, float t )
+	{
+		float cos_a = q0.w * q.w + q0.x * q.x + q0.y * q.y + q0.z * q.z;
+		glm::quat q1;
+
+		if( cos_a < 0.f )
+		{
+			cos_a = -cos_a;
+			q1 = glm::quat( -q.w, -q.x, -q.y, -q.z );
+		}
+		else
+		{
+			q1 = q;
+		}
+
+		if( fabs(cos_a) < 0.995f )
+		{
+			float sin_a = sqrt( 1.f - cos_a * cos_a );
+			float a = atan2( sin_a, cos_a );
+			float inv_sin_a = 1.f / sin_a;
+			float qc1 = sin( ( 1.f - t ) * a ) * inv_sin_a;
+			float qc2 = sin( t * a ) * inv_sin_a;
+			q1 = q0 * qc1 + q1 * qc2;
+		}
+		else
+		{
+			q1 = q0 * ( 1.f - t ) + q1 * t;
+			float qmag = q1.w*q1.w + q1.x*q1.x + q1.y*q1.y + q1.z*q1.z;
+			qmag = zhEqualf( qmag, 1.f ) ? 1.f : sqrt(qmag);
+			q1 = glm::quat( q1.w / qmag, q1.x / qmag, q1.y / qmag, q1.z / qmag );
+		}
+
+		return q1;
+	}
+
+	static glm::quat squad( const glm::quat& q1, const glm::quat& qa, const glm::quat& qb, const glm::quat& q2, float t )
+	{
+		float t0 = 2.f * t * ( 1.f - t );
+		glm::quat qi1 = slerp( q1, q2, t );
+		glm::quat qi2 = slerp( qa, qb, t );
+
+		return slerp( qi1, qi2, t0 );
+	}
+};
+
+/**
+* @brief Specialization of CatmullRomSpline for glm quaternions,
+* suitable for interpolating between rotations.
+*/
+template <>
+class CatmullRomSpline<glm::quat> : public QuatCatmullRomSpline<glm::quat>
+{
+};
+
+}
+
+#endif // __zhGlm_h__
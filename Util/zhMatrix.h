@@ -20,10 +20,12 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ******************************************************************************/
 
+
 #ifndef __zhMatrix_h__
 #define __zhMatrix_h__
 
 #include "zhPrereq.h"
+#include "zhMathMacros.h"
 #include "zhVector.h"
 
 namespace zh
@@ -32,12 +34,19 @@ namespace zh
 /**
 * NxN square matrix class. Also contains a static method for solving
 * linear equations.
+*
+* The size is a template parameter and the elements are stored
+* in place, row after row, 16-byte aligned, so matrices
+* can live on the stack and never touch the heap.
 */
+template <unsigned int N>
 class Matrix
 {
 
 public:
 
+	enum { dimension = N }; ///< Matrix size, known at compile time.
+
 	/**
 	* Constructor. Creates an identity matrix.
 	*/
@@ -46,20 +55,10 @@ public:
 	/**
 	* Constructor. Creates an identity matrix.
 	*
-	* @param Matrix size.
+	* @param Matrix size, must be equal to N.
 	*/
 	explicit Matrix( unsigned int n );
 
-	/**
-	* Copy constructor.
-	*/
-	Matrix( const Matrix& mat );
-
-	/**
-	* Destructor.
-	*/
-	~Matrix();
-
 	/**
 	* Gets the matrix size.
 	*/
@@ -103,24 +102,24 @@ public:
 	/**
 	* Solves the linear system given by the matrix.
 	*/
-	void solve( const Vector& b, Vector& x );
+	void solve( const Vector<N>& b, Vector<N>& x );
 
 	/**
 	* Performs LU decomposition of the matrix.
 	*/
-	Matrix& LUDecompose( std::vector<unsigned int>& perm );
+	Matrix& LUDecompose( unsigned int (&perm)[N] );
 
 	/**
 	* Solves the linear system given by the matrix
 	* using forward substitution.
 	*/
-	void forwardSubst( const Vector& b, const std::vector<unsigned int>& ordering, Vector& y ) const;
+	void forwardSubst( const Vector<N>& b, const unsigned int (&perm)[N], Vector<N>& y ) const;
 
 	/**
 	* Solves the linear system given by the matrix
 	* using back substitution.
 	*/
-	void backSubst( const Vector& y, Vector& x ) const;
+	void backSubst( const Vector<N>& y, Vector<N>& x ) const;
 
 	/**
 	* Returns true if two matrices are equal.
@@ -145,12 +144,7 @@ public:
 	/**
 	* Multiplies the matrix with a vector.
 	*/
-	Vector operator*( const Vector& v ) const;
-
-	/**
-	* Matrix assigment.
-	*/
-	Matrix& operator =( const Matrix& mat );
+	Vector<N> operator*( const Vector<N>& v ) const;
 
 	/**
 	* Returns true if two matrices are equal.
@@ -165,15 +159,303 @@ public:
 	/**
 	* Multiplies the current matrix with a vector.
 	*/
-	Vector mul( const Vector& v ) const;
+	Vector<N> mul( const Vector<N>& v ) const;
 
 private:
 
-	unsigned int mN; ///< Matrix size.
-	float* mMat; ///< Matrix elements.
+	zhAlign16 float mMat[N*N]; ///< Matrix elements.
 
 };
 
+template <unsigned int N>
+inline Matrix<N>::Matrix()
+{
+	identity();
+}
+
+template <unsigned int N>
+inline Matrix<N>::Matrix( unsigned int n )
+{
+	zhAssert( n == N );
+
+	identity();
+}
+
+template <unsigned int N>
+inline unsigned int Matrix<N>::size() const
+{
+	return N;
+}
+
+template <unsigned int N>
+inline float Matrix<N>::get( unsigned int i, unsigned int j ) const
+{
+	zhAssert( i < N && j < N );
+
+	return mMat[i*N+j];
+}
+
+template <unsigned int N>
+inline void Matrix<N>::set( unsigned int i, unsigned int j, float x )
+{
+	zhAssert( i < N && j < N );
+
+	mMat[i*N+j] = x;
+}
+
+template <unsigned int N>
+inline Matrix<N>& Matrix<N>::identity()
+{
+	for( unsigned int i = 0; i < N; ++i )
+	{
+		for( unsigned int j = 0; j < N; ++j )
+		{
+			if( i == j )
+				set( i, j, 1 );
+			else
+				set( i, j, 0 );
+		}
+	}
+
+	return *this;
+}
+
+template <unsigned int N>
+inline Matrix<N>& Matrix<N>::transpose()
+{
+	float t;
+
+	for( unsigned int i = 0; i < N; ++i )
+	{
+		for( unsigned int j = i; j < N; ++j )
+		{
+			t = get( i, j );
+			set( i, j, get( j, i ) );
+			set( j, i, t );
+		}
+	}
+
+	return *this;
+}
+
+template <unsigned int N>
+inline Matrix<N> Matrix<N>::getTranspose() const
+{
+	Matrix mat = *this;
+	mat.transpose();
+	return mat;
+}
+
+template <unsigned int N>
+inline Matrix<N>& Matrix<N>::invert()
+{
+	Matrix A = *this;
+	unsigned int perm[N];
+	A.LUDecompose(perm);
+	
+	Vector<N> x, e, y;
+
+	for( unsigned int j = 0; j < N; ++j )
+	{
+		e.null();
+		e.set( j, 1.f );
+
+		A.forwardSubst( e, perm, y );
+		A.backSubst( y, x );
+
+		for( unsigned int i = 0; i < N; ++i )
+			set( i, j, x.get(i) );
+	}
+
+	return *this;
+}
+
+template <unsigned int N>
+inline Matrix<N> Matrix<N>::getInverse() const
+{
+	Matrix mat = *this;
+	mat.invert();
+	return mat;
+}
+
+template <unsigned int N>
+inline void Matrix<N>::solve( const Vector<N>& b, Vector<N>& x )
+{
+	unsigned int perm[N];
+	LUDecompose(perm);
+
+	Vector<N> y;
+	forwardSubst( b, perm, y );
+	backSubst( y, x );
+}
+
+template <unsigned int N>
+inline Matrix<N>& Matrix<N>::LUDecompose( unsigned int (&perm)[N] )
+{
+	float pivot;
+	unsigned int l = 0;
+
+	for( unsigned int i = 0; i < N; ++i ) perm[i]= i;
+
+	for( unsigned int k = 0; k + 1 < N; ++k )
+	{
+		pivot = 0;
+		
+		for( unsigned int i = k; i < N; ++i )
+		{
+			if( fabs( get(i,k) ) > pivot )
+			{
+				pivot = fabs( get(i,k) );
+				l = i;
+			}
+		}
+
+		if( zhEqualf( pivot, 0 ) ) // singular matrix
+		{
+			break;
+		}
+
+		unsigned int ti = perm[k];
+		perm[k] = perm[l];
+		perm[l] = ti;
+
+		float tf;
+		for( unsigned int j = 0; j < N; ++j )
+		{
+			tf = get(k,j);
+			set( k, j, get(l,j) );
+			set( l, j, tf );
+		}
+
+		for( unsigned int i = k+1; i < N; ++i )
+		{
+			set( i, k, get(i,k) / get(k,k) );
+
+			for( unsigned int j = k+1; j < N; ++j )
+			{
+				set( i, j, get(i,j) - get(i,k) * get(k,j) );
+			}
+		}
+	}
+
+	return *this;
+}
+
+template <unsigned int N>
+inline void Matrix<N>::forwardSubst( const Vector<N>& b, const unsigned int (&perm)[N], Vector<N>& y ) const
+{
+	float rsum = 0;
+
+	for( unsigned int i = 0; i < N; ++i )
+	{
+		for( unsigned int j = 0; j < i; ++j )
+		{
+			rsum += get(i,j) * y.get(j);
+		}
+
+		y.set( i, b.get( perm[i] ) - rsum );
+		rsum = 0;
+	}
+}
+
+template <unsigned int N>
+inline void Matrix<N>::backSubst( const Vector<N>& y, Vector<N>& x ) const
+{
+	float rsum = 0;
+
+	for( int i = (int)N-1; i >= 0; --i )
+	{
+		for( int j = i+1; j < (int)N; ++j )
+		{
+			rsum += get(i,j) * x.get(j);
+		}
+
+		x.set( i, ( y.get(i) - rsum ) / get(i,i) );
+		rsum = 0;
+	}
+}
+
+template <unsigned int N>
+inline bool Matrix<N>::operator ==( const Matrix& mat ) const
+{
+	for( unsigned int i = 0; i < N*N; ++i )
+	{
+		if( !zhEqualf( mMat[i], mat.mMat[i] ) )
+			return false;
+	}
+
+	return true;
+}
+
+template <unsigned int N>
+inline bool Matrix<N>::operator !=( const Matrix& mat ) const
+{
+	return !( *this == mat );
+}
+
+template <unsigned int N>
+inline Matrix<N> Matrix<N>::operator*( const Matrix& mat ) const
+{
+	Matrix res;
+
+	for( unsigned int i = 0; i < N; ++i )
+	{
+		for( unsigned int j = 0; j < N; ++j )
+		{
+			float rt = 0;
+
+			for( unsigned int k = 0; k < N; ++k )
+				rt += get(i,k) * mat.get(k,j);
+
+			res.set( i, j, rt );
+		}
+	}
+
+	return res;
+}
+
+template <unsigned int N>
+inline void Matrix<N>::operator *=( const Matrix& mat )
+{
+	*this = *this * mat;
+}
+
+template <unsigned int N>
+inline Vector<N> Matrix<N>::operator*( const Vector<N>& v ) const
+{
+	Vector<N> res;
+
+	for( unsigned int i = 0; i < N; ++i )
+	{
+		float rt = 0;
+
+		for( unsigned int j = 0; j < N; ++j )
+			rt += get( i, j ) * v.get(j);
+
+		res.set( i, rt );
+	}
+
+	return res;
+}
+
+template <unsigned int N>
+inline bool Matrix<N>::equals( const Matrix& mat ) const
+{
+	return *this == mat;
+}
+
+template <unsigned int N>
+inline Matrix<N> Matrix<N>::mul( const Matrix& mat ) const
+{
+	return *this * mat;
+}
+
+template <unsigned int N>
+inline Vector<N> Matrix<N>::mul( const Vector<N>& v ) const
+{
+	return *this * v;
+}
+
 }
 
 #endif // __zhMatrix_h__
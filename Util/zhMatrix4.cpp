@@ -435,109 +435,114 @@ Vector3 Matrix4::mul( const Vector3& v ) const
 	return *this * v;
 }
 
-void Matrix4::getEuler( float& ax, float& ay, float& az, EulerRotOrder order ) const
+void getEulerFromRotation( const float rot[][4], float& ax, float& ay, float& az, EulerRotOrder order )
 {
-	Matrix4 mat = getRotationMatrix();
 	float A, C, E;
 
 	if( order == EulerRotOrder_XYZ )
 	{
-		ay = asin( mat.m[0][2] );
+		ay = asin( rot[0][2] );
 		C = cos(ay);
 
 		if( !zhEqualf_t( C, 0, 0.05 ) )
 		{
-			ax = atan2( -mat.m[1][2]/C, mat.m[2][2]/C );
-			az = atan2( -mat.m[0][1]/C, mat.m[0][0]/C );
+			ax = atan2( -rot[1][2]/C, rot[2][2]/C );
+			az = atan2( -rot[0][1]/C, rot[0][0]/C );
 		}
 		else
 		{
 			ax = 0;
-			az = atan2( mat.m[1][0], mat.m[1][1] );
+			az = atan2( rot[1][0], rot[1][1] );
 		}
 	}
 	else if( order == EulerRotOrder_XZY )
 	{
-		az = asin( -mat.m[0][1] );
+		az = asin( -rot[0][1] );
 		E = cos(az);
 
 		if( !zhEqualf_t( E, 0, 0.05 ) )
 		{
-			ax = atan2( mat.m[2][1]/E, mat.m[1][1]/E );
-			ay = atan2( mat.m[0][2]/E, mat.m[0][0]/E );
+			ax = atan2( rot[2][1]/E, rot[1][1]/E );
+			ay = atan2( rot[0][2]/E, rot[0][0]/E );
 		}
 		else
 		{
 			ax = 0;
-			ay = atan2( mat.m[1][2], mat.m[1][0] );
+			ay = atan2( rot[1][2], rot[1][0] );
 		}
 	}
 	else if( order == EulerRotOrder_YXZ )
 	{
-		ax = asin( -mat.m[1][2] );
+		ax = asin( -rot[1][2] );
 		A = cos(ax);
 
 		if( !zhEqualf_t( A, 0, 0.05 ) )
 		{
-			ay = atan2( mat.m[0][2]/A, mat.m[2][2]/A );
-			az = atan2( mat.m[1][0]/A, mat.m[1][1]/A );
+			ay = atan2( rot[0][2]/A, rot[2][2]/A );
+			az = atan2( rot[1][0]/A, rot[1][1]/A );
 		}
 		else
 		{
 			ay = 0;
-			az = atan2( -mat.m[0][1], mat.m[0][0] );
+			az = atan2( -rot[0][1], rot[0][0] );
 		}
 	}
 	else if( order == EulerRotOrder_YZX )
 	{
-		az = asin( mat.m[1][0] );
+		az = asin( rot[1][0] );
 		E = cos(az);
 
 		if( !zhEqualf_t( E, 0, 0.05 ) )
 		{
-			ax = atan2( -mat.m[1][2]/E, mat.m[1][1]/E );
-			ay = atan2( -mat.m[2][0]/E, mat.m[0][0]/E );
+			ax = atan2( -rot[1][2]/E, rot[1][1]/E );
+			ay = atan2( -rot[2][0]/E, rot[0][0]/E );
 		}
 		else
 		{
 			ay = 0;
-			ax = atan2( mat.m[2][1], mat.m[2][2] );
+			ax = atan2( rot[2][1], rot[2][2] );
 		}
 	}
 	else if( order == EulerRotOrder_ZXY )
 	{
-		ax = asin( mat.m[2][1] );
+		ax = asin( rot[2][1] );
 		A = cos(ax);
 
 		if( !zhEqualf_t( A, 0, 0.05 ) )
 		{
-			ay = atan2( -mat.m[2][0]/A, mat.m[2][2]/A );
-			az = atan2( -mat.m[0][1]/A, mat.m[1][1]/A );
+			ay = atan2( -rot[2][0]/A, rot[2][2]/A );
+			az = atan2( -rot[0][1]/A, rot[1][1]/A );
 		}
 		else
 		{
 			az = 0;
-			ay = atan2( mat.m[0][2], mat.m[0][0] );
+			ay = atan2( rot[0][2], rot[0][0] );
 		}
 	}
 	else if( order == EulerRotOrder_ZYX )
 	{
-		ay = asin( -mat.m[2][0] );
+		ay = asin( -rot[2][0] );
 		C = cos(ay);
 
 		if( !zhEqualf_t( C, 0, 0.05 ) )
 		{
-			ax = atan2( mat.m[2][1]/C, mat.m[2][2]/C );
-			az = atan2( mat.m[1][0]/C, mat.m[0][0]/C );
+			ax = atan2( rot[2][1]/C, rot[2][2]/C );
+			az = atan2( rot[1][0]/C, rot[0][0]/C );
 		}
 		else
 		{
 			az = 0;
-			ax = atan2( -mat.m[1][2], mat.m[1][1] );
+			ax = atan2( -rot[1][2], rot[1][1] );
 		}
 	}
 }
 
+void Matrix4::getEuler( float& ax, float& ay, float& az, EulerRotOrder order ) const
+{
+	Matrix4 mat = getRotationMatrix();
+	getEulerFromRotation( mat.m, ax, ay, az, order );
+}
+
 Matrix4& Matrix4::setEuler( float ax, float ay, float az, EulerRotOrder order )
 {
 	Matrix4 mat( ax, ay, az, order );
@@ -102,6 +102,12 @@ private:
 	void getSubMatrix3x3( int i, int j, float* subMat ) const; ///< Get a 3x3 submatrix of the current matrix.
 };
 
+/**
+* Extracts Euler angles from a rotation matrix without scale,
+* given by the upper-left 3x3 elements of the rows in rot.
+*/
+void getEulerFromRotation( const float rot[][4], float& ax, float& ay, float& az, EulerRotOrder order = EulerRotOrder_YXZ );
+
 }
 
 #endif // __zhMatrix4_h__
@@ -52,22 +52,31 @@ SOFTWARE.
 
 // compilers
 #define zhCompiler_MSVC 1
+#define zhCompiler_GNUC 2
 
-// identify compiler
+// identify compiler (Clang defines __GNUC__ as well)
 #if defined(_MSC_VER)
 	#define zhCompiler zhCompiler_MSVC
+#elif defined(__GNUC__)
+	#define zhCompiler zhCompiler_GNUC
 #else
-	#pragma error "Unknown compiler. Compilation failed."
+	#error "Unknown compiler. Compilation failed."
 #endif
 
 // platforms
 #define zhPlatform_Win 1
+#define zhPlatform_Linux 2
+#define zhPlatform_Apple 3
 
 // identify platform
 #if defined(__WIN32__) || defined(_WIN32)
 	#define zhPlatform zhPlatform_Win
+#elif defined(__linux__)
+	#define zhPlatform zhPlatform_Linux
+#elif defined(__APPLE__)
+	#define zhPlatform zhPlatform_Apple
 #else
-	#pragma error "Unknown platform. Compilation failed."
+	#error "Unknown platform. Compilation failed."
 #endif
 
 // architectures
@@ -90,6 +99,13 @@ SOFTWARE.
 	typedef unsigned long long UInt64;
 #endif
 
+// 16-byte alignment, so fixed-size math types can be loaded into SIMD registers
+#if zhCompiler == zhCompiler_MSVC
+	#define zhAlign16 __declspec( align(16) )
+#else
+	#define zhAlign16 __attribute__( ( aligned(16) ) )
+#endif
+
 // suppress some annoying warnings
 #if zhCompiler == zhCompiler_MSVC
 	#pragma warning( disable : 4251 4267 )
@@ -146,11 +162,7 @@ SOFTWARE.
 #include <set>
 #include <string>
 #include <vector>
-#if zhCompiler == zhCompiler_MSVC
 #include <unordered_map>
-#else
-#include <tr1/unordered_map>
-#endif
 #include <algorithm>
 
 // Boost
@@ -20,30 +20,38 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ******************************************************************************/
 
+
 #ifndef __zhVector_h__
 #define __zhVector_h__
 
 #include "zhPrereq.h"
 #include "zhString.h"
+#include "zhMathMacros.h"
 
 namespace zh
 {
 
-class Matrix;
+template <unsigned int N> class Matrix;
 
 /**
 * @brief Vector class, representing an N-dimensional vector
 * or point in N-dimensional space.
+*
+* The dimension is a template parameter and the components are stored
+* in place, 16-byte aligned, so vectors can live on the stack
+* and never touch the heap.
 */
+template <unsigned int N>
 class Vector
 {
 
 public:
 
+	enum { dimension = N }; ///< Vector dimensionality, known at compile time.
+
 	Vector(); ///< Constructor. Creates an uninitialized vector.
-	explicit Vector( unsigned int n, float x = 0.f ); ///< Constructor. Creates a vector and initializes all elements with specific value.
-	Vector( const Vector& v ); ///< Copy constructor.
-	~Vector(); ///< Destructor.
+	explicit Vector( float x ); ///< Constructor. Creates a vector and initializes all elements with specific value.
+	Vector( unsigned int n, float x ); ///< Constructor. Same as above, n must be equal to N.
 	unsigned int size() const; ///< Gets the vector size.
 	float get( unsigned int i ) const; ///< Gets an element of the vector by index.
 	void set( unsigned int i, float x ); ///< Sets an element of the vector by index.
@@ -71,67 +79,396 @@ public:
 	Vector operator -( const Vector& v ) const; ///< Subtracts two vectors.
 	void operator -=( const Vector& v ); ///< Subtracts two vectors.
 	Vector operator *( const Vector& v ) const; ///< Vector product.
-	Vector operator *( const Matrix& mat ) const; ///< Multiply the vector with a matrix.
-	void operator *=( const Matrix& mat ); ///< Multiply the vector with a matrix.
-	Vector& operator =( const Vector& v ); ///< Vector assignment.
+	Vector operator *( const Matrix<N>& mat ) const; ///< Multiply the vector with a matrix.
+	void operator *=( const Matrix<N>& mat ); ///< Multiply the vector with a matrix.
 	bool equals( const Vector& v ) const; ///< Returns true if vectors are equal.
 	Vector& negate(); ///< Negates the vector.
 	Vector mul( const float s ) const; ///< Scalar-vector multiplication.
 	Vector mul( const Vector& v ) const; ///< Vector-vector multiplication.
-	Vector mul( const Matrix& mat ) const; ///< Multiply the current vector with a matrix.
+	Vector mul( const Matrix<N>& mat ) const; ///< Multiply the current vector with a matrix.
 	Vector div( const float s ) const; ///< Scalar-vector division.
 	Vector add( const Vector& v ) const; ///< Adds two vectors.
 	Vector sub( const Vector& v ) const; ///< Subtracts two vectors.
 	float dot( const Vector& v ) const; ///< Vector dot-product.
 
-	// TODO: overload sizeof here and in Matrix class?
-
 private:
 
-	unsigned int mN; ///< Vector dimensionality.
-	float* mV; ///< Vector components.
+	zhAlign16 float mV[N]; ///< Vector components.
 
 };
 
-template <>
-inline std::string toString<Vector>( const Vector& v )
+typedef Vector<4> Vector4; ///< 4-dimensional vector, e.g. the powers of a cubic's parameter.
+
+template <unsigned int N>
+inline Vector<N>::Vector()
+{
+}
+
+template <unsigned int N>
+inline Vector<N>::Vector( float x )
+{
+	for( unsigned int i = 0; i < N; ++i )
+		mV[i] = x;
+}
+
+template <unsigned int N>
+inline Vector<N>::Vector( unsigned int n, float x )
+{
+	zhAssert( n == N );
+
+	for( unsigned int i = 0; i < N; ++i )
+		mV[i] = x;
+}
+
+template <unsigned int N>
+inline unsigned int Vector<N>::size() const
+{
+	return N;
+}
+
+template <unsigned int N>
+inline float Vector<N>::get( unsigned int i ) const
+{
+	zhAssert( i < N );
+
+	return mV[i];
+}
+
+template <unsigned int N>
+inline void Vector<N>::set( unsigned int i, float x )
+{
+	zhAssert( i < N );
+
+	mV[i] = x;
+}
+
+template <unsigned int N>
+inline Vector<N>& Vector<N>::null()
+{
+	memset( mV, 0, N * sizeof(float) );
+
+	return *this;
+}
+
+template <unsigned int N>
+inline float Vector<N>::lengthSq() const
+{
+	float len = 0.f;
+
+	for( unsigned int i = 0; i < N; ++i )
+		len += mV[i] * mV[i];
+
+	return len;
+}
+
+template <unsigned int N>
+inline float Vector<N>::length() const
+{
+	return sqrt( lengthSq() );
+}
+
+template <unsigned int N>
+inline Vector<N>& Vector<N>::normalize()
+{
+	float inv_len = 1.f / length();
+
+	for( unsigned int i = 0; i < N; ++i )
+		mV[i] *= inv_len;
+
+	return *this;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::getNormalized() const
+{
+	Vector v = *this;
+	return v.normalize();
+}
+
+template <unsigned int N>
+inline float Vector<N>::sum() const
 {
-	std::ostringstream oss;
+	float s = 0.f;
+
+	for( unsigned int i = 0; i < N; ++i )
+		s += mV[i];
 
-	for( unsigned int i = 0; i < v.size(); ++i )
+	return s;
+}
+
+template <unsigned int N>
+inline float Vector<N>::distance( const Vector& v ) const
+{
+	return sqrt( distanceSq(v) );
+}
+
+template <unsigned int N>
+inline float Vector<N>::distanceSq( const Vector& v ) const
+{
+	float d = 0;
+	float d1;
+
+	for( unsigned int i = 0; i < N; ++i )
 	{
-		oss << v[i];
-		
-		if( i < v.size() - 1 )
-			oss << " ";
+		d1 = mV[i] - v.mV[i];
+		d += ( d1 * d1 );
 	}
 
-	return oss.str();
+	return d;
+}
+
+template <unsigned int N>
+inline float Vector<N>::angle( const Vector& v ) const
+{
+	return acos( this->dot(v) );
+}
+
+template <unsigned int N>
+inline float& Vector<N>::operator[]( int i )
+{
+	zhAssert( (unsigned int)i < N );
+
+	return mV[i];
+}
+
+template <unsigned int N>
+inline float Vector<N>::operator[]( int i ) const
+{
+	zhAssert( (unsigned int)i < N );
+
+	return mV[i];
+}
+
+template <unsigned int N>
+inline bool Vector<N>::operator ==( const Vector& v ) const
+{
+	for( unsigned int i = 0; i < N; ++i )
+		if( !zhEqualf( mV[i], v.mV[i] ) )
+			return false;
+
+	return true;
+}
+
+template <unsigned int N>
+inline bool Vector<N>::operator !=( const Vector& v ) const
+{
+	return !( *this == v );
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::operator +() const
+{
+	return *this;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::operator -() const
+{
+	Vector v1;
+
+	for( unsigned int i = 0; i < N; ++i )
+		v1.mV[i] = -mV[i];
+
+	return v1;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::operator *( float s ) const
+{
+	Vector v1;
+
+	for( unsigned int i = 0; i < N; ++i )
+		v1.mV[i] = mV[i] * s;
+
+	return v1;
+}
+
+template <unsigned int N>
+inline void Vector<N>::operator *=( float s )
+{
+	for( unsigned int i = 0; i < N; ++i )
+		mV[i] *= s;
 }
 
-template <>
-inline Vector fromString<Vector>( const std::string& tstr )
+template <unsigned int N>
+inline Vector<N> Vector<N>::operator /( float s ) const
 {
-	std::istringstream iss(tstr);
+	Vector v1;
 
-	unsigned int n = 0;
-	float x;
-	while( !iss.eof() )
+	for( unsigned int i = 0; i < N; ++i )
+		v1.mV[i] = mV[i] / s;
+
+	return v1;
+}
+
+template <unsigned int N>
+inline void Vector<N>::operator /=( float s )
+{
+	for( unsigned int i = 0; i < N; ++i )
+		mV[i] /= s;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::operator +( const Vector& v ) const
+{
+	Vector v1;
+
+	for( unsigned int i = 0; i < N; ++i )
+		v1.mV[i] = mV[i] + v.mV[i];
+
+	return v1;
+}
+
+template <unsigned int N>
+inline void Vector<N>::operator +=( const Vector& v )
+{
+	for( unsigned int i = 0; i < N; ++i )
+		mV[i] += v.mV[i];
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::operator -( const Vector& v ) const
+{
+	Vector v1;
+
+	for( unsigned int i = 0; i < N; ++i )
+		v1.mV[i] = mV[i] - v.mV[i];
+
+	return v1;
+}
+
+template <unsigned int N>
+inline void Vector<N>::operator -=( const Vector& v )
+{
+	for( unsigned int i = 0; i < N; ++i )
+		mV[i] -= v.mV[i];
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::operator *( const Vector& v ) const
+{
+	Vector v1;
+
+	for( unsigned int i = 0; i < N; ++i )
+		v1.mV[i] = mV[i] * v.mV[i];
+
+	return v1;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::operator *( const Matrix<N>& mat ) const
+{
+	Vector res;
+
+	for( unsigned int i = 0; i < N; ++i )
 	{
-		iss >> x;
-		++n;
+		float rt = 0;
+
+		for( unsigned int j = 0; j < N; ++j )
+			rt += ( mat.get(j,i) * mV[j] );
+
+		res.mV[i] = rt;
 	}
 
-	Vector v(n);
-	n = 0;
-	iss.seekg(0);
-	while( !iss.eof() )
+	return res;
+}
+
+template <unsigned int N>
+inline void Vector<N>::operator *=( const Matrix<N>& mat )
+{
+	*this = *this * mat;
+}
+
+template <unsigned int N>
+inline bool Vector<N>::equals( const Vector& v ) const
+{
+	return *this == v;
+}
+
+template <unsigned int N>
+inline Vector<N>& Vector<N>::negate()
+{
+	*this = -*this;
+
+	return *this;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::mul( const float s ) const
+{
+	return *this * s;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::mul( const Vector& v ) const
+{
+	return *this * v;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::mul( const Matrix<N>& mat ) const
+{
+	return *this * mat;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::div( const float s ) const
+{
+	return *this/s;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::add( const Vector& v ) const
+{
+	return *this + v;
+}
+
+template <unsigned int N>
+inline Vector<N> Vector<N>::sub( const Vector& v ) const
+{
+	return *this - v;
+}
+
+template <unsigned int N>
+inline float Vector<N>::dot( const Vector& v ) const
+{
+	float d = 0.f;
+
+	for( unsigned int i = 0; i < N; ++i )
+		d += ( mV[i] * v.mV[i] );
+
+	return d;
+}
+
+/**
+* Writes vector components separated by spaces,
+* which is also how toString formats vectors.
+*/
+template <unsigned int N>
+inline std::ostream& operator <<( std::ostream& os, const Vector<N>& v )
+{
+	for( unsigned int i = 0; i < N; ++i )
 	{
-		iss >> v[n];
-		++n;
+		os << v[i];
+		
+		if( i < N - 1 )
+			os << " ";
 	}
 
-	return v;
+	return os;
+}
+
+/**
+* Reads N vector components separated by whitespace,
+* which is also how fromString parses vectors.
+*/
+template <unsigned int N>
+inline std::istream& operator >>( std::istream& is, Vector<N>& v )
+{
+	for( unsigned int i = 0; i < N; ++i )
+		is >> v[i];
+
+	return is;
 }
 
 }